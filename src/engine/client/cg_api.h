@@ -234,7 +234,9 @@ typedef enum cgameImport_s
   CG_SETCOLORGRADING,
   CG_CM_DISTANCETOMODEL,
   CG_R_SCISSOR_ENABLE,
-  CG_R_SCISSOR_SET
+  CG_R_SCISSOR_SET,
+  CG_PARSE_READ_TOKENS,
+  CG_R_DRAWSTRETCHPICS
 } cgameImport_t;
 
 typedef enum
@@ -391,6 +393,7 @@ void            trap_R_RestoreViewParms( void );
 void            trap_R_SetColor( const float *rgba );
 void            trap_R_SetClipRegion( const float *region );
 void            trap_R_DrawStretchPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader );
+void            trap_R_DrawStretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader );
 void            trap_R_DrawRotatedPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader, float angle );
 void            trap_R_DrawStretchPicGradient( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader, const float *gradientColor, int gradientType );
 void            trap_R_Add2dPolys( polyVert_t *verts, int numverts, qhandle_t hShader );
@@ -436,6 +439,7 @@ int             trap_Parse_AddGlobalDefine( const char *define );
 int             trap_Parse_LoadSource( const char *filename );
 int             trap_Parse_FreeSource( int handle );
 int             trap_Parse_ReadToken( int handle, pc_token_t *pc_token );
+int             trap_Parse_ReadTokens( int handle, pc_token_t *pc_tokens, int maxTokens );
 int             trap_Parse_SourceFileAndLine( int handle, char *filename, int *line );
 void            trap_Key_KeynumToStringBuf( int keynum, char *buf, int buflen );
 void            trap_CG_TranslateString( const char *string, char *buf );
@@ -1019,6 +1019,14 @@ int Cin_OGM_Run( int time )
 	return 0;
 }
 
+/*
+  Number of the last decoded video frame
+*/
+int Cin_OGM_FrameCount( void )
+{
+	return g_ogm.VFrameCount;
+}
+
 /*
   Gives a Pointer to the current Output-Buffer
   and the Resolution
@@ -1094,6 +1102,11 @@ unsigned char  *Cin_OGM_GetOutput( int *outWidth, int *outHeight )
 	return 0;
 }
 
+int Cin_OGM_FrameCount( void )
+{
+	return 0;
+}
+
 void Cin_OGM_Shutdown( void )
 {
 }
@@ -23,10 +23,16 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "client.h"
 #include "snd_local.h"
 
+#include <SDL_mutex.h>
+#include <SDL_thread.h>
+
 #define INDEX_FILE_EXTENSION ".index.dat"
 
 #define MAX_RIFF_CHUNKS      16
 
+// alignment padding the renderer may need for reading back pixel lines
+#define MAX_PACK_LEN         16
+
 typedef struct audioFormat_s
 {
 	int rate;
@@ -69,6 +75,8 @@ typedef struct aviFileData_s
 
 static aviFileData_t afd;
 
+static qboolean      CL_CloseAVIFile( void );
+
 #define MAX_AVI_BUFFER 2048
 
 static byte buffer[ MAX_AVI_BUFFER ];
@@ -329,15 +337,382 @@ void CL_WriteAVIHeader( void )
 	}
 }
 
+/*
+===========================================================================
+
+Capture pipeline
+
+With cl_aviEncoders set, the renderer only reads frames back and the
+encoding happens on a pool of encoder threads, with up to
+cl_aviPipelineMegs worth of frames in flight. Encoded frames are written
+out in capture order on the main thread, as neither the file system nor
+Com_Error may be used from other threads.
+
+===========================================================================
+*/
+
+#define MAX_AVI_ENCODERS        8
+#define MAX_AVI_PIPELINE_FRAMES 64
+
+// how long to wait for the renderer to read a frame back before dropping it
+#define AVI_CAPTURE_TIMEOUT     1000
+
+typedef enum
+{
+  AVIFRAME_FREE,
+  AVIFRAME_CAPTURING, // handed to the renderer
+  AVIFRAME_CAPTURED, // read back, waiting for an encoder
+  AVIFRAME_ENCODING,
+  AVIFRAME_ENCODED // waiting to be written
+} aviFrameState_t;
+
+typedef struct aviFrame_s
+{
+	aviFrameState_t state;
+	byte            *cBuffer, *eBuffer;
+	int             size;
+} aviFrame_t;
+
+typedef struct aviPipeline_s
+{
+	qboolean   active;
+	qboolean   shutdown;
+
+	SDL_mutex  *mutex;
+	SDL_cond   *frameCaptured;
+	SDL_cond   *frameEncoded;
+	SDL_Thread *encoders[ MAX_AVI_ENCODERS ];
+	int        numEncoders;
+
+	int        width, height;
+	qboolean   motionJpeg;
+	int        encodeBufferSize;
+
+	aviFrame_t frames[ MAX_AVI_PIPELINE_FRAMES ];
+	int        numFrames;
+	int        captureBufferSize;
+
+	// capture buffers of dropped frames the renderer may still write into
+	byte       *abandoned[ MAX_AVI_PIPELINE_FRAMES ];
+	int        numAbandoned;
+
+	// frames are used in sequence, frames[ seq % numFrames ]
+	int        writeSeq; // oldest frame in flight
+	int        takeSeq; // next frame to hand to the renderer
+
+	int        startTime;
+	int        peakDepth;
+	int        numStalls;
+	int        stallTime;
+	int        numDropped;
+} aviPipeline_t;
+
+static aviPipeline_t avp;
+
 /*
 ===============
-CL_OpenAVIForWriting
+CL_AVIEncoderThread
+===============
+*/
+static int CL_AVIEncoderThread( void *arg )
+{
+	aviFrame_t *frame;
+	int        seq;
+
+	SDL_LockMutex( avp.mutex );
+
+	while ( !avp.shutdown )
+	{
+		// encode the oldest frame that is ready
+		for ( frame = NULL, seq = avp.writeSeq; seq < avp.takeSeq; seq++ )
+		{
+			if ( avp.frames[ seq % avp.numFrames ].state == AVIFRAME_CAPTURED )
+			{
+				frame = &avp.frames[ seq % avp.numFrames ];
+				break;
+			}
+		}
+
+		if ( !frame )
+		{
+			SDL_CondWait( avp.frameCaptured, avp.mutex );
+			continue;
+		}
+
+		frame->state = AVIFRAME_ENCODING;
+		SDL_UnlockMutex( avp.mutex );
+
+		frame->size = re.EncodeVideoFrame( frame->eBuffer, avp.encodeBufferSize, frame->cBuffer, avp.width, avp.height, avp.motionJpeg );
+
+		SDL_LockMutex( avp.mutex );
+		frame->state = AVIFRAME_ENCODED;
+		SDL_CondBroadcast( avp.frameEncoded );
+	}
+
+	SDL_UnlockMutex( avp.mutex );
+
+	return 0;
+}
+
+/*
+===============
+CL_WriteAVIFrames
+
+Writes the encoded frames at the head of the pipeline, waiting for
+frames still being read back or encoded until at most keep are left
+===============
+*/
+static void CL_WriteAVIFrames( int keep )
+{
+	aviFrame_t *frame;
+	int        startTime;
+
+	SDL_LockMutex( avp.mutex );
+
+	while ( avp.writeSeq < avp.takeSeq )
+	{
+		frame = &avp.frames[ avp.writeSeq % avp.numFrames ];
+
+		if ( frame->state != AVIFRAME_ENCODED )
+		{
+			if ( avp.takeSeq - avp.writeSeq <= keep )
+			{
+				break;
+			}
+
+			startTime = Sys_Milliseconds();
+
+			if ( SDL_CondWaitTimeout( avp.frameEncoded, avp.mutex, AVI_CAPTURE_TIMEOUT ) == SDL_MUTEX_TIMEDOUT &&
+			     frame->state == AVIFRAME_CAPTURING && avp.numAbandoned < MAX_AVI_PIPELINE_FRAMES )
+			{
+				byte *captureBuffer = malloc( avp.captureBufferSize );
+
+				// the renderer hasn't read this one back yet, so it keeps
+				// the old buffer until CL_QueueAVIVideoFrame gets it
+				if ( captureBuffer )
+				{
+					avp.abandoned[ avp.numAbandoned++ ] = frame->cBuffer;
+					frame->cBuffer = captureBuffer;
+					frame->state = AVIFRAME_FREE;
+					avp.writeSeq++;
+					avp.numDropped++;
+				}
+			}
+
+			avp.stallTime += Sys_Milliseconds() - startTime;
+			continue;
+		}
+
+		// encoders leave encoded frames alone
+		SDL_UnlockMutex( avp.mutex );
+		CL_WriteAVIVideoFrame( frame->eBuffer, frame->size );
+		SDL_LockMutex( avp.mutex );
+
+		frame->state = AVIFRAME_FREE;
+		avp.writeSeq++;
+	}
+
+	SDL_UnlockMutex( avp.mutex );
+}
+
+/*
+===============
+CL_StopAVIPipeline
+
+Writes out all frames in flight and stops the encoders
+===============
+*/
+static void CL_StopAVIPipeline( void )
+{
+	int i;
+
+	// the renderer stops reading frames back once the file is closed
+	if ( avp.active && afd.fileOpen )
+	{
+		CL_WriteAVIFrames( 0 );
+
+		Com_Printf( "Encoded %d frames at %.1f fps on %d threads, queue depth peaked at %d of %d, %d stalls (%d msec)\n",
+		            avp.writeSeq - avp.numDropped, ( avp.writeSeq - avp.numDropped ) * 1000.0f / MAX( Sys_Milliseconds() - avp.startTime, 1 ),
+		            avp.numEncoders, avp.peakDepth, avp.numFrames, avp.numStalls, avp.stallTime );
+
+		if ( avp.numDropped )
+		{
+			Com_Printf( S_WARNING "%d frames were never read back by the renderer\n", avp.numDropped );
+		}
+	}
+
+	if ( avp.mutex )
+	{
+		SDL_LockMutex( avp.mutex );
+		avp.shutdown = qtrue;
+		SDL_CondBroadcast( avp.frameCaptured );
+		SDL_UnlockMutex( avp.mutex );
+	}
+
+	for ( i = 0; i < avp.numEncoders; i++ )
+	{
+		SDL_WaitThread( avp.encoders[ i ], NULL );
+	}
+
+	for ( i = 0; i < avp.numFrames; i++ )
+	{
+		free( avp.frames[ i ].cBuffer );
+		free( avp.frames[ i ].eBuffer );
+	}
+
+	// the buffers of frames the renderer never read back are left alone,
+	// it might still get to them
+
+	if ( avp.frameEncoded )
+	{
+		SDL_DestroyCond( avp.frameEncoded );
+	}
+
+	if ( avp.frameCaptured )
+	{
+		SDL_DestroyCond( avp.frameCaptured );
+	}
+
+	if ( avp.mutex )
+	{
+		SDL_DestroyMutex( avp.mutex );
+	}
+
+	Com_Memset( &avp, 0, sizeof( avp ) );
+}
+
+/*
+===============
+CL_StartAVIPipeline
+
+Falls back to encoding in the renderer when the pipeline can't be set up
+===============
+*/
+static void CL_StartAVIPipeline( void )
+{
+	int captureBufferSize, count, i;
+
+	CL_StopAVIPipeline();
+
+	if ( cl_aviEncoders->integer <= 0 )
+	{
+		return;
+	}
+
+	avp.width = afd.width;
+	avp.height = afd.height;
+	avp.motionJpeg = afd.motionJpeg;
+
+	// same sizes as the buffers in afd
+	captureBufferSize = ( avp.width * 3 + MAX_PACK_LEN - 1 ) * avp.height + MAX_PACK_LEN - 1;
+	avp.captureBufferSize = captureBufferSize;
+	avp.encodeBufferSize = PAD( avp.width * 3, AVI_LINE_PADDING ) * avp.height;
+
+	count = MIN( cl_aviEncoders->integer, MAX_AVI_ENCODERS );
+	avp.numFrames = cl_aviPipelineMegs->integer * 1024 * 1024 / ( captureBufferSize + avp.encodeBufferSize );
+	avp.numFrames = Com_Clamp( count + 1, MAX_AVI_PIPELINE_FRAMES, avp.numFrames );
+
+	// these are too big for the zone and the encoders write them outside the main thread
+	for ( i = 0; i < avp.numFrames; i++ )
+	{
+		avp.frames[ i ].cBuffer = malloc( captureBufferSize );
+		avp.frames[ i ].eBuffer = malloc( avp.encodeBufferSize );
+
+		if ( !avp.frames[ i ].cBuffer || !avp.frames[ i ].eBuffer )
+		{
+			Com_Printf( S_WARNING "Not enough memory for %d video frames, encoding in the renderer\n", avp.numFrames );
+			avp.numFrames = i + 1;
+			CL_StopAVIPipeline();
+			return;
+		}
+	}
+
+	avp.mutex = SDL_CreateMutex();
+	avp.frameCaptured = SDL_CreateCond();
+	avp.frameEncoded = SDL_CreateCond();
+
+	if ( !avp.mutex || !avp.frameCaptured || !avp.frameEncoded )
+	{
+		Com_Printf( S_WARNING "Video encoder setup failed: %s\n", SDL_GetError() );
+		CL_StopAVIPipeline();
+		return;
+	}
+
+	for ( avp.numEncoders = 0; avp.numEncoders < count; avp.numEncoders++ )
+	{
+		avp.encoders[ avp.numEncoders ] = SDL_CreateThread( CL_AVIEncoderThread, NULL );
+
+		if ( !avp.encoders[ avp.numEncoders ] )
+		{
+			Com_Printf( S_WARNING "SDL_CreateThread() returned %s\n", SDL_GetError() );
+			break;
+		}
+	}
+
+	if ( !avp.numEncoders )
+	{
+		CL_StopAVIPipeline();
+		return;
+	}
+
+	avp.startTime = Sys_Milliseconds();
+	avp.active = qtrue;
+}
+
+/*
+===============
+CL_QueueAVIVideoFrame
+
+Called by the renderer, possibly from its own thread, once a frame
+handed out by CL_TakeVideoFrame has been read back
+===============
+*/
+void CL_QueueAVIVideoFrame( byte *pixels )
+{
+	int seq, i;
+
+	if ( !avp.mutex )
+	{
+		return;
+	}
+
+	SDL_LockMutex( avp.mutex );
+
+	for ( seq = avp.writeSeq; seq < avp.takeSeq; seq++ )
+	{
+		aviFrame_t *frame = &avp.frames[ seq % avp.numFrames ];
+
+		if ( frame->state == AVIFRAME_CAPTURING && frame->cBuffer == pixels )
+		{
+			frame->state = AVIFRAME_CAPTURED;
+			SDL_CondSignal( avp.frameCaptured );
+			break;
+		}
+	}
+
+	// a frame CL_WriteAVIFrames already gave up on
+	for ( i = 0; i < avp.numAbandoned; i++ )
+	{
+		if ( avp.abandoned[ i ] == pixels )
+		{
+			free( pixels );
+			avp.abandoned[ i ] = avp.abandoned[ --avp.numAbandoned ];
+			break;
+		}
+	}
+
+	SDL_UnlockMutex( avp.mutex );
+}
+
+/*
+===============
+CL_OpenAVIFile
 
 Creates an AVI file and gets it into a state where
 writing the actual data can begin
 ===============
 */
-qboolean CL_OpenAVIForWriting( const char *fileName )
+static qboolean CL_OpenAVIFile( const char *fileName )
 {
 	if ( afd.fileOpen )
 	{
@@ -383,7 +758,6 @@ qboolean CL_OpenAVIForWriting( const char *fileName )
 	// Buffers only need to store RGB pixels.
 	// Allocate a bit more space for the capture buffer to account for possible
 	// padding at the end of pixel lines, and padding for alignment
-#define MAX_PACK_LEN 16
 	afd.cBuffer = Z_Malloc( ( afd.width * 3 + MAX_PACK_LEN - 1 ) * afd.height + MAX_PACK_LEN - 1 );
 	// raw avi files have pixel lines start on 4-byte boundaries
 	afd.eBuffer = Z_Malloc( PAD( afd.width * 3, AVI_LINE_PADDING ) * afd.height );
@@ -444,6 +818,23 @@ qboolean CL_OpenAVIForWriting( const char *fileName )
 	return qtrue;
 }
 
+/*
+===============
+CL_OpenAVIForWriting
+===============
+*/
+qboolean CL_OpenAVIForWriting( const char *fileName )
+{
+	if ( !CL_OpenAVIFile( fileName ) )
+	{
+		return qfalse;
+	}
+
+	CL_StartAVIPipeline();
+
+	return qtrue;
+}
+
 /*
 ===============
 CL_CheckFileSize
@@ -463,10 +854,10 @@ static qboolean CL_CheckFileSize( int bytesToAdd )
 	if ( newFileSize > INT_MAX )
 	{
 		// Close the current file...
-		CL_CloseAVI();
+		CL_CloseAVIFile();
 
 		// ...And open a new one
-		CL_OpenAVIForWriting( va( "%s_", afd.fileName ) );
+		CL_OpenAVIFile( va( "%s_", afd.fileName ) );
 
 		return qtrue;
 	}
@@ -604,23 +995,49 @@ CL_TakeVideoFrame
 */
 void CL_TakeVideoFrame( void )
 {
+	aviFrame_t *frame;
+
 	// AVI file isn't open
 	if ( !afd.fileOpen )
 	{
 		return;
 	}
 
-	re.TakeVideoFrame( afd.width, afd.height, afd.cBuffer, afd.eBuffer, afd.motionJpeg );
+	if ( !avp.active )
+	{
+		re.TakeVideoFrame( afd.width, afd.height, afd.cBuffer, afd.eBuffer, afd.motionJpeg );
+		return;
+	}
+
+	// make room for the frame, waiting for the encoders if they fell behind
+	if ( avp.takeSeq - avp.writeSeq == avp.numFrames )
+	{
+		avp.numStalls++;
+	}
+
+	CL_WriteAVIFrames( avp.numFrames - 1 );
+
+	SDL_LockMutex( avp.mutex );
+
+	frame = &avp.frames[ avp.takeSeq % avp.numFrames ];
+	frame->state = AVIFRAME_CAPTURING;
+	avp.takeSeq++;
+	avp.peakDepth = MAX( avp.peakDepth, avp.takeSeq - avp.writeSeq );
+
+	SDL_UnlockMutex( avp.mutex );
+
+	// no encode buffer makes the renderer hand the pixels to CL_QueueAVIVideoFrame
+	re.TakeVideoFrame( avp.width, avp.height, frame->cBuffer, NULL, avp.motionJpeg );
 }
 
 /*
 ===============
-CL_CloseAVI
+CL_CloseAVIFile
 
 Closes the AVI file and writes an index chunk
 ===============
 */
-qboolean CL_CloseAVI( void )
+static qboolean CL_CloseAVIFile( void )
 {
 	int        indexRemainder;
 	int        indexSize = afd.numIndices * 16;
@@ -689,6 +1106,18 @@ qboolean CL_CloseAVI( void )
 	return qtrue;
 }
 
+/*
+===============
+CL_CloseAVI
+===============
+*/
+qboolean CL_CloseAVI( void )
+{
+	CL_StopAVIPipeline();
+
+	return CL_CloseAVIFile();
+}
+
 /*
 ===============
 CL_VideoRecording
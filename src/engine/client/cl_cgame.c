@@ -1277,6 +1277,15 @@ intptr_t CL_CgameSystemCalls( intptr_t *args )
 			re.ScissorSet( args[1], args[2], args[3], args[4] );
 			return 0;
 
+		case CG_PARSE_READ_TOKENS:
+			VM_CheckBlock( args[ 2 ], args[ 3 ] * sizeof( pc_token_t ), "CGPARSETOK" );
+			return Parse_ReadTokensHandle( args[ 1 ], VMA( 2 ), args[ 3 ] );
+
+		case CG_R_DRAWSTRETCHPICS:
+			VM_CheckBlock( args[ 1 ], args[ 2 ] * sizeof( stretchPic_t ), "CGDRAWPICS" );
+			SCR_DrawStretchPics( VMA( 1 ), args[ 2 ], args[ 3 ] );
+			return 0;
+
 		default:
 			Com_Error( ERR_DROP, "Bad cgame system trap: %ld", ( long int ) args[ 0 ] );
 			exit(1); // silence warning, and make sure this behaves as expected, if Com_Error's behavior changes
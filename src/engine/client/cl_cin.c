@@ -652,6 +652,90 @@ static unsigned short yuv_to_rgb( long y, long u, long v )
 	return ( unsigned short )( ( r << 11 ) + ( g << 5 ) + ( b ) );
 }
 
+#if defined( __SSE2__ ) || idx64
+#include <emmintrin.h>
+#define CIN_SSE2 1
+#else
+#define CIN_SSE2 0
+#endif
+
+#if CIN_SSE2
+
+#define MAX_CIN_UV_WIDTH 4096
+
+// chroma contributions of one row of the u and v planes, in the same
+// fixed point as ROQ_YY_tab, so the vector path matches the tables exactly
+static short cinChromaR[ MAX_CIN_UV_WIDTH ];
+static short cinChromaG[ MAX_CIN_UV_WIDTH ];
+static short cinChromaB[ MAX_CIN_UV_WIDTH ];
+
+static void Frame_chroma_row( const unsigned char *u, const unsigned char *v, int uvWidth )
+{
+	int i;
+
+	for ( i = 0; i < uvWidth; ++i )
+	{
+		cinChromaR[ i ] = ( short ) ROQ_VR_tab[ v[ i ] ];
+		cinChromaG[ i ] = ( short )( ROQ_UG_tab[ u[ i ] ] + ROQ_VG_tab[ v[ i ] ] );
+		cinChromaB[ i ] = ( short ) ROQ_UB_tab[ u[ i ] ];
+	}
+}
+
+/*
+Frame_yuv_row_sse2
+
+Converts 8 pixels at a time of a row with full horizontal luma and full
+or half horizontal chroma resolution, returns the number of pixels done
+*/
+static int Frame_yuv_row_sse2( const unsigned char *y, int width, int uvWShift, unsigned int *output )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi8( ( char ) 255 );
+	__m128i       yy, cr, cg, cb, r, g, b, rg, ba;
+	int           i;
+
+	for ( i = 0; i + 8 <= width; i += 8 )
+	{
+		yy = _mm_unpacklo_epi8( _mm_loadl_epi64( ( const __m128i * ) &y[ i ] ), zero );
+		yy = _mm_or_si128( _mm_slli_epi16( yy, 6 ), _mm_srli_epi16( yy, 2 ) );
+
+		if ( uvWShift )
+		{
+			cr = _mm_loadl_epi64( ( const __m128i * ) &cinChromaR[ i >> 1 ] );
+			cg = _mm_loadl_epi64( ( const __m128i * ) &cinChromaG[ i >> 1 ] );
+			cb = _mm_loadl_epi64( ( const __m128i * ) &cinChromaB[ i >> 1 ] );
+			cr = _mm_unpacklo_epi16( cr, cr );
+			cg = _mm_unpacklo_epi16( cg, cg );
+			cb = _mm_unpacklo_epi16( cb, cb );
+		}
+		else
+		{
+			cr = _mm_loadu_si128( ( const __m128i * ) &cinChromaR[ i ] );
+			cg = _mm_loadu_si128( ( const __m128i * ) &cinChromaG[ i ] );
+			cb = _mm_loadu_si128( ( const __m128i * ) &cinChromaB[ i ] );
+		}
+
+		// the sums fit in 16 bits, and the saturating pack does the clamping
+		r = _mm_srai_epi16( _mm_add_epi16( yy, cr ), 6 );
+		g = _mm_srai_epi16( _mm_add_epi16( yy, cg ), 6 );
+		b = _mm_srai_epi16( _mm_add_epi16( yy, cb ), 6 );
+
+		r = _mm_packus_epi16( r, r );
+		g = _mm_packus_epi16( g, g );
+		b = _mm_packus_epi16( b, b );
+
+		rg = _mm_unpacklo_epi8( r, g );
+		ba = _mm_unpacklo_epi8( b, alpha );
+
+		_mm_storeu_si128( ( __m128i * ) &output[ i ], _mm_unpacklo_epi16( rg, ba ) );
+		_mm_storeu_si128( ( __m128i * ) &output[ i + 4 ], _mm_unpackhi_epi16( rg, ba ) );
+	}
+
+	return i;
+}
+
+#endif
+
 /*
 Frame_yuv_to_rgb24
 is used by the Theora(ogm) code
@@ -664,10 +748,33 @@ void Frame_yuv_to_rgb24( const unsigned char *y, const unsigned char *u, const u
 {
 	int  i, j, uvI;
 	long r, g, b, YY;
+#if CIN_SSE2
+	int      uvWidth = ( width + ( 1 << uvWShift ) - 1 ) >> uvWShift;
+	int      uvRow = -1;
+	qboolean vector = yWShift == 0 && uvWShift <= 1 && uvWidth <= MAX_CIN_UV_WIDTH;
+#endif
 
 	for ( j = 0; j < height; ++j )
 	{
-		for ( i = 0; i < width; ++i )
+		i = 0;
+
+#if CIN_SSE2
+
+		if ( vector )
+		{
+			if ( ( j >> uvHShift ) != uvRow )
+			{
+				uvRow = j >> uvHShift;
+				Frame_chroma_row( u + uvRow * uv_stride, v + uvRow * uv_stride, uvWidth );
+			}
+
+			i = Frame_yuv_row_sse2( y + ( j >> yHShift ) * y_stride, width, uvWShift, output );
+			output += i;
+		}
+
+#endif
+
+		for ( ; i < width; ++i )
 		{
 			YY = ( long )( ROQ_YY_tab[( y[( i >> yWShift ) + ( j >> yHShift ) * y_stride ] ) ] );
 			uvI = ( i >> uvWShift ) + ( j >> uvHShift ) * uv_stride;
@@ -2098,6 +2205,66 @@ void CL_PlayCinematic_f( void )
 	}
 }
 
+/*
+==================
+CL_CinematicBenchmark_f
+
+Decodes a whole cinematic as fast as possible, without
+drawing it or playing its sound, and reports the frame rate
+==================
+*/
+void CL_CinematicBenchmark_f( void )
+{
+	int handle, frames, startTime, msec, time;
+
+	if ( Cmd_Argc() != 2 )
+	{
+		Com_Printf( "usage: cinematicBenchmark <file>\n" );
+		return;
+	}
+
+	handle = CIN_PlayCinematic( Cmd_Argv( 1 ), 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, CIN_silent );
+
+	if ( handle < 0 )
+	{
+		return;
+	}
+
+	currentHandle = handle;
+	startTime = Sys_Milliseconds();
+
+	if ( cinTable[ handle ].fileType == FT_OGM )
+	{
+		// step through the movie time so no frame gets skipped
+		for ( time = 0; !Cin_OGM_Run( time ); time++ )
+		{
+		}
+
+		frames = Cin_OGM_FrameCount();
+		Cin_OGM_Shutdown();
+		cinTable[ handle ].buf = NULL;
+	}
+	else
+	{
+		while ( cinTable[ handle ].status == FMV_PLAY )
+		{
+			RoQInterrupt();
+		}
+
+		frames = cinTable[ handle ].numQuads;
+		FS_FCloseFile( cinTable[ handle ].iFile );
+		cinTable[ handle ].iFile = 0;
+	}
+
+	msec = MAX( Sys_Milliseconds() - startTime, 1 );
+
+	Com_Printf( "%i frames of %s decoded in %i msec, %.1f fps\n", frames, cinTable[ handle ].fileName, msec, frames * 1000.0f / msec );
+
+	cinTable[ handle ].fileName[ 0 ] = 0;
+	cinTable[ handle ].status = FMV_EOF;
+	currentHandle = -1;
+}
+
 void SCR_DrawCinematic( void )
 {
 	if ( CL_handle >= 0 && CL_handle < MAX_VIDEO_HANDLES )
@@ -876,8 +876,9 @@ qboolean CL_ReadyToSendPacket( void )
 		return qfalse;
 	}
 
-	// If we are downloading, we send no less than 50ms between packets
-	if ( *cls.downloadTempName && cls.realtime - clc.lastPacketSentTime < 50 )
+	// If we are downloading, we send no less than 50ms between packets,
+	// or 10ms for a windowed download which is clocked by our acknowledges
+	if ( *cls.downloadTempName && cls.realtime - clc.lastPacketSentTime < ( clc.downloadWindowed ? 10 : 50 ) )
 	{
 		return qfalse;
 	}
@@ -961,6 +962,9 @@ void CL_WritePacket( void )
 		return;
 	}
 
+	// one acknowledge covers every windowed download block since the last
+	CL_WriteDownloadAck();
+
 	memset( &nullcmd, 0, sizeof( nullcmd ) );
 	oldcmd = &nullcmd;
 
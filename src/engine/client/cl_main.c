@@ -127,6 +127,7 @@ cvar_t *cl_motdString;
 
 cvar_t *cl_allowDownload;
 cvar_t *cl_wwwDownload;
+cvar_t *cl_downloadWindow;
 cvar_t *cl_inGameVideo;
 
 cvar_t *cl_serverStatusResendTime;
@@ -169,6 +170,8 @@ static void        *rendererLib = NULL;
 // XreaL BEGIN
 cvar_t             *cl_aviMotionJpeg;
 // XreaL END
+cvar_t             *cl_aviEncoders;
+cvar_t             *cl_aviPipelineMegs;
 
 cvar_t             *cl_allowPaste;
 
@@ -995,9 +998,29 @@ void CL_Record( const char *name )
 	// don't start saving messages until a non-delta compressed message is received
 	clc.demowaiting = qtrue;
 
+	// demos recorded with the trained huffman table carry it, so that they
+	// can be played back without it
+	if ( clc.huffTable == HUFF_TRAINED )
+	{
+		const int *table = MSG_HuffmanTable();
+
+		len = LittleLong( clc.serverMessageSequence - 1 );
+		FS_Write( &len, 4, clc.demofile );
+
+		len = LittleLong( DEMO_HUFFMAN_TABLE );
+		FS_Write( &len, 4, clc.demofile );
+
+		for ( i = 0; i < 256; i++ )
+		{
+			len = LittleLong( table[ i ] );
+			FS_Write( &len, 4, clc.demofile );
+		}
+	}
+
 	// write out the gamestate message
 	MSG_Init( &buf, bufData, sizeof( bufData ) );
 	MSG_Bitstream( &buf );
+	buf.huffTable = clc.huffTable;
 
 	// NOTE, MRE: all server->client messages now acknowledge
 	MSG_WriteLong( &buf, clc.reliableSequence );
@@ -1148,6 +1171,37 @@ void CL_ReadDemoMessage( void )
 		return;
 	}
 
+	if ( buf.cursize == DEMO_HUFFMAN_TABLE )
+	{
+		int table[ 256 ];
+		int i;
+
+		if ( FS_Read( table, sizeof( table ), clc.demofile ) != sizeof( table ) )
+		{
+			Com_Printf("%s", _( "Demo file was truncated.\n" ));
+			CL_DemoCompleted();
+			return;
+		}
+
+		for ( i = 0; i < 256; i++ )
+		{
+			table[ i ] = LittleLong( table[ i ] );
+		}
+
+		// kept apart from net_huffmanTable, which a local server may be using
+		if ( !MSG_SetHuffmanTable( HUFF_DEMO, table ) )
+		{
+			Com_Error( ERR_DROP, "CL_ReadDemoMessage: bad huffman table" );
+		}
+
+		clc.huffTable = HUFF_DEMO;
+		CL_ReadDemoMessage();
+		return;
+	}
+
+	buf.huffTable = clc.huffTable;
+	buf.huffSample = qtrue;
+
 	if ( buf.cursize > buf.maxsize )
 	{
 		Com_Error( ERR_DROP, "CL_ReadDemoMessage: demoMsglen > MAX_MSGLEN" );
@@ -1165,6 +1219,7 @@ void CL_ReadDemoMessage( void )
 	clc.lastPacketTime = cls.realtime;
 	buf.readcount = 0;
 	CL_ParseServerMessage( &buf );
+	MSG_HuffmanCountMessage( &buf );
 }
 
 /*
@@ -2738,8 +2793,22 @@ void CL_BeginDownload( const char *localName, const char *remoteName )
 
 	clc.downloadBlock = 0; // Starting new file
 	clc.downloadCount = 0;
+	clc.downloadWindowed = qfalse;
+	clc.downloadAckPending = qfalse;
+	clc.downloadAckSequence = 0;
 
-	CL_AddReliableCommand( va( "download %s", Cmd_QuoteString( remoteName ) ) );
+	// servers that know windowed downloads switch to them when given
+	// the window and an id, others only look at the file name
+	if ( cl_downloadWindow->integer > 0 )
+	{
+		clc.downloadNumber = ( clc.downloadNumber + 1 ) & 0x7fff;
+		CL_AddReliableCommand( va( "download %s %d %d", Cmd_QuoteString( remoteName ),
+		                           MIN( cl_downloadWindow->integer, MAX_DOWNLOAD_SACK_WINDOW ), clc.downloadNumber ) );
+	}
+	else
+	{
+		CL_AddReliableCommand( va( "download %s", Cmd_QuoteString( remoteName ) ) );
+	}
 }
 
 /*
@@ -2907,6 +2976,14 @@ void CL_CheckForResend( void )
 			Info_SetValueForKey( info, "challenge", va( "%i", clc.challenge ), qfalse );
 			Info_SetValueForKey( info, "pubkey", key, qfalse );
 
+			if ( MSG_HuffmanChecksum() )
+			{
+				Info_SetValueForKey( info, "huffman", va( "%i", MSG_HuffmanChecksum() ), qfalse );
+			}
+
+			// we can inflate the configstrings and baselines of the gamestate
+			Info_SetValueForKey( info, "deflate", "1", qfalse );
+
 			sprintf( data, "connect %s", Cmd_QuoteString( info ) );
 
 			// EVEN BALANCE - T.RAY
@@ -3425,6 +3502,11 @@ void CL_ConnectionlessPacket( netadr_t from, msg_t *msg )
 		}
 
 		Netchan_Setup( NS_CLIENT, &clc.netchan, from, Cvar_VariableValue( "net_qport" ) );
+
+		// the server accepted our trained huffman table
+		clc.huffTable = Cmd_Argc() > 1 && MSG_HuffmanChecksum() &&
+		                atoi( Cmd_Argv( 1 ) ) == MSG_HuffmanChecksum() ? HUFF_TRAINED : HUFF_STATIC;
+
 		cls.state = CA_CONNECTED;
 		clc.lastPacketSentTime = -9999; // send first packet immediately
 		return;
@@ -3531,6 +3613,11 @@ void CL_PacketEvent( netadr_t from, msg_t *msg )
 		return;
 	}
 
+	msg->huffTable = clc.huffTable;
+
+	// a local server samples the messages when it writes them
+	msg->huffSample = !com_sv_running->integer;
+
 	if ( !CL_Netchan_Process( &clc.netchan, msg ) )
 	{
 		return; // out of order, duplicated, etc
@@ -3546,6 +3633,7 @@ void CL_PacketEvent( netadr_t from, msg_t *msg )
 
 	clc.lastPacketTime = cls.realtime;
 	CL_ParseServerMessage( msg );
+	MSG_HuffmanCountMessage( msg );
 
 	//
 	// we don't know if it is ok to save a demo message until
@@ -4342,6 +4430,7 @@ qboolean CL_InitRef( const char *renderer )
 	ri.CL_VideoRecording = CL_VideoRecording;
 	ri.CL_WriteAVIVideoFrame = CL_WriteAVIVideoFrame;
 	// XreaL END
+	ri.CL_QueueAVIVideoFrame = CL_QueueAVIVideoFrame;
 
 	ri.IN_Init = IN_Init;
 	ri.IN_Shutdown = IN_Shutdown;
@@ -4448,6 +4537,8 @@ void CL_Init( void )
 	// XreaL BEGIN
 	cl_aviMotionJpeg = Cvar_Get( "cl_aviMotionJpeg", "1", CVAR_ARCHIVE );
 	// XreaL END
+	cl_aviEncoders = Cvar_Get( "cl_aviEncoders", "2", CVAR_ARCHIVE );
+	cl_aviPipelineMegs = Cvar_Get( "cl_aviPipelineMegs", "128", CVAR_ARCHIVE );
 
 	rconAddress = Cvar_Get( "rconAddress", "", 0 );
 
@@ -4477,6 +4568,7 @@ void CL_Init( void )
 
 	cl_allowDownload = Cvar_Get( "cl_allowDownload", "1", CVAR_ARCHIVE );
 	cl_wwwDownload = Cvar_Get( "cl_wwwDownload", "1", CVAR_USERINFO | CVAR_ARCHIVE );
+	cl_downloadWindow = Cvar_Get( "cl_downloadWindow", "64", CVAR_ARCHIVE );
 
 	cl_profile = Cvar_Get( "cl_profile", "", CVAR_ROM );
 	cl_defaultProfile = Cvar_Get( "cl_defaultProfile", "", CVAR_ROM );
@@ -4585,6 +4677,7 @@ void CL_Init( void )
 	Cmd_AddCommand( "demo", CL_PlayDemo_f );
 	Cmd_SetCommandCompletionFunc( "demo", CL_CompleteDemoName );
 	Cmd_AddCommand( "cinematic", CL_PlayCinematic_f );
+	Cmd_AddCommand( "cinematicBenchmark", CL_CinematicBenchmark_f );
 	Cmd_AddCommand( "stoprecord", CL_StopRecord_f );
 	Cmd_AddCommand( "connect", CL_Connect_f );
 	Cmd_AddCommand( "reconnect", CL_Reconnect_f );
@@ -4696,6 +4789,7 @@ void CL_Shutdown( void )
 	Cmd_RemoveCommand( "record" );
 	Cmd_RemoveCommand( "demo" );
 	Cmd_RemoveCommand( "cinematic" );
+	Cmd_RemoveCommand( "cinematicBenchmark" );
 	Cmd_RemoveCommand( "stoprecord" );
 	Cmd_RemoveCommand( "connect" );
 	Cmd_RemoveCommand( "localservers" );
@@ -36,6 +36,8 @@ Maryland 20850 USA.
 
 #include "client.h"
 
+#include <zlib.h>
+
 static const char *const svc_strings[ 256 ] =
 {
 	"svc_bad",
@@ -556,18 +558,128 @@ void CL_SystemInfoChanged( void )
 
 /*
 ==================
-CL_ParseGamestate
+CL_ParseGamestateEntry
+
+A configstring or a baseline
 ==================
 */
-void CL_ParseGamestate( msg_t *msg )
+static void CL_ParseGamestateEntry( msg_t *msg, int cmd )
 {
 	int           i;
 	entityState_t *es;
 	int           newnum;
 	entityState_t nullstate;
-	int           cmd;
 	char          *s;
 
+	if ( cmd == svc_configstring )
+	{
+		int len;
+
+		i = MSG_ReadShort( msg );
+
+		if ( i < 0 || i >= MAX_CONFIGSTRINGS )
+		{
+			Com_Error( ERR_DROP, "configstring > MAX_CONFIGSTRINGS" );
+		}
+
+		s = MSG_ReadBigString( msg );
+		len = strlen( s );
+
+		if ( len + 1 + cl.gameState.dataCount > MAX_GAMESTATE_CHARS )
+		{
+			Com_Error( ERR_DROP, "MAX_GAMESTATE_CHARS exceeded" );
+		}
+
+		// append it to the gameState string buffer
+		cl.gameState.stringOffsets[ i ] = cl.gameState.dataCount;
+		memcpy( cl.gameState.stringData + cl.gameState.dataCount, s, len + 1 );
+		cl.gameState.dataCount += len + 1;
+	}
+	else if ( cmd == svc_baseline )
+	{
+		newnum = MSG_ReadBits( msg, GENTITYNUM_BITS );
+
+		if ( newnum < 0 || newnum >= MAX_GENTITIES )
+		{
+			Com_Error( ERR_DROP, "Baseline number out of range: %i", newnum );
+		}
+
+		memset( &nullstate, 0, sizeof( nullstate ) );
+		es = &cl.entityBaselines[ newnum ];
+		MSG_ReadDeltaEntity( msg, &nullstate, es, newnum );
+	}
+	else
+	{
+		Com_Error( ERR_DROP, "CL_ParseGamestate: bad command byte" );
+	}
+}
+
+/*
+==================
+CL_ParseDeflatedGamestate
+
+The configstrings and baselines deflated by the server,
+without huffman and up to their own svc_EOF
+==================
+*/
+static void CL_ParseDeflatedGamestate( msg_t *msg )
+{
+	static byte deflated[ MAX_MSGLEN ];
+	static byte raw[ MAX_MSGLEN ];
+	msg_t       inflated;
+	int         rawSize, deflatedSize, cmd;
+	uLongf      size;
+
+	rawSize = MSG_ReadLong( msg );
+	deflatedSize = MSG_ReadLong( msg );
+
+	if ( rawSize <= 0 || rawSize > sizeof( raw ) || deflatedSize <= 0 || deflatedSize > sizeof( deflated ) ||
+	     deflatedSize > msg->cursize - msg->readcount )
+	{
+		Com_Error( ERR_DROP, "CL_ParseGamestate: bad deflated size" );
+	}
+
+	msg->raw = qtrue;
+	MSG_ReadData( msg, deflated, deflatedSize );
+	msg->raw = qfalse;
+
+	size = rawSize;
+
+	if ( uncompress( raw, &size, deflated, deflatedSize ) != Z_OK || size != rawSize )
+	{
+		Com_Error( ERR_DROP, "CL_ParseGamestate: failed to inflate" );
+	}
+
+	// anything past the inflated data reads as zero
+	MSG_Init( &inflated, raw, rawSize );
+	inflated.cursize = rawSize;
+	inflated.raw = qtrue;
+
+	while ( ( cmd = MSG_ReadByte( &inflated ) ) != svc_EOF )
+	{
+		if ( inflated.readcount > inflated.cursize )
+		{
+			Com_Error( ERR_DROP, "CL_ParseGamestate: read past end of deflated gamestate" );
+		}
+
+		CL_ParseGamestateEntry( &inflated, cmd );
+
+		if ( inflated.readcount > inflated.cursize )
+		{
+			Com_Error( ERR_DROP, "CL_ParseGamestate: read past end of deflated gamestate" );
+		}
+	}
+}
+
+/*
+==================
+CL_ParseGamestate
+==================
+*/
+void CL_ParseGamestate( msg_t *msg )
+{
+	int cmd;
+
 	Con_Close();
 
 	clc.connectPacketCount = 0;
@@ -590,46 +702,13 @@ void CL_ParseGamestate( msg_t *msg )
 			break;
 		}
 
-		if ( cmd == svc_configstring )
-		{
-			int len;
-
-			i = MSG_ReadShort( msg );
-
-			if ( i < 0 || i >= MAX_CONFIGSTRINGS )
-			{
-				Com_Error( ERR_DROP, "configstring > MAX_CONFIGSTRINGS" );
-			}
-
-			s = MSG_ReadBigString( msg );
-			len = strlen( s );
-
-			if ( len + 1 + cl.gameState.dataCount > MAX_GAMESTATE_CHARS )
-			{
-				Com_Error( ERR_DROP, "MAX_GAMESTATE_CHARS exceeded" );
-			}
-
-			// append it to the gameState string buffer
-			cl.gameState.stringOffsets[ i ] = cl.gameState.dataCount;
-			memcpy( cl.gameState.stringData + cl.gameState.dataCount, s, len + 1 );
-			cl.gameState.dataCount += len + 1;
-		}
-		else if ( cmd == svc_baseline )
+		if ( cmd == svc_deflate )
 		{
-			newnum = MSG_ReadBits( msg, GENTITYNUM_BITS );
-
-			if ( newnum < 0 || newnum >= MAX_GENTITIES )
-			{
-				Com_Error( ERR_DROP, "Baseline number out of range: %i", newnum );
-			}
-
-			memset( &nullstate, 0, sizeof( nullstate ) );
-			es = &cl.entityBaselines[ newnum ];
-			MSG_ReadDeltaEntity( msg, &nullstate, es, newnum );
+			CL_ParseDeflatedGamestate( msg );
 		}
 		else
 		{
-			Com_Error( ERR_DROP, "CL_ParseGamestate: bad command byte" );
+			CL_ParseGamestateEntry( msg, cmd );
 		}
 	}
 
@@ -653,6 +732,198 @@ void CL_ParseGamestate( msg_t *msg )
 
 //=====================================================================
 
+// blocks of a windowed download that arrived ahead of clc.downloadBlock
+static byte downloadWindowData[ MAX_DOWNLOAD_SACK_WINDOW ][ DOWNLOAD_SACK_BLKSIZE ];
+static int  downloadWindowSize[ MAX_DOWNLOAD_SACK_WINDOW ];
+static int  downloadWindowBlock[ MAX_DOWNLOAD_SACK_WINDOW ]; // -1 for an empty slot
+
+/*
+=====================
+CL_WriteDownloadBlock
+
+Write the next block of the file, a zero length block ends the download.
+Returns qfalse when the download is over
+=====================
+*/
+static qboolean CL_WriteDownloadBlock( const byte *data, int size )
+{
+	// open the file if not opened yet
+	if ( !clc.download )
+	{
+		clc.download = FS_SV_FOpenFileWrite( cls.downloadTempName );
+
+		if ( !clc.download )
+		{
+			Com_Printf(_( "Could not create %s\n"), cls.downloadTempName );
+			CL_AddReliableCommand( "stopdl" );
+			CL_NextDownload();
+			return qfalse;
+		}
+	}
+
+	if ( size )
+	{
+		FS_Write( data, size, clc.download );
+	}
+
+	if ( clc.downloadWindowed )
+	{
+		clc.downloadAckPending = qtrue;
+	}
+	else
+	{
+		CL_AddReliableCommand( va( "nextdl %d", clc.downloadBlock ) );
+	}
+
+	clc.downloadBlock++;
+
+	clc.downloadCount += size;
+
+	// So UI gets access to it
+	Cvar_SetValue( "cl_downloadCount", clc.downloadCount );
+
+	if ( !size )
+	{
+		// A zero length block means EOF
+		if ( clc.download )
+		{
+			FS_FCloseFile( clc.download );
+			clc.download = 0;
+
+			// rename the file
+			FS_SV_Rename( cls.downloadTempName, cls.downloadName );
+		}
+
+		*cls.downloadTempName = *cls.downloadName = 0;
+		Cvar_Set( "cl_downloadName", "" );
+
+		// the acknowledge of the last block can't wait for the previous one
+		clc.downloadAckSequence = 0;
+		CL_WriteDownloadAck();
+
+		// send intentions now
+		// We need this because without it, we would hold the last nextdl and then start
+		// loading right away.  If we take a while to load, the server is happily trying
+		// to send us that last block over and over.
+		// Write it twice to help make sure we acknowledge the download
+		CL_WritePacket();
+		CL_WritePacket();
+
+		// get another file if needed
+		CL_NextDownload();
+		return qfalse;
+	}
+
+	return qtrue;
+}
+
+/*
+=====================
+CL_WriteDownloadAck
+
+Acknowledge the blocks of a windowed download received since the last
+acknowledge: the first block still missing, and a mask of those after it we
+have. Only one acknowledge is in the reliable queue at a time, the blocks
+that come in meanwhile are covered by the next one
+=====================
+*/
+void CL_WriteDownloadAck( void )
+{
+	unsigned int mask[ 2 ];
+	int          i, block;
+
+	if ( !clc.downloadAckPending || clc.downloadAckSequence > clc.reliableAcknowledge )
+	{
+		return;
+	}
+
+	mask[ 0 ] = mask[ 1 ] = 0;
+
+	for ( i = 0; i < MAX_DOWNLOAD_SACK_WINDOW; i++ )
+	{
+		block = clc.downloadBlock + 1 + i;
+
+		if ( downloadWindowBlock[ block % MAX_DOWNLOAD_SACK_WINDOW ] == block )
+		{
+			mask[ i >> 5 ] |= 1u << ( i & 31 );
+		}
+	}
+
+	CL_AddReliableCommand( va( "dlack %d %x %x", clc.downloadBlock, mask[ 0 ], mask[ 1 ] ) );
+	clc.downloadAckPending = qfalse;
+	clc.downloadAckSequence = clc.reliableSequence;
+}
+
+/*
+=====================
+CL_ParseWindowedDownload
+
+A block of a windowed download, see SV_SendDownloadBlocks.  Blocks may
+arrive out of order and are kept until the ones before them are in
+=====================
+*/
+static void CL_ParseWindowedDownload( msg_t *msg )
+{
+	byte data[ DOWNLOAD_SACK_BLKSIZE ];
+	int  id, block, size, slot;
+
+	id = MSG_ReadShort( msg );
+	block = MSG_ReadLong( msg );
+
+	// block zero is special, contains file size
+	if ( !block )
+	{
+		clc.downloadSize = MSG_ReadLong( msg );
+		Cvar_SetValue( "cl_downloadSize", clc.downloadSize );
+	}
+
+	size = MSG_ReadShort( msg );
+
+	if ( size < 0 || size > sizeof( data ) )
+	{
+		Com_Error( ERR_DROP, "CL_ParseDownload: Invalid size %d for download chunk.", size );
+	}
+
+	MSG_ReadData( msg, data, size );
+
+	// a late block of a download that is over, or of an earlier one
+	if ( !*cls.downloadTempName || id != clc.downloadNumber )
+	{
+		return;
+	}
+
+	if ( !clc.downloadWindowed )
+	{
+		clc.downloadWindowed = qtrue;
+		Com_Memset( downloadWindowBlock, -1, sizeof( downloadWindowBlock ) );
+	}
+
+	// acknowledge duplicates too, the previous acknowledge may have been lost
+	clc.downloadAckPending = qtrue;
+
+	if ( block < clc.downloadBlock || block >= clc.downloadBlock + MAX_DOWNLOAD_SACK_WINDOW )
+	{
+		return;
+	}
+
+	slot = block % MAX_DOWNLOAD_SACK_WINDOW;
+	downloadWindowBlock[ slot ] = block;
+	downloadWindowSize[ slot ] = size;
+	Com_Memcpy( downloadWindowData[ slot ], data, size );
+
+	// write out everything that is in order now
+	for ( slot = clc.downloadBlock % MAX_DOWNLOAD_SACK_WINDOW; downloadWindowBlock[ slot ] == clc.downloadBlock;
+	      slot = clc.downloadBlock % MAX_DOWNLOAD_SACK_WINDOW )
+	{
+		downloadWindowBlock[ slot ] = -1;
+
+		if ( !CL_WriteDownloadBlock( downloadWindowData[ slot ], downloadWindowSize[ slot ] ) )
+		{
+			return;
+		}
+	}
+}
+
 /*
 =====================
 CL_ParseDownload
@@ -666,6 +937,16 @@ void CL_ParseDownload( msg_t *msg )
 	unsigned char data[ MAX_MSGLEN ];
 	int           block;
 
+	// read the data
+	block = MSG_ReadShort( msg );
+
+	// block -2 is a windowed download, which sorts out late blocks itself
+	if ( block == -2 )
+	{
+		CL_ParseWindowedDownload( msg );
+		return;
+	}
+
 	if ( !*cls.downloadTempName )
 	{
 		Com_Printf("%s", _( "Server sending download, but no download was requested\n" ));
@@ -673,9 +954,6 @@ void CL_ParseDownload( msg_t *msg )
 		return;
 	}
 
-	// read the data
-	block = MSG_ReadShort( msg );
-
 	// TTimo - www dl
 	// if we haven't acked the download redirect yet
 	if ( block == -1 )
@@ -767,59 +1045,7 @@ void CL_ParseDownload( msg_t *msg )
 		return;
 	}
 
-	// open the file if not opened yet
-	if ( !clc.download )
-	{
-		clc.download = FS_SV_FOpenFileWrite( cls.downloadTempName );
-
-		if ( !clc.download )
-		{
-			Com_Printf(_( "Could not create %s\n"), cls.downloadTempName );
-			CL_AddReliableCommand( "stopdl" );
-			CL_NextDownload();
-			return;
-		}
-	}
-
-	if ( size )
-	{
-		FS_Write( data, size, clc.download );
-	}
-
-	CL_AddReliableCommand( va( "nextdl %d", clc.downloadBlock ) );
-	clc.downloadBlock++;
-
-	clc.downloadCount += size;
-
-	// So UI gets access to it
-	Cvar_SetValue( "cl_downloadCount", clc.downloadCount );
-
-	if ( !size )
-	{
-		// A zero length block means EOF
-		if ( clc.download )
-		{
-			FS_FCloseFile( clc.download );
-			clc.download = 0;
-
-			// rename the file
-			FS_SV_Rename( cls.downloadTempName, cls.downloadName );
-		}
-
-		*cls.downloadTempName = *cls.downloadName = 0;
-		Cvar_Set( "cl_downloadName", "" );
-
-		// send intentions now
-		// We need this because without it, we would hold the last nextdl and then start
-		// loading right away.  If we take a while to load, the server is happily trying
-		// to send us that last block over and over.
-		// Write it twice to help make sure we acknowledge the download
-		CL_WritePacket();
-		CL_WritePacket();
-
-		// get another file if needed
-		CL_NextDownload();
-	}
+	CL_WriteDownloadBlock( data, size );
 }
 
 #ifdef USE_VOIP
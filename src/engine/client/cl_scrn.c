@@ -151,6 +151,19 @@ void SCR_DrawPic( float x, float y, float width, float height, qhandle_t hShader
 	re.DrawStretchPic( x, y, width, height, 0, 0, 1, 1, hShader );
 }
 
+/*
+================
+SCR_DrawStretchPics
+
+Draws a batch of coloured quads sharing a shader,
+coordinates are screen values
+=================
+*/
+void SCR_DrawStretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader )
+{
+	re.DrawStretchPics( pics, numPics, hShader );
+}
+
 static glyphInfo_t *Glyph( int ch )
 {
 	static glyphInfo_t glyphs[8];
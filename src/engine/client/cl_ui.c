@@ -1414,6 +1414,15 @@ intptr_t CL_UISystemCalls( intptr_t *args )
 			Q_strncpyz( VMA( 1 ), P__( VMA( 2 ), VMA( 3 ), args[ 4 ] ), args[ 5 ] );
 			return 0;
 
+		case UI_PARSE_READ_TOKENS:
+			VM_CheckBlock( args[ 2 ], args[ 3 ] * sizeof( pc_token_t ), "UIPARSETOK" );
+			return Parse_ReadTokensHandle( args[ 1 ], VMA( 2 ), args[ 3 ] );
+
+		case UI_R_DRAWSTRETCHPICS:
+			VM_CheckBlock( args[ 1 ], args[ 2 ] * sizeof( stretchPic_t ), "UIDRAWPICS" );
+			SCR_DrawStretchPics( VMA( 1 ), args[ 2 ], args[ 3 ] );
+			return 0;
+
 		default:
 			Com_Error( ERR_DROP, "Bad UI system trap: %ld", ( long int ) args[ 0 ] );
 	}
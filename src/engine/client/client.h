@@ -53,6 +53,8 @@ Maryland 20850 USA.
 
 #define RETRANSMIT_TIMEOUT 3000 // time between connection packet retransmits
 
+#define DEMO_HUFFMAN_TABLE -2 // demo message length marking an embedded huffman table
+
 // snapshots are a view of the server at a given time
 typedef struct
 {
@@ -227,7 +229,10 @@ typedef struct
 
 	// file transfer from server
 	fileHandle_t download;
-	int          downloadNumber;
+	int          downloadNumber; // id of the current windowed download request
+	qboolean     downloadWindowed; // the server sends blocks out of order, acknowledged selectively
+	qboolean     downloadAckPending; // windowed blocks came in since the last acknowledge
+	int          downloadAckSequence; // reliable command of the last acknowledge
 	int          downloadBlock; // block we are waiting for
 	int          downloadCount; // how many bytes we got
 	int          downloadSize; // how many bytes we got
@@ -241,6 +246,8 @@ typedef struct
 	char     badChecksumList[ MAX_INFO_STRING ]; // list of files for which wwwdl redirect is broken (wrong checksum)
 	char     newsString[ MAX_NEWS_STRING ];
 
+	int      huffTable; // msgHuffTable_t of the server messages
+
 	// demo information
 	char         demoName[ MAX_QPATH ];
 	qboolean     demorecording;
@@ -486,6 +493,7 @@ extern cvar_t *cl_activeAction;
 extern cvar_t *cl_autorecord;
 
 extern cvar_t *cl_allowDownload;
+extern cvar_t *cl_downloadWindow;
 extern cvar_t *cl_conXOffset;
 extern cvar_t *cl_inGameVideo;
 
@@ -520,6 +528,8 @@ extern cvar_t *con_scrollLock;
 extern cvar_t *cl_aviFrameRate;
 extern cvar_t *cl_aviMotionJpeg;
 // XreaL END
+extern cvar_t *cl_aviEncoders;
+extern cvar_t *cl_aviPipelineMegs;
 
 extern cvar_t *cl_allowPaste;
 
@@ -673,6 +683,7 @@ void       CL_Voip_f( void );
 
 void CL_SystemInfoChanged( void );
 void CL_ParseServerMessage( msg_t *msg );
+void CL_WriteDownloadAck( void );
 
 //====================================================================
 
@@ -801,6 +812,7 @@ void  SCR_AdjustFrom640( float *x, float *y, float *w, float *h );
 void  SCR_FillAdjustedRect( float x, float y, float width, float height, const float *color );
 void  SCR_FillRect( float x, float y, float width, float height, const float *color );
 void  SCR_DrawPic( float x, float y, float width, float height, qhandle_t hShader );
+void  SCR_DrawStretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader );
 void  SCR_DrawNamedPic( float x, float y, float width, float height, const char *picname );
 
 void  SCR_DrawBigString( int x, int y, const char *s, float alpha, qboolean noColorEscape );  // draws a string with embedded color control characters with fade
@@ -820,6 +832,7 @@ float SCR_ConsoleFontStringWidth( const char *s, int len );
 //
 
 void     CL_PlayCinematic_f( void );
+void     CL_CinematicBenchmark_f( void );
 void     SCR_DrawCinematic( void );
 void     SCR_RunCinematic( void );
 void     SCR_StopCinematic( void );
@@ -845,6 +858,7 @@ void     Frame_yuv_to_rgb24( const unsigned char *y, const unsigned char *u, con
 int           Cin_OGM_Init( const char *filename );
 int           Cin_OGM_Run( int time );
 unsigned char *Cin_OGM_GetOutput( int *outWidth, int *outHeight );
+int           Cin_OGM_FrameCount( void );
 void          Cin_OGM_Shutdown( void );
 
 //
@@ -888,6 +902,7 @@ qboolean CL_Netchan_Process( netchan_t *chan, msg_t *msg );
 qboolean CL_OpenAVIForWriting( const char *filename );
 void     CL_TakeVideoFrame( void );
 void     CL_WriteAVIVideoFrame( const byte *imageBuffer, int size );
+void     CL_QueueAVIVideoFrame( byte *pixels );
 void     CL_WriteAVIAudioFrame( const byte *pcmBuffer, int size );
 qboolean CL_CloseAVI( void );
 qboolean CL_VideoRecording( void );
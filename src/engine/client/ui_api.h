@@ -146,6 +146,8 @@ typedef enum uiImport_s
   UI_R_UREGISTERFONT,
   UI_PGETTEXT,
   UI_GETTEXT_PLURAL,
+  UI_PARSE_READ_TOKENS,
+  UI_R_DRAWSTRETCHPICS,
 } uiImport_t;
 
 typedef struct
@@ -276,6 +278,7 @@ void        trap_R_SetColor( const float *rgba );
 void        trap_R_SetClipRegion( const float *region );
 void        trap_R_Add2dPolys( polyVert_t *verts, int numverts, qhandle_t hShader );
 void        trap_R_DrawStretchPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader );
+void        trap_R_DrawStretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader );
 void        trap_R_DrawRotatedPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader, float angle );
 void        trap_R_ModelBounds( clipHandle_t model, vec3_t mins, vec3_t maxs );
 void        trap_UpdateScreen( void );
@@ -325,6 +328,7 @@ int         trap_Parse_AddGlobalDefine( const char *define );
 int         trap_Parse_LoadSource( const char *filename );
 int         trap_Parse_FreeSource( int handle );
 int         trap_Parse_ReadToken( int handle, pc_token_t *pc_token );
+int         trap_Parse_ReadTokens( int handle, pc_token_t *pc_tokens, int maxTokens );
 int         trap_Parse_SourceFileAndLine( int handle, char *filename, int *line );
 int         trap_PC_AddGlobalDefine( const char *define );
 int         trap_PC_RemoveAllGlobalDefines( void );
@@ -71,6 +71,7 @@ void RE_RestoreViewParms( void ) { }
 void RE_SetColor( const float *rgba ) { }
 void RE_SetClipRegion( const float *region ) { }
 void RE_StretchPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader ) { }
+void RE_StretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader ) { }
 void RE_RotatedPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader, float angle ) { }
 void RE_StretchPicGradient( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader, const float *gradientColor, int gradientType ) { }
 void RE_2DPolyies( polyVert_t *polys, int numverts, qhandle_t hShader ) { }
@@ -97,6 +98,7 @@ void RE_RenderToTexture( int textureid, int x, int y, int w, int h ) { }
 int R_GetTextureId( const char *imagename ) { return 0; }
 void RE_Finish( void ) { }
 void RE_TakeVideoFrame( int h, int w, byte *captureBuffer, byte *encodeBuffer, qboolean motionJpeg ) { }
+int RE_EncodeVideoFrame( byte *buffer, int bufferSize, byte *pixels, int width, int height, qboolean motionJpeg ) { return 0; }
 void RE_AddRefLightToScene( const refLight_t *light ) { }
 int RE_RegisterAnimation( const char *name ) { return 1; }
 int RE_CheckSkeleton( refSkeleton_t *skel, qhandle_t model, qhandle_t anim ) { return 1; }
@@ -174,6 +176,7 @@ extern "C" {
 		re.SetColor = RE_SetColor;
 		re.SetClipRegion = RE_SetClipRegion;
 		re.DrawStretchPic = RE_StretchPic;
+		re.DrawStretchPics = RE_StretchPics;
 		re.DrawRotatedPic = RE_RotatedPic; // NERVE - SMF
 		re.DrawStretchPicGradient = RE_StretchPicGradient;
 		re.Add2dPolys = RE_2DPolyies;
@@ -212,6 +215,7 @@ extern "C" {
 		re.Finish = RE_Finish;
 
 		re.TakeVideoFrame = RE_TakeVideoFrame;
+		re.EncodeVideoFrame = RE_EncodeVideoFrame;
 		#if defined( USE_REFLIGHT )
 		re.AddRefLightToScene = RE_AddRefLightToScene;
 		#endif
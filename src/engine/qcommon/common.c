@@ -93,6 +93,7 @@ cvar_t *com_version;
 
 cvar_t *con_drawnotify;
 cvar_t *com_ansiColor;
+cvar_t *com_parseCache;
 
 cvar_t *com_consoleCommand;
 
@@ -810,6 +811,14 @@ The rover can be left pointing at a non-empty block
 
 The zone calls are pretty much only used for small strings and structures,
 all big things are allocated on the hunk.
+
+Blocks of up to ZONE_MAX_CLASS_SIZE bytes don't come from the zone lists
+but from slabs of their size class, which are zone blocks themselves.
+Every thread keeps a few free blocks of each size class and only goes to
+the locked free list of the class when it runs out or holds too many, so
+small allocations neither fragment the zones nor walk their lists.  The
+zone lists are behind a lock too, so the zone can be used from any thread.
+Slabs are never given back to the zones, their blocks are reused.
 ==============================================================================
 */
 
@@ -828,9 +837,11 @@ typedef struct memblock_s
 {
 	int               size; // including the header and possibly tiny fragments
 	int               tag; // a tag of 0 is a free block
-	struct memblock_s *next, *prev;
+	struct memblock_s *next, *prev; // next links the free blocks of a size class
 
 	int               id; // should be ZONEID
+	int               sizeClass; // size class + 1 for the blocks of a slab, 0 for the blocks of a zone list
+	int               tester; // offset of the trash tester, right after the requested bytes
 #ifdef ZONE_DEBUG
 	zonedebug_t       d;
 #endif
@@ -848,11 +859,115 @@ typedef struct
 memzone_t *mainzone;
 
 // we also have a small zone for small allocations that would only
-// fragment the main zone (think of cvar and cmd strings)
+// fragment the main zone (think of cvar and cmd strings), it is
+// there before the main zone so it also takes the first slabs
 memzone_t *smallzone;
 
 void      Z_CheckHeap( void );
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ZONE_THREAD_LOCAL __declspec( thread )
+#define Z_TryLock( lock ) ( !_InterlockedExchange( ( lock ), 1 ) )
+#define Z_Unlock( lock )  _InterlockedExchange( ( lock ), 0 )
+#else
+#define ZONE_THREAD_LOCAL __thread
+#define Z_TryLock( lock ) ( !__sync_lock_test_and_set( ( lock ), 1 ) )
+#define Z_Unlock( lock )  __sync_lock_release( lock )
+#endif
+
+// only ever held for a few list operations
+typedef volatile long zoneLock_t;
+
+static zoneLock_t zoneLock; // the lists of both zones
+
+#define ZONE_MAX_CLASS_SIZE 2048 // the largest blocks taken from slabs, header and trash tester included
+#define ZONE_CACHE_MAX      32 // free blocks a thread keeps of a size class
+#define ZONE_CACHE_BATCH    16 // free blocks moved between a thread and a size class at once
+
+typedef struct zoneSlab_s
+{
+	struct zoneSlab_s *next;
+	int               numBlocks;
+} zoneSlab_t;
+
+#define ZONE_SLAB_HEADER PAD( sizeof( zoneSlab_t ), sizeof( intptr_t ) )
+
+typedef struct
+{
+	int        size; // of the blocks, header and trash tester included
+	int        slabBlocks;
+	zoneLock_t lock;
+	memblock_t *free;
+	zoneSlab_t *slabs;
+	int        numSlabs;
+} zoneClass_t;
+
+static const int zoneClassSizes[] =
+{
+	48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512,
+	640, 768, 896, 1024, 1280, 1536, 1792, ZONE_MAX_CLASS_SIZE
+};
+
+#define ZONE_NUM_CLASSES ARRAY_LEN( zoneClassSizes )
+
+static zoneClass_t zoneClasses[ ZONE_NUM_CLASSES ];
+static byte        zoneClassOfSize[ ZONE_MAX_CLASS_SIZE / 16 + 1 ]; // size class + 1, by size / 16 rounded up
+
+typedef struct
+{
+	memblock_t *free[ ZONE_NUM_CLASSES ];
+	int        numFree[ ZONE_NUM_CLASSES ];
+} zoneCache_t;
+
+static ZONE_THREAD_LOCAL zoneCache_t zoneCache;
+
+static const char *const zoneTagNames[] =
+{
+	"free", "general", "botlib", "renderer", "small", "crypto", "static", "slab"
+};
+
+/*
+========================
+Z_Lock
+========================
+*/
+static void Z_Lock( zoneLock_t *lock )
+{
+	while ( !Z_TryLock( lock ) )
+	{
+		while ( *lock )
+		{
+		}
+	}
+}
+
+/*
+========================
+Z_InitSizeClasses
+========================
+*/
+static void Z_InitSizeClasses( void )
+{
+	int i, c;
+
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ )
+	{
+		zoneClasses[ i ].size = zoneClassSizes[ i ];
+		zoneClasses[ i ].slabBlocks = MAX( 4096 / zoneClassSizes[ i ], 16 );
+	}
+
+	for ( i = 0, c = 0; i < ARRAY_LEN( zoneClassOfSize ); i++ )
+	{
+		while ( zoneClassSizes[ c ] < i * 16 )
+		{
+			c++;
+		}
+
+		zoneClassOfSize[ i ] = c + 1;
+	}
+}
+
 /*
 ========================
 Z_ClearZone
@@ -875,61 +990,38 @@ void Z_ClearZone( memzone_t *zone, int size )
 	block->prev = block->next = &zone->blocklist;
 	block->tag = 0; // free block
 	block->id = ZONEID;
+	block->sizeClass = 0;
 	block->size = size - sizeof( memzone_t );
 }
 
 /*
 ========================
-Z_Free
+Z_ZoneOf
 ========================
 */
-void Z_Free( void *ptr )
+static memzone_t *Z_ZoneOf( const memblock_t *block )
 {
-	memblock_t *block, *other;
-	memzone_t  *zone;
-
-	if ( !ptr )
+	if ( smallzone && ( const byte * ) block > ( const byte * ) smallzone &&
+	     ( const byte * ) block < ( const byte * ) smallzone + smallzone->size )
 	{
-		Com_Error( ERR_DROP, "Z_Free: NULL pointer" );
+		return smallzone;
 	}
 
-	block = ( memblock_t * )( ( byte * ) ptr - sizeof( memblock_t ) );
-
-	if ( block->id != ZONEID )
-	{
-		Com_Error( ERR_FATAL, "Z_Free: freed a pointer without ZONEID" );
-	}
-
-	if ( block->tag == 0 )
-	{
-		Com_Error( ERR_FATAL, "Z_Free: freed a freed pointer" );
-	}
-
-	// if static memory
-	if ( block->tag == TAG_STATIC )
-	{
-		return;
-	}
+	return mainzone;
+}
 
-	// check the memory trash tester
-	if ( * ( int * )( ( byte * ) block + block->size - 4 ) != ZONEID )
-	{
-		Com_Error( ERR_FATAL, "Z_Free: memory block wrote past end" );
-	}
+/*
+========================
+Z_ZoneFree
 
-	if ( block->tag == TAG_SMALL )
-	{
-		zone = smallzone;
-	}
-	else
-	{
-		zone = mainzone;
-	}
+Called with the zone lock held
+========================
+*/
+static void Z_ZoneFree( memzone_t *zone, memblock_t *block )
+{
+	memblock_t *other;
 
 	zone->used -= block->size;
-	// set the block to something that should cause problems
-	// if it is referenced...
-	memset( ptr, 0xaa, block->size - sizeof( *block ) );
 
 	block->tag = 0; // mark as free
 
@@ -968,6 +1060,332 @@ void Z_Free( void *ptr )
 	}
 }
 
+/*
+========================
+Z_ZoneAlloc
+
+Called with the zone lock held, returns NULL if the zone has no room
+========================
+*/
+static memblock_t *Z_ZoneAlloc( memzone_t *zone, int size, int tag )
+{
+	int        extra;
+	memblock_t *start, *rover, *new, *base;
+
+	if ( !zone )
+	{
+		return NULL;
+	}
+
+	// scan through the block list looking for the first free block
+	// of sufficient size
+	base = rover = zone->rover;
+	start = base->prev;
+
+	do
+	{
+		if ( rover == start )
+		{
+			// scaned all the way around the list
+			return NULL;
+		}
+
+		if ( rover->tag )
+		{
+			base = rover = rover->next;
+		}
+		else
+		{
+			rover = rover->next;
+		}
+	}
+	while ( base->tag || base->size < size );
+
+	//
+	// found a block big enough
+	//
+	extra = base->size - size;
+
+	if ( extra > MINFRAGMENT )
+	{
+		// there will be a free fragment after the allocated block
+		new = ( memblock_t * )( ( byte * ) base + size );
+		new->size = extra;
+		new->tag = 0; // free block
+		new->prev = base;
+		new->id = ZONEID;
+		new->sizeClass = 0;
+		new->next = base->next;
+		new->next->prev = new;
+		base->next = new;
+		base->size = size;
+	}
+
+	base->tag = tag; // no longer a free block
+
+	zone->rover = base->next; // next allocation will start looking here
+	zone->used += base->size; //
+
+	base->id = ZONEID;
+
+	return base;
+}
+
+/*
+========================
+Z_NewSlab
+
+Called with the lock of the size class held
+========================
+*/
+/*
+========================
+Z_SetTrashTester
+
+The tester may land anywhere inside the padding, so it is copied
+rather than stored through an int pointer
+========================
+*/
+static void Z_SetTrashTester( memblock_t *block )
+{
+	int id = ZONEID;
+
+	Com_Memcpy( ( byte * ) block + block->tester, &id, sizeof( id ) );
+}
+
+/*
+========================
+Z_ReleaseBlock
+
+Checks the trash tester of a block about to be freed and fills it
+with something that should cause problems if it is referenced...
+========================
+*/
+static void Z_ReleaseBlock( memblock_t *block )
+{
+	int id;
+
+	Com_Memcpy( &id, ( byte * ) block + block->tester, sizeof( id ) );
+
+	if ( id != ZONEID )
+	{
+		Com_Error( ERR_FATAL, "Z_Free: memory block wrote past end" );
+	}
+
+	memset( block + 1, 0xaa, block->size - sizeof( *block ) );
+}
+
+static void Z_NewSlab( int sizeClass )
+{
+	zoneClass_t *zc = &zoneClasses[ sizeClass ];
+	memblock_t  *zoneBlock, *block;
+	zoneSlab_t  *slab;
+	int         size, i;
+
+	size = PAD( sizeof( memblock_t ) + ZONE_SLAB_HEADER + zc->slabBlocks * zc->size + 4, sizeof( intptr_t ) );
+
+	Z_Lock( &zoneLock );
+
+	zoneBlock = Z_ZoneAlloc( smallzone, size, TAG_SLAB );
+
+	if ( !zoneBlock )
+	{
+		zoneBlock = Z_ZoneAlloc( mainzone, size, TAG_SLAB );
+	}
+
+	Z_Unlock( &zoneLock );
+
+	if ( !zoneBlock )
+	{
+		Com_Error( ERR_FATAL, "Z_Malloc: failed on allocation of a %i bytes slab for %i bytes blocks", size, zc->size );
+	}
+
+#ifdef ZONE_DEBUG
+	zoneBlock->d.label = "slab";
+	zoneBlock->d.file = __FILE__;
+	zoneBlock->d.line = __LINE__;
+	zoneBlock->d.allocSize = size;
+#endif
+	zoneBlock->tester = sizeof( memblock_t ) + ZONE_SLAB_HEADER + zc->slabBlocks * zc->size;
+	Z_SetTrashTester( zoneBlock );
+
+	slab = ( zoneSlab_t * )( zoneBlock + 1 );
+	slab->numBlocks = zc->slabBlocks;
+	slab->next = zc->slabs;
+	zc->slabs = slab;
+	zc->numSlabs++;
+
+	// hand them out in address order
+	for ( i = zc->slabBlocks - 1; i >= 0; i-- )
+	{
+		block = ( memblock_t * )( ( byte * ) slab + ZONE_SLAB_HEADER + i * zc->size );
+		block->size = zc->size;
+		block->tag = 0;
+		block->id = ZONEID;
+		block->sizeClass = sizeClass + 1;
+		block->prev = NULL;
+		block->next = zc->free;
+		zc->free = block;
+	}
+}
+
+/*
+========================
+Z_SlabAlloc
+========================
+*/
+static memblock_t *Z_SlabAlloc( int sizeClass )
+{
+	zoneCache_t *cache = &zoneCache;
+	zoneClass_t *zc;
+	memblock_t  *block;
+	int         i;
+
+	if ( !cache->free[ sizeClass ] )
+	{
+		zc = &zoneClasses[ sizeClass ];
+
+		Z_Lock( &zc->lock );
+
+		if ( !zc->free )
+		{
+			Z_NewSlab( sizeClass );
+		}
+
+		for ( i = 0; i < ZONE_CACHE_BATCH && zc->free; i++ )
+		{
+			block = zc->free;
+			zc->free = block->next;
+			block->next = cache->free[ sizeClass ];
+			cache->free[ sizeClass ] = block;
+		}
+
+		Z_Unlock( &zc->lock );
+
+		cache->numFree[ sizeClass ] += i;
+	}
+
+	block = cache->free[ sizeClass ];
+	cache->free[ sizeClass ] = block->next;
+	cache->numFree[ sizeClass ]--;
+
+	return block;
+}
+
+/*
+========================
+Z_SlabFree
+========================
+*/
+static void Z_SlabFree( memblock_t *block )
+{
+	zoneCache_t *cache = &zoneCache;
+	zoneClass_t *zc;
+	int         sizeClass, i;
+
+	sizeClass = block->sizeClass - 1;
+
+	block->tag = 0; // mark as free
+	block->next = cache->free[ sizeClass ];
+	cache->free[ sizeClass ] = block;
+
+	if ( ++cache->numFree[ sizeClass ] <= ZONE_CACHE_MAX )
+	{
+		return;
+	}
+
+	// give some back for the other threads
+	zc = &zoneClasses[ sizeClass ];
+
+	Z_Lock( &zc->lock );
+
+	for ( i = 0; i < ZONE_CACHE_BATCH; i++ )
+	{
+		block = cache->free[ sizeClass ];
+		cache->free[ sizeClass ] = block->next;
+		block->next = zc->free;
+		zc->free = block;
+	}
+
+	Z_Unlock( &zc->lock );
+
+	cache->numFree[ sizeClass ] -= ZONE_CACHE_BATCH;
+}
+
+/*
+========================
+Z_SlabBlock
+========================
+*/
+static memblock_t *Z_SlabBlock( const zoneClass_t *zc, zoneSlab_t *slab, int index )
+{
+	return ( memblock_t * )( ( byte * ) slab + ZONE_SLAB_HEADER + index * zc->size );
+}
+
+/*
+========================
+Z_FirstSlab
+
+Slabs are only ever added at the head, so the list can be walked
+without the lock from there
+========================
+*/
+static zoneSlab_t *Z_FirstSlab( zoneClass_t *zc )
+{
+	zoneSlab_t *slab;
+
+	Z_Lock( &zc->lock );
+	slab = zc->slabs;
+	Z_Unlock( &zc->lock );
+
+	return slab;
+}
+
+/*
+========================
+Z_Free
+========================
+*/
+void Z_Free( void *ptr )
+{
+	memblock_t *block;
+
+	if ( !ptr )
+	{
+		Com_Error( ERR_DROP, "Z_Free: NULL pointer" );
+	}
+
+	block = ( memblock_t * )( ( byte * ) ptr - sizeof( memblock_t ) );
+
+	if ( block->id != ZONEID )
+	{
+		Com_Error( ERR_FATAL, "Z_Free: freed a pointer without ZONEID" );
+	}
+
+	if ( block->tag == 0 )
+	{
+		Com_Error( ERR_FATAL, "Z_Free: freed a freed pointer" );
+	}
+
+	// if static memory
+	if ( block->tag == TAG_STATIC )
+	{
+		return;
+	}
+
+	Z_ReleaseBlock( block );
+
+	if ( block->sizeClass )
+	{
+		Z_SlabFree( block );
+		return;
+	}
+
+	Z_Lock( &zoneLock );
+	Z_ZoneFree( Z_ZoneOf( block ), block );
+	Z_Unlock( &zoneLock );
+}
+
 /*
 ================
 Z_FreeTags
@@ -975,35 +1393,60 @@ Z_FreeTags
 */
 void Z_FreeTags( int tag )
 {
-	int       count;
-	memzone_t *zone;
+	memzone_t  *zones[ 2 ];
+	memzone_t  *zone;
+	zoneSlab_t *slab;
+	memblock_t *block;
+	int        i, j;
 
-	if ( tag == TAG_SMALL )
-	{
-		zone = smallzone;
-	}
-	else
+	zones[ 0 ] = mainzone;
+	zones[ 1 ] = smallzone;
+
+	Z_Lock( &zoneLock );
+
+	for ( i = 0; i < ARRAY_LEN( zones ); i++ )
 	{
-		zone = mainzone;
+		if ( !( zone = zones[ i ] ) )
+		{
+			continue;
+		}
+
+		// use the rover as our pointer, because
+		// Z_ZoneFree automatically adjusts it
+		zone->rover = zone->blocklist.next;
+
+		do
+		{
+			if ( zone->rover->tag == tag )
+			{
+				Z_ReleaseBlock( zone->rover );
+				Z_ZoneFree( zone, zone->rover );
+				continue;
+			}
+
+			zone->rover = zone->rover->next;
+		}
+		while ( zone->rover != &zone->blocklist );
 	}
 
-	count = 0;
-	// use the rover as our pointer, because
-	// Z_Free automatically adjusts it
-	zone->rover = zone->blocklist.next;
+	Z_Unlock( &zoneLock );
 
-	do
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ )
 	{
-		if ( zone->rover->tag == tag )
+		for ( slab = Z_FirstSlab( &zoneClasses[ i ] ); slab; slab = slab->next )
 		{
-			count++;
-			Z_Free( ( void * )( zone->rover + 1 ) );
-			continue;
-		}
+			for ( j = 0; j < slab->numBlocks; j++ )
+			{
+				block = Z_SlabBlock( &zoneClasses[ i ], slab, j );
 
-		zone->rover = zone->rover->next;
+				if ( block->tag == tag )
+				{
+					Z_ReleaseBlock( block );
+					Z_SlabFree( block );
+				}
+			}
+		}
 	}
-	while ( zone->rover != &zone->blocklist );
 }
 
 /*
@@ -1021,9 +1464,9 @@ void           *Z_TagMallocDebug( int size, int tag, const char *label, const ch
 void           *Z_TagMalloc( int size, int tag )
 {
 #endif
-	int        extra;
-	memblock_t *start, *rover, *new, *base;
+	memblock_t *base;
 	memzone_t  *zone;
+	int        requested;
 #ifdef ZONE_DEBUG
 	int        allocSize;
 	allocSize = size;
@@ -1034,30 +1477,34 @@ void           *Z_TagMalloc( int size, int tag )
 		Com_Error( ERR_FATAL, "Z_TagMalloc: tried to use a 0 tag" );
 	}
 
-	if ( tag == TAG_SMALL )
+	requested = size;
+	size += sizeof( memblock_t );  // account for size of block header
+	size += 4; // space for memory trash tester
+	size = PAD( size, sizeof( intptr_t ) );   // align to 32/64 bit boundary
+
+	if ( size <= ZONE_MAX_CLASS_SIZE )
 	{
-		zone = smallzone;
+		base = Z_SlabAlloc( zoneClassOfSize[ ( size + 15 ) >> 4 ] - 1 );
+		base->tag = tag; // no longer a free block
 	}
 	else
 	{
-		zone = mainzone;
-	}
+		// big strings go to the small zone as long as it has room
+		zone = tag == TAG_SMALL ? smallzone : mainzone;
 
-	// scan through the block list looking for the first free block
-	// of sufficient size
-	//
-	size += sizeof( memblock_t );  // account for size of block header
-	size += 4; // space for memory trash tester
-	size = PAD( size, sizeof( intptr_t ) );   // align to 32/64 bit boundary
+		Z_Lock( &zoneLock );
 
-	base = rover = zone->rover;
-	start = base->prev;
+		base = Z_ZoneAlloc( zone, size, tag );
 
-	do
-	{
-		if ( rover == start )
+		if ( !base && zone == smallzone )
+		{
+			base = Z_ZoneAlloc( mainzone, size, tag );
+		}
+
+		Z_Unlock( &zoneLock );
+
+		if ( !base )
 		{
-			// scaned all the way around the list
 #ifdef ZONE_DEBUG
 			Z_LogHeap();
 
@@ -1069,44 +1516,8 @@ void           *Z_TagMalloc( int size, int tag )
 #endif
 			return NULL;
 		}
-
-		if ( rover->tag )
-		{
-			base = rover = rover->next;
-		}
-		else
-		{
-			rover = rover->next;
-		}
-	}
-	while ( base->tag || base->size < size );
-
-	//
-	// found a block big enough
-	//
-	extra = base->size - size;
-
-	if ( extra > MINFRAGMENT )
-	{
-		// there will be a free fragment after the allocated block
-		new = ( memblock_t * )( ( byte * ) base + size );
-		new->size = extra;
-		new->tag = 0; // free block
-		new->prev = base;
-		new->id = ZONEID;
-		new->next = base->next;
-		new->next->prev = new;
-		base->next = new;
-		base->size = size;
 	}
 
-	base->tag = tag; // no longer a free block
-
-	zone->rover = base->next; // next allocation will start looking here
-	zone->used += base->size; //
-
-	base->id = ZONEID;
-
 #ifdef ZONE_DEBUG
 	base->d.label = label;
 	base->d.file = file;
@@ -1114,8 +1525,10 @@ void           *Z_TagMalloc( int size, int tag )
 	base->d.allocSize = allocSize;
 #endif
 
-	// marker for memory trash testing
-	* ( int * )( ( byte * ) base + base->size - 4 ) = ZONEID;
+	// marker for memory trash testing, right after the requested bytes
+	// so that writes into the rounding slack of the block are caught too
+	base->tester = sizeof( memblock_t ) + requested;
+	Z_SetTrashTester( base );
 
 	return ( void * )( ( byte * ) base + sizeof( memblock_t ) );
 }
@@ -1163,6 +1576,9 @@ void           *S_Malloc( int size )
 /*
 ========================
 Z_CheckHeap
+
+This and the other diagnostics walk the zones without the locks,
+they are meant for the main thread
 ========================
 */
 void Z_CheckHeap( void )
@@ -1195,16 +1611,70 @@ void Z_CheckHeap( void )
 
 /*
 ========================
-Z_LogZoneHeap
+Z_LogBlock
 ========================
 */
-void Z_LogZoneHeap( const memzone_t *zone, const char *name )
+static void Z_LogBlock( const memblock_t *block, int *size, int *allocSize, int *numBlocks )
 {
 #ifdef ZONE_DEBUG
 	char       dump[ 32 ];
 	const char *ptr;
 	int        i, j;
+	char       buf[ 4096 ];
+
+	ptr = ( ( const char * ) block ) + sizeof( memblock_t );
+	j = 0;
+
+	for ( i = 0; i < 20 && i < block->d.allocSize; i++ )
+	{
+		if ( ptr[ i ] >= 32 && ptr[ i ] < 127 )
+		{
+			dump[ j++ ] = ptr[ i ];
+		}
+		else
+		{
+			dump[ j++ ] = '_';
+		}
+	}
+
+	dump[ j ] = '\0';
+	Com_sprintf( buf, sizeof( buf ), "size = %8d: %s, line: %d (%s) [%s]\r\n", block->d.allocSize, block->d.file,
+	             block->d.line, block->d.label, dump );
+	FS_Write( buf, strlen( buf ), logfile );
+	*allocSize += block->d.allocSize;
+#endif
+	*size += block->size;
+	( *numBlocks )++;
+}
+
+/*
+========================
+Z_LogBlocksTotal
+========================
+*/
+static void Z_LogBlocksTotal( const char *name, int size, int allocSize, int numBlocks )
+{
+	char buf[ 4096 ];
+
+#ifdef ZONE_DEBUG
+	// subtract debug memory
+	size -= numBlocks * sizeof( zonedebug_t );
+#else
+	allocSize = numBlocks * sizeof( memblock_t );  // + 32 bit alignment
 #endif
+	Com_sprintf( buf, sizeof( buf ), "%d %s memory in %d blocks\r\n", size, name, numBlocks );
+	FS_Write( buf, strlen( buf ), logfile );
+	Com_sprintf( buf, sizeof( buf ), "%d %s memory overhead\r\n", size - allocSize, name );
+	FS_Write( buf, strlen( buf ), logfile );
+}
+
+/*
+========================
+Z_LogZoneHeap
+========================
+*/
+void Z_LogZoneHeap( const memzone_t *zone, const char *name )
+{
 	const memblock_t *block;
 	char       buf[ 4096 ];
 	int        size, allocSize, numBlocks;
@@ -1222,43 +1692,52 @@ void Z_LogZoneHeap( const memzone_t *zone, const char *name )
 	{
 		if ( block->tag )
 		{
-#ifdef ZONE_DEBUG
-			ptr = ( ( const char * ) block ) + sizeof( memblock_t );
-			j = 0;
+			Z_LogBlock( block, &size, &allocSize, &numBlocks );
+		}
+	}
+
+	Z_LogBlocksTotal( name, size, allocSize, numBlocks );
+}
+
+/*
+========================
+Z_LogSlabHeap
+========================
+*/
+static void Z_LogSlabHeap( void )
+{
+	zoneSlab_t *slab;
+	memblock_t *block;
+	char       buf[ 4096 ];
+	int        size, allocSize, numBlocks;
+	int        i, j;
+
+	if ( !logfile || !FS_Initialized() )
+	{
+		return;
+	}
 
-			for ( i = 0; i < 20 && i < block->d.allocSize; i++ )
+	size = allocSize = numBlocks = 0;
+	Com_sprintf( buf, sizeof( buf ), "\r\n================\r\nSLAB log\r\n================\r\n" );
+	FS_Write( buf, strlen( buf ), logfile );
+
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ )
+	{
+		for ( slab = zoneClasses[ i ].slabs; slab; slab = slab->next )
+		{
+			for ( j = 0; j < slab->numBlocks; j++ )
 			{
-				if ( ptr[ i ] >= 32 && ptr[ i ] < 127 )
-				{
-					dump[ j++ ] = ptr[ i ];
-				}
-				else
+				block = Z_SlabBlock( &zoneClasses[ i ], slab, j );
+
+				if ( block->tag )
 				{
-					dump[ j++ ] = '_';
+					Z_LogBlock( block, &size, &allocSize, &numBlocks );
 				}
 			}
-
-			dump[ j ] = '\0';
-			Com_sprintf( buf, sizeof( buf ), "size = %8d: %s, line: %d (%s) [%s]\r\n", block->d.allocSize, block->d.file,
-			             block->d.line, block->d.label, dump );
-			FS_Write( buf, strlen( buf ), logfile );
-			allocSize += block->d.allocSize;
-#endif
-			size += block->size;
-			numBlocks++;
 		}
 	}
 
-#ifdef ZONE_DEBUG
-	// subtract debug memory
-	size -= numBlocks * sizeof( zonedebug_t );
-#else
-	allocSize = numBlocks * sizeof( memblock_t );  // + 32 bit alignment
-#endif
-	Com_sprintf( buf, sizeof( buf ), "%d %s memory in %d blocks\r\n", size, name, numBlocks );
-	FS_Write( buf, strlen( buf ), logfile );
-	Com_sprintf( buf, sizeof( buf ), "%d %s memory overhead\r\n", size - allocSize, name );
-	FS_Write( buf, strlen( buf ), logfile );
+	Z_LogBlocksTotal( "SLAB", size, allocSize, numBlocks );
 }
 
 /*
@@ -1270,6 +1749,7 @@ void Z_LogHeap( void )
 {
 	Z_LogZoneHeap( mainzone, "MAIN" );
 	Z_LogZoneHeap( smallzone, "SMALL" );
+	Z_LogSlabHeap();
 }
 
 // static mem blocks to reduce a lot of small zone overhead
@@ -1435,17 +1915,22 @@ Com_Meminfo_f
 */
 void Com_Meminfo_f( void )
 {
-	memblock_t *block;
-	int        zoneBytes, zoneBlocks;
-	int        smallZoneBytes, smallZoneBlocks;
-	int        botlibBytes, rendererBytes;
-	int        unused;
+	memblock_t  *block;
+	zoneSlab_t  *slab;
+	zoneClass_t *zc;
+	int         zoneBytes, zoneBlocks;
+	int         smallZoneBytes, smallZoneBlocks;
+	int         tagBytes[ ARRAY_LEN( zoneTagNames ) ], tagBlocks[ ARRAY_LEN( zoneTagNames ) ];
+	int         classUsed, classFree;
+	int         unused;
+	int         i, j;
 
 	zoneBytes = 0;
-	botlibBytes = 0;
-	rendererBytes = 0;
 	zoneBlocks = 0;
 
+	Com_Memset( tagBytes, 0, sizeof( tagBytes ) );
+	Com_Memset( tagBlocks, 0, sizeof( tagBlocks ) );
+
 	for ( block = mainzone->blocklist.next;; block = block->next )
 	{
 		if ( Cmd_Argc() != 1 )
@@ -1458,13 +1943,10 @@ void Com_Meminfo_f( void )
 			zoneBytes += block->size;
 			zoneBlocks++;
 
-			if ( block->tag == TAG_BOTLIB )
-			{
-				botlibBytes += block->size;
-			}
-			else if ( block->tag == TAG_RENDERER )
+			if ( block->tag > 0 && block->tag < ARRAY_LEN( zoneTagNames ) )
 			{
-				rendererBytes += block->size;
+				tagBytes[ block->tag ] += block->size;
+				tagBlocks[ block->tag ]++;
 			}
 		}
 
@@ -1498,6 +1980,12 @@ void Com_Meminfo_f( void )
 		{
 			smallZoneBytes += block->size;
 			smallZoneBlocks++;
+
+			if ( block->tag > 0 && block->tag < ARRAY_LEN( zoneTagNames ) )
+			{
+				tagBytes[ block->tag ] += block->size;
+				tagBlocks[ block->tag ]++;
+			}
 		}
 
 		if ( block->next == &smallzone->blocklist )
@@ -1506,6 +1994,23 @@ void Com_Meminfo_f( void )
 		}
 	}
 
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ )
+	{
+		for ( slab = zoneClasses[ i ].slabs; slab; slab = slab->next )
+		{
+			for ( j = 0; j < slab->numBlocks; j++ )
+			{
+				block = Z_SlabBlock( &zoneClasses[ i ], slab, j );
+
+				if ( block->tag > 0 && block->tag < ARRAY_LEN( zoneTagNames ) )
+				{
+					tagBytes[ block->tag ] += block->size;
+					tagBlocks[ block->tag ]++;
+				}
+			}
+		}
+	}
+
 	Com_Printf( "%9i bytes (%6.2f MB) total hunk\n", s_hunkTotal, s_hunkTotal / Square( 1024.f ) );
 	Com_Printf( "%9i bytes (%6.2f MB) total zone\n", s_zoneTotal, s_zoneTotal / Square( 1024.f ) );
 	Com_Printf( "\n" );
@@ -1546,11 +2051,149 @@ void Com_Meminfo_f( void )
 	Com_Printf( "%9i bytes (%6.2f MB) unused highwater\n", unused, unused / Square( 1024.f ) );
 	Com_Printf( "\n" );
 	Com_Printf( "%9i bytes (%6.2f MB) in %i zone blocks\n", zoneBytes, zoneBytes / Square( 1024.f ), zoneBlocks );
-	Com_Printf( "        %9i bytes (%6.2f MB) in dynamic botlib\n", botlibBytes, botlibBytes / Square( 1024.f ) );
-	Com_Printf( "        %9i bytes (%6.2f MB) in dynamic renderer\n", rendererBytes, rendererBytes / Square( 1024.f ) );
-	Com_Printf( "        %9i bytes (%6.2f MB) in dynamic other\n", zoneBytes - ( botlibBytes + rendererBytes ),
-	            ( zoneBytes - ( botlibBytes + rendererBytes ) ) / Square( 1024.f ) );
-	Com_Printf( "        %9i bytes (%6.2f MB) in small Zone memory\n", smallZoneBytes, smallZoneBytes / Square( 1024.f ) );
+	Com_Printf( "%9i bytes (%6.2f MB) in %i small zone blocks\n", smallZoneBytes, smallZoneBytes / Square( 1024.f ), smallZoneBlocks );
+	Com_Printf( "\n" );
+
+	// the blocks of the slabs are counted by their own tags,
+	// "slab" is the zone memory the slabs take
+	Com_Printf( "tag        blocks      bytes\n" );
+
+	for ( i = 1; i < ARRAY_LEN( zoneTagNames ); i++ )
+	{
+		if ( tagBlocks[ i ] )
+		{
+			Com_Printf( "%-8s %8i %10i\n", zoneTagNames[ i ], tagBlocks[ i ], tagBytes[ i ] );
+		}
+	}
+
+	Com_Printf( "\n" );
+	Com_Printf( "class  slabs   used   free      bytes\n" );
+
+	for ( i = 0; i < ZONE_NUM_CLASSES; i++ )
+	{
+		zc = &zoneClasses[ i ];
+		classUsed = classFree = 0;
+
+		for ( slab = zc->slabs; slab; slab = slab->next )
+		{
+			for ( j = 0; j < slab->numBlocks; j++ )
+			{
+				if ( Z_SlabBlock( zc, slab, j )->tag )
+				{
+					classUsed++;
+				}
+				else
+				{
+					classFree++;
+				}
+			}
+		}
+
+		if ( zc->numSlabs )
+		{
+			Com_Printf( "%5i %6i %6i %6i %10i\n", zc->size, zc->numSlabs, classUsed, classFree, classUsed * zc->size );
+		}
+	}
+}
+
+/*
+=================
+Com_ZoneBench_f
+
+Times the zone on the allocations that are made all the time: command
+lines copied argument by argument, chains of parser tokens as copied by
+Parse_CopyToken, and a mix of sizes freed in random order
+=================
+*/
+#define ZONEBENCH_TOKEN_SIZE ( MAX_TOKEN_CHARS + 64 ) // a token_t of parse.c
+#define ZONEBENCH_TOKENS     64
+#define ZONEBENCH_LIVE       1024
+
+static void Com_ZoneBench_f( void )
+{
+	static const char *const lines[] =
+	{
+		"bind MOUSE1 +attack",
+		"seta cg_drawFPS 1",
+		"set nextmap \"map atcs\"; vstr nextmap",
+		"say_team \"need help at the reactor\"",
+		"exec autoexec.cfg",
+	};
+	void         *ptrs[ ZONEBENCH_LIVE ];
+	int          count, i, j, n, start, msec;
+	unsigned int seed;
+
+	count = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 10000;
+	count = MAX( count, 1 );
+
+	start = Sys_Milliseconds();
+
+	for ( i = 0; i < count; i++ )
+	{
+		Cmd_TokenizeString( lines[ i % ARRAY_LEN( lines ) ] );
+		n = MIN( Cmd_Argc(), ZONEBENCH_LIVE );
+
+		for ( j = 0; j < n; j++ )
+		{
+			ptrs[ j ] = CopyString( Cmd_Argv( j ) );
+		}
+
+		for ( j = 0; j < n; j++ )
+		{
+			Z_Free( ptrs[ j ] );
+		}
+	}
+
+	msec = Sys_Milliseconds() - start;
+	Com_Printf( "%6i msec for %i command lines\n", msec, count );
+
+	start = Sys_Milliseconds();
+
+	for ( i = 0; i < count; i++ )
+	{
+		for ( j = 0; j < ZONEBENCH_TOKENS; j++ )
+		{
+			ptrs[ j ] = Z_Malloc( ZONEBENCH_TOKEN_SIZE );
+		}
+
+		for ( j = 0; j < ZONEBENCH_TOKENS; j++ )
+		{
+			Z_Free( ptrs[ j ] );
+		}
+	}
+
+	msec = Sys_Milliseconds() - start;
+	Com_Printf( "%6i msec for %i tokens, %.1f nsec each\n", msec, count * ZONEBENCH_TOKENS,
+	            msec * 1000000.0 / ( count * ZONEBENCH_TOKENS ) );
+
+	Com_Memset( ptrs, 0, sizeof( ptrs ) );
+	seed = 0x5eed;
+	start = Sys_Milliseconds();
+
+	for ( i = 0; i < count * 16; i++ )
+	{
+		seed = seed * 1664525 + 1013904223;
+		j = ( seed >> 8 ) % ZONEBENCH_LIVE;
+
+		if ( ptrs[ j ] )
+		{
+			Z_Free( ptrs[ j ] );
+		}
+
+		// mostly small, up to a few kilobytes
+		ptrs[ j ] = Z_TagMalloc( ( 8 << ( ( seed >> 20 ) % 10 ) ) + ( seed >> 28 ), TAG_GENERAL );
+	}
+
+	for ( j = 0; j < ZONEBENCH_LIVE; j++ )
+	{
+		if ( ptrs[ j ] )
+		{
+			Z_Free( ptrs[ j ] );
+		}
+	}
+
+	msec = Sys_Milliseconds() - start;
+	Com_Printf( "%6i msec for %i mixed allocations, %.1f nsec each\n", msec, count * 16, msec * 1000000.0 / ( count * 16 ) );
 }
 
 /*
@@ -1674,6 +2317,8 @@ Com_InitZoneMemory
 */
 void Com_InitSmallZoneMemory( void )
 {
+	Z_InitSizeClasses();
+
 	s_smallZoneTotal = 512 * 1024;
 	// bk001205 - was malloc
 	smallzone = calloc( s_smallZoneTotal, 1 );
@@ -1869,6 +2514,7 @@ void Com_InitHunkMemory( void )
 	Hunk_Clear();
 
 	Cmd_AddCommand( "meminfo", Com_Meminfo_f );
+	Cmd_AddCommand( "zonebench", Com_ZoneBench_f );
 #ifdef ZONE_DEBUG
 	Cmd_AddCommand( "zonelog", Z_LogHeap );
 #endif
@@ -3153,6 +3799,7 @@ void Com_Init( char *commandLine )
 
 	com_introPlayed = Cvar_Get( "com_introplayed", "0", CVAR_ARCHIVE );
 	com_ansiColor = Cvar_Get( "com_ansiColor", "0", CVAR_ARCHIVE );
+	com_parseCache = Cvar_Get( "com_parseCache", "1", CVAR_ARCHIVE );
 	com_logosPlaying = Cvar_Get( "com_logosPlaying", "0", CVAR_ROM );
 	com_recommendedSet = Cvar_Get( "com_recommendedSet", "0", CVAR_ARCHIVE );
 
@@ -3200,6 +3847,7 @@ void Com_Init( char *commandLine )
 	// qport values.
 	Com_RandomBytes( ( byte * )&qport, sizeof( int ) );
 	Netchan_Init( qport & 0xffff );
+	MSG_LoadHuffmanTable();
 
 	VM_Init();
 	SV_Init();
@@ -3507,7 +4155,7 @@ Com_Frame
 */
 void Com_Frame( void )
 {
-	int             msec, minMsec;
+	int             msec, minMsec, sleepMsec, paceMsec;
 	static int      lastTime = 0;
 	//int             key;
 
@@ -3599,7 +4247,27 @@ void Com_Frame( void )
 	while ( msec < minMsec )
 	{
 		//give cycles back to the OS
-		Sys_Sleep( minMsec - msec );
+		sleepMsec = minMsec - msec;
+
+		if ( com_dedicated->integer )
+		{
+			// windowed downloads keep going between server frames,
+			// as they are clocked by the acknowledges of the clients
+			if ( SV_SendDownloadMessages() )
+			{
+				sleepMsec = 1;
+			}
+
+			// the messages of the last server frame go out over the frame interval
+			paceMsec = SV_SendPacedMessages();
+
+			if ( paceMsec >= 0 && paceMsec < sleepMsec )
+			{
+				sleepMsec = paceMsec;
+			}
+		}
+
+		Sys_Sleep( sleepMsec );
 
 		com_frameTime = Com_EventLoop();
 		msec = com_frameTime - lastTime;
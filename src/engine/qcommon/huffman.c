@@ -483,6 +483,181 @@ void Huff_offsetTransmit( huff_t *huff, int ch, byte *fout, int *offset )
 	*offset = bloc;
 }
 
+/*
+Table driven coding for trees that are built once and never updated, like
+the message trees in msg.c.  The output is bit for bit the same as
+Huff_offsetTransmit/Huff_offsetReceive.
+*/
+
+/* Codeword of a node, first bit sent in bit 0 */
+static int codeword( const node_t *node, uint64_t *code )
+{
+	int length = 0;
+
+	*code = 0;
+
+	for ( ; node->parent; node = node->parent )
+	{
+		*code = ( *code << 1 ) | ( node->parent->right == node );
+		length++;
+
+		if ( length > 64 )
+		{
+			return -1;
+		}
+	}
+
+	return length;
+}
+
+void Huff_BuildTables( const huffman_t *huff, huffTables_t *tables )
+{
+	int      i, j, length;
+	uint64_t code;
+
+	Com_Memset( tables, 0, sizeof( *tables ) );
+
+	for ( i = 0; i < HMAX; i++ )
+	{
+		if ( huff->compressor.loc[ i ] )
+		{
+			length = codeword( huff->compressor.loc[ i ], &code );
+
+			if ( length > 0 && length <= 32 )
+			{
+				tables->code[ i ] = ( uint32_t ) code;
+				tables->length[ i ] = length;
+			}
+		}
+	}
+
+	// NYT is included, Huff_offsetReceive can return it too
+	for ( i = 0; i <= HMAX; i++ )
+	{
+		if ( !huff->decompressor.loc[ i ] )
+		{
+			continue;
+		}
+
+		length = codeword( huff->decompressor.loc[ i ], &code );
+
+		if ( length <= 0 || length > HUFF_LOOKUP_BITS )
+		{
+			continue;
+		}
+
+		// every index starting with this codeword decodes to the symbol
+		for ( j = 0; j < 1 << ( HUFF_LOOKUP_BITS - length ); j++ )
+		{
+			tables->lookup[ ( int ) code | ( j << length ) ] = i | ( length << 9 );
+		}
+	}
+}
+
+/*
+Builds a tree that is never updated straight from the symbol weights, instead
+of adding every reference one by one.  The two lightest subtrees are merged
+first, the earlier one wins ties so every build of the same weights is equal.
+NYT isn't in the tree, so every symbol needs a weight.
+*/
+void Huff_BuildStaticTree( huff_t *huff, const int *weights )
+{
+	node_t *roots[ HMAX ];
+	node_t *node;
+	int    numRoots, i, first, second;
+
+	Com_Memset( huff, 0, sizeof( *huff ) );
+
+	for ( i = 0; i < HMAX; i++ )
+	{
+		node = &huff->nodeList[ huff->blocNode++ ];
+		node->symbol = i;
+		node->weight = weights[ i ];
+		huff->loc[ i ] = roots[ i ] = node;
+	}
+
+	for ( numRoots = HMAX; numRoots > 1; numRoots-- )
+	{
+		first = second = -1;
+
+		for ( i = 0; i < numRoots; i++ )
+		{
+			if ( first < 0 || roots[ i ]->weight < roots[ first ]->weight )
+			{
+				second = first;
+				first = i;
+			}
+			else if ( second < 0 || roots[ i ]->weight < roots[ second ]->weight )
+			{
+				second = i;
+			}
+		}
+
+		node = &huff->nodeList[ huff->blocNode++ ];
+		node->symbol = INTERNAL_NODE;
+		node->weight = roots[ first ]->weight + roots[ second ]->weight;
+		node->left = roots[ first ];
+		node->right = roots[ second ];
+		roots[ first ]->parent = roots[ second ]->parent = node;
+
+		// the new subtree takes the place of the first, the last root fills the gap
+		roots[ first ] = node;
+		roots[ second ] = roots[ numRoots - 1 ];
+	}
+
+	huff->tree = roots[ 0 ];
+}
+
+/* Write up to 56 bits at once, clearing the following bits like Huff_putBit */
+void Huff_putBits( uint64_t bits, int count, byte *fout, int *offset )
+{
+	int      x, y, n;
+	uint64_t acc;
+
+	x = *offset >> 3;
+	y = *offset & 7;
+
+	acc = bits << y;
+
+	if ( y )
+	{
+		acc |= fout[ x ];
+	}
+
+	for ( n = ( y + count + 7 ) >> 3; n > 0; n-- )
+	{
+		fout[ x++ ] = ( byte ) acc;
+		acc >>= 8;
+	}
+
+	*offset += count;
+}
+
+/* Get a symbol, looking up HUFF_LOOKUP_BITS at once */
+int Huff_tableReceive( const huffTables_t *tables, node_t *tree, byte *fin, int *offset, int maxbytes )
+{
+	int      x, entry, ch;
+	uint32_t window;
+
+	x = *offset >> 3;
+
+	if ( x + 3 <= maxbytes )
+	{
+		window = ( fin[ x ] | fin[ x + 1 ] << 8 | fin[ x + 2 ] << 16 ) >> ( *offset & 7 );
+		entry = tables->lookup[ window & ( ( 1 << HUFF_LOOKUP_BITS ) - 1 ) ];
+
+		if ( entry )
+		{
+			*offset += entry >> 9;
+			return entry & 0x1ff;
+		}
+	}
+
+	// long codes and the end of the buffer walk the tree
+	Huff_offsetReceive( tree, &ch, fin, offset );
+	return ch;
+}
+
 void Huff_Decompress( msg_t *mbuf, int offset )
 {
 	int    ch, cch, i, j, size;
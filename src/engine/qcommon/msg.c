@@ -35,8 +35,35 @@ Maryland 20850 USA.
 #include "../qcommon/q_shared.h"
 #include "qcommon.h"
 
-static huffman_t msgHuff;
-static qboolean  msgInit = qfalse;
+static huffman_t    msgHuff;
+static huffTables_t msgHuffTables;
+static qboolean     msgInit = qfalse;
+
+// optional trees trained on our own traffic, see MSG_LoadHuffmanTable
+typedef struct
+{
+	huffman_t    huff;
+	huffTables_t tables;
+	int          data[ 256 ]; // frequencies as loaded
+	int          checksum; // 0 if none is loaded
+} msgHuffTree_t;
+
+static msgHuffTree_t msgHuffTrained; // net_huffmanTable
+static msgHuffTree_t msgHuffDemo; // the table of the demo being played back
+
+// huffman trainer and bandwidth report, see MSG_Huffman_f
+static struct
+{
+	qboolean sampling;
+	int      counts[ 256 ];
+	int      codeLength[ 2 ][ 256 ];
+	int      messages;
+	double   bits[ 2 ]; // static, trained
+} msgHuffStats;
+
+static msgHuffTree_t *MSG_HuffmanTree( int huffTable );
+static void MSG_HuffmanSample( int nbits, int symbol );
+static void MSG_HuffmanCodeLengths( const huff_t *huff, int *lengths );
 
 /*
 ==============================================================================
@@ -193,9 +220,22 @@ void MSG_WriteBits( msg_t *msg, int value, int bits )
 			Com_Error( ERR_DROP, "can't read %d bits", bits );
 		}
 	}
+	else if ( msg->raw )
+	{
+		value &= ( 0xffffffff >> ( 32 - bits ) );
+
+		Huff_putBits( ( uint32_t ) value, bits, msg->data, &msg->bit );
+		msg->cursize = ( msg->bit >> 3 ) + 1;
+	}
 	else
 	{
-//      fp = fopen("c:\\netchan.bin", "a");
+		msgHuffTree_t      *trained = MSG_HuffmanTree( msg->huffTable );
+		huff_t             *huff = trained ? &trained->huff.compressor : &msgHuff.compressor;
+		const huffTables_t *tables = trained ? &trained->tables : &msgHuffTables;
+		uint64_t           acc = 0;
+		int                accBits = 0;
+		int                symbol, length;
+
 		value &= ( 0xffffffff >> ( 32 - bits ) );
 
 		if ( bits & 7 )
@@ -204,23 +244,52 @@ void MSG_WriteBits( msg_t *msg, int value, int bits )
 
 			nbits = bits & 7;
 
-			for ( i = 0; i < nbits; i++ )
+			acc = value & ( ( 1 << nbits ) - 1 );
+			accBits = nbits;
+			value = ( value >> nbits );
+
+			if ( msg->huffSample && msgHuffStats.sampling )
 			{
-				Huff_putBit( ( value & 1 ), msg->data, &msg->bit );
-				value = ( value >> 1 );
+				MSG_HuffmanSample( nbits, -1 );
 			}
 
 			bits = bits - nbits;
 		}
 
-		if ( bits )
+		// gather the codewords and write them out a word at a time
+		for ( i = 0; i < bits; i += 8 )
 		{
-			for ( i = 0; i < bits; i += 8 )
+			symbol = value & 0xff;
+			length = tables->length[ symbol ];
+
+			if ( accBits && ( !length || accBits + length > 56 ) )
+			{
+				Huff_putBits( acc, accBits, msg->data, &msg->bit );
+				acc = 0;
+				accBits = 0;
+			}
+
+			if ( length )
+			{
+				acc |= ( uint64_t ) tables->code[ symbol ] << accBits;
+				accBits += length;
+			}
+			else
+			{
+				Huff_offsetTransmit( huff, symbol, msg->data, &msg->bit );
+			}
+
+			if ( msg->huffSample && msgHuffStats.sampling )
 			{
-//              fwrite(bp, 1, 1, fp);
-				Huff_offsetTransmit( &msgHuff.compressor, ( value & 0xff ), msg->data, &msg->bit );
-				value = ( value >> 8 );
+				MSG_HuffmanSample( 0, symbol );
 			}
+
+			value = ( value >> 8 );
+		}
+
+		if ( accBits )
+		{
+			Huff_putBits( acc, accBits, msg->data, &msg->bit );
 		}
 
 		msg->cursize = ( msg->bit >> 3 ) + 1;
@@ -278,8 +347,22 @@ int MSG_ReadBits( msg_t *msg, int bits )
 			Com_Error( ERR_DROP, "can't read %d bits", bits );
 		}
 	}
+	else if ( msg->raw )
+	{
+		for ( i = 0; i < bits && ( msg->bit >> 3 ) < msg->maxsize; i++ )
+		{
+			value |= ( unsigned int ) Huff_getBit( msg->data, &msg->bit ) << i;
+		}
+
+		// bits past the end of the buffer read as zero,
+		// readcount still shows the overrun to the caller
+		msg->bit += bits - i;
+		msg->readcount = ( msg->bit >> 3 ) + 1;
+	}
 	else
 	{
+		msgHuffTree_t *trained = MSG_HuffmanTree( msg->huffTable );
+
 		nbits = 0;
 
 		if ( bits & 7 )
@@ -291,6 +374,11 @@ int MSG_ReadBits( msg_t *msg, int bits )
 				value |= ( Huff_getBit( msg->data, &msg->bit ) << i );
 			}
 
+			if ( msg->huffSample && msgHuffStats.sampling )
+			{
+				MSG_HuffmanSample( nbits, -1 );
+			}
+
 			bits = bits - nbits;
 		}
 
@@ -299,8 +387,16 @@ int MSG_ReadBits( msg_t *msg, int bits )
 //          fp = fopen("c:\\netchan.bin", "a");
 			for ( i = 0; i < bits; i += 8 )
 			{
-				Huff_offsetReceive( msgHuff.decompressor.tree, &get, msg->data, &msg->bit );
+				get = Huff_tableReceive( trained ? &trained->tables : &msgHuffTables,
+				                         trained ? trained->huff.decompressor.tree : msgHuff.decompressor.tree,
+				                         msg->data, &msg->bit, msg->maxsize );
 //              fwrite(&get, 1, 1, fp);
+
+				if ( msg->huffSample && msgHuffStats.sampling )
+				{
+					MSG_HuffmanSample( 0, get );
+				}
+
 				value |= ( get << ( i + nbits ) );
 			}
 
@@ -2239,6 +2335,510 @@ void MSG_initHuffman( void )
 			Huff_addRef( &msgHuff.decompressor, ( byte ) i );  /* Do update */
 		}
 	}
+
+	Huff_BuildTables( &msgHuff, &msgHuffTables );
+	MSG_HuffmanCodeLengths( &msgHuff.compressor, msgHuffStats.codeLength[ 0 ] );
+}
+
+/*
+=============================================================================
+
+TRAINED HUFFMAN TABLE
+
+The static tree above was built from Quake 3 traffic.  A symbol frequency
+table trained on our own snapshots can be loaded from net_huffmanTable.
+It is only used for the server to client stream, and only when the client
+and the server loaded the same table: the client sends the table checksum
+in its connect userinfo and the server echoes it in connectResponse.
+Everything else falls back to the static tree.  Demos recorded with the
+table carry it, and get a tree of their own when they are played back.
+
+Tables are made with the "huffman" command, either on a dedicated server
+or by playing back demos:
+
+  huffman train          start counting server to client symbols
+  huffman stop           stop counting
+  huffman save <file>    write the counted frequencies as a table
+  huffman report         bytes per message under the static and trained trees
+  huffman bench [count]  check and time the message coder against the tree walk
+=============================================================================
+*/
+
+/*
+==================
+MSG_HuffmanCodeLengths
+
+Code length in bits of every symbol in a built tree
+==================
+*/
+static void MSG_HuffmanCodeLengths( const huff_t *huff, int *lengths )
+{
+	int          i;
+	const node_t *node;
+
+	for ( i = 0; i < 256; i++ )
+	{
+		lengths[ i ] = 0;
+
+		for ( node = huff->loc[ i ]; node && node->parent; node = node->parent )
+		{
+			lengths[ i ]++;
+		}
+	}
+}
+
+/*
+==================
+MSG_HuffmanSample
+
+Accounts a huffman coded symbol, or nbits of raw bits if symbol is -1
+==================
+*/
+static void MSG_HuffmanSample( int nbits, int symbol )
+{
+	if ( symbol < 0 )
+	{
+		msgHuffStats.bits[ 0 ] += nbits;
+		msgHuffStats.bits[ 1 ] += nbits;
+		return;
+	}
+
+	msgHuffStats.counts[ symbol ]++;
+	msgHuffStats.bits[ 0 ] += msgHuffStats.codeLength[ 0 ][ symbol ];
+	msgHuffStats.bits[ 1 ] += msgHuffStats.codeLength[ 1 ][ symbol ];
+}
+
+/*
+==================
+MSG_HuffmanCountMessage
+
+Called once per server to client message that was sampled
+==================
+*/
+void MSG_HuffmanCountMessage( const msg_t *msg )
+{
+	if ( msg->huffSample && msgHuffStats.sampling )
+	{
+		msgHuffStats.messages++;
+	}
+}
+
+/*
+==================
+MSG_HuffmanTree
+
+The trained tree a message uses, or NULL for the static one
+==================
+*/
+static msgHuffTree_t *MSG_HuffmanTree( int huffTable )
+{
+	switch ( huffTable )
+	{
+		case HUFF_TRAINED:
+			return &msgHuffTrained;
+
+		case HUFF_DEMO:
+			return &msgHuffDemo;
+
+		default:
+			return NULL;
+	}
+}
+
+#define HUFF_TABLE_TOTAL ( 1 << 16 )
+
+/*
+==================
+MSG_SetHuffmanTable
+
+Builds a trained tree from a frequency table.  Every symbol needs a
+non-zero frequency, as the tree is never updated afterwards.  The
+tables come from files and demos, so they are scaled down to at most
+HUFF_TABLE_TOTAL before the tree is built, which also keeps the
+codewords short enough for the lookup tables.
+==================
+*/
+qboolean MSG_SetHuffmanTable( msgHuffTable_t table, const int *frequencies )
+{
+	msgHuffTree_t *tree = MSG_HuffmanTree( table );
+	int           weights[ 256 ];
+	int           swapped[ 256 ];
+	int64_t       total;
+	int           i;
+
+	if ( !tree )
+	{
+		return qfalse;
+	}
+
+	for ( i = 0, total = 0; i < 256; i++ )
+	{
+		if ( frequencies[ i ] <= 0 )
+		{
+			return qfalse;
+		}
+
+		total += frequencies[ i ];
+	}
+
+	if ( !msgInit )
+	{
+		MSG_initHuffman();
+	}
+
+	for ( i = 0; i < 256; i++ )
+	{
+		weights[ i ] = frequencies[ i ];
+
+		if ( total > HUFF_TABLE_TOTAL )
+		{
+			weights[ i ] = MAX( ( int )( ( int64_t ) frequencies[ i ] * HUFF_TABLE_TOTAL / total ), 1 );
+		}
+
+		tree->data[ i ] = frequencies[ i ];
+		swapped[ i ] = LittleLong( frequencies[ i ] );
+	}
+
+	Huff_BuildStaticTree( &tree->huff.compressor, weights );
+	Huff_BuildStaticTree( &tree->huff.decompressor, weights );
+	Huff_BuildTables( &tree->huff, &tree->tables );
+
+	// the report compares the static tree with net_huffmanTable
+	if ( table == HUFF_TRAINED )
+	{
+		MSG_HuffmanCodeLengths( &tree->huff.compressor, msgHuffStats.codeLength[ 1 ] );
+	}
+
+	// never 0, that means no trained table
+	tree->checksum = Com_BlockChecksum( swapped, sizeof( swapped ) ) | 1;
+
+	return qtrue;
+}
+
+/*
+==================
+MSG_HuffmanTable
+
+The trained frequency table, or NULL if none is loaded
+==================
+*/
+const int *MSG_HuffmanTable( void )
+{
+	return msgHuffTrained.checksum ? msgHuffTrained.data : NULL;
+}
+
+/*
+==================
+MSG_HuffmanChecksum
+
+Identifies the trained table during connection, 0 if none is loaded
+==================
+*/
+int MSG_HuffmanChecksum( void )
+{
+	return msgHuffTrained.checksum;
+}
+
+/*
+==================
+MSG_LoadHuffmanTable
+==================
+*/
+void MSG_LoadHuffmanTable( void )
+{
+	cvar_t *net_huffmanTable;
+	char   *buffer, *text, *token;
+	int    frequencies[ 256 ];
+	int    i;
+
+	net_huffmanTable = Cvar_Get( "net_huffmanTable", "", CVAR_ARCHIVE | CVAR_LATCH );
+
+	Cmd_AddCommand( "huffman", MSG_Huffman_f );
+
+	if ( !net_huffmanTable->string[ 0 ] )
+	{
+		return;
+	}
+
+	if ( FS_ReadFile( net_huffmanTable->string, ( void ** ) &buffer ) <= 0 )
+	{
+		Com_Printf( S_COLOR_YELLOW "WARNING: couldn't load huffman table %s\n", net_huffmanTable->string );
+		return;
+	}
+
+	text = buffer;
+
+	for ( i = 0; i < 256; i++ )
+	{
+		token = COM_Parse( &text );
+
+		if ( !token[ 0 ] )
+		{
+			break;
+		}
+
+		frequencies[ i ] = atoi( token );
+	}
+
+	FS_FreeFile( buffer );
+
+	if ( i < 256 || !MSG_SetHuffmanTable( HUFF_TRAINED, frequencies ) )
+	{
+		Com_Printf( S_COLOR_YELLOW "WARNING: huffman table %s is invalid, using the static tree\n",
+		            net_huffmanTable->string );
+		return;
+	}
+
+	Com_Printf( "Loaded huffman table %s (checksum %08x)\n", net_huffmanTable->string, msgHuffTrained.checksum );
+}
+
+/*
+==================
+MSG_SaveHuffmanTable
+
+Writes the sampled frequencies, scaled to the total MSG_SetHuffmanTable
+builds trees from, with every symbol present
+==================
+*/
+static void MSG_SaveHuffmanTable( const char *filename )
+{
+	fileHandle_t f;
+	double       total = 0;
+	int          i, frequency;
+
+	for ( i = 0; i < 256; i++ )
+	{
+		total += msgHuffStats.counts[ i ];
+	}
+
+	if ( !total )
+	{
+		Com_Printf( "No huffman symbols were sampled, use \"huffman train\" first.\n" );
+		return;
+	}
+
+	f = FS_FOpenFileWrite( filename );
+
+	if ( !f )
+	{
+		Com_Printf( "Couldn't write %s.\n", filename );
+		return;
+	}
+
+	FS_Printf( f, "// huffman table trained from %.0f symbols in %d messages\n",
+	           total, msgHuffStats.messages );
+
+	for ( i = 0; i < 256; i++ )
+	{
+		frequency = ( int )( msgHuffStats.counts[ i ] * ( double ) HUFF_TABLE_TOTAL / total + 0.5 );
+		FS_Printf( f, "%d // %d\n", MAX( frequency, 1 ), i );
+	}
+
+	FS_FCloseFile( f );
+	Com_Printf( "Wrote huffman table to %s.\n", filename );
+}
+
+/*
+==================
+MSG_HuffmanBench
+
+Checks MSG_WriteBits/MSG_ReadBits against the plain bit by bit coder on
+random fields whose bytes follow the sampled (or static) frequencies,
+and times both
+==================
+*/
+static void MSG_HuffmanBench( int count )
+{
+	const int *frequencies = msgHuffStats.counts;
+	int       cumulative[ 256 ];
+	int       *values, *widths;
+	byte      *ref, *data;
+	int       size, total, i, j, r, bit, value, get;
+	int       start, refWrite, refRead, tableWrite, tableRead;
+	int       mismatches = 0;
+	msg_t     msg;
+
+	if ( !msgInit )
+	{
+		MSG_initHuffman();
+	}
+
+	for ( i = 0, total = 0; i < 256; i++ )
+	{
+		total += msgHuffStats.counts[ i ];
+	}
+
+	if ( !total )
+	{
+		frequencies = msg_hData;
+	}
+
+	for ( i = 0, total = 0; i < 256; i++ )
+	{
+		total += frequencies[ i ];
+		cumulative[ i ] = total;
+	}
+
+	size = count * 17 + 64; // 7 raw bits and four 32 bit codewords at worst
+	values = Z_Malloc( count * sizeof( int ) );
+	widths = Z_Malloc( count * sizeof( int ) );
+	ref = Z_Malloc( size );
+	data = Z_Malloc( size );
+
+	for ( i = 0; i < count; i++ )
+	{
+		widths[ i ] = 1 + rand() % 32;
+		values[ i ] = 0;
+
+		for ( j = 0; j < widths[ i ]; j += 8 )
+		{
+			r = ( int )( ( double ) rand() / ( ( double ) RAND_MAX + 1 ) * total );
+
+			for ( value = 0; cumulative[ value ] <= r; value++ )
+			{
+			}
+
+			values[ i ] |= value << j;
+		}
+
+		if ( widths[ i ] < 32 )
+		{
+			values[ i ] &= ( 1 << widths[ i ] ) - 1;
+		}
+	}
+
+	// reference coder, as MSG_WriteBits/MSG_ReadBits used to be
+	start = Sys_Milliseconds();
+
+	for ( i = 0, bit = 0; i < count; i++ )
+	{
+		value = values[ i ];
+
+		for ( j = 0; j < ( widths[ i ] & 7 ); j++ )
+		{
+			Huff_putBit( value & 1, ref, &bit );
+			value >>= 1;
+		}
+
+		for ( j = widths[ i ] & 7; j < widths[ i ]; j += 8 )
+		{
+			Huff_offsetTransmit( &msgHuff.compressor, value & 0xff, ref, &bit );
+			value >>= 8;
+		}
+	}
+
+	refWrite = Sys_Milliseconds() - start;
+	start = Sys_Milliseconds();
+
+	for ( i = 0, bit = 0; i < count; i++ )
+	{
+		value = 0;
+
+		for ( j = 0; j < ( widths[ i ] & 7 ); j++ )
+		{
+			value |= Huff_getBit( ref, &bit ) << j;
+		}
+
+		for ( j = widths[ i ] & 7; j < widths[ i ]; j += 8 )
+		{
+			Huff_offsetReceive( msgHuff.decompressor.tree, &get, ref, &bit );
+			value |= get << j;
+		}
+	}
+
+	refRead = Sys_Milliseconds() - start;
+
+	// table coder
+	MSG_Init( &msg, data, size );
+	start = Sys_Milliseconds();
+
+	for ( i = 0; i < count; i++ )
+	{
+		MSG_WriteBits( &msg, values[ i ], widths[ i ] );
+	}
+
+	tableWrite = Sys_Milliseconds() - start;
+
+	if ( msg.overflowed || memcmp( ref, data, msg.cursize ) )
+	{
+		Com_Printf( S_COLOR_RED "huffman bench: encoded streams differ\n" );
+	}
+
+	msg.readcount = 0;
+	msg.bit = 0;
+	start = Sys_Milliseconds();
+
+	for ( i = 0; i < count; i++ )
+	{
+		if ( MSG_ReadBits( &msg, widths[ i ] ) != values[ i ] )
+		{
+			mismatches++;
+		}
+	}
+
+	tableRead = Sys_Milliseconds() - start;
+
+	Com_Printf( "huffman bench: %d fields, %d bytes, %d decode mismatches\n", count, msg.cursize, mismatches );
+	Com_Printf( "  encode: %d msec bit by bit, %d msec tables\n", refWrite, tableWrite );
+	Com_Printf( "  decode: %d msec bit by bit, %d msec tables\n", refRead, tableRead );
+
+	Z_Free( data );
+	Z_Free( ref );
+	Z_Free( widths );
+	Z_Free( values );
+}
+
+/*
+==================
+MSG_Huffman_f
+==================
+*/
+void MSG_Huffman_f( void )
+{
+	const char *cmd = Cmd_Argv( 1 );
+
+	if ( !Q_stricmp( cmd, "train" ) )
+	{
+		Com_Memset( msgHuffStats.counts, 0, sizeof( msgHuffStats.counts ) );
+		msgHuffStats.bits[ 0 ] = msgHuffStats.bits[ 1 ] = 0;
+		msgHuffStats.messages = 0;
+		msgHuffStats.sampling = qtrue;
+		Com_Printf( "Sampling server to client huffman symbols.\n" );
+	}
+	else if ( !Q_stricmp( cmd, "stop" ) )
+	{
+		msgHuffStats.sampling = qfalse;
+	}
+	else if ( !Q_stricmp( cmd, "save" ) && Cmd_Argc() == 3 )
+	{
+		MSG_SaveHuffmanTable( Cmd_Argv( 2 ) );
+	}
+	else if ( !Q_stricmp( cmd, "bench" ) )
+	{
+		MSG_HuffmanBench( Cmd_Argc() > 2 ? Com_Clamp( 1, 1000000, atoi( Cmd_Argv( 2 ) ) ) : 1000000 );
+	}
+	else if ( !Q_stricmp( cmd, "report" ) )
+	{
+		int messages = MAX( msgHuffStats.messages, 1 );
+
+		Com_Printf( "%d messages sampled%s\n", msgHuffStats.messages,
+		            msgHuffStats.sampling ? " (still sampling)" : "" );
+		Com_Printf( "static tree:  %.1f bytes/message\n", msgHuffStats.bits[ 0 ] / 8 / messages );
+
+		if ( msgHuffTrained.checksum )
+		{
+			Com_Printf( "trained tree: %.1f bytes/message (%+.1f%%)\n", msgHuffStats.bits[ 1 ] / 8 / messages,
+			            msgHuffStats.bits[ 0 ] ? 100.0 * ( msgHuffStats.bits[ 1 ] / msgHuffStats.bits[ 0 ] - 1 ) : 0.0 );
+		}
+		else
+		{
+			Com_Printf( "trained tree: none loaded (net_huffmanTable)\n" );
+		}
+	}
+	else
+	{
+		Cmd_PrintUsage( "train | stop | save <file> | report | bench [count]", NULL );
+	}
 }
 
 //===========================================================================
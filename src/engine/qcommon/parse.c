@@ -207,6 +207,42 @@ typedef struct indent_s
 	struct indent_s *next; //next indent on the indent stack
 } indent_t;
 
+//precompiled token cache
+//a source that has been read to its end is written to parsecache/<filename>.bin
+//as the header, the files it was read from, the tokens and their strings
+#define PARSE_CACHE_IDENT   ( ( 'K' << 24 ) + ( 'O' << 16 ) + ( 'T' << 8 ) + 'P' )
+#define PARSE_CACHE_VERSION 1
+#define MAX_CACHEFILES      32
+
+typedef struct
+{
+	int      ident;
+	int      version;
+	unsigned defines; //checksum of the global defines
+	int      numFiles;
+	int      numTokens;
+	int      stringsLength;
+} cacheHeader_t;
+
+//a script file the tokens were read from
+typedef struct
+{
+	char     filename[ MAX_QPATH ];
+	int      length;
+	unsigned checksum;
+} cacheFile_t;
+
+//a token as handed to the modules
+typedef struct
+{
+	int   type;
+	int   subtype;
+	int   intvalue;
+	float floatvalue;
+	int   line;
+	int   string; //offset in the strings
+} cacheToken_t;
+
 //source file
 typedef struct source_s
 {
@@ -220,6 +256,19 @@ typedef struct source_s
 	indent_t      *indentstack; //stack with indents
 	int           skip; // > 0 if skipping conditional code
 	token_t       token; //last read token
+	qboolean      eof; //true if the end of the initial script was reached
+	//precompiled tokens, read from the cache or recorded for it
+	qboolean      cached; //true if the tokens come from the cache
+	void          *cachebuffer; //the cache file the cached tokens are in
+	unsigned      globaldefines; //checksum of the global defines when loaded
+	qboolean      nocache; //true if the tokens are not recorded
+	cacheFile_t   files[ MAX_CACHEFILES ];
+	int           numFiles;
+	cacheToken_t  *cachetokens;
+	int           numCacheTokens, maxCacheTokens;
+	int           cacheToken; //next token to read from the cache
+	char          *cachestrings;
+	int           cacheStringsLength, maxCacheStrings;
 } source_t;
 
 #define MAX_DEFINEPARMS 128
@@ -1344,6 +1393,30 @@ static void Parse_PushScript( source_t *source, script_t *script )
 	source->scriptstack = script;
 }
 
+/*
+===============
+Parse_AddSourceFile
+
+remembers the checksum of a script file the source reads,
+the cached tokens are only used while all of them are unchanged
+===============
+*/
+static void Parse_AddSourceFile( source_t *source, script_t *script )
+{
+	cacheFile_t *file;
+
+	if ( source->numFiles >= MAX_CACHEFILES )
+	{
+		source->nocache = qtrue;
+		return;
+	}
+
+	file = &source->files[ source->numFiles++ ];
+	Q_strncpyz( file->filename, script->filename, sizeof( file->filename ) );
+	file->length = script->length;
+	file->checksum = Com_BlockChecksum( script->buffer, script->length );
+}
+
 /*
 ===============
 Parse_CopyToken
@@ -1423,7 +1496,11 @@ static int Parse_ReadSourceToken( source_t *source, token_t *token )
 		}
 
 		//if this was the initial script
-		if ( !source->scriptstack->next ) { return qfalse; }
+		if ( !source->scriptstack->next )
+		{
+			source->eof = Parse_EndOfScript( source->scriptstack );
+			return qfalse;
+		}
 
 		//remove the script and return to the last one
 		script = source->scriptstack;
@@ -3016,6 +3093,7 @@ static int Parse_Directive_include( source_t *source )
 		return qfalse;
 	}
 
+	Parse_AddSourceFile( source, script );
 	Parse_PushScript( source, script );
 	return qtrue;
 }
@@ -4127,6 +4205,54 @@ static define_t *Parse_CopyDefine( source_t *source, define_t *define )
 	return newdefine;
 }
 
+/*
+===============
+Parse_ChecksumString
+===============
+*/
+static unsigned Parse_ChecksumString( unsigned checksum, const char *string )
+{
+	do
+	{
+		checksum = ( checksum ^ ( byte ) *string ) * 16777619;
+	}
+	while ( *string++ );
+
+	return checksum;
+}
+
+/*
+===============
+Parse_GlobalDefinesChecksum
+===============
+*/
+static unsigned Parse_GlobalDefinesChecksum( void )
+{
+	define_t *define;
+	token_t  *token;
+	unsigned checksum;
+
+	checksum = 2166136261u;
+
+	for ( define = globaldefines; define; define = define->next )
+	{
+		checksum = Parse_ChecksumString( checksum, define->name );
+		checksum = ( checksum ^ define->numparms ) * 16777619;
+
+		for ( token = define->parms; token; token = token->next )
+		{
+			checksum = Parse_ChecksumString( checksum, token->string );
+		}
+
+		for ( token = define->tokens; token; token = token->next )
+		{
+			checksum = Parse_ChecksumString( checksum, token->string );
+		}
+	}
+
+	return checksum;
+}
+
 /*
 ===============
 Parse_AddGlobalDefinesToSource
@@ -4172,9 +4298,194 @@ static source_t *Parse_LoadSourceFile( const char *filename )
 	source->definehash = Z_Malloc( DEFINEHASHSIZE * sizeof( define_t * ) );
 	Com_Memset( source->definehash, 0, DEFINEHASHSIZE * sizeof( define_t * ) );
 	Parse_AddGlobalDefinesToSource( source );
+
+	source->nocache = !com_parseCache || !com_parseCache->integer;
+	source->globaldefines = Parse_GlobalDefinesChecksum();
+	Parse_AddSourceFile( source, script );
 	return source;
 }
 
+/*
+===============
+Parse_LoadCachedSource
+
+loads the precompiled tokens of a source if none of the files
+it was read from and none of the global defines have changed
+===============
+*/
+static source_t *Parse_LoadCachedSource( const char *filename )
+{
+	fileHandle_t  fp;
+	cacheHeader_t *header;
+	cacheFile_t   *files;
+	cacheToken_t  *tokens;
+	script_t      *script;
+	source_t      *source;
+	byte          *buffer;
+	int           length, i;
+	qboolean      valid;
+
+	length = FS_SV_FOpenFileRead( va( "parsecache/%s.bin", filename ), &fp );
+
+	if ( !fp ) { return NULL; }
+
+	if ( length < sizeof( cacheHeader_t ) )
+	{
+		FS_FCloseFile( fp );
+		return NULL;
+	}
+
+	buffer = Z_Malloc( length );
+	valid = FS_Read( buffer, length, fp ) == length;
+	FS_FCloseFile( fp );
+
+	header = ( cacheHeader_t * ) buffer;
+	files = ( cacheFile_t * )( header + 1 );
+
+	valid = valid && header->ident == PARSE_CACHE_IDENT && header->version == PARSE_CACHE_VERSION &&
+	        header->defines == Parse_GlobalDefinesChecksum() &&
+	        header->numFiles > 0 && header->numFiles <= MAX_CACHEFILES &&
+	        header->numTokens >= 0 && header->numTokens <= length / sizeof( cacheToken_t ) &&
+	        header->stringsLength >= 0 && header->stringsLength <= length &&
+	        length == sizeof( *header ) + header->numFiles * sizeof( cacheFile_t ) +
+	        header->numTokens * sizeof( cacheToken_t ) + header->stringsLength &&
+	        ( !header->stringsLength || buffer[ length - 1 ] == '\0' );
+
+	//the files must still be the ones the tokens were read from
+	for ( i = 0; valid && i < header->numFiles; i++ )
+	{
+		files[ i ].filename[ sizeof( files[ i ].filename ) - 1 ] = '\0';
+		script = Parse_LoadScriptFile( files[ i ].filename );
+
+		valid = script && script->length == files[ i ].length &&
+		        Com_BlockChecksum( script->buffer, script->length ) == files[ i ].checksum;
+
+		if ( script ) { Parse_FreeScript( script ); }
+	}
+
+	tokens = ( cacheToken_t * )( files + header->numFiles );
+
+	for ( i = 0; valid && i < header->numTokens; i++ )
+	{
+		valid = tokens[ i ].string >= 0 && tokens[ i ].string < header->stringsLength;
+	}
+
+	if ( !valid )
+	{
+		Z_Free( buffer );
+		return NULL;
+	}
+
+	source = ( source_t * ) Z_Malloc( sizeof( source_t ) );
+	Com_Memset( source, 0, sizeof( source_t ) );
+
+	Q_strncpyz( source->filename, filename, sizeof( source->filename ) );
+	source->cached = qtrue;
+	source->nocache = qtrue;
+	source->cachebuffer = buffer;
+	source->cachetokens = tokens;
+	source->numCacheTokens = header->numTokens;
+	source->cachestrings = ( char * )( tokens + header->numTokens );
+	source->cacheStringsLength = header->stringsLength;
+	return source;
+}
+
+/*
+===============
+Parse_WriteCachedSource
+
+writes the tokens of a source that has been read to its end
+===============
+*/
+static void Parse_WriteCachedSource( source_t *source )
+{
+	fileHandle_t  fp;
+	cacheHeader_t header;
+
+	fp = FS_SV_FOpenFileWrite( va( "parsecache/%s.bin", source->filename ) );
+
+	if ( fp )
+	{
+		header.ident = PARSE_CACHE_IDENT;
+		header.version = PARSE_CACHE_VERSION;
+		header.defines = source->globaldefines;
+		header.numFiles = source->numFiles;
+		header.numTokens = source->numCacheTokens;
+		header.stringsLength = source->cacheStringsLength;
+
+		FS_Write( &header, sizeof( header ), fp );
+		FS_Write( source->files, source->numFiles * sizeof( cacheFile_t ), fp );
+		FS_Write( source->cachetokens, source->numCacheTokens * sizeof( cacheToken_t ), fp );
+		FS_Write( source->cachestrings, source->cacheStringsLength, fp );
+		FS_FCloseFile( fp );
+	}
+
+	source->nocache = qtrue;
+}
+
+/*
+===============
+Parse_GrowCache
+===============
+*/
+static void *Parse_GrowCache( void *buffer, int size, int newSize )
+{
+	void *newBuffer;
+
+	newBuffer = Z_Malloc( newSize );
+
+	if ( buffer )
+	{
+		Com_Memcpy( newBuffer, buffer, size );
+		Z_Free( buffer );
+	}
+
+	return newBuffer;
+}
+
+/*
+===============
+Parse_CacheToken
+
+records a token read by a module for the cache
+===============
+*/
+static void Parse_CacheToken( source_t *source, const pc_token_t *pc_token )
+{
+	cacheToken_t *token;
+	int          length, max;
+
+	if ( source->numCacheTokens >= source->maxCacheTokens )
+	{
+		max = source->maxCacheTokens ? source->maxCacheTokens * 2 : 256;
+		source->cachetokens = Parse_GrowCache( source->cachetokens, source->numCacheTokens * sizeof( cacheToken_t ),
+		                                       max * sizeof( cacheToken_t ) );
+		source->maxCacheTokens = max;
+	}
+
+	length = strlen( pc_token->string ) + 1;
+
+	if ( source->cacheStringsLength + length > source->maxCacheStrings )
+	{
+		for ( max = source->maxCacheStrings ? source->maxCacheStrings : 4096;
+		      source->cacheStringsLength + length > max; max *= 2 ) { }
+
+		source->cachestrings = Parse_GrowCache( source->cachestrings, source->cacheStringsLength, max );
+		source->maxCacheStrings = max;
+	}
+
+	token = &source->cachetokens[ source->numCacheTokens++ ];
+	token->type = pc_token->type;
+	token->subtype = pc_token->subtype;
+	token->intvalue = pc_token->intvalue;
+	token->floatvalue = pc_token->floatvalue;
+	token->line = pc_token->line;
+	token->string = source->cacheStringsLength;
+
+	Com_Memcpy( source->cachestrings + source->cacheStringsLength, pc_token->string, length );
+	source->cacheStringsLength += length;
+}
+
 /*
 ===============
 Parse_FreeSource
@@ -4205,7 +4516,7 @@ static void Parse_FreeSource( source_t *source )
 		Parse_FreeToken( token );
 	}
 
-	for ( i = 0; i < DEFINEHASHSIZE; i++ )
+	for ( i = 0; source->definehash && i < DEFINEHASHSIZE; i++ )
 	{
 		while ( source->definehash[ i ] )
 		{
@@ -4226,6 +4537,18 @@ static void Parse_FreeSource( source_t *source )
 	//
 	if ( source->definehash ) { Z_Free( source->definehash ); }
 
+	//free the cached tokens
+	if ( source->cachebuffer )
+	{
+		Z_Free( source->cachebuffer );
+	}
+	else
+	{
+		if ( source->cachetokens ) { Z_Free( source->cachetokens ); }
+
+		if ( source->cachestrings ) { Z_Free( source->cachestrings ); }
+	}
+
 	//free the source itself
 	Z_Free( source );
 }
@@ -4257,7 +4580,17 @@ int Parse_LoadSourceHandle( const char *filename )
 		return 0;
 	}
 
-	source = Parse_LoadSourceFile( filename );
+	source = NULL;
+
+	if ( com_parseCache && com_parseCache->integer )
+	{
+		source = Parse_LoadCachedSource( filename );
+	}
+
+	if ( !source )
+	{
+		source = Parse_LoadSourceFile( filename );
+	}
 
 	if ( !source )
 	{
@@ -4292,39 +4625,113 @@ int Parse_FreeSourceHandle( int handle )
 
 /*
 ===============
-Parse_ReadTokenHandle
+Parse_ReadSourceHandleToken
 ===============
 */
-int Parse_ReadTokenHandle( int handle, pc_token_t *pc_token )
+static int Parse_ReadSourceHandleToken( source_t *source, pc_token_t *pc_token )
 {
-	token_t token;
-	int     ret;
+	token_t      token;
+	cacheToken_t *cached;
+	int          ret;
 
-	if ( handle < 1 || handle >= MAX_SOURCEFILES )
+	if ( source->cached )
 	{
-		return 0;
-	}
+		if ( source->cacheToken >= source->numCacheTokens )
+		{
+			Com_Memset( pc_token, 0, sizeof( *pc_token ) );
+			return 0;
+		}
 
-	if ( !sourceFiles[ handle ] )
-	{
-		return 0;
+		cached = &source->cachetokens[ source->cacheToken++ ];
+		Q_strncpyz( pc_token->string, source->cachestrings + cached->string, sizeof( pc_token->string ) );
+		pc_token->type = cached->type;
+		pc_token->subtype = cached->subtype;
+		pc_token->intvalue = cached->intvalue;
+		pc_token->floatvalue = cached->floatvalue;
+		pc_token->line = cached->line;
+		return qtrue;
 	}
 
-	ret = Parse_ReadToken( sourceFiles[ handle ], &token );
+	ret = Parse_ReadToken( source, &token );
 	strcpy( pc_token->string, token.string );
 	pc_token->type = token.type;
 	pc_token->subtype = token.subtype;
 	pc_token->intvalue = token.intvalue;
 	pc_token->floatvalue = token.floatvalue;
+	pc_token->line = token.line;
 
 	if ( pc_token->type == TT_STRING )
 	{
 		Parse_StripDoubleQuotes( pc_token->string );
 	}
 
+	if ( !source->nocache )
+	{
+		if ( ret )
+		{
+			Parse_CacheToken( source, pc_token );
+		}
+		else if ( source->eof )
+		{
+			Parse_WriteCachedSource( source );
+		}
+	}
+
 	return ret;
 }
 
+/*
+===============
+Parse_ReadTokenHandle
+===============
+*/
+int Parse_ReadTokenHandle( int handle, pc_token_t *pc_token )
+{
+	if ( handle < 1 || handle >= MAX_SOURCEFILES )
+	{
+		return 0;
+	}
+
+	if ( !sourceFiles[ handle ] )
+	{
+		return 0;
+	}
+
+	return Parse_ReadSourceHandleToken( sourceFiles[ handle ], pc_token );
+}
+
+/*
+===============
+Parse_ReadTokensHandle
+
+reads up to maxTokens tokens at once, returns the number read
+===============
+*/
+int Parse_ReadTokensHandle( int handle, pc_token_t *pc_tokens, int maxTokens )
+{
+	int i;
+
+	if ( handle < 1 || handle >= MAX_SOURCEFILES )
+	{
+		return 0;
+	}
+
+	if ( !sourceFiles[ handle ] )
+	{
+		return 0;
+	}
+
+	for ( i = 0; i < maxTokens; i++ )
+	{
+		if ( !Parse_ReadSourceHandleToken( sourceFiles[ handle ], &pc_tokens[ i ] ) )
+		{
+			break;
+		}
+	}
+
+	return i;
+}
+
 /*
 ===============
 Parse_SourceFileAndLine
@@ -4348,6 +4755,10 @@ int Parse_SourceFileAndLine( int handle, char *filename, int *line )
 	{
 		*line = sourceFiles[ handle ]->scriptstack->line;
 	}
+	else if ( sourceFiles[ handle ]->cacheToken > 0 )
+	{
+		*line = sourceFiles[ handle ]->cachetokens[ sourceFiles[ handle ]->cacheToken - 1 ].line;
+	}
 	else
 	{
 		*line = 0;
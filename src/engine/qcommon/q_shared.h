@@ -2121,6 +2121,7 @@ typedef struct
 {
 	void         *face, *faceData, *fallback, *fallbackData;
 	glyphInfo_t  *glyphBlock[0x110000 / 256]; // glyphBlock_t
+	void         *atlas; // where the renderer packs the glyphs it renders
 	int           pointSize;
 	int           height;
 	float         glyphScale;
@@ -45,6 +45,14 @@ Maryland 20850 USA.
 //
 // msg.c
 //
+// huffman trees of the server to client stream
+typedef enum
+{
+    HUFF_STATIC, // built into the engine
+    HUFF_TRAINED, // loaded from net_huffmanTable
+    HUFF_DEMO // embedded in the demo being played back
+} msgHuffTable_t;
+
 typedef struct
 {
     qboolean allowoverflow; // if false, do a Com_Error
@@ -56,6 +64,9 @@ typedef struct
     int      uncompsize; // NERVE - SMF - net debugging
     int      readcount;
     int      bit; // for bitwise reads and writes
+    int      huffTable; // msgHuffTable_t, the huffman tree of the server to client stream
+    qboolean huffSample; // server to client message, sampled by the huffman trainer
+    qboolean raw; // bits are stored as they are, for data that is compressed already
 } msg_t;
 
 void MSG_Init( msg_t *buf, byte *data, int length );
@@ -72,6 +83,13 @@ void MSG_Uncompressed( msg_t *buf );
 // sets data buffer as MSG_Init does prior to do the copy
 void MSG_Copy( msg_t *buf, byte *data, int length, msg_t *src );
 
+void MSG_LoadHuffmanTable( void );
+qboolean MSG_SetHuffmanTable( msgHuffTable_t table, const int *frequencies );
+const int *MSG_HuffmanTable( void );
+int MSG_HuffmanChecksum( void );
+void MSG_HuffmanCountMessage( const msg_t *msg );
+void MSG_Huffman_f( void );
+
 struct usercmd_s;
 
 struct entityState_s;
@@ -208,6 +226,11 @@ void       NET_Sleep( int msec );
 #define MAX_DOWNLOAD_WINDOW  8 // max of eight download frames
 #define MAX_DOWNLOAD_BLKSIZE 2048 // 2048 byte block chunks
 
+// windowed downloads send one block per message, small enough to travel in a
+// single packet, and acknowledge them selectively over a larger window
+#define MAX_DOWNLOAD_SACK_WINDOW 64 // blocks, also the number of bits in an acknowledge
+#define DOWNLOAD_SACK_BLKSIZE    1024
+
 /*
 Netchan handles packet fragmentation and out of order / duplicate suppression
 */
@@ -306,6 +329,7 @@ enum svc_ops_e
   //  this keeps legacy clients compatible.
   svc_extension,
   svc_voip, // not wrapped in USE_VOIP, so this value is reserved.
+  svc_deflate, // [long] size [long] deflated size [bytes] configstrings and baselines, only in gamestate messages
 };
 
 //
@@ -851,6 +875,7 @@ extern cvar_t       *com_consoleCommand;
 
 extern cvar_t       *com_journal;
 extern cvar_t       *com_ansiColor;
+extern cvar_t       *com_parseCache;
 extern cvar_t       *com_logosPlaying;
 
 extern cvar_t       *com_unfocused;
@@ -892,7 +917,8 @@ typedef enum
   TAG_RENDERER,
   TAG_SMALL,
   TAG_CRYPTO,
-  TAG_STATIC
+  TAG_STATIC,
+  TAG_SLAB // the zone blocks holding the blocks of a size class
 } memtag_t;
 
 /*
@@ -1050,6 +1076,8 @@ void     SV_Frame( int msec );
 void     SV_PacketEvent( netadr_t from, msg_t *msg );
 qboolean SV_GameCommand( void );
 int      SV_FrameMsec( void );
+int      SV_SendDownloadMessages( void );
+int      SV_SendPacedMessages( void );
 
 //
 // UI interface
@@ -1169,6 +1197,16 @@ void         Sys_Sleep( int msec );
 
 qboolean     Sys_LowPhysicalMemory( void );
 
+// sampling profiler support; the callback interrupts the thread that started the
+// timer and gets its program counter, stack pointer and native call stack, innermost first
+#define SYS_PROFILE_MAX_FRAMES 64
+
+typedef void ( *sysProfileCallback_t )( void *pc, void *sp, void **frames, int numFrames );
+
+qboolean     Sys_StartProfileTimer( int hz, sysProfileCallback_t callback );
+void         Sys_StopProfileTimer( void );
+qboolean     Sys_AddressInfo( void *address, void **moduleBase, char *symbol, int symbolSize );
+
 typedef enum
 {
   DR_YES = 0,
@@ -1237,6 +1275,16 @@ typedef struct
     huff_t decompressor;
 } huffman_t;
 
+#define HUFF_LOOKUP_BITS 11
+
+// precomputed codes for trees that are no longer updated
+typedef struct
+{
+    uint32_t       code[ HMAX ]; // codeword, first bit sent in bit 0
+    byte           length[ HMAX ]; // 0 if the codeword doesn't fit in code
+    unsigned short lookup[ 1 << HUFF_LOOKUP_BITS ]; // symbol | length << 9, 0 if the code is longer
+} huffTables_t;
+
 void             Huff_Compress( msg_t *buf, int offset );
 void             Huff_Decompress( msg_t *buf, int offset );
 void             Huff_Init( huffman_t *huff );
@@ -1247,6 +1295,10 @@ void             Huff_offsetReceive( node_t *node, int *ch, byte *fin, int *offs
 void             Huff_offsetTransmit( huff_t *huff, int ch, byte *fout, int *offset );
 void             Huff_putBit( int bit, byte *fout, int *offset );
 int              Huff_getBit( byte *fout, int *offset );
+void             Huff_BuildTables( const huffman_t *huff, huffTables_t *tables );
+void             Huff_BuildStaticTree( huff_t *huff, const int *weights );
+void             Huff_putBits( uint64_t bits, int count, byte *fout, int *offset );
+int              Huff_tableReceive( const huffTables_t *tables, node_t *tree, byte *fin, int *offset, int maxbytes );
 
 // don't use if you don't know what you're doing.
 int              Huff_getBloc( void );
@@ -1263,6 +1315,7 @@ int  Parse_AddGlobalDefine( const char *string );
 int  Parse_LoadSourceHandle( const char *filename );
 int  Parse_FreeSourceHandle( int handle );
 int  Parse_ReadTokenHandle( int handle, pc_token_t *pc_token );
+int  Parse_ReadTokensHandle( int handle, pc_token_t *pc_tokens, int maxTokens );
 int  Parse_SourceFileAndLine( int handle, char *filename, int *line );
 
 void Com_GetHunkInfo( int *hunkused, int *hunkexpected );
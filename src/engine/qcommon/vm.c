@@ -54,6 +54,7 @@ and one exported function: Perform
 
 #include "vm_local.h"
 #include "vm_traps.h"
+#include "htable.h"
 
 #ifdef USE_LLVM
 #include "vm_llvm.h"
@@ -62,6 +63,7 @@ and one exported function: Perform
 vm_t       *currentVM = NULL;
 vm_t       *lastVM = NULL;
 int        vm_debugLevel;
+qboolean   vm_profiling; // the sampling profiler is running
 
 // used by Com_Error to get rid of running VMs before longjmp
 static int forced_unload;
@@ -69,6 +71,9 @@ static int forced_unload;
 #define MAX_VM 3
 vm_t       vmTable[ MAX_VM ];
 
+// bumped whenever a vmTable slot is freed, so stale profiler samples can be told apart
+static int vmGeneration[ MAX_VM ];
+
 void       VM_VmInfo_f( void );
 void       VM_VmProfile_f( void );
 
@@ -169,6 +174,33 @@ vmSymbol_t *VM_ValueToFunctionSymbol( vm_t *vm, int value )
 	return sym;
 }
 
+/*
+===============
+VM_InstructionToFunctionSymbol
+
+Same as VM_ValueToFunctionSymbol, but for an instruction number
+===============
+*/
+vmSymbol_t *VM_InstructionToFunctionSymbol( vm_t *vm, int instruction )
+{
+	vmSymbol_t        *sym;
+	static vmSymbol_t nullSym;
+
+	sym = vm->symbols;
+
+	if ( !sym )
+	{
+		return &nullSym;
+	}
+
+	while ( sym->next && sym->next->symInstruction >= 0 && sym->next->symInstruction <= instruction )
+	{
+		sym = sym->next;
+	}
+
+	return sym;
+}
+
 /*
 ===============
 VM_SymbolToValue
@@ -189,15 +221,65 @@ int VM_SymbolToValue( vm_t *vm, const char *symbol )
 	return 0;
 }
 
+/*
+=====================
+VM_InstructionForCompiledPointer
+
+Returns the bytecode instruction a piece of JIT output belongs to, or -1.
+Safe to call from a signal handler.
+=====================
+*/
+int VM_InstructionForCompiledPointer( vm_t *vm, void *code )
+{
+	intptr_t address = ( intptr_t ) code;
+	int      low, high, mid;
+
+	if ( !vm->compiled || !vm->codeBase || !vm->instructionCount )
+	{
+		return -1;
+	}
+
+	if ( code < ( void * ) vm->codeBase || code >= ( void * )( vm->codeBase + vm->codeLength ) )
+	{
+		return -1;
+	}
+
+	// the helper procedures in front of the first instruction
+	if ( address < vm->instructionPointers[ 0 ] )
+	{
+		return -1;
+	}
+
+	// instructionPointers are absolute and ascending once compiled;
+	// find the last instruction starting at or before the address
+	low = 0;
+	high = vm->instructionCount - 1;
+
+	while ( low < high )
+	{
+		mid = ( low + high + 1 ) / 2;
+
+		if ( vm->instructionPointers[ mid ] <= address )
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	return low;
+}
+
 /*
 =====================
 VM_SymbolForCompiledPointer
 =====================
 */
-#if 0 // 64bit!
 const char *VM_SymbolForCompiledPointer( vm_t *vm, void *code )
 {
-	int i;
+	int instruction;
 
 	if ( code < ( void * ) vm->codeBase )
 	{
@@ -209,23 +291,16 @@ const char *VM_SymbolForCompiledPointer( vm_t *vm, void *code )
 		return "After code block";
 	}
 
-	// find which original instruction it is after
-	for ( i = 0; i < vm->codeLength; i++ )
+	instruction = VM_InstructionForCompiledPointer( vm, code );
+
+	if ( instruction < 0 )
 	{
-		if ( ( void * ) vm->instructionPointers[ i ] > code )
-		{
-			break;
-		}
+		return "Not compiled";
 	}
 
-	i--;
-
-	// now look up the bytecode instruction pointer
-	return VM_ValueToSymbol( vm, i );
+	return VM_InstructionToFunctionSymbol( vm, instruction )->symName;
 }
 
-#endif
-
 /*
 ===============
 ParseHex
@@ -353,8 +428,13 @@ void VM_LoadSymbols( vm_t *vm )
 		// convert value from an instruction number to a code offset
 		if ( value >= 0 && value < numInstructions )
 		{
+			sym->symInstruction = value;
 			value = vm->instructionPointers[ value ];
 		}
+		else
+		{
+			sym->symInstruction = -1;
+		}
 
 		sym->symValue = value;
 		Q_strncpyz( sym->symName, token, chars + 1 );
@@ -929,6 +1009,8 @@ void VM_Free( vm_t *vm )
 #endif
 	Com_Memset( vm, 0, sizeof( *vm ) );
 
+	vmGeneration[ vm - vmTable ]++;
+
 	currentVM = NULL;
 	lastVM = NULL;
 }
@@ -1141,10 +1223,447 @@ static int QDECL VM_ProfileSort( const void *a, const void *b )
 	return 0;
 }
 
+/*
+==============================================================================
+
+SAMPLING PROFILER
+
+A CPU timer interrupts the engine and records where the current VM is,
+without instrumenting its code:
+ - interpreted VMs are walked through the frame links on the program stack,
+   for the calls made while the profiler runs
+ - compiled VMs map the native program counter and the return addresses
+   on the native stack back to bytecode instructions
+ - native modules use the platform backtrace
+Samples are only turned into names when dumped, as collapsed stacks for
+flame graph tools ("vm;outer;...;inner count" per line).
+
+==============================================================================
+*/
+
+#define VM_PROFILE_MAX_SAMPLES 65536
+#define VM_PROFILE_MAX_DEPTH   32
+#define VM_PROFILE_DEFAULT_HZ  997 // prime, so that it doesn't beat with sv_fps or com_maxfps
+#define VM_PROFILE_MAX_HZ      10000
+#define VM_PROFILE_TOP         15
+#define VM_PROFILE_MAX_SCAN    0x10000 // bytes of native stack searched for compiled frames
+
+typedef struct
+{
+	short    vm;
+	short    depth;
+	int      generation;
+	qboolean engine; // stopped in a system call
+	intptr_t frames[ VM_PROFILE_MAX_DEPTH ]; // innermost first
+} vmProfileSample_t;
+
+typedef struct
+{
+	char *name;
+	int  count;
+} vmProfileStack_t;
+
+static vmProfileSample_t *vmProfileSamples;
+static volatile int       vmProfileNumSamples;
+static volatile int       vmProfileTicks; // including those outside of any VM
+static volatile int       vmProfileDropped;
+
+/*
+==============
+VM_ProfileWalkInterpreted
+
+Follows the frame links the interpreter keeps at programStack + 4
+==============
+*/
+static int VM_ProfileWalkInterpreted( vm_t *vm, intptr_t *frames )
+{
+	int pc = vm->profilePC;
+	int frame = vm->profileStack;
+	int link = vm->profileLink;
+	int depth = 0;
+
+	while ( depth < VM_PROFILE_MAX_DEPTH && pc >= 0 && pc < vm->codeLength )
+	{
+		frames[ depth++ ] = pc;
+
+		if ( frame < 0 || frame > vm->dataMask - 7 || ( frame & 3 ) )
+		{
+			break;
+		}
+
+		if ( !link )
+		{
+			link = * ( int * ) &vm->dataBase[ frame + 4 ];
+		}
+
+		// frames only ever get older towards the end of the image
+		if ( link <= frame || link > vm->dataMask - 3 || ( link & 3 ) )
+		{
+			break;
+		}
+
+		pc = * ( int * ) &vm->dataBase[ link ];
+		frame = link;
+		link = 0;
+	}
+
+	return depth;
+}
+
+/*
+==============
+VM_ProfileWalkCompiled
+
+Compiled code calls with native calls, so its frames are the return
+addresses into the code between the interrupted stack pointer and
+VM_CallCompiled. In a system call the search starts above DoSyscall,
+the engine frames below it may hold anything.
+==============
+*/
+static int VM_ProfileWalkCompiled( vm_t *vm, void *pc, void *sp, intptr_t *frames )
+{
+	byte     *stack, *end;
+	intptr_t address;
+	int      depth = 0;
+	int      instruction;
+
+	instruction = VM_InstructionForCompiledPointer( vm, pc );
+
+	if ( instruction >= 0 )
+	{
+		frames[ depth++ ] = instruction;
+	}
+
+	stack = ( instruction < 0 && vm->profileSyscallStack ) ? vm->profileSyscallStack : ( byte * ) sp;
+	stack = ( byte * )( ( intptr_t ) stack & ~( intptr_t )( sizeof( void * ) - 1 ) );
+	end = vm->profileEntryStack;
+
+	// the stack grows down; anything else means a stale or foreign stack
+	if ( !stack || !end || stack > end || end - stack > VM_PROFILE_MAX_SCAN )
+	{
+		return depth;
+	}
+
+	for ( ; stack < end && depth < VM_PROFILE_MAX_DEPTH; stack += sizeof( void * ) )
+	{
+		address = * ( intptr_t * ) stack;
+
+		// return addresses point past the call
+		instruction = VM_InstructionForCompiledPointer( vm, ( void * )( address - 1 ) );
+
+		if ( instruction >= 0 )
+		{
+			frames[ depth++ ] = instruction;
+		}
+	}
+
+	return depth;
+}
+
+/*
+==============
+VM_ProfileSample
+
+Called from the profile timer signal; must not allocate or print
+==============
+*/
+static void VM_ProfileSample( void *pc, void *sp, void **frames, int numFrames )
+{
+	vm_t              *vm = currentVM;
+	vmProfileSample_t *sample;
+	int               i;
+
+	vmProfileTicks++;
+
+	if ( !vm || vm->callLevel <= 0 || !vmProfileSamples )
+	{
+		return;
+	}
+
+	if ( vmProfileNumSamples >= VM_PROFILE_MAX_SAMPLES )
+	{
+		vmProfileDropped++;
+		return;
+	}
+
+	sample = &vmProfileSamples[ vmProfileNumSamples ];
+	sample->vm = vm - vmTable;
+	sample->generation = vmGeneration[ sample->vm ];
+	sample->depth = 0;
+	sample->engine = qfalse;
+
+	if ( vm->entryPoint )
+	{
+		if ( pc && ( !numFrames || frames[ 0 ] != pc ) )
+		{
+			sample->frames[ sample->depth++ ] = ( intptr_t ) pc;
+		}
+
+		for ( i = 0; i < numFrames && sample->depth < VM_PROFILE_MAX_DEPTH; i++ )
+		{
+			sample->frames[ sample->depth++ ] = ( intptr_t ) frames[ i ];
+		}
+	}
+	else if ( vm->compiled )
+	{
+		sample->depth = VM_ProfileWalkCompiled( vm, pc, sp, sample->frames );
+		sample->engine = pc < ( void * ) vm->codeBase || pc >= ( void * )( vm->codeBase + vm->codeLength );
+	}
+	else if ( vm->currentlyInterpreting )
+	{
+		sample->depth = VM_ProfileWalkInterpreted( vm, sample->frames );
+		sample->engine = vm->profileLink != 0;
+	}
+
+	vmProfileNumSamples++;
+}
+
+/*
+==============
+VM_ProfileFrameName
+
+Returns qfalse for native frames outside of the VM's module
+==============
+*/
+static qboolean VM_ProfileFrameName( vm_t *vm, intptr_t frame, qboolean returnAddress, void *moduleBase,
+                                     char *name, int size )
+{
+	vmSymbol_t *sym;
+
+	if ( vm->entryPoint )
+	{
+		void *base;
+
+		// return addresses point past the call, which may be the start of the next function
+		if ( !Sys_AddressInfo( ( byte * ) frame - ( returnAddress ? 1 : 0 ), &base, name, size ) || base != moduleBase )
+		{
+			return qfalse;
+		}
+
+		return qtrue;
+	}
+
+	if ( vm->compiled )
+	{
+		sym = VM_InstructionToFunctionSymbol( vm, frame );
+	}
+	else
+	{
+		sym = VM_ValueToFunctionSymbol( vm, frame );
+	}
+
+	if ( sym->symName[ 0 ] )
+	{
+		Q_strncpyz( name, sym->symName, size );
+	}
+	else
+	{
+		Com_sprintf( name, size, "0x%x", ( int ) frame );
+	}
+
+	return qtrue;
+}
+
+static qboolean VM_ProfileCollectTop( void *item, void *extra )
+{
+	vmProfileStack_t *entry = item;
+	vmProfileStack_t **top = extra;
+	int              i;
+
+	for ( i = VM_PROFILE_TOP; i > 0 && ( !top[ i - 1 ] || top[ i - 1 ]->count < entry->count ); i-- )
+	{
+		if ( i < VM_PROFILE_TOP )
+		{
+			top[ i ] = top[ i - 1 ];
+		}
+	}
+
+	if ( i < VM_PROFILE_TOP )
+	{
+		top[ i ] = entry;
+	}
+
+	return qtrue;
+}
+
+static qboolean VM_ProfileWriteStack( void *item, void *extra )
+{
+	vmProfileStack_t *entry = item;
+
+	FS_Printf( * ( fileHandle_t * ) extra, "%s %i\n", entry->name, entry->count );
+	return qtrue;
+}
+
+/*
+==============
+VM_ProfileDump
+
+Writes the collapsed stacks and prints the functions most samples ended in
+==============
+*/
+static void VM_ProfileDump( const char *filename )
+{
+	hashtable_t      stacks, leaves;
+	vmProfileStack_t *entry, *top[ VM_PROFILE_TOP ];
+	void             *moduleBase[ MAX_VM ];
+	char             line[ MAX_STRING_CHARS ];
+	char             name[ MAX_TOKEN_CHARS ];
+	fileHandle_t     f;
+	qboolean         created, inModule;
+	int              numSamples, stale, i, j;
+
+	if ( !vmProfileSamples )
+	{
+		Com_Printf( "No profile samples; use vmprofile start first\n" );
+		return;
+	}
+
+	// don't let the timer append while we read
+	numSamples = vmProfileNumSamples;
+
+	f = FS_FOpenFileWrite( filename );
+
+	if ( !f )
+	{
+		Com_Printf( "Couldn't open %s for writing\n", filename );
+		return;
+	}
+
+	for ( i = 0; i < MAX_VM; i++ )
+	{
+		moduleBase[ i ] = NULL;
+
+		if ( vmTable[ i ].entryPoint )
+		{
+			Sys_AddressInfo( ( void * ) vmTable[ i ].entryPoint, &moduleBase[ i ], NULL, 0 );
+		}
+	}
+
+	stacks = HT_Create( 1024, HT_FLAG_INTABLE | HT_FLAG_CASE | HT_FLAG_SORTED,
+	                    sizeof( vmProfileStack_t ), HT_OffsetOfField( vmProfileStack_t, name ), 0 );
+	leaves = HT_Create( 256, HT_FLAG_INTABLE | HT_FLAG_CASE,
+	                    sizeof( vmProfileStack_t ), HT_OffsetOfField( vmProfileStack_t, name ), 0 );
+	stale = 0;
+
+	for ( i = 0; i < numSamples; i++ )
+	{
+		vmProfileSample_t *sample = &vmProfileSamples[ i ];
+		vm_t              *vm = &vmTable[ sample->vm ];
+
+		if ( sample->generation != vmGeneration[ sample->vm ] || !vm->name[ 0 ] )
+		{
+			stale++;
+			continue;
+		}
+
+		Q_strncpyz( line, vm->name, sizeof( line ) );
+		Q_strncpyz( name, vm->name, sizeof( name ) );
+		inModule = qfalse;
+
+		for ( j = sample->depth - 1; j >= 0; j-- )
+		{
+			inModule = VM_ProfileFrameName( vm, sample->frames[ j ], j > 0, moduleBase[ sample->vm ], name, sizeof( name ) );
+
+			if ( inModule )
+			{
+				Q_strcat( line, sizeof( line ), va( ";%s", name ) );
+			}
+		}
+
+		// time spent in the engine on behalf of the innermost VM function
+		if ( sample->engine || ( vm->entryPoint && !inModule ) )
+		{
+			Q_strncpyz( name, "[engine]", sizeof( name ) );
+			Q_strcat( line, sizeof( line ), ";[engine]" );
+		}
+
+		entry = HT_GetItem( stacks, line, &created );
+		entry->count++;
+
+		entry = HT_GetItem( leaves, name, &created );
+		entry->count++;
+	}
+
+	HT_Apply( stacks, VM_ProfileWriteStack, &f );
+	FS_FCloseFile( f );
+
+	Com_Memset( top, 0, sizeof( top ) );
+	HT_Apply( leaves, VM_ProfileCollectTop, top );
+
+	Com_Printf( "%i samples in VMs out of %i (%i dropped, %i from unloaded VMs)\n",
+	            numSamples - stale, vmProfileTicks, vmProfileDropped, stale );
+
+	for ( i = 0; i < VM_PROFILE_TOP && top[ i ]; i++ )
+	{
+		Com_Printf( "%5.1f%% %7i %s\n", 100.0f * top[ i ]->count / MAX( 1, numSamples - stale ),
+		            top[ i ]->count, top[ i ]->name );
+	}
+
+	Com_Printf( "Collapsed stacks written to %s\n", filename );
+
+	HT_Destroy( leaves );
+	HT_Destroy( stacks );
+}
+
+/*
+==============
+VM_ProfileStart
+VM_ProfileStop
+==============
+*/
+static void VM_ProfileStart( int hz )
+{
+	if ( vm_profiling )
+	{
+		Com_Printf( "VM profiler is already running\n" );
+		return;
+	}
+
+	if ( !vmProfileSamples )
+	{
+		vmProfileSamples = malloc( VM_PROFILE_MAX_SAMPLES * sizeof( *vmProfileSamples ) );
+
+		if ( !vmProfileSamples )
+		{
+			Com_Printf( "Couldn't allocate profile samples\n" );
+			return;
+		}
+	}
+
+	vmProfileNumSamples = 0;
+	vmProfileTicks = 0;
+	vmProfileDropped = 0;
+
+	if ( !Sys_StartProfileTimer( hz, VM_ProfileSample ) )
+	{
+		Com_Printf( "Sampling profiler isn't available on this platform\n" );
+		return;
+	}
+
+	vm_profiling = qtrue;
+	Com_Printf( "VM profiler sampling at %i Hz\n", hz );
+}
+
+static void VM_ProfileStop( void )
+{
+	if ( !vm_profiling )
+	{
+		return;
+	}
+
+	Sys_StopProfileTimer();
+	vm_profiling = qfalse;
+	Com_Printf( "VM profiler stopped with %i samples\n", vmProfileNumSamples );
+}
+
 /*
 ==============
 VM_VmProfile_f
 
+vmprofile                       instruction counts (interpreter with DEBUG_VM)
+vmprofile start [hz]            start the sampling profiler, 0 or no hz for the default rate
+vmprofile stop                  stop sampling
+vmprofile dump [file]           write collapsed stacks for flame graphs
 ==============
 */
 void VM_VmProfile_f( void )
@@ -1154,6 +1673,40 @@ void VM_VmProfile_f( void )
 	int        i;
 	double     total;
 
+	if ( Cmd_Argc() > 1 )
+	{
+		const char *cmd = Cmd_Argv( 1 );
+
+		if ( !Q_stricmp( cmd, "start" ) )
+		{
+			int hz = 0;
+
+			// 0 is a valid rate, so check the parse rather than the value
+			if ( Cmd_Argc() > 2 && ( !Q_strtoi( Cmd_Argv( 2 ), &hz ) || hz < 0 || hz > VM_PROFILE_MAX_HZ ) )
+			{
+				Com_Printf( "vmprofile: bad sampling rate '%s', expected 0 to %i Hz\n", Cmd_Argv( 2 ), VM_PROFILE_MAX_HZ );
+				return;
+			}
+
+			VM_ProfileStart( hz ? hz : VM_PROFILE_DEFAULT_HZ );
+		}
+		else if ( !Q_stricmp( cmd, "stop" ) )
+		{
+			VM_ProfileStop();
+		}
+		else if ( !Q_stricmp( cmd, "dump" ) )
+		{
+			VM_ProfileStop();
+			VM_ProfileDump( Cmd_Argc() > 2 ? Cmd_Argv( 2 ) : "vmprofile.txt" );
+		}
+		else
+		{
+			Com_Printf( "usage: vmprofile [start [hz]|stop|dump [file]]\n" );
+		}
+
+		return;
+	}
+
 	if ( !lastVM )
 	{
 		return;
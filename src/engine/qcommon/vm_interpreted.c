@@ -366,6 +366,8 @@ int     VM_CallInterpreted( vm_t *vm, int *args )
 	int              *codeImage;
 	int              v1;
 	int              dataMask;
+	int              oldProfilePC, oldProfileStack, oldProfileLink;
+	qboolean         profiling;
 #ifdef DEBUG_VM
 	vmSymbol_t       *profileSymbol;
 #endif
@@ -376,6 +378,19 @@ int     VM_CallInterpreted( vm_t *vm, int *args )
 	// we might be called recursively, so this might not be the very top
 	programStack = stackOnEntry = vm->programStack;
 
+	oldProfilePC = vm->profilePC;
+	oldProfileStack = vm->profileStack;
+	oldProfileLink = vm->profileLink;
+
+	// only calls made while the sampling profiler runs keep
+	// their frames up to date, the others can't be walked
+	profiling = vm_profiling;
+
+	if ( !profiling )
+	{
+		vm->profilePC = -1;
+	}
+
 #ifdef DEBUG_VM
 	profileSymbol = VM_ValueToFunctionSymbol( vm, 0 );
 	// uncomment this for debugging breakpoints
@@ -547,8 +562,8 @@ nextInstruction2:
 					// system call
 					int r;
 //				int   temp;
-#ifdef DEBUG_VM
 					int stomped;
+#ifdef DEBUG_VM
 
 					if ( vm_debugLevel )
 					{
@@ -559,9 +574,8 @@ nextInstruction2:
 					// save the stack to allow recursive VM entry
 //				temp = vm->callLevel;
 					vm->programStack = programStack - 4;
-#ifdef DEBUG_VM
 					stomped = * ( int * ) &image[ programStack + 4 ];
-#endif
+					vm->profileLink = stomped;
 					* ( int * ) &image[ programStack + 4 ] = -1 - programCounter;
 
 //VM_LogSyscalls( (int *)&image[ programStack + 4 ] );
@@ -605,11 +619,10 @@ nextInstruction2:
 						VM_CheckSanity( vm, ~programCounter );
 					}
 
-#ifdef DEBUG_VM
-					// this is just our stack frame pointer, only needed
-					// for debugging
+					// this is our stack frame pointer, used for
+					// debugging and by the sampling profiler
 					* ( int * ) &image[ programStack + 4 ] = stomped;
-#endif
+					vm->profileLink = 0;
 
 					// save return value
 					opStackOfs++;
@@ -654,9 +667,22 @@ nextInstruction2:
 
 				programCounter += 1;
 				programStack -= v1;
+
+				// save old stack frame for debugging and profiler traces
+#ifndef DEBUG_VM
+				if ( profiling )
+#endif
+				{
+					* ( int * ) &image[ programStack + 4 ] = programStack + v1;
+				}
+
+				if ( profiling )
+				{
+					vm->profilePC = programCounter;
+					vm->profileStack = programStack;
+				}
+
 #ifdef DEBUG_VM
-				// save old stack frame for debugging traces
-				* ( int * ) &image[ programStack + 4 ] = programStack + v1;
 
 				if ( vm_debugLevel )
 				{
@@ -684,6 +710,12 @@ nextInstruction2:
 
 				// grab the saved program counter
 				programCounter = * ( int * ) &image[ programStack ];
+
+				if ( profiling )
+				{
+					vm->profilePC = programCounter;
+					vm->profileStack = programStack;
+				}
 #ifdef DEBUG_VM
 				profileSymbol = VM_ValueToFunctionSymbol( vm, programCounter );
 
@@ -1079,6 +1111,9 @@ done:
 	}
 
 	vm->programStack = stackOnEntry;
+	vm->profilePC = oldProfilePC;
+	vm->profileStack = oldProfileStack;
+	vm->profileLink = oldProfileLink;
 
 	// return the result
 	return opStack[ opStackOfs ];
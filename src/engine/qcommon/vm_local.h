@@ -140,6 +140,7 @@ typedef struct vmSymbol_s
 	struct vmSymbol_s *next;
 
 	int               symValue;
+	int               symInstruction; // -1 if not a code symbol
 	int               profileCount;
 	char              symName[ 1 ]; // variable sized
 } vmSymbol_t;
@@ -194,6 +195,16 @@ struct vm_s
 	byte              *jumpTableTargets;
 	int               numJumpTableTargets;
 
+	// kept up to date by the interpreter for the sampling profiler
+	int               profilePC;
+	int               profileStack;
+	int               profileLink; // caller frame while image[ profileStack + 4 ] holds a syscall
+
+	// native stack of the compiled code for the sampling profiler,
+	// the JIT return addresses lie between the stack pointer and profileEntryStack
+	byte              *profileEntryStack; // in VM_CallCompiled
+	byte              *profileSyscallStack; // in DoSyscall, NULL outside of system calls
+
 	byte              sanity[ 16 ];
 	qboolean          versionChecked;
 	qboolean          clean;
@@ -201,6 +212,7 @@ struct vm_s
 
 extern  vm_t *currentVM;
 extern  int  vm_debugLevel;
+extern  qboolean vm_profiling;
 
 void         VM_Compile( vm_t *vm, vmHeader_t *header );
 int          VM_CallCompiled( vm_t *vm, int *args );
@@ -209,6 +221,9 @@ void         VM_PrepareInterpreter( vm_t *vm, vmHeader_t *header );
 int          VM_CallInterpreted( vm_t *vm, int *args );
 
 vmSymbol_t   *VM_ValueToFunctionSymbol( vm_t *vm, int value );
+vmSymbol_t   *VM_InstructionToFunctionSymbol( vm_t *vm, int instruction );
+int          VM_InstructionForCompiledPointer( vm_t *vm, void *code );
+const char   *VM_SymbolForCompiledPointer( vm_t *vm, void *code );
 int          VM_SymbolToValue( vm_t *vm, const char *symbol );
 const char   *VM_ValueToSymbol( vm_t *vm, int value );
 void         VM_LogSyscalls( int *args );
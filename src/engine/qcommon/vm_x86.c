@@ -445,12 +445,17 @@ static struct {
 static void DoSyscall( void )
 {
 	vm_t     *savedVM;
+	byte     *savedSyscallStack;
 
 	// save currentVM so as to allow for recursive VM entry
 	savedVM = currentVM;
 	// modify VM stack pointer for recursive VM entry
 	currentVM->programStack = vmInfo.programStack - 4;
 
+	// the sampling profiler finds the compiled frames above this one
+	savedSyscallStack = savedVM->profileSyscallStack;
+	savedVM->profileSyscallStack = ( byte * ) &savedSyscallStack;
+
 	if ( vmInfo.syscallNum < 0 )
 	{
 		int      *data;
@@ -512,6 +517,7 @@ static void DoSyscall( void )
 		}
 	}
 
+	savedVM->profileSyscallStack = savedSyscallStack;
 	currentVM = savedVM;
 }
 
@@ -1943,9 +1949,16 @@ int VM_CallCompiled( vm_t *vm, int *args )
 	byte *image;
 	int  *opStack;
 	int  opStackOfs;
+	byte *oldEntryStack, *oldSyscallStack;
 
 	currentVM = vm;
 
+	// the sampling profiler looks for the compiled frames below this one
+	oldEntryStack = vm->profileEntryStack;
+	oldSyscallStack = vm->profileSyscallStack;
+	vm->profileEntryStack = ( byte * ) &oldEntryStack;
+	vm->profileSyscallStack = NULL;
+
 	// interpret the code
 	vm->currentlyInterpreting = qtrue;
 
@@ -2044,6 +2057,8 @@ int VM_CallCompiled( vm_t *vm, int *args )
 	}
 
 	vm->programStack = stackOnEntry;
+	vm->profileEntryStack = oldEntryStack;
+	vm->profileSyscallStack = oldSyscallStack;
 
 	return opStack[ opStackOfs ];
 }
@@ -1096,34 +1096,15 @@ const void     *RB_SetColor( const void *data )
 
 /*
 =============
-RB_StretchPic
+RB_AddStretchPic
+
+Adds a 2D quad to the current surface
 =============
 */
-const void     *RB_StretchPic( const void *data )
+static void RB_AddStretchPic( float x, float y, float w, float h,
+                              float s1, float t1, float s2, float t2, const byte *color )
 {
-	const stretchPicCommand_t *cmd;
-	shader_t                  *shader;
-	int                       numVerts, numIndexes;
-
-	cmd = ( const stretchPicCommand_t * ) data;
-
-	if ( !backEnd.projection2D )
-	{
-		RB_SetGL2D();
-	}
-
-	shader = cmd->shader;
-
-	if ( shader != tess.shader )
-	{
-		if ( tess.numIndexes )
-		{
-			RB_EndSurface();
-		}
-
-		backEnd.currentEntity = &backEnd.entity2D;
-		RB_BeginSurface( shader, 0 );
-	}
+	int numVerts, numIndexes;
 
 	RB_CHECKOVERFLOW( 4, 6 );
 	numVerts = tess.numVertexes;
@@ -1141,39 +1122,102 @@ const void     *RB_StretchPic( const void *data )
 
 	* ( int * ) tess.vertexColors[ numVerts ].v =
 	  * ( int * ) tess.vertexColors[ numVerts + 1 ].v =
-	    * ( int * ) tess.vertexColors[ numVerts + 2 ].v = * ( int * ) tess.vertexColors[ numVerts + 3 ].v = * ( int * ) backEnd.color2D;
+	    * ( int * ) tess.vertexColors[ numVerts + 2 ].v = * ( int * ) tess.vertexColors[ numVerts + 3 ].v = * ( const int * ) color;
 
-	tess.xyz[ numVerts ].v[ 0 ] = cmd->x;
-	tess.xyz[ numVerts ].v[ 1 ] = cmd->y;
+	tess.xyz[ numVerts ].v[ 0 ] = x;
+	tess.xyz[ numVerts ].v[ 1 ] = y;
 	tess.xyz[ numVerts ].v[ 2 ] = 0;
 
-	tess.texCoords0[ numVerts ].v[ 0 ] = cmd->s1;
-	tess.texCoords0[ numVerts ].v[ 1 ] = cmd->t1;
+	tess.texCoords0[ numVerts ].v[ 0 ] = s1;
+	tess.texCoords0[ numVerts ].v[ 1 ] = t1;
 
-	tess.xyz[ numVerts + 1 ].v[ 0 ] = cmd->x + cmd->w;
-	tess.xyz[ numVerts + 1 ].v[ 1 ] = cmd->y;
+	tess.xyz[ numVerts + 1 ].v[ 0 ] = x + w;
+	tess.xyz[ numVerts + 1 ].v[ 1 ] = y;
 	tess.xyz[ numVerts + 1 ].v[ 2 ] = 0;
 
-	tess.texCoords0[ numVerts + 1 ].v[ 0 ] = cmd->s2;
-	tess.texCoords0[ numVerts + 1 ].v[ 1 ] = cmd->t1;
+	tess.texCoords0[ numVerts + 1 ].v[ 0 ] = s2;
+	tess.texCoords0[ numVerts + 1 ].v[ 1 ] = t1;
 
-	tess.xyz[ numVerts + 2 ].v[ 0 ] = cmd->x + cmd->w;
-	tess.xyz[ numVerts + 2 ].v[ 1 ] = cmd->y + cmd->h;
+	tess.xyz[ numVerts + 2 ].v[ 0 ] = x + w;
+	tess.xyz[ numVerts + 2 ].v[ 1 ] = y + h;
 	tess.xyz[ numVerts + 2 ].v[ 2 ] = 0;
 
-	tess.texCoords0[ numVerts + 2 ].v[ 0 ] = cmd->s2;
-	tess.texCoords0[ numVerts + 2 ].v[ 1 ] = cmd->t2;
+	tess.texCoords0[ numVerts + 2 ].v[ 0 ] = s2;
+	tess.texCoords0[ numVerts + 2 ].v[ 1 ] = t2;
 
-	tess.xyz[ numVerts + 3 ].v[ 0 ] = cmd->x;
-	tess.xyz[ numVerts + 3 ].v[ 1 ] = cmd->y + cmd->h;
+	tess.xyz[ numVerts + 3 ].v[ 0 ] = x;
+	tess.xyz[ numVerts + 3 ].v[ 1 ] = y + h;
 	tess.xyz[ numVerts + 3 ].v[ 2 ] = 0;
 
-	tess.texCoords0[ numVerts + 3 ].v[ 0 ] = cmd->s1;
-	tess.texCoords0[ numVerts + 3 ].v[ 1 ] = cmd->t2;
+	tess.texCoords0[ numVerts + 3 ].v[ 0 ] = s1;
+	tess.texCoords0[ numVerts + 3 ].v[ 1 ] = t2;
+}
+
+/*
+=============
+RB_BeginStretchPic
+=============
+*/
+static void RB_BeginStretchPic( shader_t *shader )
+{
+	if ( !backEnd.projection2D )
+	{
+		RB_SetGL2D();
+	}
+
+	if ( shader != tess.shader )
+	{
+		if ( tess.numIndexes )
+		{
+			RB_EndSurface();
+		}
+
+		backEnd.currentEntity = &backEnd.entity2D;
+		RB_BeginSurface( shader, 0 );
+	}
+}
+
+/*
+=============
+RB_StretchPic
+=============
+*/
+const void     *RB_StretchPic( const void *data )
+{
+	const stretchPicCommand_t *cmd;
+
+	cmd = ( const stretchPicCommand_t * ) data;
+
+	RB_BeginStretchPic( cmd->shader );
+	RB_AddStretchPic( cmd->x, cmd->y, cmd->w, cmd->h, cmd->s1, cmd->t1, cmd->s2, cmd->t2, backEnd.color2D );
 
 	return ( const void * )( cmd + 1 );
 }
 
+/*
+=============
+RB_StretchPics
+=============
+*/
+const void     *RB_StretchPics( const void *data )
+{
+	const stretchPicsCommand_t *cmd;
+	const stretchPic_t         *pic;
+	int                        i;
+
+	cmd = ( const stretchPicsCommand_t * ) data;
+	pic = ( const stretchPic_t * )( cmd + 1 );
+
+	RB_BeginStretchPic( cmd->shader );
+
+	for ( i = 0; i < cmd->numPics; i++, pic++ )
+	{
+		RB_AddStretchPic( pic->x, pic->y, pic->w, pic->h, pic->s1, pic->t1, pic->s2, pic->t2, pic->modulate );
+	}
+
+	return ( const void * )( ( const byte * )( cmd + 1 ) + PAD( cmd->numPics * sizeof( stretchPic_t ), sizeof( void * ) ) );
+}
+
 const void     *RB_ScissorEnable( const void *data )
 {
 	const scissorEnableCommand_t *cmd;
@@ -1862,6 +1906,10 @@ void RB_ExecuteRenderCommands( const void *data )
 				data = RB_StretchPic( data );
 				break;
 
+			case RC_STRETCH_PICS:
+				data = RB_StretchPics( data );
+				break;
+
 			case RC_2DPOLYS:
 				data = RB_Draw2dPolys( data );
 				break;
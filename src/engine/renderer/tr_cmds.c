@@ -479,6 +479,77 @@ void RE_StretchPic ( float x, float y, float w, float h,
 	cmd->t2 = t2;
 }
 
+/*
+=============
+R_AddStretchPicsCmd
+=============
+*/
+static void R_AddStretchPicsCmd( const stretchPic_t *pics, int numPics, shader_t *shader )
+{
+	renderCommandList_t  *cmdList = &backEndData[ tr.smpFrame ]->commands;
+	stretchPicsCommand_t *cmd;
+	stretchPic_t         *out, *first;
+	int                  i;
+
+	cmd = R_GetCommandBuffer( sizeof( *cmd ) + PAD( numPics * sizeof( stretchPic_t ), sizeof( void * ) ) );
+	if ( !cmd )
+	{
+		return;
+	}
+
+	out = first = ( stretchPic_t * )( cmd + 1 );
+
+	for ( i = 0; i < numPics; i++ )
+	{
+		*out = pics[ i ];
+
+		if ( !R_ClipRegion( &out->x, &out->y, &out->w, &out->h, &out->s1, &out->t1, &out->s2, &out->t2 ) )
+		{
+			out++;
+		}
+	}
+
+	// give back the room taken by the clipped quads
+	cmdList->used -= PAD( numPics * sizeof( stretchPic_t ), sizeof( void * ) ) - PAD( ( out - first ) * sizeof( stretchPic_t ), sizeof( void * ) );
+
+	if ( out == first )
+	{
+		cmdList->used -= sizeof( *cmd );
+		return;
+	}
+
+	cmd->commandId = RC_STRETCH_PICS;
+	cmd->shader = shader;
+	cmd->numPics = out - first;
+}
+
+/*
+=============
+RE_StretchPics
+
+Draws a run of quads which share a shader, each modulated by its own
+colour rather than the one set by RE_SetColor
+=============
+*/
+void RE_StretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader )
+{
+	shader_t *shader;
+	int      count;
+
+	if ( !tr.registered )
+	{
+		return;
+	}
+
+	shader = R_GetShaderByHandle( hShader );
+
+	for ( ; numPics > 0; numPics -= count, pics += count )
+	{
+		count = MIN( numPics, MAX_STRETCH_PICS );
+		R_AddStretchPicsCmd( pics, count, shader );
+	}
+}
+
 /*
 =============
 RE_2DPolyies
@@ -114,6 +114,24 @@ static struct {
 	char  name[ MAX_QPATH ];
 } fontData[ MAX_FILES ];
 
+// glyphs which FreeType renders are packed into one atlas per font, a
+// chunk at a time as they are needed, so that text drawn in a font
+// shares a shader whichever chunks its characters come from. Chunks
+// only get pages of their own once the atlas is full. The images are
+// kept from one font registered in a slot to the next.
+#define FONT_ATLAS_HEIGHT 2048
+
+typedef struct
+{
+	image_t   *image;
+	qhandle_t shader;
+	char      name[ MAX_QPATH ];
+	int       height;
+	int       used; // rows taken by chunks
+} fontAtlas_t;
+
+static fontAtlas_t fontAtlas[ MAX_FONTS ];
+
 void RE_RenderChunk( fontInfo_t *font, const int chunk );
 
 
@@ -403,6 +421,98 @@ void RE_GlyphVM( fontHandle_t handle, const char *str, glyphInfo_t *glyph )
 	RE_GlyphCharVM( handle, str ? Q_UTF8_CodePoint( str ) : 0, glyph );
 }
 
+static qboolean RE_StoreAtlas( fontInfo_t *font, int chunk, int from, int to, const unsigned char *bitmap, int yEnd )
+{
+	fontAtlas_t   *atlas = font->atlas;
+	glyphInfo_t   *glyphs = font->glyphBlock[ chunk ];
+	unsigned char *buffer;
+	int           rows, size;
+	int           i, j;
+	float         max;
+
+	if ( !atlas )
+	{
+		return qfalse;
+	}
+
+	if ( !atlas->image )
+	{
+		atlas->height = MIN( FONT_ATLAS_HEIGHT, glConfig.maxTextureSize );
+		Com_sprintf( atlas->name, sizeof( atlas->name ), "fontAtlas_%i", ( int )( atlas - fontAtlas ) );
+
+		size = FONT_SIZE * atlas->height;
+		buffer = ri.Z_Malloc( size * 2 );
+
+		for ( i = 0; i < size; i++ )
+		{
+			buffer[ i * 2 ] = 255;
+			buffer[ i * 2 + 1 ] = 0;
+		}
+
+		atlas->image = R_CreateGlyph( atlas->name, buffer, FONT_SIZE, atlas->height );
+		ri.Free( buffer );
+
+		if ( !atlas->image )
+		{
+			return qfalse;
+		}
+
+#ifdef USE_XREAL_RENDERER
+		atlas->shader = RE_RegisterShaderFromImage( atlas->name, atlas->image );
+#else
+		atlas->shader = RE_RegisterShaderFromImage( atlas->name, LIGHTMAP_2D, atlas->image );
+#endif
+	}
+
+	rows = MIN( yEnd, FONT_SIZE );
+
+	if ( atlas->used + rows > atlas->height )
+	{
+		return qfalse;
+	}
+
+	size = FONT_SIZE * rows;
+	buffer = ri.Z_Malloc( size * 2 );
+	max = 0;
+
+	for ( i = 0; i < size; i++ )
+	{
+		if ( max < bitmap[ i ] )
+		{
+			max = bitmap[ i ];
+		}
+	}
+
+	if ( max > 0 )
+	{
+		max = 255 / max;
+	}
+
+	for ( i = j = 0; i < size; i++ )
+	{
+		buffer[ j++ ] = 255;
+		buffer[ j++ ] = ( ( float ) bitmap[ i ] * max );
+	}
+
+	R_UpdateGlyph( atlas->image, buffer, atlas->used, rows );
+	ri.Free( buffer );
+
+	for ( j = from; j < to; j++ )
+	{
+		if ( glyphs[ j ].shaderName[0] ) // non-0 if we have a glyph here
+		{
+			glyphs[ j ].t = ( atlas->used + glyphs[ j ].t * FONT_SIZE ) / atlas->height;
+			glyphs[ j ].t2 = ( atlas->used + glyphs[ j ].t2 * FONT_SIZE ) / atlas->height;
+			glyphs[ j ].glyph = atlas->shader;
+			Q_strncpyz( glyphs[ j ].shaderName, atlas->name, sizeof( glyphs[ j ].shaderName ) );
+		}
+	}
+
+	atlas->used += rows;
+
+	return qtrue;
+}
+
 static void RE_StoreImage( fontInfo_t *font, int chunk, int page, int from, int to, const unsigned char *bitmap, int yEnd )
 {
 	int           scaledSize = FONT_SIZE * FONT_SIZE;
@@ -417,6 +527,11 @@ static void RE_StoreImage( fontInfo_t *font, int chunk, int page, int from, int
 
 	char          fileName[ MAX_QPATH ];
 
+	if ( RE_StoreAtlas( font, chunk, from, to, bitmap, yEnd ) )
+	{
+		return;
+	}
+
 	// maybe crop image while retaining power-of-2 height
 	i = 1;
 	y = FONT_SIZE;
@@ -491,6 +606,9 @@ void RE_RenderChunk( fontInfo_t *font, const int chunk )
 		return;
 	}
 
+	// images are created and updated
+	R_SyncRenderThread();
+
 	out = ri.Z_Malloc( FONT_SIZE * FONT_SIZE );
 
 	if ( out == NULL )
@@ -841,6 +959,10 @@ static fontHandle_t RE_RegisterFont_Internal( const char *fontName, const char *
 	font->glyphScale = Com_Clamp( 24.0f, 64.0f, r_fontScale->value ) / pointSize;
 	font->height = ceil( ( face->height / 64.0 ) * ( face->size->metrics.y_scale / 65536.0 ) * font->glyphScale );
 
+	// the glyphs of the font this slot held before are gone
+	font->atlas = &fontAtlas[ fontNo ];
+	fontAtlas[ fontNo ].used = 0;
+
 	RE_RenderChunk( font, 0 );
 
 	Com_Memcpy( &registeredFont[ fontNo ], font, sizeof( fontInfo_t ) );
@@ -957,4 +1079,7 @@ void R_DoneFreeType( void )
 		FT_Done_FreeType( ftLibrary );
 		ftLibrary = NULL;
 	}
+
+	// the images go with the renderer
+	Com_Memset( fontAtlas, 0, sizeof( fontAtlas ) );
 }
@@ -779,6 +779,49 @@ void R_ScreenShot_f( void )
 
 //============================================================================
 
+/*
+==================
+RE_EncodeVideoFrame
+
+Encodes a tightly packed, bottom-up RGB frame into the payload of an
+AVI video chunk and returns its size. Only touches its arguments, so
+the client can call it from its encoder threads.
+==================
+*/
+int RE_EncodeVideoFrame( byte *buffer, int bufferSize, byte *pixels, int width, int height, qboolean motionJpeg )
+{
+	int lineLen = width * 3;
+	int aviLineLen = PAD( lineLen, AVI_LINE_PADDING );
+	int i, j;
+
+	if ( motionJpeg )
+	{
+		return SaveJPGToBuffer( buffer, bufferSize, 90, width, height, pixels );
+	}
+
+	if ( aviLineLen * height > bufferSize )
+	{
+		return 0;
+	}
+
+	for ( i = 0; i < height; ++i )
+	{
+		for ( j = 0; j < lineLen; j += 3 )
+		{
+			buffer[ i * aviLineLen + j + 0 ] = pixels[ i * lineLen + j + 2 ];
+			buffer[ i * aviLineLen + j + 1 ] = pixels[ i * lineLen + j + 1 ];
+			buffer[ i * aviLineLen + j + 2 ] = pixels[ i * lineLen + j + 0 ];
+		}
+
+		while ( j < aviLineLen )
+		{
+			buffer[ i * aviLineLen + j++ ] = 0;
+		}
+	}
+
+	return aviLineLen * height;
+}
+
 /*
 ==================
 RB_TakeVideoFrameCmd
@@ -792,8 +835,6 @@ const void     *RB_TakeVideoFrameCmd( const void *data )
 	byte                      *pixels;
 	int                       i;
 	int                       outputSize;
-	int                       j;
-	int                       aviLineLen;
 
 	cmd = ( const videoFrameCommand_t * ) data;
 
@@ -817,37 +858,22 @@ const void     *RB_TakeVideoFrameCmd( const void *data )
 			R_GammaCorrect( pixels, captureLineLen * cmd->height );
 		}
 
-		if ( cmd->motionJpeg )
+		// Drop alignment and line padding bytes
+		for ( i = 0; i < cmd->height; ++i )
 		{
-			// Drop alignment and line padding bytes
-			for ( i = 0; i < cmd->height; ++i )
-			{
-				memmove( cmd->captureBuffer + i * lineLen, pixels + i * captureLineLen, lineLen );
-			}
+			memmove( cmd->captureBuffer + i * lineLen, pixels + i * captureLineLen, lineLen );
+		}
 
-			outputSize = SaveJPGToBuffer( cmd->encodeBuffer, 3 * cmd->width * cmd->height, 90, cmd->width, cmd->height, cmd->captureBuffer );
-			ri.CL_WriteAVIVideoFrame( cmd->encodeBuffer, outputSize );
+		if ( !cmd->encodeBuffer )
+		{
+			// the client encodes the frame on its own threads
+			ri.CL_QueueAVIVideoFrame( cmd->captureBuffer );
 		}
 		else
 		{
-			aviLineLen = PAD( lineLen, AVI_LINE_PADDING );
-
-			for ( i = 0; i < cmd->height; ++i )
-			{
-				for ( j = 0; j < lineLen; j += 3 )
-				{
-					cmd->encodeBuffer[ i * aviLineLen + j + 0 ] = pixels[ i * captureLineLen + j + 2 ];
-					cmd->encodeBuffer[ i * aviLineLen + j + 1 ] = pixels[ i * captureLineLen + j + 1 ];
-					cmd->encodeBuffer[ i * aviLineLen + j + 2 ] = pixels[ i * captureLineLen + j + 0 ];
-				}
-
-				while ( j < aviLineLen )
-				{
-					cmd->encodeBuffer[ i * aviLineLen + j++ ] = 0;
-				}
-			}
-
-			ri.CL_WriteAVIVideoFrame( cmd->encodeBuffer, aviLineLen * cmd->height );
+			outputSize = RE_EncodeVideoFrame( cmd->encodeBuffer, PAD( lineLen, AVI_LINE_PADDING ) * cmd->height, cmd->captureBuffer,
+			                                  cmd->width, cmd->height, cmd->motionJpeg );
+			ri.CL_WriteAVIVideoFrame( cmd->encodeBuffer, outputSize );
 		}
 	}
 
@@ -1577,6 +1603,7 @@ extern "C" {
 		re.SetColor = RE_SetColor;
 		re.SetClipRegion = RE_SetClipRegion;
 		re.DrawStretchPic = RE_StretchPic;
+		re.DrawStretchPics = RE_StretchPics;
 		re.DrawRotatedPic = RE_RotatedPic; // NERVE - SMF
 		re.DrawStretchPicGradient = RE_StretchPicGradient;
 		re.Add2dPolys = RE_2DPolyies;
@@ -1617,6 +1644,7 @@ extern "C" {
 		re.Finish = RE_Finish;
 
 		re.TakeVideoFrame = RE_TakeVideoFrame;
+		re.EncodeVideoFrame = RE_EncodeVideoFrame;
 #if defined( USE_REFLIGHT )
 		re.AddRefLightToScene = NULL;
 #endif
@@ -1909,6 +1909,7 @@ image_t  *R_FindImageFile( const char *name, qboolean mipmap, qboolean allowPicm
 image_t  *R_CreateImage( const char *name, const byte *pic, int width, int height, qboolean mipmap, qboolean allowPicmip,
                          int wrapClampMode );
 image_t  *R_CreateGlyph( const char *name, const byte *pic, int width, int height );
+void     R_UpdateGlyph( image_t *image, const byte *pic, int y, int height );
 void     R_FreeImage( image_t *image );
 void     R_FreeImages( void );
 qboolean R_GetModeInfo( int *width, int *height, float *windowAspect, int mode );
@@ -2337,6 +2338,16 @@ typedef struct
 	float    angle; // NERVE - SMF
 } stretchPicCommand_t;
 
+// followed by numPics stretchPic_t, padded to pointer alignment
+#define MAX_STRETCH_PICS 1024
+
+typedef struct
+{
+	int      commandId;
+	shader_t *shader;
+	int      numPics;
+} stretchPicsCommand_t;
+
 typedef struct
 {
 	int        commandId;
@@ -2417,6 +2428,7 @@ typedef enum
   RC_END_OF_LIST,
   RC_SET_COLOR,
   RC_STRETCH_PIC,
+  RC_STRETCH_PICS,
   RC_2DPOLYS,
   RC_SCISSORENABLE,
   RC_SCISSORSET,
@@ -2490,6 +2502,7 @@ void                                R_AddRunVisTestsCmd( visTest_t **visTests, i
 void                                RE_SetColor( const float *rgba );
 void                                RE_SetClipRegion( const float *region );
 void                                RE_StretchPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader );
+void                                RE_StretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader );
 void                                RE_RotatedPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader, float angle );  // NERVE - SMF
 void                                RE_StretchPicGradient( float x, float y, float w, float h,
     float s1, float t1, float s2, float t2, qhandle_t hShader, const float *gradientColor,
@@ -2507,6 +2520,7 @@ void                                SavePNG( const char *name, const byte *pic,
 // video stuff
 const void *RB_TakeVideoFrameCmd( const void *data );
 void       RE_TakeVideoFrame( int width, int height, byte *captureBuffer, byte *encodeBuffer, qboolean motionJpeg );
+int        RE_EncodeVideoFrame( byte *buffer, int bufferSize, byte *pixels, int width, int height, qboolean motionJpeg );
 
 qhandle_t  RE_RegisterAnimation( const char *name );
 int        RE_CheckSkeleton( refSkeleton_t *skel, qhandle_t hModel, qhandle_t hAnim );
@@ -38,7 +38,7 @@ Maryland 20850 USA.
 
 #include "tr_types.h"
 
-#define REF_API_VERSION 10
+#define REF_API_VERSION 12
 
 // *INDENT-OFF*
 
@@ -116,6 +116,7 @@ typedef struct
 	void ( *SetColor )( const float *rgba );             // NULL = 1,1,1,1
 	void ( *SetClipRegion )( const float *region );
 	void ( *DrawStretchPic )( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader );             // 0 = white
+	void ( *DrawStretchPics )( const stretchPic_t *pics, int numPics, qhandle_t hShader );             // each with its own colour
 	void ( *DrawRotatedPic )( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader, float angle );             // NERVE - SMF
 	void ( *DrawStretchPicGradient )( float x, float y, float w, float h, float s1, float t1, float s2, float t2,
 	                                  qhandle_t hShader, const float *gradientColor, int gradientType );
@@ -166,6 +167,7 @@ typedef struct
 
 	// XreaL BEGIN
 	void ( *TakeVideoFrame )( int h, int w, byte *captureBuffer, byte *encodeBuffer, qboolean motionJpeg );
+	int ( *EncodeVideoFrame )( byte *buffer, int bufferSize, byte *pixels, int width, int height, qboolean motionJpeg );
 
 #if defined( USE_REFLIGHT )
 	void ( *AddRefLightToScene )( const refLight_t *light );
@@ -280,6 +282,7 @@ typedef struct
 	// XreaL BEGIN
 	qboolean( *CL_VideoRecording )( void );
 	void ( *CL_WriteAVIVideoFrame )( const byte *buffer, int size );
+	void ( *CL_QueueAVIVideoFrame )( byte *pixels );
 	// XreaL END
 
 	void ( *Sys_GLimpSafeInit )( void );
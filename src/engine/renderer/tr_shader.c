@@ -4126,6 +4126,15 @@ static void FixRenderCommandList( int newShader )
 						break;
 					}
 
+				case RC_STRETCH_PICS:
+					{
+						const stretchPicsCommand_t *sp_cmd = ( const stretchPicsCommand_t * ) curCmd;
+
+						curCmd = ( const void * )( ( const byte * )( sp_cmd + 1 ) +
+						                           PAD( sp_cmd->numPics * sizeof( stretchPic_t ), sizeof( void * ) ) );
+						break;
+					}
+
 				case RC_2DPOLYS:
 					{
 						const poly2dCommand_t *sp_cmd = ( const poly2dCommand_t * ) curCmd;
@@ -104,6 +104,14 @@ typedef struct
 	byte   modulate[ 4 ];
 } polyVert_t;
 
+// a quad of a batch of 2D pics, in screen coordinates
+typedef struct
+{
+	float x, y, w, h;
+	float s1, t1, s2, t2;
+	byte  modulate[ 4 ];
+} stretchPic_t;
+
 typedef struct poly_s
 {
 	qhandle_t  hShader;
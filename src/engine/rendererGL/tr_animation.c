@@ -976,6 +976,13 @@ void R_AddMD5Surfaces( trRefEntity_t *ent )
 	// set up world bounds for light intersection tests
 	R_SetupEntityWorldBounds( ent );
 
+	R_CullOccludedEntity( ent );
+
+	if ( ent->cull == CULL_OUT )
+	{
+		return;
+	}
+
 	// set up lighting now that we know we aren't culled
 	if ( !personalModel || r_shadows->integer > SHADOWING_BLOB )
 	{
@@ -1139,25 +1146,13 @@ void R_AddMD5Interactions( trRefEntity_t *ent, trRefLight_t *light, interactionT
 
 	model = tr.currentModel->md5;
 
-	// do a quick AABB cull
-	if ( !BoundsIntersect( light->worldBounds[ 0 ], light->worldBounds[ 1 ], ent->worldBounds[ 0 ], ent->worldBounds[ 1 ] ) )
+	// cull against the light volume and find the shadow cube sides it touches
+	if ( !R_LightIntersectsEntity( light, ent, &cubeSideBits ) )
 	{
 		tr.pc.c_dlightSurfacesCulled += model->numSurfaces;
 		return;
 	}
 
-	// do a more expensive and precise light frustum cull
-	if ( !r_noLightFrustums->integer )
-	{
-		if ( R_CullLightWorldBounds( light, ent->worldBounds ) == CULL_OUT )
-		{
-			tr.pc.c_dlightSurfacesCulled += model->numSurfaces;
-			return;
-		}
-	}
-
-	cubeSideBits = R_CalcLightCubeSideBits( light, ent->worldBounds );
-
 	if ( !r_vboModels->integer || !model->numVBOSurfaces ||
 	     ( !glConfig2.vboVertexSkinningAvailable && ent->e.skeleton.type == SK_ABSOLUTE ) )
 	{
@@ -1707,3 +1702,160 @@ int RE_AnimFrameRate( qhandle_t hAnim )
 }
 
 #endif
+
+/*
+===========================================================================
+
+CPU SKINNING
+
+Vertices are skinned by first blending the bone matrices by the vertex
+weights, so the tangent space only has to be transformed once. Surfaces
+are split into jobs of SKIN_JOB_VERTEXES for the render worker threads.
+
+===========================================================================
+*/
+
+#if defined( __SSE__ ) || id386_sse
+#include <xmmintrin.h>
+#define SKIN_SSE 1
+#else
+#define SKIN_SSE 0
+#endif
+
+#define SKIN_JOB_VERTEXES 256
+
+#if SKIN_SSE
+
+static INLINE __m128 Skin_Transform( __m128 c0, __m128 c1, __m128 c2, const vec3_t in )
+{
+	return _mm_add_ps( _mm_add_ps( _mm_mul_ps( c0, _mm_set1_ps( in[ 0 ] ) ),
+	                               _mm_mul_ps( c1, _mm_set1_ps( in[ 1 ] ) ) ),
+	                   _mm_mul_ps( c2, _mm_set1_ps( in[ 2 ] ) ) );
+}
+
+static INLINE void Skin_Store( __m128 v, vec4_t out )
+{
+	_mm_storeu_ps( out, v );
+	out[ 3 ] = 1;
+}
+
+static void Tess_SkinVertexRange( const skinVertexes_t *skin, int first, int last )
+{
+	const md5Vertex_t *v;
+	const md5Weight_t *w;
+	const float       *bone;
+	__m128            c0, c1, c2, c3, b0, b1, b2, b3, weight, position;
+	int               i, k;
+
+	for ( i = first, v = skin->verts + first; i < last; i++, v++ )
+	{
+		c0 = c1 = c2 = c3 = position = _mm_setzero_ps();
+
+		for ( k = 0; k < v->numWeights; k++ )
+		{
+			w = v->weights[ k ];
+			bone = skin->bones[ w->boneIndex ];
+			weight = _mm_set1_ps( w->boneWeight );
+
+			b0 = _mm_mul_ps( _mm_loadu_ps( &bone[ 0 ] ), weight );
+			b1 = _mm_mul_ps( _mm_loadu_ps( &bone[ 4 ] ), weight );
+			b2 = _mm_mul_ps( _mm_loadu_ps( &bone[ 8 ] ), weight );
+			b3 = _mm_mul_ps( _mm_loadu_ps( &bone[ 12 ] ), weight );
+
+			if ( skin->weightOffsets )
+			{
+				position = _mm_add_ps( position, _mm_add_ps( Skin_Transform( b0, b1, b2, w->offset ), b3 ) );
+			}
+
+			c0 = _mm_add_ps( c0, b0 );
+			c1 = _mm_add_ps( c1, b1 );
+			c2 = _mm_add_ps( c2, b2 );
+			c3 = _mm_add_ps( c3, b3 );
+		}
+
+		if ( !skin->weightOffsets )
+		{
+			position = _mm_add_ps( Skin_Transform( c0, c1, c2, v->position ), c3 );
+		}
+
+		Skin_Store( position, skin->xyz[ i ] );
+
+		if ( skin->tangentSpace )
+		{
+			Skin_Store( Skin_Transform( c0, c1, c2, v->tangent ), skin->tangents[ i ] );
+			Skin_Store( Skin_Transform( c0, c1, c2, v->binormal ), skin->binormals[ i ] );
+			Skin_Store( Skin_Transform( c0, c1, c2, v->normal ), skin->normals[ i ] );
+		}
+	}
+}
+
+#else
+
+static void Tess_SkinVertexRange( const skinVertexes_t *skin, int first, int last )
+{
+	const md5Vertex_t *v;
+	const md5Weight_t *w;
+	matrix_t          blend;
+	vec3_t            tmpVert;
+	int               i, j, k;
+
+	for ( i = first, v = skin->verts + first; i < last; i++, v++ )
+	{
+		Com_Memset( blend, 0, sizeof( blend ) );
+		VectorClear( skin->xyz[ i ] );
+
+		for ( k = 0; k < v->numWeights; k++ )
+		{
+			w = v->weights[ k ];
+
+			if ( skin->weightOffsets )
+			{
+				MatrixTransformPoint( skin->bones[ w->boneIndex ], w->offset, tmpVert );
+				VectorMA( skin->xyz[ i ], w->boneWeight, tmpVert, skin->xyz[ i ] );
+			}
+
+			for ( j = 0; j < 16; j++ )
+			{
+				blend[ j ] += w->boneWeight * skin->bones[ w->boneIndex ][ j ];
+			}
+		}
+
+		if ( !skin->weightOffsets )
+		{
+			MatrixTransformPoint( blend, v->position, skin->xyz[ i ] );
+		}
+
+		skin->xyz[ i ][ 3 ] = 1;
+
+		if ( skin->tangentSpace )
+		{
+			MatrixTransformNormal( blend, v->tangent, skin->tangents[ i ] );
+			MatrixTransformNormal( blend, v->binormal, skin->binormals[ i ] );
+			MatrixTransformNormal( blend, v->normal, skin->normals[ i ] );
+
+			skin->tangents[ i ][ 3 ] = 1;
+			skin->binormals[ i ][ 3 ] = 1;
+			skin->normals[ i ][ 3 ] = 1;
+		}
+	}
+}
+
+#endif
+
+static void Tess_SkinJob( void *data, int job )
+{
+	const skinVertexes_t *skin = ( const skinVertexes_t * ) data;
+	int                  first = job * SKIN_JOB_VERTEXES;
+
+	Tess_SkinVertexRange( skin, first, MIN( first + SKIN_JOB_VERTEXES, skin->numVerts ) );
+}
+
+/*
+==============
+Tess_SkinVertexes
+==============
+*/
+void Tess_SkinVertexes( const skinVertexes_t *skin )
+{
+	GLimp_RunJobs( Tess_SkinJob, ( void * ) skin, ( skin->numVerts + SKIN_JOB_VERTEXES - 1 ) / SKIN_JOB_VERTEXES );
+}
@@ -58,6 +58,7 @@ static float                    frontlerp, backlerp;
 static float                    torsoFrontlerp, torsoBacklerp;
 //static int     *boneRefs;
 static mdxBoneFrame_t           bones[ MDX_MAX_BONES ], rawBones[ MDX_MAX_BONES ], oldBones[ MDX_MAX_BONES ];
+static matrix_t                 skinBones[ MDX_MAX_BONES ];
 static char                     validBones[ MDX_MAX_BONES ];
 static char                     newBones[ MDX_MAX_BONES ];
 static mdxBoneFrame_t           *bonePtr, *bone, *parentBone;
@@ -529,6 +530,7 @@ void R_MDM_AddAnimSurfaces( trRefEntity_t *ent )
 	// cull the entire model if merged bounding box of both frames
 	// is outside the view frustum.
 	ent->cull = R_CullModel( ent );
+	R_CullOccludedEntity( ent );
 
 	if ( ent->cull == CULL_OUT )
 	{
@@ -634,25 +636,13 @@ void R_AddMDMInteractions( trRefEntity_t *ent, trRefLight_t *light, interactionT
 
 	model = tr.currentModel->mdm;
 
-	// do a quick AABB cull
-	if ( !BoundsIntersect( light->worldBounds[ 0 ], light->worldBounds[ 1 ], ent->worldBounds[ 0 ], ent->worldBounds[ 1 ] ) )
+	// cull against the light volume and find the shadow cube sides it touches
+	if ( !R_LightIntersectsEntity( light, ent, &cubeSideBits ) )
 	{
 		tr.pc.c_dlightSurfacesCulled += model->numSurfaces;
 		return;
 	}
 
-	// do a more expensive and precise light frustum cull
-	if ( !r_noLightFrustums->integer )
-	{
-		if ( R_CullLightWorldBounds( light, ent->worldBounds ) == CULL_OUT )
-		{
-			tr.pc.c_dlightSurfacesCulled += model->numSurfaces;
-			return;
-		}
-	}
-
-	cubeSideBits = R_CalcLightCubeSideBits( light, ent->worldBounds );
-
 	// generate interactions with all surfaces
 	if ( r_vboModels->integer && model->numVBOSurfaces && glConfig2.vboVertexSkinningAvailable )
 	{
@@ -1850,14 +1840,14 @@ Tess_MDM_SurfaceAnim
 void Tess_MDM_SurfaceAnim( mdmSurfaceIntern_t *surface )
 {
 #if 1
-	int           i, j, k;
-	refEntity_t   *refent;
-	int           *boneList;
-	mdmModel_t    *mdm;
-	md5Vertex_t   *v;
-	srfTriangle_t *tri;
-	int           baseIndex, baseVertex;
-	float         *tmpPosition, *tmpNormal, *tmpTangent, *tmpBinormal;
+	int            i, j;
+	refEntity_t    *refent;
+	int            *boneList;
+	mdmModel_t     *mdm;
+	md5Vertex_t    *v;
+	srfTriangle_t  *tri;
+	int            baseIndex, baseVertex;
+	skinVertexes_t skin;
 
 #ifdef DBG_PROFILE_BONES
 	int           di = 0, dt, ldt;
@@ -2009,36 +1999,39 @@ void Tess_MDM_SurfaceAnim( mdmSurfaceIntern_t *surface )
 
 #endif
 
-	// deform the vertexes by the lerped bones
-	v = surface->verts;
-	tmpPosition = ( float * )( &tess.xyz[ baseVertex ][ 0 ] );
-	tmpNormal = ( float * )( &tess.normals[ baseVertex ][ 0 ] );
-	tmpBinormal = ( float * )( &tess.binormals[ baseVertex ][ 0 ] );
-	tmpTangent = ( float * )( &tess.tangents[ baseVertex ][ 0 ] );
-
-	for ( j = 0; j < render_count; j++, tmpPosition += 4, tmpNormal += 4, tmpTangent += 4, tmpBinormal += 4, v++ )
+	// convert the lerped bones referenced by this surface for the skinning jobs
+	for ( i = 0; i < surface->numBoneReferences; i++ )
 	{
-		md5Weight_t *w;
-
-		Vector4Set( tmpPosition, 0, 0, 0, 1 );
-		Vector4Set( tmpTangent, 0, 0, 0, 1 );
-		Vector4Set( tmpBinormal, 0, 0, 0, 1 );
-		Vector4Set( tmpNormal, 0, 0, 0, 1 );
+		mdxBoneFrame_t *bonePtr = &bones[ boneList[ i ] ];
+		float          *m = skinBones[ boneList[ i ] ];
 
-		for ( k = 0; k < v->numWeights; k++ )
+		for ( j = 0; j < 3; j++ )
 		{
-			w = v->weights[ k ];
+			m[ j * 4 + 0 ] = bonePtr->matrix[ 0 ][ j ];
+			m[ j * 4 + 1 ] = bonePtr->matrix[ 1 ][ j ];
+			m[ j * 4 + 2 ] = bonePtr->matrix[ 2 ][ j ];
+			m[ j * 4 + 3 ] = 0;
+		}
 
-			bone = &bones[ w->boneIndex ];
-			LocalAddScaledMatrixTransformVectorTranslate( w->offset, w->boneWeight, bone->matrix, bone->translation, tmpPosition );
+		VectorCopy( bonePtr->translation, &m[ 12 ] );
+		m[ 15 ] = 1;
+	}
 
-			LocalAddScaledMatrixTransformVector( v->tangent, w->boneWeight, bone->matrix, tmpTangent );
-			LocalAddScaledMatrixTransformVector( v->binormal, w->boneWeight, bone->matrix, tmpBinormal );
-			LocalAddScaledMatrixTransformVector( v->normal, w->boneWeight, bone->matrix, tmpNormal );
-		}
+	// deform the vertexes by the lerped bones
+	skin.bones = ( const matrix_t * ) skinBones;
+	skin.verts = surface->verts;
+	skin.numVerts = render_count;
+	skin.weightOffsets = qtrue;
+	skin.tangentSpace = qtrue;
+	skin.xyz = &tess.xyz[ baseVertex ];
+	skin.tangents = &tess.tangents[ baseVertex ];
+	skin.binormals = &tess.binormals[ baseVertex ];
+	skin.normals = &tess.normals[ baseVertex ];
 
-		//LocalMatrixTransformVector(v->normal, bones[v->weights[0]->boneIndex].matrix, tempNormal);
+	Tess_SkinVertexes( &skin );
 
+	for ( j = 0, v = surface->verts; j < render_count; j++, v++ )
+	{
 		tess.texCoords[ baseVertex + j ][ 0 ] = v->texCoords[ 0 ];
 		tess.texCoords[ baseVertex + j ][ 1 ] = v->texCoords[ 1 ];
 	}
@@ -8913,37 +8913,16 @@ const void     *RB_SetColor( const void *data )
 
 /*
 =============
-RB_StretchPic
+RB_AddStretchPic
+
+Adds a 2D quad to the current surface
 =============
 */
-const void     *RB_StretchPic( const void *data )
+static void RB_AddStretchPic( float x, float y, float w, float h,
+                              float s1, float t1, float s2, float t2, const vec4_t color )
 {
-	int                       i;
-	const stretchPicCommand_t *cmd;
-	shader_t                  *shader;
-	int                       numVerts, numIndexes;
-
-	GLimp_LogComment( "--- RB_StretchPic ---\n" );
-
-	cmd = ( const stretchPicCommand_t * ) data;
-
-	if ( !backEnd.projection2D )
-	{
-		RB_SetGL2D();
-	}
-
-	shader = cmd->shader;
-
-	if ( shader != tess.surfaceShader )
-	{
-		if ( tess.numIndexes )
-		{
-			Tess_End();
-		}
-
-		backEnd.currentEntity = &backEnd.entity2D;
-		Tess_Begin( Tess_StageIteratorGeneric, NULL, shader, NULL, qfalse, qfalse, -1, 0 );
-	}
+	int i;
+	int numVerts, numIndexes;
 
 	Tess_CheckOverflow( 4, 6 );
 	numVerts = tess.numVertexes;
@@ -8961,55 +8940,128 @@ const void     *RB_StretchPic( const void *data )
 
 	for ( i = 0; i < 4; i++ )
 	{
-		tess.colors[ numVerts + i ][ 0 ] = backEnd.color2D[ 0 ];
-		tess.colors[ numVerts + i ][ 1 ] = backEnd.color2D[ 1 ];
-		tess.colors[ numVerts + i ][ 2 ] = backEnd.color2D[ 2 ];
-		tess.colors[ numVerts + i ][ 3 ] = backEnd.color2D[ 3 ];
+		tess.colors[ numVerts + i ][ 0 ] = color[ 0 ];
+		tess.colors[ numVerts + i ][ 1 ] = color[ 1 ];
+		tess.colors[ numVerts + i ][ 2 ] = color[ 2 ];
+		tess.colors[ numVerts + i ][ 3 ] = color[ 3 ];
 	}
 
-	tess.xyz[ numVerts ][ 0 ] = cmd->x;
-	tess.xyz[ numVerts ][ 1 ] = cmd->y;
+	tess.xyz[ numVerts ][ 0 ] = x;
+	tess.xyz[ numVerts ][ 1 ] = y;
 	tess.xyz[ numVerts ][ 2 ] = 0;
 	tess.xyz[ numVerts ][ 3 ] = 1;
 
-	tess.texCoords[ numVerts ][ 0 ] = cmd->s1;
-	tess.texCoords[ numVerts ][ 1 ] = cmd->t1;
+	tess.texCoords[ numVerts ][ 0 ] = s1;
+	tess.texCoords[ numVerts ][ 1 ] = t1;
 	tess.texCoords[ numVerts ][ 2 ] = 0;
 	tess.texCoords[ numVerts ][ 3 ] = 1;
 
-	tess.xyz[ numVerts + 1 ][ 0 ] = cmd->x + cmd->w;
-	tess.xyz[ numVerts + 1 ][ 1 ] = cmd->y;
+	tess.xyz[ numVerts + 1 ][ 0 ] = x + w;
+	tess.xyz[ numVerts + 1 ][ 1 ] = y;
 	tess.xyz[ numVerts + 1 ][ 2 ] = 0;
 	tess.xyz[ numVerts + 1 ][ 3 ] = 1;
 
-	tess.texCoords[ numVerts + 1 ][ 0 ] = cmd->s2;
-	tess.texCoords[ numVerts + 1 ][ 1 ] = cmd->t1;
+	tess.texCoords[ numVerts + 1 ][ 0 ] = s2;
+	tess.texCoords[ numVerts + 1 ][ 1 ] = t1;
 	tess.texCoords[ numVerts + 1 ][ 2 ] = 0;
 	tess.texCoords[ numVerts + 1 ][ 3 ] = 1;
 
-	tess.xyz[ numVerts + 2 ][ 0 ] = cmd->x + cmd->w;
-	tess.xyz[ numVerts + 2 ][ 1 ] = cmd->y + cmd->h;
+	tess.xyz[ numVerts + 2 ][ 0 ] = x + w;
+	tess.xyz[ numVerts + 2 ][ 1 ] = y + h;
 	tess.xyz[ numVerts + 2 ][ 2 ] = 0;
 	tess.xyz[ numVerts + 2 ][ 3 ] = 1;
 
-	tess.texCoords[ numVerts + 2 ][ 0 ] = cmd->s2;
-	tess.texCoords[ numVerts + 2 ][ 1 ] = cmd->t2;
+	tess.texCoords[ numVerts + 2 ][ 0 ] = s2;
+	tess.texCoords[ numVerts + 2 ][ 1 ] = t2;
 	tess.texCoords[ numVerts + 2 ][ 2 ] = 0;
 	tess.texCoords[ numVerts + 2 ][ 3 ] = 1;
 
-	tess.xyz[ numVerts + 3 ][ 0 ] = cmd->x;
-	tess.xyz[ numVerts + 3 ][ 1 ] = cmd->y + cmd->h;
+	tess.xyz[ numVerts + 3 ][ 0 ] = x;
+	tess.xyz[ numVerts + 3 ][ 1 ] = y + h;
 	tess.xyz[ numVerts + 3 ][ 2 ] = 0;
 	tess.xyz[ numVerts + 3 ][ 3 ] = 1;
 
-	tess.texCoords[ numVerts + 3 ][ 0 ] = cmd->s1;
-	tess.texCoords[ numVerts + 3 ][ 1 ] = cmd->t2;
+	tess.texCoords[ numVerts + 3 ][ 0 ] = s1;
+	tess.texCoords[ numVerts + 3 ][ 1 ] = t2;
 	tess.texCoords[ numVerts + 3 ][ 2 ] = 0;
 	tess.texCoords[ numVerts + 3 ][ 3 ] = 1;
+}
+
+/*
+=============
+RB_BeginStretchPic
+=============
+*/
+static void RB_BeginStretchPic( shader_t *shader )
+{
+	if ( !backEnd.projection2D )
+	{
+		RB_SetGL2D();
+	}
+
+	if ( shader != tess.surfaceShader )
+	{
+		if ( tess.numIndexes )
+		{
+			Tess_End();
+		}
+
+		backEnd.currentEntity = &backEnd.entity2D;
+		Tess_Begin( Tess_StageIteratorGeneric, NULL, shader, NULL, qfalse, qfalse, -1, 0 );
+	}
+}
+
+/*
+=============
+RB_StretchPic
+=============
+*/
+const void     *RB_StretchPic( const void *data )
+{
+	const stretchPicCommand_t *cmd;
+
+	GLimp_LogComment( "--- RB_StretchPic ---\n" );
+
+	cmd = ( const stretchPicCommand_t * ) data;
+
+	RB_BeginStretchPic( cmd->shader );
+	RB_AddStretchPic( cmd->x, cmd->y, cmd->w, cmd->h, cmd->s1, cmd->t1, cmd->s2, cmd->t2, backEnd.color2D );
 
 	return ( const void * )( cmd + 1 );
 }
 
+/*
+=============
+RB_StretchPics
+=============
+*/
+const void     *RB_StretchPics( const void *data )
+{
+	const stretchPicsCommand_t *cmd;
+	const stretchPic_t         *pic;
+	vec4_t                     color;
+	int                        i;
+
+	GLimp_LogComment( "--- RB_StretchPics ---\n" );
+
+	cmd = ( const stretchPicsCommand_t * ) data;
+	pic = ( const stretchPic_t * )( cmd + 1 );
+
+	RB_BeginStretchPic( cmd->shader );
+
+	for ( i = 0; i < cmd->numPics; i++, pic++ )
+	{
+		color[ 0 ] = pic->modulate[ 0 ] * ( 1.0f / 255.0f );
+		color[ 1 ] = pic->modulate[ 1 ] * ( 1.0f / 255.0f );
+		color[ 2 ] = pic->modulate[ 2 ] * ( 1.0f / 255.0f );
+		color[ 3 ] = pic->modulate[ 3 ] * ( 1.0f / 255.0f );
+
+		RB_AddStretchPic( pic->x, pic->y, pic->w, pic->h, pic->s1, pic->t1, pic->s2, pic->t2, color );
+	}
+
+	return ( const void * )( ( const byte * )( cmd + 1 ) + PAD( cmd->numPics * sizeof( stretchPic_t ), sizeof( void * ) ) );
+}
+
 const void     *RB_ScissorEnable( const void *data )
 {
 	const scissorEnableCommand_t *cmd;
@@ -9733,6 +9785,10 @@ void RB_ExecuteRenderCommands( const void *data )
 				data = RB_StretchPic( data );
 				break;
 
+			case RC_STRETCH_PICS:
+				data = RB_StretchPics( data );
+				break;
+
 			case RC_2DPOLYS:
 				data = RB_Draw2dPolys( data );
 				break;
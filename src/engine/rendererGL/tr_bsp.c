@@ -44,6 +44,147 @@ static int        c_vboWorldSurfaces;
 static int        c_vboLightSurfaces;
 static int        c_vboShadowSurfaces;
 
+/*
+=============================================================================
+
+CACHE FILES
+
+Growing write buffers, bounds checked readers and hashing shared by the
+files the world loading caches its results in.
+
+=============================================================================
+*/
+
+typedef struct
+{
+	byte *data;
+	int  size;
+	int  used;
+} cacheBuffer_t;
+
+typedef struct
+{
+	const byte *data;
+	int        size;
+	int        pos;
+	qboolean   overflow;
+} cacheReader_t;
+
+static unsigned int s_worldChecksum;
+
+/*
+===============
+R_CacheHash
+===============
+*/
+static unsigned int R_CacheHash( unsigned int hash, const void *data, int size )
+{
+	const byte *p = ( const byte * ) data;
+	int        i;
+
+	// FNV-1a
+	for ( i = 0; i < size; i++ )
+	{
+		hash = ( hash ^ p[ i ] ) * 16777619;
+	}
+
+	return hash;
+}
+
+/*
+===============
+R_CacheWrite
+===============
+*/
+static void R_CacheWrite( cacheBuffer_t *buf, const void *data, int size )
+{
+	byte *newData;
+
+	if ( buf->used + size > buf->size )
+	{
+		buf->size = MAX( buf->size * 2, buf->used + size + 65536 );
+		newData = Com_Allocate( buf->size );
+
+		if ( buf->data )
+		{
+			Com_Memcpy( newData, buf->data, buf->used );
+			Com_Dealloc( buf->data );
+		}
+
+		buf->data = newData;
+	}
+
+	Com_Memcpy( buf->data + buf->used, data, size );
+	buf->used += size;
+}
+
+/*
+===============
+R_CacheWriteInt
+===============
+*/
+static void R_CacheWriteInt( cacheBuffer_t *buf, int value )
+{
+	R_CacheWrite( buf, &value, sizeof( value ) );
+}
+
+/*
+===============
+R_CacheFree
+===============
+*/
+static void R_CacheFree( cacheBuffer_t *buf )
+{
+	if ( buf->data )
+	{
+		Com_Dealloc( buf->data );
+	}
+
+	Com_Memset( buf, 0, sizeof( *buf ) );
+}
+
+/*
+===============
+R_CacheReadInt
+===============
+*/
+static int R_CacheReadInt( cacheReader_t *reader )
+{
+	int value;
+
+	if ( reader->pos + ( int ) sizeof( value ) > reader->size )
+	{
+		reader->overflow = qtrue;
+		return 0;
+	}
+
+	Com_Memcpy( &value, reader->data + reader->pos, sizeof( value ) );
+	reader->pos += sizeof( value );
+
+	return value;
+}
+
+/*
+===============
+R_CacheRead
+===============
+*/
+static void R_CacheRead( cacheReader_t *reader, void *data, int size )
+{
+	if ( size < 0 || size > reader->size - reader->pos )
+	{
+		reader->overflow = qtrue;
+		return;
+	}
+
+	if ( data )
+	{
+		Com_Memcpy( data, reader->data + reader->pos, size );
+	}
+
+	reader->pos += size;
+}
+
 //===============================================================================
 
 void HSVtoRGB( float h, float s, float v, float rgb[ 3 ] )
@@ -1652,21 +1793,10 @@ static void ParseFace( dsurface_t *ds, drawVert_t *verts, bspSurface_t *surf, in
 			VectorNormalize( cv->verts[ i ].normal );
 		}
 	}
-#else
-	{
-		srfVert_t *dv[ 3 ];
-
-		for ( i = 0, tri = cv->triangles; i < numTriangles; i++, tri++ )
-		{
-			dv[ 0 ] = &cv->verts[ tri->indexes[ 0 ] ];
-			dv[ 1 ] = &cv->verts[ tri->indexes[ 1 ] ];
-			dv[ 2 ] = &cv->verts[ tri->indexes[ 2 ] ];
-
-			R_CalcTangentVectors( dv );
-		}
-	}
 #endif
 
+	// the tangent vectors are calculated for all surfaces at once by R_CalcWorldTangents
+
 	// finish surface
 	FinishGenericSurface( ds, ( srfGeneric_t * ) cv, cv->verts[ 0 ].xyz );
 }
@@ -2021,21 +2151,10 @@ static void ParseTriSurf( dsurface_t *ds, drawVert_t *verts, bspSurface_t *surf,
 			//VectorNormalize(cv->verts[i].tangent);
 		}
 	}
-#else
-	{
-		srfVert_t *dv[ 3 ];
-
-		for ( i = 0, tri = cv->triangles; i < numTriangles; i++, tri++ )
-		{
-			dv[ 0 ] = &cv->verts[ tri->indexes[ 0 ] ];
-			dv[ 1 ] = &cv->verts[ tri->indexes[ 1 ] ];
-			dv[ 2 ] = &cv->verts[ tri->indexes[ 2 ] ];
-
-			R_CalcTangentVectors( dv );
-		}
-	}
 #endif
 
+	// the tangent vectors are calculated for all surfaces at once by R_CalcWorldTangents
+
 #if 0
 
 	// do another extra smoothing for normals to avoid flat shading
@@ -2485,6 +2604,99 @@ void R_FixSharedVertexLodError( void )
 	}
 }
 
+/*
+=============================================================================
+
+WORLD GEOMETRY CACHE
+
+R_StitchAllPatches and R_FixSharedVertexLodError test every patch against
+every other one. The stitches they make and the LoD errors the patches end
+up with are saved to maps/<map>.worldcache and replayed from there as long
+as the BSP and the cvars the patch grids depend on stay the same.
+
+=============================================================================
+*/
+
+#define WORLDCACHE_IDENT   ( ( 'C' << 24 ) + ( 'G' << 16 ) + ( 'W' << 8 ) + 'X' ) // little-endian "XWGC"
+#define WORLDCACHE_VERSION 1
+
+typedef struct
+{
+	int          ident;
+	int          version;
+	unsigned int checksum; // of the BSP file
+	unsigned int settings; // of the cvars the patch grids depend on
+	int          numSurfaces;
+	int          numStitches;
+	int          numGrids; // number of LoD error records that follow the stitches
+} worldCacheHeader_t;
+
+// a column or row R_StitchPatches inserted into a patch grid
+typedef struct
+{
+	int    surfaceNum;
+	int    row; // qtrue if a row was inserted
+	int    index; // of the inserted column or row
+	int    other; // row or column of the stitched point
+	vec3_t point;
+	float  lodError;
+} patchStitch_t;
+
+static qboolean      s_worldCacheRecording;
+static cacheBuffer_t s_worldCacheStitches;
+
+/*
+===============
+R_StitchInsertColumn
+===============
+*/
+static srfGridMesh_t *R_StitchInsertColumn( int surfaceNum, srfGridMesh_t *grid, int column, int row, vec3_t point, float lodError )
+{
+	patchStitch_t stitch;
+
+	grid = R_GridInsertColumn( grid, column, row, point, lodError );
+
+	if ( grid && s_worldCacheRecording )
+	{
+		stitch.surfaceNum = surfaceNum;
+		stitch.row = qfalse;
+		stitch.index = column;
+		stitch.other = row;
+		VectorCopy( point, stitch.point );
+		stitch.lodError = lodError;
+
+		R_CacheWrite( &s_worldCacheStitches, &stitch, sizeof( stitch ) );
+	}
+
+	return grid;
+}
+
+/*
+===============
+R_StitchInsertRow
+===============
+*/
+static srfGridMesh_t *R_StitchInsertRow( int surfaceNum, srfGridMesh_t *grid, int row, int column, vec3_t point, float lodError )
+{
+	patchStitch_t stitch;
+
+	grid = R_GridInsertRow( grid, row, column, point, lodError );
+
+	if ( grid && s_worldCacheRecording )
+	{
+		stitch.surfaceNum = surfaceNum;
+		stitch.row = qtrue;
+		stitch.index = row;
+		stitch.other = column;
+		VectorCopy( point, stitch.point );
+		stitch.lodError = lodError;
+
+		R_CacheWrite( &s_worldCacheStitches, &stitch, sizeof( stitch ) );
+	}
+
+	return grid;
+}
+
 /*
 ===============
 R_StitchPatches
@@ -2594,7 +2806,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 						row = 0;
 					}
 
-					grid2 = R_GridInsertColumn( grid2, l + 1, row, grid1->verts[ k + 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
+					grid2 = R_StitchInsertColumn( grid2num, grid2, l + 1, row, grid1->verts[ k + 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
 					grid2->lodStitched = qfalse;
 					s_worldData.surfaces[ grid2num ].data = ( void * ) grid2;
 					return qtrue;
@@ -2677,7 +2889,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 						column = 0;
 					}
 
-					grid2 = R_GridInsertRow( grid2, l + 1, column, grid1->verts[ k + 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
+					grid2 = R_StitchInsertRow( grid2num, grid2, l + 1, column, grid1->verts[ k + 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
 					grid2->lodStitched = qfalse;
 					s_worldData.surfaces[ grid2num ].data = ( void * ) grid2;
 					return qtrue;
@@ -2781,8 +2993,8 @@ int R_StitchPatches( int grid1num, int grid2num )
 						row = 0;
 					}
 
-					grid2 = R_GridInsertColumn( grid2, l + 1, row,
-					                            grid1->verts[ grid1->width * ( k + 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
+					grid2 = R_StitchInsertColumn( grid2num, grid2, l + 1, row,
+					                              grid1->verts[ grid1->width * ( k + 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
 					grid2->lodStitched = qfalse;
 					s_worldData.surfaces[ grid2num ].data = ( void * ) grid2;
 					return qtrue;
@@ -2865,8 +3077,8 @@ int R_StitchPatches( int grid1num, int grid2num )
 						column = 0;
 					}
 
-					grid2 = R_GridInsertRow( grid2, l + 1, column,
-					                         grid1->verts[ grid1->width * ( k + 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
+					grid2 = R_StitchInsertRow( grid2num, grid2, l + 1, column,
+					                           grid1->verts[ grid1->width * ( k + 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
 					grid2->lodStitched = qfalse;
 					s_worldData.surfaces[ grid2num ].data = ( void * ) grid2;
 					return qtrue;
@@ -2970,7 +3182,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 						row = 0;
 					}
 
-					grid2 = R_GridInsertColumn( grid2, l + 1, row, grid1->verts[ k - 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
+					grid2 = R_StitchInsertColumn( grid2num, grid2, l + 1, row, grid1->verts[ k - 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
 					grid2->lodStitched = qfalse;
 					s_worldData.surfaces[ grid2num ].data = ( void * ) grid2;
 					return qtrue;
@@ -3053,7 +3265,7 @@ int R_StitchPatches( int grid1num, int grid2num )
 						column = 0;
 					}
 
-					grid2 = R_GridInsertRow( grid2, l + 1, column, grid1->verts[ k - 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
+					grid2 = R_StitchInsertRow( grid2num, grid2, l + 1, column, grid1->verts[ k - 1 + offset1 ].xyz, grid1->widthLodError[ k + 1 ] );
 
 					if ( !grid2 )
 					{
@@ -3163,8 +3375,8 @@ int R_StitchPatches( int grid1num, int grid2num )
 						row = 0;
 					}
 
-					grid2 = R_GridInsertColumn( grid2, l + 1, row,
-					                            grid1->verts[ grid1->width * ( k - 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
+					grid2 = R_StitchInsertColumn( grid2num, grid2, l + 1, row,
+					                              grid1->verts[ grid1->width * ( k - 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
 					grid2->lodStitched = qfalse;
 					s_worldData.surfaces[ grid2num ].data = ( void * ) grid2;
 					return qtrue;
@@ -3247,8 +3459,8 @@ int R_StitchPatches( int grid1num, int grid2num )
 						column = 0;
 					}
 
-					grid2 = R_GridInsertRow( grid2, l + 1, column,
-					                         grid1->verts[ grid1->width * ( k - 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
+					grid2 = R_StitchInsertRow( grid2num, grid2, l + 1, column,
+					                           grid1->verts[ grid1->width * ( k - 1 ) + offset1 ].xyz, grid1->heightLodError[ k + 1 ] );
 					grid2->lodStitched = qfalse;
 					s_worldData.surfaces[ grid2num ].data = ( void * ) grid2;
 					return qtrue;
@@ -3418,88 +3630,397 @@ void R_MovePatchSurfacesToHunk( void )
 }
 
 /*
-=================
-BSPSurfaceCompare
-compare function for qsort()
-=================
+===============
+R_WorldCacheName
+===============
 */
-static int BSPSurfaceCompare( const void *a, const void *b )
+static const char *R_WorldCacheName( void )
 {
-	bspSurface_t *aa, *bb;
+	return va( "maps/%s.worldcache", s_worldData.baseName );
+}
 
-	aa = * ( bspSurface_t ** ) a;
-	bb = * ( bspSurface_t ** ) b;
+/*
+===============
+R_WorldCacheSettings
 
-	// shader first
-	if ( aa->shader < bb->shader )
-	{
-		return -1;
-	}
+Hashes the cvars the patch grids depend on
+===============
+*/
+static unsigned int R_WorldCacheSettings( void )
+{
+	unsigned int hash;
 
-	else if ( aa->shader > bb->shader )
+	hash = R_CacheHash( 2166136261u, &r_stitchCurves->integer, sizeof( r_stitchCurves->integer ) );
+	hash = R_CacheHash( hash, &r_subdivisions->value, sizeof( r_subdivisions->value ) );
+
+	return hash;
+}
+
+/*
+===============
+R_CheckWorldCache
+
+Checks the stitches and LoD errors against the patch grids
+before anything is changed
+===============
+*/
+static qboolean R_CheckWorldCache( cacheReader_t *reader, const worldCacheHeader_t *header, const patchStitch_t *stitches )
+{
+	int           i, numGrids;
+	int           *sizes;
+	int           surfaceNum, width, height;
+	srfGridMesh_t *grid;
+	qboolean      valid;
+
+	// width and height of every grid, -1 for the other surfaces
+	sizes = ri.Hunk_AllocateTempMemory( s_worldData.numSurfaces * 2 * sizeof( *sizes ) );
+
+	for ( i = 0, numGrids = 0; i < s_worldData.numSurfaces; i++ )
 	{
-		return 1;
+		grid = ( srfGridMesh_t * ) s_worldData.surfaces[ i ].data;
+
+		if ( grid->surfaceType != SF_GRID )
+		{
+			sizes[ i * 2 + 0 ] = sizes[ i * 2 + 1 ] = -1;
+			continue;
+		}
+
+		sizes[ i * 2 + 0 ] = grid->width;
+		sizes[ i * 2 + 1 ] = grid->height;
+		numGrids++;
 	}
 
-	// by lightmap
-	if ( aa->lightmapNum < bb->lightmapNum )
+	valid = ( header->numGrids == numGrids );
+
+	for ( i = 0; i < header->numStitches && valid; i++ )
 	{
-		return -1;
+		surfaceNum = stitches[ i ].surfaceNum;
+
+		if ( surfaceNum < 0 || surfaceNum >= s_worldData.numSurfaces || sizes[ surfaceNum * 2 ] < 0 )
+		{
+			valid = qfalse;
+			break;
+		}
+
+		width = sizes[ surfaceNum * 2 + 0 ];
+		height = sizes[ surfaceNum * 2 + 1 ];
+
+		// the new column or row is lerped between two existing ones
+		if ( stitches[ i ].row )
+		{
+			valid = height + 1 <= MAX_GRID_SIZE && stitches[ i ].index >= 1 && stitches[ i ].index < height &&
+			        stitches[ i ].other >= 0 && stitches[ i ].other < width;
+			sizes[ surfaceNum * 2 + 1 ]++;
+		}
+		else
+		{
+			valid = width + 1 <= MAX_GRID_SIZE && stitches[ i ].index >= 1 && stitches[ i ].index < width &&
+			        stitches[ i ].other >= 0 && stitches[ i ].other < height;
+			sizes[ surfaceNum * 2 + 0 ]++;
+		}
 	}
 
-	else if ( aa->lightmapNum > bb->lightmapNum )
+	for ( i = 0; i < header->numGrids && valid; i++ )
 	{
-		return 1;
+		surfaceNum = R_CacheReadInt( reader );
+		width = R_CacheReadInt( reader );
+		height = R_CacheReadInt( reader );
+
+		if ( reader->overflow || surfaceNum < 0 || surfaceNum >= s_worldData.numSurfaces ||
+		     sizes[ surfaceNum * 2 + 0 ] != width || sizes[ surfaceNum * 2 + 1 ] != height || width < 0 )
+		{
+			valid = qfalse;
+			break;
+		}
+
+		// each grid only once
+		sizes[ surfaceNum * 2 + 0 ] = -1;
+
+		R_CacheRead( reader, NULL, ( width + height ) * sizeof( float ) );
 	}
 
-	return 0;
+	ri.Hunk_FreeTempMemory( sizes );
+
+	return valid && !reader->overflow && reader->pos == reader->size;
 }
 
-static void CopyVert( const srfVert_t *in, srfVert_t *out )
+/*
+===============
+R_LoadWorldCache
+
+Replays the patch stitches and LoD errors saved by R_SaveWorldCache,
+returns qfalse if there is no cache that matches the map
+===============
+*/
+static qboolean R_LoadWorldCache( void )
 {
-	int j;
+	worldCacheHeader_t header;
+	patchStitch_t      *stitches;
+	cacheReader_t      reader;
+	srfGridMesh_t      *grid;
+	byte               *buffer;
+	int                length;
+	int                i, surfaceNum;
 
-	for ( j = 0; j < 3; j++ )
+	length = ri.FS_ReadFile( R_WorldCacheName(), ( void ** ) &buffer );
+
+	if ( !buffer )
 	{
-		out->xyz[ j ] = in->xyz[ j ];
-		out->tangent[ j ] = in->tangent[ j ];
-		out->binormal[ j ] = in->binormal[ j ];
-		out->normal[ j ] = in->normal[ j ];
-#if !defined( COMPAT_Q3A ) && !defined( COMPAT_ET )
-		out->lightDirection[ j ] = in->lightDirection[ j ];
-#endif
+		return qfalse;
 	}
 
-	for ( j = 0; j < 2; j++ )
+	if ( length < ( int ) sizeof( header ) )
 	{
-		out->st[ j ] = in->st[ j ];
-		out->lightmap[ j ] = in->lightmap[ j ];
+		ri.FS_FreeFile( buffer );
+		return qfalse;
 	}
 
-	for ( j = 0; j < 4; j++ )
+	Com_Memcpy( &header, buffer, sizeof( header ) );
+
+	if ( header.ident != WORLDCACHE_IDENT || header.version != WORLDCACHE_VERSION ||
+	     header.checksum != s_worldChecksum || header.settings != R_WorldCacheSettings() ||
+	     header.numSurfaces != s_worldData.numSurfaces )
 	{
-#if !defined( COMPAT_Q3A ) && !defined( COMPAT_ET )
-		out->paintColor[ j ] = in->paintColor[ j ];
-#endif
-		out->lightColor[ j ] = in->lightColor[ j ];
+		ri.Printf( PRINT_DEVELOPER, "%s is out of date\n", R_WorldCacheName() );
+		ri.FS_FreeFile( buffer );
+		return qfalse;
 	}
 
-#if DEBUG_OPTIMIZEVERTICES
-	out->id = in->id;
-#endif
-}
+	reader.data = buffer;
+	reader.size = length;
+	reader.pos = sizeof( header );
+	reader.overflow = qfalse;
 
-#define EQUAL_EPSILON 0.001
+	stitches = ( patchStitch_t * )( buffer + reader.pos );
 
-/*static qboolean CompareWorldVert(const srfVert_t * v1, const srfVert_t * v2)
-{
-        int             i;
+	// grids only come from Com_Allocate when they can be stitched
+	if ( header.numStitches < 0 || ( header.numStitches && !r_stitchCurves->integer ) ||
+	     header.numStitches > ( length - reader.pos ) / ( int ) sizeof( *stitches ) )
+	{
+		reader.overflow = qtrue;
+	}
+	else
+	{
+		reader.pos += header.numStitches * sizeof( *stitches );
+	}
 
-        for(i = 0; i < 3; i++)
-        {
-                //if(fabs(v1->xyz[i] - v2->xyz[i]) > EQUAL_EPSILON)
-                if(v1->xyz[i] != v2->xyz[i])
-                        return qfalse;
+	if ( reader.overflow || !R_CheckWorldCache( &reader, &header, stitches ) )
+	{
+		ri.Printf( PRINT_WARNING, "WARNING: %s is corrupt\n", R_WorldCacheName() );
+		ri.FS_FreeFile( buffer );
+		return qfalse;
+	}
+
+	for ( i = 0; i < header.numStitches; i++ )
+	{
+		surfaceNum = stitches[ i ].surfaceNum;
+		grid = ( srfGridMesh_t * ) s_worldData.surfaces[ surfaceNum ].data;
+
+		if ( stitches[ i ].row )
+		{
+			grid = R_GridInsertRow( grid, stitches[ i ].index, stitches[ i ].other, stitches[ i ].point, stitches[ i ].lodError );
+		}
+		else
+		{
+			grid = R_GridInsertColumn( grid, stitches[ i ].index, stitches[ i ].other, stitches[ i ].point, stitches[ i ].lodError );
+		}
+
+		s_worldData.surfaces[ surfaceNum ].data = ( void * ) grid;
+	}
+
+	reader.pos = sizeof( header ) + header.numStitches * sizeof( *stitches );
+
+	for ( i = 0; i < header.numGrids; i++ )
+	{
+		surfaceNum = R_CacheReadInt( &reader );
+		R_CacheReadInt( &reader );
+		R_CacheReadInt( &reader );
+
+		grid = ( srfGridMesh_t * ) s_worldData.surfaces[ surfaceNum ].data;
+		R_CacheRead( &reader, grid->widthLodError, grid->width * sizeof( float ) );
+		R_CacheRead( &reader, grid->heightLodError, grid->height * sizeof( float ) );
+
+		grid->lodStitched = qtrue;
+		grid->lodFixed = 2;
+	}
+
+	ri.FS_FreeFile( buffer );
+
+	ri.Printf( PRINT_DEVELOPER, "...replayed %i patch stitches from %s\n", header.numStitches, R_WorldCacheName() );
+
+	return qtrue;
+}
+
+/*
+===============
+R_SaveWorldCache
+===============
+*/
+static void R_SaveWorldCache( void )
+{
+	worldCacheHeader_t header;
+	cacheBuffer_t      buf;
+	srfGridMesh_t      *grid;
+	int                i;
+
+	Com_Memset( &buf, 0, sizeof( buf ) );
+
+	header.ident = WORLDCACHE_IDENT;
+	header.version = WORLDCACHE_VERSION;
+	header.checksum = s_worldChecksum;
+	header.settings = R_WorldCacheSettings();
+	header.numSurfaces = s_worldData.numSurfaces;
+	header.numStitches = s_worldCacheStitches.used / sizeof( patchStitch_t );
+	header.numGrids = 0;
+
+	R_CacheWrite( &buf, &header, sizeof( header ) );
+
+	if ( s_worldCacheStitches.used )
+	{
+		R_CacheWrite( &buf, s_worldCacheStitches.data, s_worldCacheStitches.used );
+	}
+
+	for ( i = 0; i < s_worldData.numSurfaces; i++ )
+	{
+		grid = ( srfGridMesh_t * ) s_worldData.surfaces[ i ].data;
+
+		if ( grid->surfaceType != SF_GRID )
+		{
+			continue;
+		}
+
+		R_CacheWriteInt( &buf, i );
+		R_CacheWriteInt( &buf, grid->width );
+		R_CacheWriteInt( &buf, grid->height );
+		R_CacheWrite( &buf, grid->widthLodError, grid->width * sizeof( float ) );
+		R_CacheWrite( &buf, grid->heightLodError, grid->height * sizeof( float ) );
+		header.numGrids++;
+	}
+
+	Com_Memcpy( buf.data, &header, sizeof( header ) );
+
+	ri.FS_WriteFile( R_WorldCacheName(), buf.data, buf.used );
+
+	R_CacheFree( &buf );
+}
+
+/*
+===============
+R_FixPatchCracks
+
+Stitches the patches together and evens out the LoD errors
+of shared vertices, or replays it all from the world cache
+===============
+*/
+static void R_FixPatchCracks( void )
+{
+	if ( r_worldCache->integer && R_LoadWorldCache() )
+	{
+		return;
+	}
+
+	R_CacheFree( &s_worldCacheStitches );
+	s_worldCacheRecording = r_worldCache->integer != 0;
+
+	if ( r_stitchCurves->integer )
+	{
+		R_StitchAllPatches();
+	}
+
+	R_FixSharedVertexLodError();
+
+	if ( s_worldCacheRecording )
+	{
+		R_SaveWorldCache();
+	}
+
+	s_worldCacheRecording = qfalse;
+	R_CacheFree( &s_worldCacheStitches );
+}
+
+/*
+=================
+BSPSurfaceCompare
+compare function for qsort()
+=================
+*/
+static int BSPSurfaceCompare( const void *a, const void *b )
+{
+	bspSurface_t *aa, *bb;
+
+	aa = * ( bspSurface_t ** ) a;
+	bb = * ( bspSurface_t ** ) b;
+
+	// shader first
+	if ( aa->shader < bb->shader )
+	{
+		return -1;
+	}
+
+	else if ( aa->shader > bb->shader )
+	{
+		return 1;
+	}
+
+	// by lightmap
+	if ( aa->lightmapNum < bb->lightmapNum )
+	{
+		return -1;
+	}
+
+	else if ( aa->lightmapNum > bb->lightmapNum )
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+static void CopyVert( const srfVert_t *in, srfVert_t *out )
+{
+	int j;
+
+	for ( j = 0; j < 3; j++ )
+	{
+		out->xyz[ j ] = in->xyz[ j ];
+		out->tangent[ j ] = in->tangent[ j ];
+		out->binormal[ j ] = in->binormal[ j ];
+		out->normal[ j ] = in->normal[ j ];
+#if !defined( COMPAT_Q3A ) && !defined( COMPAT_ET )
+		out->lightDirection[ j ] = in->lightDirection[ j ];
+#endif
+	}
+
+	for ( j = 0; j < 2; j++ )
+	{
+		out->st[ j ] = in->st[ j ];
+		out->lightmap[ j ] = in->lightmap[ j ];
+	}
+
+	for ( j = 0; j < 4; j++ )
+	{
+#if !defined( COMPAT_Q3A ) && !defined( COMPAT_ET )
+		out->paintColor[ j ] = in->paintColor[ j ];
+#endif
+		out->lightColor[ j ] = in->lightColor[ j ];
+	}
+
+#if DEBUG_OPTIMIZEVERTICES
+	out->id = in->id;
+#endif
+}
+
+#define EQUAL_EPSILON 0.001
+
+/*static qboolean CompareWorldVert(const srfVert_t * v1, const srfVert_t * v2)
+{
+        int             i;
+
+        for(i = 0; i < 3; i++)
+        {
+                //if(fabs(v1->xyz[i] - v2->xyz[i]) > EQUAL_EPSILON)
+                if(v1->xyz[i] != v2->xyz[i])
+                        return qfalse;
         }
 
         for(i = 0; i < 2; i++)
@@ -5700,6 +6221,154 @@ static void R_CreateSubModelVBOs( void )
 	}
 }
 
+/*
+=============================================================================
+
+LOAD TIMING
+
+=============================================================================
+*/
+
+#define MAX_WORLD_LOAD_PHASES 24
+
+typedef struct
+{
+	const char *name;
+	int        msec;
+} worldLoadPhase_t;
+
+static worldLoadPhase_t s_loadPhases[ MAX_WORLD_LOAD_PHASES ];
+static int              s_numLoadPhases;
+static int              s_loadPhaseStartTime;
+
+/*
+===============
+R_BeginLoadPhases
+===============
+*/
+static void R_BeginLoadPhases( void )
+{
+	s_numLoadPhases = 0;
+	s_loadPhaseStartTime = ri.Milliseconds();
+}
+
+/*
+===============
+R_EndLoadPhase
+
+Accounts the time since the last phase ended to the named one
+===============
+*/
+static void R_EndLoadPhase( const char *name )
+{
+	int time;
+
+	time = ri.Milliseconds();
+
+	if ( s_numLoadPhases < MAX_WORLD_LOAD_PHASES )
+	{
+		s_loadPhases[ s_numLoadPhases ].name = name;
+		s_loadPhases[ s_numLoadPhases ].msec = time - s_loadPhaseStartTime;
+		s_numLoadPhases++;
+	}
+
+	s_loadPhaseStartTime = time;
+}
+
+/*
+===============
+R_PrintLoadPhases
+===============
+*/
+static void R_PrintLoadPhases( void )
+{
+	char string[ 1024 ];
+	int  i, total;
+
+	if ( !r_speeds->integer )
+	{
+		return;
+	}
+
+	string[ 0 ] = '\0';
+
+	for ( i = 0, total = 0; i < s_numLoadPhases; i++ )
+	{
+		Q_strcat( string, sizeof( string ), va( "%i %s ", s_loadPhases[ i ].msec, s_loadPhases[ i ].name ) );
+		total += s_loadPhases[ i ].msec;
+	}
+
+	ri.Printf( PRINT_ALL, "world load: %s%i msec\n", string, total );
+}
+
+//==================================================================
+
+#define TANGENTS_JOB_SURFACES 64
+
+/*
+===============
+R_CalcWorldTangentsJob
+===============
+*/
+static void R_CalcWorldTangentsJob( void *data, int jobNum )
+{
+	bspSurface_t  *surface;
+	srfTriangle_t *triangles, *tri;
+	srfVert_t     *verts;
+	srfVert_t     *dv[ 3 ];
+	int           numTriangles;
+	int           i, j, last;
+
+	i = jobNum * TANGENTS_JOB_SURFACES;
+	last = MIN( i + TANGENTS_JOB_SURFACES, s_worldData.numSurfaces );
+
+	for ( surface = &s_worldData.surfaces[ i ]; i < last; i++, surface++ )
+	{
+		if ( *surface->data == SF_FACE )
+		{
+			srfSurfaceFace_t *face = ( srfSurfaceFace_t * ) surface->data;
+
+			numTriangles = face->numTriangles;
+			triangles = face->triangles;
+			verts = face->verts;
+		}
+		else if ( *surface->data == SF_TRIANGLES )
+		{
+			srfTriangles_t *tris = ( srfTriangles_t * ) surface->data;
+
+			numTriangles = tris->numTriangles;
+			triangles = tris->triangles;
+			verts = tris->verts;
+		}
+		else
+		{
+			continue;
+		}
+
+		for ( j = 0, tri = triangles; j < numTriangles; j++, tri++ )
+		{
+			dv[ 0 ] = &verts[ tri->indexes[ 0 ] ];
+			dv[ 1 ] = &verts[ tri->indexes[ 1 ] ];
+			dv[ 2 ] = &verts[ tri->indexes[ 2 ] ];
+
+			R_CalcTangentVectors( dv );
+		}
+	}
+}
+
+/*
+===============
+R_CalcWorldTangents
+
+Calculates the tangent vectors of the face and triangle surfaces,
+each job handles its own surfaces so they don't share any vertices
+===============
+*/
+static void R_CalcWorldTangents( void )
+{
+	GLimp_RunJobs( R_CalcWorldTangentsJob, NULL, ( s_worldData.numSurfaces + TANGENTS_JOB_SURFACES - 1 ) / TANGENTS_JOB_SURFACES );
+}
+
 /*
 ===============
 R_LoadSurfaces
@@ -5789,17 +6458,22 @@ static void R_LoadSurfaces( lump_t *surfs, lump_t *verts, lump_t *indexLump )
 	ri.Printf( PRINT_DEVELOPER, "...loaded %d faces, %i meshes, %i trisurfs, %i flares %i foliages\n", numFaces, numMeshes, numTriSurfs,
 	           numFlares, numFoliages );
 
-	if ( r_stitchCurves->integer )
+	R_EndLoadPhase( "surfaces" );
+
+	R_CalcWorldTangents();
+	R_EndLoadPhase( "tangents" );
+
+	if ( numMeshes )
 	{
-		R_StitchAllPatches();
+		R_FixPatchCracks();
 	}
 
-	R_FixSharedVertexLodError();
-
 	if ( r_stitchCurves->integer )
 	{
 		R_MovePatchSurfacesToHunk();
 	}
+
+	R_EndLoadPhase( "patches" );
 }
 
 /*
@@ -6127,7 +6801,300 @@ static void R_LoadNodesAndLeafs( lump_t *nodeLump, lump_t *leafLump )
 	tess.numVertexes = 0;
 }
 
-//=============================================================================
+/*
+=================
+R_SetupCullBounds
+
+Copies the node bounds and the spheres of the surfaces the leafs
+point to into the arrays R_CullBoxes and R_CullSpheres test
+=================
+*/
+static void R_SetupCullBounds( void )
+{
+	int          i, j, numNodes, numMarks;
+	float        *data;
+	bspNode_t    *node;
+	srfGeneric_t *gen;
+
+	// padded for the batches reading past the end
+	numNodes = s_worldData.numnodes + CULL_BATCH;
+	numMarks = s_worldData.numMarkSurfaces + CULL_BATCH;
+
+	data = ri.Hunk_Alloc( ( numNodes * 6 + numMarks * 4 ) * sizeof( float ), h_low );
+
+	for ( j = 0; j < 3; j++ )
+	{
+		s_worldData.nodeBounds.mins[ j ] = data;
+		data += numNodes;
+		s_worldData.nodeBounds.maxs[ j ] = data;
+		data += numNodes;
+		s_worldData.markSurfaceSpheres.origin[ j ] = data;
+		data += numMarks;
+	}
+
+	s_worldData.markSurfaceSpheres.radius = data;
+
+	s_worldData.nodeFrontBits = ri.Hunk_Alloc( numNodes, h_low );
+	s_worldData.nodeBackBits = ri.Hunk_Alloc( numNodes, h_low );
+	s_worldData.markSurfaceCulled = ri.Hunk_Alloc( numMarks, h_low );
+
+	for ( i = 0, node = s_worldData.nodes; i < s_worldData.numnodes; i++, node++ )
+	{
+		for ( j = 0; j < 3; j++ )
+		{
+			s_worldData.nodeBounds.mins[ j ][ i ] = node->mins[ j ];
+			s_worldData.nodeBounds.maxs[ j ][ i ] = node->maxs[ j ];
+		}
+	}
+
+	// only faces, grids and triangles are sphere culled
+	for ( i = 0; i < s_worldData.numMarkSurfaces; i++ )
+	{
+		gen = ( srfGeneric_t * ) s_worldData.markSurfaces[ i ]->data;
+
+		if ( gen->surfaceType != SF_FACE && gen->surfaceType != SF_GRID && gen->surfaceType != SF_TRIANGLES )
+		{
+			continue;
+		}
+
+		for ( j = 0; j < 3; j++ )
+		{
+			s_worldData.markSurfaceSpheres.origin[ j ][ i ] = gen->origin[ j ];
+		}
+
+		s_worldData.markSurfaceSpheres.radius[ i ] = gen->radius;
+	}
+}
+
+#define OCCLUDER_MIN_AREA 4096.0f // a 64x64 wall
+
+typedef struct
+{
+	float st[ 2 ];
+	int   index;
+} occluderPoint_t;
+
+/*
+=================
+OccluderPointCompare
+
+compare function for qsort()
+=================
+*/
+static int OccluderPointCompare( const void *a, const void *b )
+{
+	const occluderPoint_t *aa = ( const occluderPoint_t * ) a;
+	const occluderPoint_t *bb = ( const occluderPoint_t * ) b;
+
+	if ( aa->st[ 0 ] != bb->st[ 0 ] )
+	{
+		return aa->st[ 0 ] < bb->st[ 0 ] ? -1 : 1;
+	}
+
+	if ( aa->st[ 1 ] != bb->st[ 1 ] )
+	{
+		return aa->st[ 1 ] < bb->st[ 1 ] ? -1 : 1;
+	}
+
+	return 0;
+}
+
+/*
+=================
+R_OccluderCross
+=================
+*/
+static float R_OccluderCross( const occluderPoint_t *o, const occluderPoint_t *a, const occluderPoint_t *b )
+{
+	return ( a->st[ 0 ] - o->st[ 0 ] ) * ( b->st[ 1 ] - o->st[ 1 ] ) - ( a->st[ 1 ] - o->st[ 1 ] ) * ( b->st[ 0 ] - o->st[ 0 ] );
+}
+
+/*
+=================
+R_OccluderOutline
+
+Finds the convex outline of a face that is big enough to hide something,
+the rasterizer only marks the pixels a whole outline covers so concave
+faces are skipped. Returns the number of outline vertices written to
+indexes, 0 if the face can't be an occluder
+=================
+*/
+static int R_OccluderOutline( bspSurface_t *surface, int indexes[ MAX_OCCLUDER_VERTS ] )
+{
+	srfSurfaceFace_t *face;
+	srfTriangle_t    *tri;
+	shader_t         *shader;
+	occluderPoint_t  points[ MAX_OCCLUDER_VERTS * 2 ];
+	occluderPoint_t  hull[ MAX_OCCLUDER_VERTS * 2 + 1 ];
+	vec3_t           edge1, edge2, cross, right, up;
+	float            area, hullArea;
+	int              i, numHull, lower;
+
+	if ( *surface->data != SF_FACE )
+	{
+		return 0;
+	}
+
+	shader = surface->shader;
+
+	if ( shader->sort != SS_OPAQUE || shader->isSky || shader->isPortal || shader->alphaTest || shader->translucent ||
+	     shader->polygonOffset || shader->numDeforms || ( shader->surfaceFlags & SURF_NODRAW ) )
+	{
+		return 0;
+	}
+
+	face = ( srfSurfaceFace_t * ) surface->data;
+
+	if ( face->numVerts < 3 || face->numVerts > MAX_OCCLUDER_VERTS * 2 )
+	{
+		return 0;
+	}
+
+	area = 0;
+
+	for ( i = 0, tri = face->triangles; i < face->numTriangles; i++, tri++ )
+	{
+		VectorSubtract( face->verts[ tri->indexes[ 1 ] ].xyz, face->verts[ tri->indexes[ 0 ] ].xyz, edge1 );
+		VectorSubtract( face->verts[ tri->indexes[ 2 ] ].xyz, face->verts[ tri->indexes[ 0 ] ].xyz, edge2 );
+		CrossProduct( edge1, edge2, cross );
+		area += 0.5f * VectorLength( cross );
+	}
+
+	if ( area < OCCLUDER_MIN_AREA )
+	{
+		return 0;
+	}
+
+	// monotone chain hull in the plane of the face
+	PerpendicularVector( right, face->plane.normal );
+	CrossProduct( face->plane.normal, right, up );
+
+	for ( i = 0; i < face->numVerts; i++ )
+	{
+		points[ i ].st[ 0 ] = DotProduct( face->verts[ i ].xyz, right );
+		points[ i ].st[ 1 ] = DotProduct( face->verts[ i ].xyz, up );
+		points[ i ].index = i;
+	}
+
+	qsort( points, face->numVerts, sizeof( points[ 0 ] ), OccluderPointCompare );
+
+	numHull = 0;
+
+	for ( i = 0; i < face->numVerts; i++ )
+	{
+		while ( numHull >= 2 && R_OccluderCross( &hull[ numHull - 2 ], &hull[ numHull - 1 ], &points[ i ] ) <= 0 )
+		{
+			numHull--;
+		}
+
+		hull[ numHull++ ] = points[ i ];
+	}
+
+	for ( i = face->numVerts - 2, lower = numHull + 1; i >= 0; i-- )
+	{
+		while ( numHull >= lower && R_OccluderCross( &hull[ numHull - 2 ], &hull[ numHull - 1 ], &points[ i ] ) <= 0 )
+		{
+			numHull--;
+		}
+
+		hull[ numHull++ ] = points[ i ];
+	}
+
+	// the first point closes the loop
+	numHull--;
+
+	if ( numHull < 3 || numHull > MAX_OCCLUDER_VERTS )
+	{
+		return 0;
+	}
+
+	for ( i = 0, hullArea = 0; i < numHull; i++ )
+	{
+		hullArea += 0.5f * R_OccluderCross( &hull[ 0 ], &hull[ i ], &hull[ ( i + 1 ) % numHull ] );
+	}
+
+	if ( hullArea > area * 1.01f )
+	{
+		return 0;
+	}
+
+	for ( i = 0; i < numHull; i++ )
+	{
+		indexes[ i ] = hull[ i ].index;
+	}
+
+	return numHull;
+}
+
+/*
+=================
+R_SetupOccluders
+
+Copies the outlines of the world faces that are big enough
+to hide something for R_RenderOcclusionBuffer
+=================
+*/
+static void R_SetupOccluders( void )
+{
+	int              i, j, numVerts, numOutline;
+	int              outline[ MAX_OCCLUDER_VERTS ];
+	bspSurface_t     *surface;
+	srfSurfaceFace_t *face;
+	occluder_t       *occluder;
+	vec3_t           *vert;
+
+	s_worldData.surfaceOccluders = ri.Hunk_Alloc( s_worldData.numWorldSurfaces * sizeof( int ), h_low );
+	s_worldData.numOccluders = 0;
+	numVerts = 0;
+
+	for ( i = 0, surface = s_worldData.surfaces; i < s_worldData.numWorldSurfaces; i++, surface++ )
+	{
+		numOutline = R_OccluderOutline( surface, outline );
+
+		if ( numOutline )
+		{
+			s_worldData.surfaceOccluders[ i ] = s_worldData.numOccluders++;
+			numVerts += numOutline;
+		}
+		else
+		{
+			s_worldData.surfaceOccluders[ i ] = -1;
+		}
+	}
+
+	s_worldData.occluders = ri.Hunk_Alloc( s_worldData.numOccluders * sizeof( occluder_t ), h_low );
+	s_worldData.occluderVerts = ri.Hunk_Alloc( numVerts * sizeof( vec3_t ), h_low );
+
+	occluder = s_worldData.occluders;
+	vert = s_worldData.occluderVerts;
+
+	for ( i = 0, surface = s_worldData.surfaces; i < s_worldData.numWorldSurfaces; i++, surface++ )
+	{
+		if ( s_worldData.surfaceOccluders[ i ] < 0 )
+		{
+			continue;
+		}
+
+		face = ( srfSurfaceFace_t * ) surface->data;
+		numOutline = R_OccluderOutline( surface, outline );
+
+		VectorCopy( face->origin, occluder->origin );
+		occluder->radius = face->radius;
+		occluder->firstVert = vert - s_worldData.occluderVerts;
+		occluder->numVerts = numOutline;
+
+		for ( j = 0; j < numOutline; j++, vert++ )
+		{
+			VectorCopy( face->verts[ outline[ j ] ].xyz, *vert );
+		}
+
+		occluder++;
+	}
+
+	ri.Printf( PRINT_DEVELOPER, "%i occluders with %i outline vertices\n", s_worldData.numOccluders, numVerts );
+}
+
+//=============================================================================
 
 /*
 =================
@@ -7842,6 +8809,143 @@ static int UpdateLightTriangles( const srfVert_t *verts, int numTriangles, srfTr
 	return numFacing;
 }
 
+/*
+===============
+CountLightTriangles
+
+Counts the triangles R_UpdateLightTriangles found facing the light
+===============
+*/
+static int CountLightTriangles( int numTriangles, const srfTriangle_t *triangles )
+{
+	int i;
+	int numFacing;
+
+	numFacing = 0;
+
+	for ( i = 0; i < numTriangles; i++ )
+	{
+		if ( triangles[ i ].facingLight )
+		{
+			numFacing++;
+		}
+	}
+
+	return numFacing;
+}
+
+#define LIGHTTRIANGLES_JOB_SURFACES 16
+
+typedef struct
+{
+	trRefLight_t       *light;
+	interactionCache_t **caches;
+	int                numCaches;
+} lightTrianglesJobs_t;
+
+static void R_UpdateLightTrianglesJob( void *data, int job )
+{
+	const lightTrianglesJobs_t *jobs = ( const lightTrianglesJobs_t * ) data;
+	int                        first = job * LIGHTTRIANGLES_JOB_SURFACES;
+	int                        last = MIN( first + LIGHTTRIANGLES_JOB_SURFACES, jobs->numCaches );
+	bspSurface_t               *surface;
+	int                        i;
+
+	for ( i = first; i < last; i++ )
+	{
+		surface = jobs->caches[ i ]->surface;
+
+		if ( *surface->data == SF_FACE )
+		{
+			srfSurfaceFace_t *srf = ( srfSurfaceFace_t * ) surface->data;
+
+			UpdateLightTriangles( s_worldData.verts, srf->numTriangles, s_worldData.triangles + srf->firstTriangle, surface->shader, jobs->light );
+		}
+		else if ( *surface->data == SF_GRID )
+		{
+			srfGridMesh_t *srf = ( srfGridMesh_t * ) surface->data;
+
+			UpdateLightTriangles( s_worldData.verts, srf->numTriangles, s_worldData.triangles + srf->firstTriangle, surface->shader, jobs->light );
+		}
+		else if ( *surface->data == SF_TRIANGLES )
+		{
+			srfTriangles_t *srf = ( srfTriangles_t * ) surface->data;
+
+			UpdateLightTriangles( s_worldData.verts, srf->numTriangles, s_worldData.triangles + srf->firstTriangle, surface->shader, jobs->light );
+		}
+	}
+}
+
+/*
+===============
+R_UpdateLightTriangles
+
+Does the facing tests of all triangles touched by the light on the
+render worker threads. The result only depends on the light and the
+surface, so the mesh builders just count it instead of testing every
+triangle again for the light, shadow and each shadow cube side mesh.
+===============
+*/
+static void R_UpdateLightTriangles( trRefLight_t *light )
+{
+	lightTrianglesJobs_t jobs;
+	interactionCache_t   *iaCache;
+
+	jobs.light = light;
+	jobs.numCaches = 0;
+
+	for ( iaCache = light->firstInteractionCache; iaCache; iaCache = iaCache->next )
+	{
+		jobs.numCaches++;
+	}
+
+	if ( !jobs.numCaches )
+	{
+		return;
+	}
+
+	jobs.caches = ri.Hunk_AllocateTempMemory( jobs.numCaches * sizeof( jobs.caches[ 0 ] ) );
+	jobs.numCaches = 0;
+
+	for ( iaCache = light->firstInteractionCache; iaCache; iaCache = iaCache->next )
+	{
+		jobs.caches[ jobs.numCaches++ ] = iaCache;
+	}
+
+	GLimp_RunJobs( R_UpdateLightTrianglesJob, &jobs, ( jobs.numCaches + LIGHTTRIANGLES_JOB_SURFACES - 1 ) / LIGHTTRIANGLES_JOB_SURFACES );
+
+	ri.Hunk_FreeTempMemory( jobs.caches );
+}
+
+static qboolean           s_lightCacheRecording;
+static cacheBuffer_t s_lightCacheFile;
+static cacheBuffer_t s_lightCacheIBOs; // triangles of the IBOs created for the current light
+static unsigned int  s_lightCacheGeometry; // R_LightCacheGeometry before any light ran
+
+/*
+===============
+R_CreateInteractionIBO
+
+Keeps a copy of the triangles for the static light cache
+===============
+*/
+static IBO_t *R_CreateInteractionIBO( const char *name, int numTriangles, srfTriangle_t *triangles )
+{
+	int i;
+
+	if ( s_lightCacheRecording )
+	{
+		R_CacheWriteInt( &s_lightCacheIBOs, numTriangles );
+
+		for ( i = 0; i < numTriangles; i++ )
+		{
+			R_CacheWrite( &s_lightCacheIBOs, triangles[ i ].indexes, sizeof( triangles[ i ].indexes ) );
+		}
+	}
+
+	return R_CreateStaticIBO2( name, numTriangles, triangles );
+}
+
 /*
 ===============
 R_CreateVBOLightMeshes
@@ -7991,7 +9095,7 @@ static void R_CreateVBOLightMeshes( trRefLight_t *light )
 
 					if ( srf->numTriangles )
 					{
-						numLitTriangles = UpdateLightTriangles( s_worldData.verts, srf->numTriangles, s_worldData.triangles + srf->firstTriangle, surface->shader, light );
+						numLitTriangles = CountLightTriangles( srf->numTriangles, s_worldData.triangles + srf->firstTriangle );
 
 						if ( numLitTriangles )
 						{
@@ -8012,7 +9116,7 @@ static void R_CreateVBOLightMeshes( trRefLight_t *light )
 
 					if ( srf->numTriangles )
 					{
-						numLitTriangles = UpdateLightTriangles( s_worldData.verts, srf->numTriangles, s_worldData.triangles + srf->firstTriangle, surface->shader, light );
+						numLitTriangles = CountLightTriangles( srf->numTriangles, s_worldData.triangles + srf->firstTriangle );
 
 						if ( numLitTriangles )
 						{
@@ -8033,7 +9137,7 @@ static void R_CreateVBOLightMeshes( trRefLight_t *light )
 
 					if ( srf->numTriangles )
 					{
-						numLitTriangles = UpdateLightTriangles( s_worldData.verts, srf->numTriangles, s_worldData.triangles + srf->firstTriangle, surface->shader, light );
+						numLitTriangles = CountLightTriangles( srf->numTriangles, s_worldData.triangles + srf->firstTriangle );
 
 						if ( numLitTriangles )
 						{
@@ -8161,7 +9265,7 @@ static void R_CreateVBOLightMeshes( trRefLight_t *light )
 
 #endif
 			vboSurf->vbo = s_worldData.vbo;
-			vboSurf->ibo = R_CreateStaticIBO2( va( "staticLightMesh_IBO %i", c_vboLightSurfaces ), numTriangles, triangles );
+			vboSurf->ibo = R_CreateInteractionIBO( va( "staticLightMesh_IBO %i", c_vboLightSurfaces ), numTriangles, triangles );
 
 			ri.Hunk_FreeTempMemory( triangles );
 
@@ -8402,7 +9506,7 @@ static void R_CreateVBOShadowMeshes( trRefLight_t *light )
 
 					if ( srf->numTriangles )
 					{
-						numLitTriangles = UpdateLightTriangles( s_worldData.verts, srf->numTriangles, s_worldData.triangles + srf->firstTriangle, surface->shader, light );
+						numLitTriangles = CountLightTriangles( srf->numTriangles, s_worldData.triangles + srf->firstTriangle );
 
 						if ( numLitTriangles )
 						{
@@ -8423,7 +9527,7 @@ static void R_CreateVBOShadowMeshes( trRefLight_t *light )
 
 					if ( srf->numTriangles )
 					{
-						numLitTriangles = UpdateLightTriangles( s_worldData.verts, srf->numTriangles, s_worldData.triangles + srf->firstTriangle, surface->shader, light );
+						numLitTriangles = CountLightTriangles( srf->numTriangles, s_worldData.triangles + srf->firstTriangle );
 
 						if ( numLitTriangles )
 						{
@@ -8444,7 +9548,7 @@ static void R_CreateVBOShadowMeshes( trRefLight_t *light )
 
 					if ( srf->numTriangles )
 					{
-						numLitTriangles = UpdateLightTriangles( s_worldData.verts, srf->numTriangles, s_worldData.triangles + srf->firstTriangle, surface->shader, light );
+						numLitTriangles = CountLightTriangles( srf->numTriangles, s_worldData.triangles + srf->firstTriangle );
 
 						if ( numLitTriangles )
 						{
@@ -8593,7 +9697,7 @@ static void R_CreateVBOShadowMeshes( trRefLight_t *light )
 
 #endif
 			vboSurf->vbo = s_worldData.vbo;
-			vboSurf->ibo = R_CreateStaticIBO2( va( "staticShadowMesh_IBO %i", c_vboLightSurfaces ), numTriangles, triangles );
+			vboSurf->ibo = R_CreateInteractionIBO( va( "staticShadowMesh_IBO %i", c_vboLightSurfaces ), numTriangles, triangles );
 
 			ri.Hunk_FreeTempMemory( triangles );
 
@@ -8831,9 +9935,7 @@ static void R_CreateVBOShadowCubeMeshes( trRefLight_t *light )
 
 						if ( srf->numTriangles )
 						{
-							numTriangles +=
-							  UpdateLightTriangles( s_worldData.verts, srf->numTriangles,
-							                        s_worldData.triangles + srf->firstTriangle, surface->shader, light );
+							numTriangles += CountLightTriangles( srf->numTriangles, s_worldData.triangles + srf->firstTriangle );
 						}
 
 						if ( srf->numVerts )
@@ -8847,9 +9949,7 @@ static void R_CreateVBOShadowCubeMeshes( trRefLight_t *light )
 
 						if ( srf->numTriangles )
 						{
-							numTriangles +=
-							  UpdateLightTriangles( s_worldData.verts, srf->numTriangles,
-							                        s_worldData.triangles + srf->firstTriangle, surface->shader, light );
+							numTriangles += CountLightTriangles( srf->numTriangles, s_worldData.triangles + srf->firstTriangle );
 						}
 
 						if ( srf->numVerts )
@@ -8863,9 +9963,7 @@ static void R_CreateVBOShadowCubeMeshes( trRefLight_t *light )
 
 						if ( srf->numTriangles )
 						{
-							numTriangles +=
-							  UpdateLightTriangles( s_worldData.verts, srf->numTriangles,
-							                        s_worldData.triangles + srf->firstTriangle, surface->shader, light );
+							numTriangles += CountLightTriangles( srf->numTriangles, s_worldData.triangles + srf->firstTriangle );
 						}
 
 						if ( srf->numVerts )
@@ -9000,7 +10098,7 @@ static void R_CreateVBOShadowCubeMeshes( trRefLight_t *light )
 
 #endif
 					vboSurf->vbo = s_worldData.vbo;
-					vboSurf->ibo = R_CreateStaticIBO2( va( "staticShadowPyramidMesh_IBO %i", c_vboShadowSurfaces ), numTriangles, triangles );
+					vboSurf->ibo = R_CreateInteractionIBO( va( "staticShadowPyramidMesh_IBO %i", c_vboShadowSurfaces ), numTriangles, triangles );
 				}
 				else
 				{
@@ -9017,7 +10115,7 @@ static void R_CreateVBOShadowCubeMeshes( trRefLight_t *light )
 
 #endif
 					vboSurf->vbo = s_worldData.vbo;
-					vboSurf->ibo = R_CreateStaticIBO2( va( "staticShadowPyramidMesh_IBO %i", c_vboShadowSurfaces ), numTriangles, triangles );
+					vboSurf->ibo = R_CreateInteractionIBO( va( "staticShadowPyramidMesh_IBO %i", c_vboShadowSurfaces ), numTriangles, triangles );
 				}
 
 				ri.Hunk_FreeTempMemory( triangles );
@@ -9115,22 +10213,606 @@ static void R_CalcInteractionCubeSideBits( trRefLight_t *light )
 }
 
 /*
-=============
-R_PrecacheInteractions
-=============
-*/
-void R_PrecacheInteractions( void )
-{
-	int          i;
-	trRefLight_t *light;
-	bspSurface_t *surface;
-//	int             numLeafs;
-	int          startTime, endTime;
+=============================================================================
 
-	//if(r_precomputedLighting->integer)
-	//  return;
+STATIC LIGHT CACHE
 
-	startTime = ri.Milliseconds();
+The interactions and meshes R_PrecacheInteractions builds for the static
+lights are saved to maps/<map>.lightcache and loaded from there as long
+as the BSP and the shaders and cvars they depend on stay the same.
+
+=============================================================================
+*/
+
+#define LIGHTCACHE_IDENT   ( ( 'C' << 24 ) + ( 'I' << 16 ) + ( 'L' << 8 ) + 'X' ) // little-endian "XLIC"
+#define LIGHTCACHE_VERSION 2
+
+enum
+{
+  LIGHTMESH_LIGHT,
+  LIGHTMESH_SHADOW,
+  LIGHTMESH_SHADOWCUBE
+};
+
+typedef struct
+{
+	int          ident;
+	int          version;
+	unsigned int checksum; // of the BSP file
+	unsigned int settings; // of the cvars and shader properties the interactions depend on
+	unsigned int geometry; // of the world VBO the saved indexes point into
+	int          numSurfaces;
+	int          numNodes;
+	int          numVerts;
+	int          numTriangles;
+	int          numLights; // number of light records that follow
+} lightCacheHeader_t;
+
+/*
+===============
+R_LightCacheSettings
+
+Hashes everything besides the BSP itself that changes the result
+of R_PrecacheInteractions
+===============
+*/
+static unsigned int R_LightCacheSettings( void )
+{
+	int          i;
+	int          values[ 8 ];
+	unsigned int hash;
+	bspSurface_t *surface;
+	shader_t     *shader;
+
+	values[ 0 ] = r_vboLighting->integer;
+	values[ 1 ] = r_vboShadows->integer;
+	values[ 2 ] = r_deferredShading->integer;
+	values[ 3 ] = r_shadows->integer;
+	values[ 4 ] = r_precomputedLighting->integer;
+	values[ 5 ] = r_vertexLighting->integer;
+	values[ 6 ] = r_noShadowPyramids->integer;
+	values[ 7 ] = r_nocull->integer;
+
+	hash = R_CacheHash( R_WorldCacheSettings(), values, sizeof( values ) );
+	hash = R_CacheHash( hash, tr.sunDirection, sizeof( tr.sunDirection ) );
+
+	for ( i = 0, surface = s_worldData.surfaces; i < s_worldData.numSurfaces; i++, surface++ )
+	{
+		shader = surface->shader;
+
+		values[ 0 ] = shader->isSky;
+		values[ 1 ] = shader->interactLight;
+		values[ 2 ] = shader->noShadows;
+		values[ 3 ] = shader->isPortal;
+		values[ 4 ] = shader->alphaTest;
+		values[ 5 ] = shader->cullType;
+		values[ 6 ] = ShaderRequiresCPUDeforms( shader );
+		values[ 7 ] = *surface->data;
+
+		hash = R_CacheHash( hash, values, sizeof( values ) );
+	}
+
+	return hash;
+}
+
+/*
+===============
+R_LightCacheGeometry
+
+Hashes the world vertexes and triangles as they ended up in the world VBO,
+their order also depends on the shaders the surfaces were sorted by.
+Only the positions and indexes, the lights rewrite facingLight.
+===============
+*/
+static unsigned int R_LightCacheGeometry( void )
+{
+	int          i;
+	unsigned int hash;
+
+	hash = 2166136261u;
+
+	for ( i = 0; i < s_worldData.numVerts; i++ )
+	{
+		hash = R_CacheHash( hash, s_worldData.verts[ i ].xyz, sizeof( s_worldData.verts[ i ].xyz ) );
+	}
+
+	for ( i = 0; i < s_worldData.numTriangles; i++ )
+	{
+		hash = R_CacheHash( hash, s_worldData.triangles[ i ].indexes, sizeof( s_worldData.triangles[ i ].indexes ) );
+	}
+
+	return hash;
+}
+
+/*
+===============
+R_LightCacheInteraction
+
+Checks the interaction type and cube sides of a record
+===============
+*/
+static qboolean R_LightCacheInteraction( int type, int cubeSideBits )
+{
+	return type >= IA_DEFAULT && type <= IA_LIGHTONLY && cubeSideBits >= 0 && cubeSideBits <= CUBESIDE_CLIPALL;
+}
+
+/*
+===============
+R_WriteLightCacheRecord
+
+Saves what R_PrecacheInteractions built for the light, returns qfalse
+if it can't be saved
+===============
+*/
+static qboolean R_WriteLightCacheRecord( trRefLight_t *light, int lightNum )
+{
+	cacheBuffer_t *buf = &s_lightCacheFile;
+	interactionCache_t *iaCache;
+	interactionVBO_t   *iaVBO;
+	srfVBOMesh_t       *mesh;
+	link_t             *l;
+	int                count, kind, shaderSurface;
+	int                iboPos, numTriangles;
+
+	R_CacheWriteInt( buf, lightNum );
+
+	// interactions
+	for ( count = 0, iaCache = light->firstInteractionCache; iaCache; iaCache = iaCache->next )
+	{
+		count++;
+	}
+
+	R_CacheWriteInt( buf, count );
+
+	for ( iaCache = light->firstInteractionCache; iaCache; iaCache = iaCache->next )
+	{
+		R_CacheWriteInt( buf, iaCache->surface - s_worldData.surfaces );
+		R_CacheWriteInt( buf, iaCache->type );
+		R_CacheWriteInt( buf, iaCache->cubeSideBits );
+		R_CacheWriteInt( buf, ( iaCache->redundant ? 1 : 0 ) | ( iaCache->mergedIntoVBO ? 2 : 0 ) );
+	}
+
+	// leafs, oldest first so that they can be linked in again in the same order
+	for ( count = 0, l = light->leafs.prev; l && l != &light->leafs && l->data; l = l->prev )
+	{
+		count++;
+	}
+
+	R_CacheWriteInt( buf, count );
+
+	for ( l = light->leafs.prev; l && l != &light->leafs && l->data; l = l->prev )
+	{
+		R_CacheWriteInt( buf, ( bspNode_t * ) l->data - s_worldData.nodes );
+	}
+
+	// meshes, their triangles were kept by R_CreateInteractionIBO in the same order
+	for ( count = 0, iaVBO = light->firstInteractionVBO; iaVBO; iaVBO = iaVBO->next )
+	{
+		count++;
+	}
+
+	R_CacheWriteInt( buf, count );
+
+	iboPos = 0;
+
+	for ( iaVBO = light->firstInteractionVBO; iaVBO; iaVBO = iaVBO->next )
+	{
+		if ( iaVBO->vboLightMesh )
+		{
+			kind = LIGHTMESH_LIGHT;
+			mesh = iaVBO->vboLightMesh;
+		}
+		else if ( iaVBO->vboShadowMesh && !iaVBO->cubeSideBits )
+		{
+			kind = LIGHTMESH_SHADOW;
+			mesh = iaVBO->vboShadowMesh;
+		}
+		else if ( iaVBO->vboShadowMesh )
+		{
+			kind = LIGHTMESH_SHADOWCUBE;
+			mesh = iaVBO->vboShadowMesh;
+		}
+		else
+		{
+			return qfalse;
+		}
+
+		// the shader is saved as one of the surfaces using it
+		shaderSurface = -1;
+
+		for ( iaCache = light->firstInteractionCache; iaCache; iaCache = iaCache->next )
+		{
+			if ( iaCache->surface->shader == iaVBO->shader )
+			{
+				shaderSurface = iaCache->surface - s_worldData.surfaces;
+				break;
+			}
+		}
+
+		if ( shaderSurface < 0 || iboPos + ( int ) sizeof( int ) > s_lightCacheIBOs.used )
+		{
+			return qfalse;
+		}
+
+		Com_Memcpy( &numTriangles, s_lightCacheIBOs.data + iboPos, sizeof( int ) );
+		iboPos += sizeof( int );
+
+		if ( numTriangles * 3 != mesh->numIndexes )
+		{
+			return qfalse;
+		}
+
+		R_CacheWriteInt( buf, kind );
+		R_CacheWriteInt( buf, iaVBO->type );
+		R_CacheWriteInt( buf, iaVBO->cubeSideBits );
+		R_CacheWriteInt( buf, shaderSurface );
+		R_CacheWriteInt( buf, mesh->numVerts );
+		R_CacheWrite( buf, mesh->bounds, sizeof( mesh->bounds ) );
+		R_CacheWriteInt( buf, numTriangles );
+		R_CacheWrite( buf, s_lightCacheIBOs.data + iboPos, numTriangles * 3 * sizeof( int ) );
+
+		iboPos += numTriangles * 3 * sizeof( int );
+	}
+
+	if ( iboPos != s_lightCacheIBOs.used )
+	{
+		return qfalse;
+	}
+
+	s_lightCacheIBOs.used = 0;
+
+	return qtrue;
+}
+
+/*
+===============
+R_ReadLightCacheRecord
+
+Checks the record of the light if apply is qfalse,
+otherwise creates the interactions and meshes from it
+===============
+*/
+static qboolean R_ReadLightCacheRecord( cacheReader_t *reader, trRefLight_t *light, int lightNum, qboolean apply )
+{
+	interactionCache_t *iaCache;
+	interactionVBO_t   *iaVBO;
+	srfVBOMesh_t       *vboSurf;
+	srfTriangle_t      *triangles;
+	link_t             *l;
+	const char         *name;
+	int                i, j, count, value, kind, numTriangles;
+
+	if ( R_CacheReadInt( reader ) != lightNum )
+	{
+		return qfalse;
+	}
+
+	// interactions
+	count = R_CacheReadInt( reader );
+
+	if ( count < 0 || count > s_worldData.numSurfaces )
+	{
+		return qfalse;
+	}
+
+	for ( i = 0; i < count; i++ )
+	{
+		value = R_CacheReadInt( reader );
+
+		if ( value < 0 || value >= s_worldData.numSurfaces )
+		{
+			return qfalse;
+		}
+
+		if ( apply )
+		{
+			R_PrecacheInteraction( light, &s_worldData.surfaces[ value ] );
+			iaCache = light->lastInteractionCache;
+
+			iaCache->type = ( interactionType_t ) R_CacheReadInt( reader );
+			iaCache->cubeSideBits = R_CacheReadInt( reader );
+			value = R_CacheReadInt( reader );
+			iaCache->redundant = ( value & 1 ) ? qtrue : qfalse;
+			iaCache->mergedIntoVBO = ( value & 2 ) ? qtrue : qfalse;
+		}
+		else
+		{
+			value = R_CacheReadInt( reader );
+
+			if ( !R_LightCacheInteraction( value, R_CacheReadInt( reader ) ) )
+			{
+				return qfalse;
+			}
+
+			R_CacheReadInt( reader );
+		}
+	}
+
+	// leafs
+	count = R_CacheReadInt( reader );
+
+	if ( count < 0 || count > s_worldData.numnodes )
+	{
+		return qfalse;
+	}
+
+	for ( i = 0; i < count; i++ )
+	{
+		value = R_CacheReadInt( reader );
+
+		if ( value < 0 || value >= s_worldData.numnodes )
+		{
+			return qfalse;
+		}
+
+		if ( apply )
+		{
+			l = ( link_t * ) ri.Hunk_Alloc( sizeof( *l ), h_low );
+			InitLink( l, &s_worldData.nodes[ value ] );
+
+			InsertLink( l, &light->leafs );
+
+			light->leafs.numElements++;
+		}
+	}
+
+	// meshes
+	count = R_CacheReadInt( reader );
+
+	if ( count < 0 || reader->overflow )
+	{
+		return qfalse;
+	}
+
+	for ( i = 0; i < count; i++ )
+	{
+		kind = R_CacheReadInt( reader );
+
+		if ( kind < LIGHTMESH_LIGHT || kind > LIGHTMESH_SHADOWCUBE )
+		{
+			return qfalse;
+		}
+
+		if ( apply )
+		{
+			iaVBO = R_CreateInteractionVBO( light );
+			iaVBO->type = ( interactionType_t ) R_CacheReadInt( reader );
+			iaVBO->cubeSideBits = R_CacheReadInt( reader );
+			iaVBO->shader = s_worldData.surfaces[ R_CacheReadInt( reader ) ].shader;
+
+			vboSurf = ri.Hunk_Alloc( sizeof( *vboSurf ), h_low );
+			vboSurf->surfaceType = SF_VBO_MESH;
+			vboSurf->numVerts = R_CacheReadInt( reader );
+			vboSurf->lightmapNum = -1;
+
+			Com_Memcpy( vboSurf->bounds, reader->data + reader->pos, sizeof( vboSurf->bounds ) );
+			reader->pos += sizeof( vboSurf->bounds );
+
+			numTriangles = R_CacheReadInt( reader );
+			vboSurf->numIndexes = numTriangles * 3;
+
+			triangles = ri.Hunk_AllocateTempMemory( numTriangles * sizeof( srfTriangle_t ) );
+
+			for ( j = 0; j < numTriangles; j++ )
+			{
+				Com_Memcpy( triangles[ j ].indexes, reader->data + reader->pos, sizeof( triangles[ j ].indexes ) );
+				reader->pos += sizeof( triangles[ j ].indexes );
+			}
+
+			switch ( kind )
+			{
+				case LIGHTMESH_LIGHT:
+					name = va( "staticLightMesh_IBO %i", c_vboLightSurfaces++ );
+					iaVBO->vboLightMesh = vboSurf;
+					break;
+
+				case LIGHTMESH_SHADOW:
+					name = va( "staticShadowMesh_IBO %i", c_vboLightSurfaces );
+					iaVBO->vboShadowMesh = vboSurf;
+					c_vboShadowSurfaces++;
+					break;
+
+				default:
+					name = va( "staticShadowPyramidMesh_IBO %i", c_vboShadowSurfaces++ );
+					iaVBO->vboShadowMesh = vboSurf;
+					break;
+			}
+
+			vboSurf->vbo = s_worldData.vbo;
+			vboSurf->ibo = R_CreateStaticIBO2( name, numTriangles, triangles );
+
+			ri.Hunk_FreeTempMemory( triangles );
+		}
+		else
+		{
+			value = R_CacheReadInt( reader );
+
+			if ( !R_LightCacheInteraction( value, R_CacheReadInt( reader ) ) )
+			{
+				return qfalse;
+			}
+
+			value = R_CacheReadInt( reader );
+
+			if ( value < 0 || value >= s_worldData.numSurfaces )
+			{
+				return qfalse;
+			}
+
+			R_CacheReadInt( reader );
+			reader->pos += sizeof( vboSurf->bounds );
+
+			numTriangles = R_CacheReadInt( reader );
+
+			if ( numTriangles <= 0 || reader->overflow || numTriangles > ( reader->size - reader->pos ) / ( 3 * ( int ) sizeof( int ) ) )
+			{
+				return qfalse;
+			}
+
+			for ( j = 0; j < numTriangles * 3; j++ )
+			{
+				value = R_CacheReadInt( reader );
+
+				if ( value < 0 || value >= s_worldData.numVerts )
+				{
+					return qfalse;
+				}
+			}
+		}
+	}
+
+	return !reader->overflow;
+}
+
+/*
+===============
+R_LightCacheName
+===============
+*/
+static const char *R_LightCacheName( void )
+{
+	return va( "maps/%s.lightcache", s_worldData.baseName );
+}
+
+/*
+===============
+R_LightCacheLightSkipped
+===============
+*/
+static qboolean R_LightCacheLightSkipped( trRefLight_t *light )
+{
+	return ( r_precomputedLighting->integer || r_vertexLighting->integer ) && !light->noRadiosity;
+}
+
+/*
+===============
+R_LoadLightCache
+
+Reads and checks the static light cache, returns NULL if there is
+none that matches the map
+===============
+*/
+static byte *R_LoadLightCache( cacheReader_t *reader )
+{
+	lightCacheHeader_t header;
+	byte               *buffer;
+	int                length;
+	int                i, numLights;
+
+	length = ri.FS_ReadFile( R_LightCacheName(), ( void ** ) &buffer );
+
+	if ( !buffer )
+	{
+		return NULL;
+	}
+
+	for ( i = 0, numLights = 0; i < s_worldData.numLights; i++ )
+	{
+		if ( !R_LightCacheLightSkipped( &s_worldData.lights[ i ] ) )
+		{
+			numLights++;
+		}
+	}
+
+	if ( length < ( int ) sizeof( header ) )
+	{
+		ri.FS_FreeFile( buffer );
+		return NULL;
+	}
+
+	Com_Memcpy( &header, buffer, sizeof( header ) );
+
+	if ( header.ident != LIGHTCACHE_IDENT || header.version != LIGHTCACHE_VERSION ||
+	     header.checksum != s_worldChecksum || header.settings != R_LightCacheSettings() ||
+	     header.numSurfaces != s_worldData.numSurfaces || header.numNodes != s_worldData.numnodes ||
+	     header.numVerts != s_worldData.numVerts || header.numTriangles != s_worldData.numTriangles ||
+	     header.geometry != s_lightCacheGeometry || header.numLights != numLights )
+	{
+		ri.Printf( PRINT_DEVELOPER, "%s is out of date\n", R_LightCacheName() );
+		ri.FS_FreeFile( buffer );
+		return NULL;
+	}
+
+	reader->data = buffer;
+	reader->size = length;
+	reader->pos = sizeof( header );
+	reader->overflow = qfalse;
+
+	// check it all before anything is created from it
+	for ( i = 0; i < s_worldData.numLights; i++ )
+	{
+		if ( R_LightCacheLightSkipped( &s_worldData.lights[ i ] ) )
+		{
+			continue;
+		}
+
+		if ( !R_ReadLightCacheRecord( reader, &s_worldData.lights[ i ], i, qfalse ) )
+		{
+			ri.Printf( PRINT_WARNING, "WARNING: %s is corrupt\n", R_LightCacheName() );
+			ri.FS_FreeFile( buffer );
+			return NULL;
+		}
+	}
+
+	reader->pos = sizeof( header );
+
+	return buffer;
+}
+
+/*
+===============
+R_SaveLightCache
+===============
+*/
+static void R_SaveLightCache( int numLights )
+{
+	lightCacheHeader_t header;
+
+	// the next load compares against the keys from before lighting,
+	// a file they can't match would only be written again every time
+	if ( R_LightCacheGeometry() != s_lightCacheGeometry )
+	{
+		ri.Printf( PRINT_WARNING, "WARNING: world geometry changed while lighting, not writing %s\n", R_LightCacheName() );
+		return;
+	}
+
+	header.ident = LIGHTCACHE_IDENT;
+	header.version = LIGHTCACHE_VERSION;
+	header.checksum = s_worldChecksum;
+	header.settings = R_LightCacheSettings();
+	header.geometry = s_lightCacheGeometry;
+	header.numSurfaces = s_worldData.numSurfaces;
+	header.numNodes = s_worldData.numnodes;
+	header.numVerts = s_worldData.numVerts;
+	header.numTriangles = s_worldData.numTriangles;
+	header.numLights = numLights;
+
+	Com_Memcpy( s_lightCacheFile.data, &header, sizeof( header ) );
+
+	ri.FS_WriteFile( R_LightCacheName(), s_lightCacheFile.data, s_lightCacheFile.used );
+}
+
+/*
+=============
+R_PrecacheInteractions
+=============
+*/
+void R_PrecacheInteractions( void )
+{
+	int                i;
+	trRefLight_t       *light;
+	bspSurface_t       *surface;
+//	int             numLeafs;
+	int                startTime, endTime;
+	byte               *cache;
+	int                numCachedLights;
+	cacheReader_t reader;
+	lightCacheHeader_t header;
+
+	//if(r_precomputedLighting->integer)
+	//  return;
+
+	startTime = ri.Milliseconds();
 
 	// reset surfaces' viewCount
 	s_lightCount = 0;
@@ -9147,13 +10829,27 @@ void R_PrecacheInteractions( void )
 	c_vboLightSurfaces = 0;
 	c_vboShadowSurfaces = 0;
 
+	s_lightCacheGeometry = r_lightCache->integer ? R_LightCacheGeometry() : 0;
+	cache = r_lightCache->integer ? R_LoadLightCache( &reader ) : NULL;
+	numCachedLights = 0;
+
+	// keep everything that is built for the cache file
+	s_lightCacheRecording = r_lightCache->integer && !cache;
+
+	if ( s_lightCacheRecording )
+	{
+		// the header is filled in once all lights are done
+		Com_Memset( &header, 0, sizeof( header ) );
+		R_CacheWrite( &s_lightCacheFile, &header, sizeof( header ) );
+	}
+
 	ri.Printf( PRINT_DEVELOPER, "...precaching %i lights\n", s_worldData.numLights );
 
 	for ( i = 0; i < s_worldData.numLights; i++ )
 	{
 		light = &s_worldData.lights[ i ];
 
-		if ( ( r_precomputedLighting->integer || r_vertexLighting->integer ) && !light->noRadiosity )
+		if ( R_LightCacheLightSkipped( light ) )
 		{
 			continue;
 		}
@@ -9197,6 +10893,15 @@ void R_PrecacheInteractions( void )
 		// perform culling and add all the potentially visible surfaces
 		s_lightCount++;
 		QueueInit( &light->leafs );
+
+		numCachedLights++;
+
+		if ( cache )
+		{
+			R_ReadLightCacheRecord( &reader, light, i, qtrue );
+			continue;
+		}
+
 		R_RecursivePrecacheInteractionNode( s_worldData.nodes, light );
 		//ri.Printf(PRINT_ALL, "light %i touched %i leaves\n", i, QueueSize(&light->leafs));
 
@@ -9207,6 +10912,9 @@ void R_PrecacheInteractions( void )
 		R_KillRedundantInteractions( light );
 #endif
 
+		// find the triangles facing the light for the mesh builders
+		R_UpdateLightTriangles( light );
+
 		// create a static VBO surface for each light geometry batch
 		R_CreateVBOLightMeshes( light );
 
@@ -9218,8 +10926,28 @@ void R_PrecacheInteractions( void )
 
 		// create a static VBO surface for each light geometry batch inside a cubemap pyramid
 		R_CreateVBOShadowCubeMeshes( light );
+
+		if ( s_lightCacheRecording && !R_WriteLightCacheRecord( light, i ) )
+		{
+			ri.Printf( PRINT_WARNING, "WARNING: couldn't save light %i to %s\n", i, R_LightCacheName() );
+			s_lightCacheRecording = qfalse;
+		}
 	}
 
+	if ( cache )
+	{
+		ri.Printf( PRINT_DEVELOPER, "...loaded %i lights from %s\n", numCachedLights, R_LightCacheName() );
+		ri.FS_FreeFile( cache );
+	}
+	else if ( s_lightCacheRecording && numCachedLights )
+	{
+		R_SaveLightCache( numCachedLights );
+	}
+
+	s_lightCacheRecording = qfalse;
+	R_CacheFree( &s_lightCacheFile );
+	R_CacheFree( &s_lightCacheIBOs );
+
 	// move interactions grow list to hunk
 	s_worldData.numInteractions = s_interactions.currentElements;
 	s_worldData.interactions = ri.Hunk_Alloc( s_worldData.numInteractions * sizeof( *s_worldData.interactions ), h_low );
@@ -10120,6 +11848,7 @@ Called directly from cgame
 void RE_LoadWorldMap( const char *name )
 {
 	int       i;
+	int       length;
 	dheader_t *header;
 	byte      *buffer;
 	byte      *startMarker;
@@ -10168,13 +11897,15 @@ void RE_LoadWorldMap( const char *name )
 	tr.worldMapLoaded = qtrue;
 
 	// load it
-	ri.FS_ReadFile( name, ( void ** ) &buffer );
+	length = ri.FS_ReadFile( name, ( void ** ) &buffer );
 
 	if ( !buffer )
 	{
 		ri.Error( ERR_DROP, "RE_LoadWorldMap: %s not found", name );
 	}
 
+	s_worldChecksum = R_CacheHash( 2166136261u, buffer, length );
+
 	// clear tr.world so if the level fails to load, the next
 	// try will not look at the partially loaded version
 	tr.world = NULL;
@@ -10210,48 +11941,66 @@ void RE_LoadWorldMap( const char *name )
 	}
 
 	// load into heap
+	R_BeginLoadPhases();
+
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadEntities( &header->lumps[ LUMP_ENTITIES ] );
+	R_EndLoadPhase( "entities" );
 
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadShaders( &header->lumps[ LUMP_SHADERS ] );
+	R_EndLoadPhase( "shaders" );
 
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadLightmaps( &header->lumps[ LUMP_LIGHTMAPS ], name );
+	R_EndLoadPhase( "lightmaps" );
 
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadPlanes( &header->lumps[ LUMP_PLANES ] );
+	R_EndLoadPhase( "planes" );
 
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadSurfaces( &header->lumps[ LUMP_SURFACES ], &header->lumps[ LUMP_DRAWVERTS ], &header->lumps[ LUMP_DRAWINDEXES ] );
 
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadMarksurfaces( &header->lumps[ LUMP_LEAFSURFACES ] );
+	R_EndLoadPhase( "marksurfaces" );
 
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadNodesAndLeafs( &header->lumps[ LUMP_NODES ], &header->lumps[ LUMP_LEAFS ] );
+	R_SetupCullBounds();
+	R_EndLoadPhase( "nodes" );
 
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadSubmodels( &header->lumps[ LUMP_MODELS ] );
+	R_EndLoadPhase( "submodels" );
+
+	R_SetupOccluders();
+	R_EndLoadPhase( "occluders" );
 
 	// moved fog lump loading here, so fogs can be tagged with a model num
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadFogs( &header->lumps[ LUMP_FOGS ], &header->lumps[ LUMP_BRUSHES ], &header->lumps[ LUMP_BRUSHSIDES ] );
+	R_EndLoadPhase( "fogs" );
 
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadVisibility( &header->lumps[ LUMP_VISIBILITY ] );
+	R_EndLoadPhase( "visibility" );
 
 //	ri.Cmd_ExecuteText(EXEC_NOW, "updatescreen\n");
 	R_LoadLightGrid( &header->lumps[ LUMP_LIGHTGRID ] );
+	R_EndLoadPhase( "lightgrid" );
 
 	// create static VBOS from the world
 	R_CreateWorldVBO();
 	R_CreateClusters();
 	R_CreateSubModelVBOs();
+	R_EndLoadPhase( "vbos" );
 
 	// we precache interactions between lights and surfaces
 	// to reduce the polygon count
 	R_PrecacheInteractions();
+	R_EndLoadPhase( "interactions" );
 
 	s_worldData.dataSize = ( byte * ) ri.Hunk_Alloc( 0, h_low ) - startMarker;
 
@@ -10288,4 +12037,6 @@ void RE_LoadWorldMap( const char *name )
 	ClearLink( &tr.occlusionQueryList );
 
 	ri.FS_FreeFile( buffer );
-}
+
+	R_PrintLoadPhases();
+}
\ No newline at end of file
@@ -151,6 +151,11 @@ void R_PerformanceCounters( void )
 		           tr.pc.c_decalProjectors, tr.pc.c_decalTestSurfaces, tr.pc.c_decalClipSurfaces, tr.pc.c_decalSurfaces,
 		           tr.pc.c_decalSurfacesCreated );
 	}
+	else if ( r_speeds->integer == RSPEEDS_SOFTWARE_OCCLUSION )
+	{
+		ri.Printf( PRINT_ALL, "occluders:%i culled nodes:%i culled entities:%i buffer time:%i\n",
+		           tr.pc.c_occluders, tr.pc.c_occludedNodes, tr.pc.c_occludedEntities, tr.pc.c_occlusionBufferTime );
+	}
 
 	Com_Memset( &tr.pc, 0, sizeof( tr.pc ) );
 	Com_Memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
@@ -540,6 +545,174 @@ void RE_StretchPic ( float x, float y, float w, float h,
 	cmd->t2 = t2;
 }
 
+/*
+=============
+R_AddStretchPicsCmd
+=============
+*/
+static void R_AddStretchPicsCmd( const stretchPic_t *pics, int numPics, shader_t *shader )
+{
+	renderCommandList_t  *cmdList = &backEndData[ tr.smpFrame ]->commands;
+	stretchPicsCommand_t *cmd;
+	stretchPic_t         *out, *first;
+	int                  i;
+
+	cmd = R_GetCommandBuffer( sizeof( *cmd ) + PAD( numPics * sizeof( stretchPic_t ), sizeof( void * ) ) );
+	if ( !cmd )
+	{
+		return;
+	}
+
+	out = first = ( stretchPic_t * )( cmd + 1 );
+
+	for ( i = 0; i < numPics; i++ )
+	{
+		*out = pics[ i ];
+
+		if ( !R_ClipRegion( &out->x, &out->y, &out->w, &out->h, &out->s1, &out->t1, &out->s2, &out->t2 ) )
+		{
+			out++;
+		}
+	}
+
+	// give back the room taken by the clipped quads
+	cmdList->used -= PAD( numPics * sizeof( stretchPic_t ), sizeof( void * ) ) - PAD( ( out - first ) * sizeof( stretchPic_t ), sizeof( void * ) );
+
+	if ( out == first )
+	{
+		cmdList->used -= sizeof( *cmd );
+		return;
+	}
+
+	cmd->commandId = RC_STRETCH_PICS;
+	cmd->shader = shader;
+	cmd->numPics = out - first;
+}
+
+/*
+=============
+RE_StretchPics
+
+Draws a run of quads which share a shader, each modulated by its own
+colour rather than the one set by RE_SetColor
+=============
+*/
+void RE_StretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader )
+{
+	shader_t *shader;
+	int      count;
+
+	if ( !tr.registered )
+	{
+		return;
+	}
+
+	shader = R_GetShaderByHandle( hShader );
+
+	for ( ; numPics > 0; numPics -= count, pics += count )
+	{
+		count = MIN( numPics, MAX_STRETCH_PICS );
+		R_AddStretchPicsCmd( pics, count, shader );
+	}
+}
+
+/*
+=============
+R_StretchPicBench_f
+
+Times queueing quads the way text used to be drawn, each after a
+colour change, against queueing them as runs. The commands are
+dropped again rather than drawn, so this measures the front end on
+whatever context the renderer has, a software one included.
+=============
+*/
+void R_StretchPicBench_f( void )
+{
+	renderCommandList_t *cmdList = &backEndData[ tr.smpFrame ]->commands;
+	stretchPic_t        *pics, *pic;
+	vec4_t              color;
+	int                 numPics, frames, maxPics, used;
+	int                 i, j, start, msec, bytes;
+
+	if ( !tr.registered )
+	{
+		return;
+	}
+
+	numPics = ri.Cmd_Argc() > 1 ? atoi( ri.Cmd_Argv( 1 ) ) : 2000;
+	frames = ri.Cmd_Argc() > 2 ? atoi( ri.Cmd_Argv( 2 ) ) : 1000;
+
+	// the commands of a frame have to fit, in what is left of the command buffer
+	maxPics = MAX( MAX_RENDER_COMMANDS - cmdList->used - 1024, 0 ) / ( int )( sizeof( setColorCommand_t ) + sizeof( stretchPicCommand_t ) );
+
+	if ( maxPics < 1 )
+	{
+		ri.Printf( PRINT_WARNING, "stretchpicbench: the command buffer is full\n" );
+		return;
+	}
+
+	numPics = Com_Clamp( 1, maxPics, numPics );
+	frames = MAX( frames, 1 );
+
+	pics = ri.Hunk_AllocateTempMemory( numPics * sizeof( stretchPic_t ) );
+
+	// lines of 10x16 glyphs in a few colours
+	for ( i = 0, pic = pics; i < numPics; i++, pic++ )
+	{
+		pic->x = ( i % 100 ) * 10;
+		pic->y = ( i / 100 % 40 ) * 18;
+		pic->w = 10;
+		pic->h = 16;
+		pic->s1 = ( i % 16 ) / 16.0f;
+		pic->t1 = ( i / 16 % 16 ) / 16.0f;
+		pic->s2 = pic->s1 + 1 / 16.0f;
+		pic->t2 = pic->t1 + 1 / 16.0f;
+		pic->modulate[ 0 ] = ( i / 7 & 1 ) ? 255 : 0;
+		pic->modulate[ 1 ] = ( i / 11 & 1 ) ? 255 : 128;
+		pic->modulate[ 2 ] = 255;
+		pic->modulate[ 3 ] = 255;
+	}
+
+	used = cmdList->used;
+	start = ri.Milliseconds();
+
+	for ( j = 0; j < frames; j++ )
+	{
+		for ( i = 0, pic = pics; i < numPics; i++, pic++ )
+		{
+			color[ 0 ] = pic->modulate[ 0 ] * ( 1.0f / 255.0f );
+			color[ 1 ] = pic->modulate[ 1 ] * ( 1.0f / 255.0f );
+			color[ 2 ] = pic->modulate[ 2 ] * ( 1.0f / 255.0f );
+			color[ 3 ] = pic->modulate[ 3 ] * ( 1.0f / 255.0f );
+			RE_SetColor( color );
+			RE_StretchPic( pic->x, pic->y, pic->w, pic->h, pic->s1, pic->t1, pic->s2, pic->t2, 0 );
+		}
+
+		bytes = cmdList->used - used;
+		cmdList->used = used;
+	}
+
+	msec = ri.Milliseconds() - start;
+	ri.Printf( PRINT_ALL, "%6i msec for %i frames of %i quads one at a time, %i bytes of commands a frame\n",
+	           msec, frames, numPics, bytes );
+
+	start = ri.Milliseconds();
+
+	for ( j = 0; j < frames; j++ )
+	{
+		RE_StretchPics( pics, numPics, 0 );
+
+		bytes = cmdList->used - used;
+		cmdList->used = used;
+	}
+
+	msec = ri.Milliseconds() - start;
+	ri.Printf( PRINT_ALL, "%6i msec for %i frames of %i quads in runs, %i bytes of commands a frame\n",
+	           msec, frames, numPics, bytes );
+
+	ri.Hunk_FreeTempMemory( pics );
+}
+
 /*
 =============
 RE_2DPolyies
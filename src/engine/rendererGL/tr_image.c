@@ -1589,6 +1589,22 @@ image_t *R_CreateGlyph( const char *name, const byte *pic, int width, int height
 	return image;
 }
 
+/*
+================
+R_UpdateGlyph
+
+Replaces whole rows of an image made by R_CreateGlyph
+================
+*/
+void R_UpdateGlyph( image_t *image, const byte *pic, int y, int height )
+{
+	GL_Bind( image );
+
+	glTexSubImage2D( GL_TEXTURE_2D, 0, 0, y, image->width, height, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, pic );
+
+	GL_CheckErrors();
+}
+
 /*
 ================
 R_CreateCubeImage
@@ -156,6 +156,10 @@ extern "C" {
 	cvar_t      *r_debugShadowMaps;
 	cvar_t      *r_noShadowFrustums;
 	cvar_t      *r_noLightFrustums;
+	cvar_t      *r_parallelLightCulling;
+	cvar_t      *r_batchCulling;
+	cvar_t      *r_lightCache;
+	cvar_t      *r_worldCache;
 	cvar_t      *r_shadowMapLuminanceAlpha;
 	cvar_t      *r_shadowMapLinearFilter;
 	cvar_t      *r_lightBleedReduction;
@@ -263,6 +267,7 @@ extern "C" {
 	cvar_t      *r_vboModels;
 	cvar_t      *r_vboOptimizeVertices;
 	cvar_t      *r_vboVertexSkinning;
+	cvar_t      *r_skinningThreads;
 	cvar_t      *r_vboDeformVertexes;
 	cvar_t      *r_vboSmoothNormals;
 
@@ -278,6 +283,7 @@ extern "C" {
 	cvar_t      *r_parallaxDepthScale;
 
 	cvar_t      *r_dynamicBspOcclusionCulling;
+	cvar_t      *r_softwareOcclusionCulling;
 	cvar_t      *r_dynamicEntityOcclusionCulling;
 	cvar_t      *r_dynamicLightOcclusionCulling;
 	cvar_t      *r_chcMaxPrevInvisNodesBatchSize;
@@ -973,6 +979,49 @@ extern "C" {
 
 //============================================================================
 
+	/*
+	==================
+	RE_EncodeVideoFrame
+
+	Encodes a tightly packed, bottom-up RGB frame into the payload of an
+	AVI video chunk and returns its size. Only touches its arguments, so
+	the client can call it from its encoder threads.
+	==================
+	*/
+	int RE_EncodeVideoFrame( byte *buffer, int bufferSize, byte *pixels, int width, int height, qboolean motionJpeg )
+	{
+		int lineLen = width * 3;
+		int aviLineLen = PAD( lineLen, AVI_LINE_PADDING );
+		int i, j;
+
+		if ( motionJpeg )
+		{
+			return SaveJPGToBuffer( buffer, bufferSize, 90, width, height, pixels );
+		}
+
+		if ( aviLineLen * height > bufferSize )
+		{
+			return 0;
+		}
+
+		for ( i = 0; i < height; ++i )
+		{
+			for ( j = 0; j < lineLen; j += 3 )
+			{
+				buffer[ i * aviLineLen + j + 0 ] = pixels[ i * lineLen + j + 2 ];
+				buffer[ i * aviLineLen + j + 1 ] = pixels[ i * lineLen + j + 1 ];
+				buffer[ i * aviLineLen + j + 2 ] = pixels[ i * lineLen + j + 0 ];
+			}
+
+			while ( j < aviLineLen )
+			{
+				buffer[ i * aviLineLen + j++ ] = 0;
+			}
+		}
+
+		return aviLineLen * height;
+	}
+
 	/*
 	==================
 	RB_TakeVideoFrameCmd
@@ -986,8 +1035,6 @@ extern "C" {
 		byte                      *pixels;
 		int                       i;
 		int                       outputSize;
-		int                       j;
-		int                       aviLineLen;
 
 		cmd = ( const videoFrameCommand_t * ) data;
 
@@ -1011,37 +1058,22 @@ extern "C" {
 				R_GammaCorrect( pixels, captureLineLen * cmd->height );
 			}
 
-			if ( cmd->motionJpeg )
+			// Drop alignment and line padding bytes
+			for ( i = 0; i < cmd->height; ++i )
 			{
-				// Drop alignment and line padding bytes
-				for ( i = 0; i < cmd->height; ++i )
-				{
-					memmove( cmd->captureBuffer + i * lineLen, pixels + i * captureLineLen, lineLen );
-				}
+				memmove( cmd->captureBuffer + i * lineLen, pixels + i * captureLineLen, lineLen );
+			}
 
-				outputSize = SaveJPGToBuffer( cmd->encodeBuffer, 3 * cmd->width * cmd->height, 90, cmd->width, cmd->height, cmd->captureBuffer );
-				ri.CL_WriteAVIVideoFrame( cmd->encodeBuffer, outputSize );
+			if ( !cmd->encodeBuffer )
+			{
+				// the client encodes the frame on its own threads
+				ri.CL_QueueAVIVideoFrame( cmd->captureBuffer );
 			}
 			else
 			{
-				aviLineLen = PAD( lineLen, AVI_LINE_PADDING );
-
-				for ( i = 0; i < cmd->height; ++i )
-				{
-					for ( j = 0; j < lineLen; j += 3 )
-					{
-						cmd->encodeBuffer[ i * aviLineLen + j + 0 ] = pixels[ i * captureLineLen + j + 2 ];
-						cmd->encodeBuffer[ i * aviLineLen + j + 1 ] = pixels[ i * captureLineLen + j + 1 ];
-						cmd->encodeBuffer[ i * aviLineLen + j + 2 ] = pixels[ i * captureLineLen + j + 0 ];
-					}
-
-					while ( j < aviLineLen )
-					{
-						cmd->encodeBuffer[ i * aviLineLen + j++ ] = 0;
-					}
-				}
-
-				ri.CL_WriteAVIVideoFrame( cmd->encodeBuffer, aviLineLen * cmd->height );
+				outputSize = RE_EncodeVideoFrame( cmd->encodeBuffer, PAD( lineLen, AVI_LINE_PADDING ) * cmd->height, cmd->captureBuffer,
+				                                  cmd->width, cmd->height, cmd->motionJpeg );
+				ri.CL_WriteAVIVideoFrame( cmd->encodeBuffer, outputSize );
 			}
 		}
 
@@ -1500,6 +1532,7 @@ extern "C" {
 		r_vboModels = ri.Cvar_Get( "r_vboModels", "1", CVAR_ARCHIVE );
 		r_vboOptimizeVertices = ri.Cvar_Get( "r_vboOptimizeVertices", "1", CVAR_CHEAT | CVAR_LATCH );
 		r_vboVertexSkinning = ri.Cvar_Get( "r_vboVertexSkinning", "1", CVAR_ARCHIVE | CVAR_LATCH );
+		r_skinningThreads = ri.Cvar_Get( "r_skinningThreads", "2", CVAR_ARCHIVE | CVAR_LATCH );
 		r_vboDeformVertexes = ri.Cvar_Get( "r_vboDeformVertexes", "0", CVAR_ARCHIVE | CVAR_LATCH );
 		r_vboSmoothNormals = ri.Cvar_Get( "r_vboSmoothNormals", "1", CVAR_ARCHIVE | CVAR_LATCH );
 
@@ -1511,6 +1544,7 @@ extern "C" {
 #endif
 
 		r_dynamicBspOcclusionCulling = ri.Cvar_Get( "r_dynamicBspOcclusionCulling", "0", CVAR_ARCHIVE );
+		r_softwareOcclusionCulling = ri.Cvar_Get( "r_softwareOcclusionCulling", "0", CVAR_ARCHIVE );
 		r_dynamicEntityOcclusionCulling = ri.Cvar_Get( "r_dynamicEntityOcclusionCulling", "0", CVAR_CHEAT );
 		r_dynamicLightOcclusionCulling = ri.Cvar_Get( "r_dynamicLightOcclusionCulling", "0", CVAR_CHEAT );
 		r_chcMaxPrevInvisNodesBatchSize = ri.Cvar_Get( "r_chcMaxPrevInvisNodesBatchSize", "50", CVAR_CHEAT );
@@ -1677,6 +1711,10 @@ extern "C" {
 		r_cullShadowPyramidTriangles = ri.Cvar_Get( "r_cullShadowPyramidTriangles", "1", CVAR_CHEAT );
 		r_noShadowFrustums = ri.Cvar_Get( "r_noShadowFrustums", "0", CVAR_CHEAT );
 		r_noLightFrustums = ri.Cvar_Get( "r_noLightFrustums", "1", CVAR_CHEAT );
+		r_parallelLightCulling = ri.Cvar_Get( "r_parallelLightCulling", "1", CVAR_ARCHIVE );
+		r_batchCulling = ri.Cvar_Get( "r_batchCulling", "1", CVAR_ARCHIVE );
+		r_lightCache = ri.Cvar_Get( "r_lightCache", "1", CVAR_ARCHIVE );
+		r_worldCache = ri.Cvar_Get( "r_worldCache", "1", CVAR_ARCHIVE );
 
 		r_maxPolys = ri.Cvar_Get( "r_maxpolys", "10000", 0 );  // 600 in vanilla Q3A
 		AssertCvarRange( r_maxPolys, 600, 30000, qtrue );
@@ -1741,6 +1779,10 @@ extern "C" {
 		ri.Cmd_AddCommand( "buildcubemaps", R_BuildCubeMaps );
 
 		ri.Cmd_AddCommand( "glsl_restart", GLSL_restart_f );
+		ri.Cmd_AddCommand( "stretchpicbench", R_StretchPicBench_f );
+		ri.Cmd_AddCommand( "sortbench", R_SortBench_f );
+		ri.Cmd_AddCommand( "cullbench", R_CullBench_f );
+		ri.Cmd_AddCommand( "occlusionbench", R_OcclusionBench_f );
 	}
 
 	/*
@@ -1824,6 +1866,8 @@ extern "C" {
 
 		R_ToggleSmpFrame();
 
+		GLimp_InitWorkers( r_skinningThreads->integer );
+
 		R_InitImages();
 
 		R_InitFBOs();
@@ -1897,11 +1941,18 @@ extern "C" {
 		ri.Cmd_RemoveCommand( "buildcubemaps" );
 
 		ri.Cmd_RemoveCommand( "glsl_restart" );
+		ri.Cmd_RemoveCommand( "stretchpicbench" );
+		ri.Cmd_RemoveCommand( "sortbench" );
+		ri.Cmd_RemoveCommand( "cullbench" );
+		ri.Cmd_RemoveCommand( "occlusionbench" );
 
 		if ( tr.registered )
 		{
 			R_SyncRenderThread();
 
+			GLimp_ShutdownWorkers();
+			R_ShutdownLightEntityCulls();
+			R_ShutdownSortBuffers();
 			R_ShutdownCommandBuffers();
 			R_ShutdownImages();
 			R_ShutdownVBOs();
@@ -2079,6 +2130,7 @@ extern "C" {
 		re.SetColor = RE_SetColor;
 		re.SetClipRegion = RE_SetClipRegion;
 		re.DrawStretchPic = RE_StretchPic;
+		re.DrawStretchPics = RE_StretchPics;
 		re.DrawStretchRaw = RE_StretchRaw;
 		re.UploadCinematic = RE_UploadCinematic;
 
@@ -2134,6 +2186,7 @@ extern "C" {
 
 		// XreaL BEGIN
 		re.TakeVideoFrame = RE_TakeVideoFrame;
+		re.EncodeVideoFrame = RE_EncodeVideoFrame;
 
 #if !defined( COMPAT_ET )
 		re.TakeScreenshotPNG = RB_TakeScreenshotPNG;
@@ -75,25 +75,13 @@ void R_AddBrushModelInteractions( trRefEntity_t *ent, trRefLight_t *light, inter
 	pModel = R_GetModelByHandle( ent->e.hModel );
 	bspModel = pModel->bsp;
 
-	// do a quick AABB cull
-	if ( !BoundsIntersect( light->worldBounds[ 0 ], light->worldBounds[ 1 ], ent->worldBounds[ 0 ], ent->worldBounds[ 1 ] ) )
+	// cull against the light volume and find the shadow cube sides it touches
+	if ( !R_LightIntersectsEntity( light, ent, &cubeSideBits ) )
 	{
 		tr.pc.c_dlightSurfacesCulled += bspModel->numSurfaces;
 		return;
 	}
 
-	// do a more expensive and precise light frustum cull
-	if ( !r_noLightFrustums->integer )
-	{
-		if ( R_CullLightWorldBounds( light, ent->worldBounds ) == CULL_OUT )
-		{
-			tr.pc.c_dlightSurfacesCulled += bspModel->numSurfaces;
-			return;
-		}
-	}
-
-	cubeSideBits = R_CalcLightCubeSideBits( light, ent->worldBounds );
-
 	if ( r_vboModels->integer && bspModel->numVBOSurfaces )
 	{
 		srfVBOMesh_t *vboSurface;
@@ -1199,57 +1187,6 @@ qboolean R_AddLightInteraction( trRefLight_t *light, surfaceType_t *surface, sha
 	return qtrue;
 }
 
-/*
-=================
-InteractionCompare
-compare function for qsort()
-=================
-*/
-static int InteractionCompare( const void *a, const void *b )
-{
-#if 1
-
-	// shader first
-	if ( ( ( interaction_t * ) a )->shaderNum < ( ( interaction_t * ) b )->shaderNum )
-	{
-		return -1;
-	}
-
-	else if ( ( ( interaction_t * ) a )->shaderNum > ( ( interaction_t * ) b )->shaderNum )
-	{
-		return 1;
-	}
-
-#endif
-
-#if 1
-
-	// then entity
-	if ( ( ( interaction_t * ) a )->entity == &tr.worldEntity && ( ( interaction_t * ) b )->entity != &tr.worldEntity )
-	{
-		return -1;
-	}
-
-	else if ( ( ( interaction_t * ) a )->entity != &tr.worldEntity && ( ( interaction_t * ) b )->entity == &tr.worldEntity )
-	{
-		return 1;
-	}
-
-	else if ( ( ( interaction_t * ) a )->entity < ( ( interaction_t * ) b )->entity )
-	{
-		return -1;
-	}
-
-	else if ( ( ( interaction_t * ) a )->entity > ( ( interaction_t * ) b )->entity )
-	{
-		return 1;
-	}
-
-#endif
-
-	return 0;
-}
-
 /*
 =================
 R_SortInteractions
@@ -1262,6 +1199,7 @@ void R_SortInteractions( trRefLight_t *light )
 	interaction_t *iaFirst;
 	interaction_t *ia;
 	interaction_t *iaLast;
+	sortKey_t     *keys;
 
 	if ( r_noInteractionSort->integer )
 	{
@@ -1276,8 +1214,15 @@ void R_SortInteractions( trRefLight_t *light )
 	iaFirst = light->firstInteraction;
 	iaFirstIndex = light->firstInteraction - tr.refdef.interactions;
 
-	// sort by material etc. for geometry batching in the renderer backend
-	qsort( iaFirst, light->numInteractions, sizeof( interaction_t ), InteractionCompare );
+	// sort by material, then entity for geometry batching in the renderer backend
+	keys = R_GetSortKeys( light->numInteractions );
+
+	for ( i = 0, ia = iaFirst; i < light->numInteractions; i++, ia++ )
+	{
+		keys[ i ].key = ( ( uint64_t ) ( uint32_t ) ia->shaderNum << 32 ) | R_EntitySortKey( ia->entity );
+	}
+
+	R_SortByKeys( iaFirst, sizeof( interaction_t ), keys, light->numInteractions );
 
 	// fix linked list
 	iaLast = NULL;
@@ -1570,15 +1515,18 @@ void R_SetupLightScissor( trRefLight_t *light )
 
 /*
 =============
-R_CalcLightCubeSideBits
+R_TestLightCubeSides
+
+Finds the omni light shadow cube sides the bounds touch, without touching
+the performance counters so that it can run on the render worker threads.
+Returns qfalse if no per side tests were needed.
 =============
 */
 // *INDENT-OFF*
-byte R_CalcLightCubeSideBits( trRefLight_t *light, vec3_t worldBounds[ 2 ] )
+static qboolean R_TestLightCubeSides( trRefLight_t *light, vec3_t worldBounds[ 2 ], byte *cubeSideBits, byte *clipSideBits )
 {
 	int        i;
 	int        cubeSide;
-	byte       cubeSideBits;
 	float      xMin, xMax, yMin, yMax;
 	float      zNear, zFar;
 	float      fovX, fovY;
@@ -1590,27 +1538,15 @@ byte R_CalcLightCubeSideBits( trRefLight_t *light, vec3_t worldBounds[ 2 ] )
 	qboolean   anyClip;
 	qboolean   culled;
 
-#if 0
-	static int count = 0;
-	cubeSideBits = 0;
-
-	for ( cubeSide = 0; cubeSide < 6; cubeSide++ )
-	{
-		if ( count % 2 == 0 )
-		{
-			cubeSideBits |= ( 1 << cubeSide );
-		}
-	}
-
-	return cubeSideBits;
-#endif
+	*cubeSideBits = CUBESIDE_CLIPALL;
+	*clipSideBits = 0;
 
 	if ( light->l.rlType != RL_OMNI || r_shadows->integer < SHADOWING_ESM16 || r_noShadowPyramids->integer )
 	{
-		return CUBESIDE_CLIPALL;
+		return qfalse;
 	}
 
-	cubeSideBits = 0;
+	*cubeSideBits = 0;
 
 	for ( cubeSide = 0; cubeSide < 6; cubeSide++ )
 	{
@@ -1713,32 +1649,233 @@ byte R_CalcLightCubeSideBits( trRefLight_t *light, vec3_t worldBounds[ 2 ] )
 
 		if ( !culled )
 		{
-			if ( !anyClip )
-			{
-				// completely inside frustum
-				tr.pc.c_pyramid_cull_ent_in++;
-			}
-			else
+			if ( anyClip )
 			{
 				// partially clipped
-				tr.pc.c_pyramid_cull_ent_clip++;
+				*clipSideBits |= ( 1 << cubeSide );
 			}
 
-			cubeSideBits |= ( 1 << cubeSide );
+			*cubeSideBits |= ( 1 << cubeSide );
 		}
-		else
+	}
+
+	return qtrue;
+}
+
+// *INDENT-ON*
+
+/*
+=============
+R_CountLightCubeSides
+=============
+*/
+static void R_CountLightCubeSides( byte cubeSideBits, byte clipSideBits )
+{
+	int cubeSide;
+
+	for ( cubeSide = 0; cubeSide < 6; cubeSide++ )
+	{
+		if ( !( cubeSideBits & ( 1 << cubeSide ) ) )
 		{
-			// completely outside frustum
 			tr.pc.c_pyramid_cull_ent_out++;
 		}
+		else if ( clipSideBits & ( 1 << cubeSide ) )
+		{
+			tr.pc.c_pyramid_cull_ent_clip++;
+		}
+		else
+		{
+			tr.pc.c_pyramid_cull_ent_in++;
+		}
 	}
 
 	tr.pc.c_pyramidTests++;
+}
+
+/*
+=============
+R_CalcLightCubeSideBits
+=============
+*/
+byte R_CalcLightCubeSideBits( trRefLight_t *light, vec3_t worldBounds[ 2 ] )
+{
+	byte cubeSideBits, clipSideBits;
+
+	if ( R_TestLightCubeSides( light, worldBounds, &cubeSideBits, &clipSideBits ) )
+	{
+		R_CountLightCubeSides( cubeSideBits, clipSideBits );
+	}
 
 	return cubeSideBits;
 }
 
-// *INDENT-ON*
+/*
+=============
+R_ClassifyLightEntity
+=============
+*/
+static void R_ClassifyLightEntity( trRefLight_t *light, trRefEntity_t *ent, lightEntityCull_t *cull )
+{
+	cull->pyramidTested = qfalse;
+	cull->cubeSideBits = 0;
+	cull->clipSideBits = 0;
+
+	// do a quick AABB cull
+	if ( !BoundsIntersect( light->worldBounds[ 0 ], light->worldBounds[ 1 ], ent->worldBounds[ 0 ], ent->worldBounds[ 1 ] ) )
+	{
+		cull->result = LIGHTCULL_OUT;
+		return;
+	}
+
+	// do a more expensive and precise light frustum cull
+	if ( !r_noLightFrustums->integer )
+	{
+		if ( R_CullLightWorldBounds( light, ent->worldBounds ) == CULL_OUT )
+		{
+			cull->result = LIGHTCULL_OUT;
+			return;
+		}
+	}
+
+	cull->result = LIGHTCULL_IN;
+	cull->pyramidTested = R_TestLightCubeSides( light, ent->worldBounds, &cull->cubeSideBits, &cull->clipSideBits );
+}
+
+/*
+=============
+R_LightIntersectsEntity
+
+Culls the entity bounds against the light volume, using the result of
+R_CullLightEntities when there is one, and returns the shadow cube sides
+the entity touches
+=============
+*/
+qboolean R_LightIntersectsEntity( trRefLight_t *light, trRefEntity_t *ent, byte *cubeSideBits )
+{
+	lightEntityCull_t       local;
+	const lightEntityCull_t *cull = NULL;
+
+	if ( light->entityCulls && ent >= tr.refdef.entities && ent < tr.refdef.entities + tr.refdef.numEntities )
+	{
+		cull = &light->entityCulls[ ent - tr.refdef.entities ];
+
+		if ( cull->result == LIGHTCULL_UNKNOWN )
+		{
+			cull = NULL;
+		}
+	}
+
+	if ( !cull )
+	{
+		R_ClassifyLightEntity( light, ent, &local );
+		cull = &local;
+	}
+
+	if ( cull->result == LIGHTCULL_OUT )
+	{
+		return qfalse;
+	}
+
+	if ( cull->pyramidTested )
+	{
+		R_CountLightCubeSides( cull->cubeSideBits, cull->clipSideBits );
+	}
+
+	*cubeSideBits = cull->cubeSideBits;
+	return qtrue;
+}
+
+#define LIGHTCULL_JOB_ENTITIES 64
+
+typedef struct
+{
+	trRefLight_t **lights;
+	int          numChunks;
+} lightCullJobs_t;
+
+static lightEntityCull_t *lightEntityCulls;
+static int               lightEntityCullsSize;
+
+static void R_CullLightEntitiesJob( void *data, int job )
+{
+	const lightCullJobs_t *jobs = ( const lightCullJobs_t * ) data;
+	trRefLight_t          *light = jobs->lights[ job / jobs->numChunks ];
+	int                   first = ( job % jobs->numChunks ) * LIGHTCULL_JOB_ENTITIES;
+	int                   last = MIN( first + LIGHTCULL_JOB_ENTITIES, tr.refdef.numEntities );
+	int                   i;
+
+	for ( i = first; i < last; i++ )
+	{
+		// only models are tested against lights
+		if ( tr.refdef.entities[ i ].e.reType != RT_MODEL )
+		{
+			light->entityCulls[ i ].result = LIGHTCULL_UNKNOWN;
+			continue;
+		}
+
+		R_ClassifyLightEntity( light, &tr.refdef.entities[ i ], &light->entityCulls[ i ] );
+	}
+}
+
+/*
+=============
+R_CullLightEntities
+
+Tests every entity against every light on the render worker threads.
+The interactions are still added one light at a time in R_AddLightInteractions,
+which only picks up the results, so they come out in the same order
+=============
+*/
+void R_CullLightEntities( trRefLight_t **lights, int numLights )
+{
+	lightCullJobs_t jobs;
+	int             size;
+	int             i;
+
+	size = numLights * tr.refdef.numEntities;
+
+	if ( !size )
+	{
+		return;
+	}
+
+	if ( size > lightEntityCullsSize )
+	{
+		if ( lightEntityCulls )
+		{
+			ri.Free( lightEntityCulls );
+		}
+
+		lightEntityCullsSize = size;
+		lightEntityCulls = ( lightEntityCull_t * ) ri.Z_Malloc( size * sizeof( lightEntityCull_t ) );
+	}
+
+	for ( i = 0; i < numLights; i++ )
+	{
+		lights[ i ]->entityCulls = &lightEntityCulls[ i * tr.refdef.numEntities ];
+	}
+
+	jobs.lights = lights;
+	jobs.numChunks = ( tr.refdef.numEntities + LIGHTCULL_JOB_ENTITIES - 1 ) / LIGHTCULL_JOB_ENTITIES;
+
+	GLimp_RunJobs( R_CullLightEntitiesJob, &jobs, numLights * jobs.numChunks );
+}
+
+/*
+=============
+R_ShutdownLightEntityCulls
+=============
+*/
+void R_ShutdownLightEntityCulls( void )
+{
+	if ( lightEntityCulls )
+	{
+		ri.Free( lightEntityCulls );
+		lightEntityCulls = NULL;
+	}
+
+	lightEntityCullsSize = 0;
+}
 
 /*
 =================
@@ -91,7 +91,8 @@ extern "C" {
 	  RSPEEDS_SHADING_TIMES,
 	  RSPEEDS_CHC,
 	  RSPEEDS_NEAR_FAR,
-	  RSPEEDS_DECALS
+	  RSPEEDS_DECALS,
+	  RSPEEDS_SOFTWARE_OCCLUSION
 	} renderSpeeds_t;
 
 #define DS_STANDARD_ENABLED() (( r_deferredShading->integer == DS_STANDARD && glConfig2.maxColorAttachments >= 4 && glConfig2.drawBuffersAvailable && glConfig2.maxDrawBuffers >= 4 && /*glConfig2.framebufferPackedDepthStencilAvailable &&*/ glConfig.driverType != GLDRV_MESA ))
@@ -310,6 +311,23 @@ extern "C" {
 		return l->prev;
 	}
 
+// result of testing one entity against a light volume,
+// precomputed on the render worker threads by R_CullLightEntities
+	enum
+	{
+	  LIGHTCULL_UNKNOWN,
+	  LIGHTCULL_OUT,
+	  LIGHTCULL_IN
+	};
+
+	typedef struct
+	{
+		byte result;
+		byte pyramidTested; // R_CalcLightCubeSideBits did the per side tests
+		byte cubeSideBits;
+		byte clipSideBits; // sides that were only partially inside
+	} lightEntityCull_t;
+
 // a trRefLight_t has all the information passed in by
 // the client game, as well as some locally derived info
 	typedef struct trRefLight_s
@@ -353,6 +371,8 @@ extern "C" {
 		int                       restrictInteractionFirst;
 		int                       restrictInteractionLast;
 
+		lightEntityCull_t         *entityCulls; // indexed by entity number, NULL if not precomputed this view
+
 		frustum_t                 frustum;
 		vec4_t                    localFrustum[ 6 ];
 		struct VBO_s              *frustumVBO;
@@ -1613,6 +1633,14 @@ extern "C" {
 		surfaceType_t *surface; // any of surface*_t
 	} drawSurf_t;
 
+// drawSurfs and interactions are sorted by packing their sort order into
+// a 64 bit key and radix sorting the keys, see R_SortByKeys
+	typedef struct
+	{
+		uint64_t key;
+		int      index;
+	} sortKey_t;
+
 	typedef enum
 	{
 	  IA_DEFAULT, // lighting and shadowing
@@ -2038,6 +2066,36 @@ extern "C" {
 	} bspCluster_t;
 #endif
 
+// structure-of-arrays bounds for culling CULL_BATCH of them at once,
+// the arrays are padded so a batch may read past the last element
+#define CULL_BATCH 4
+
+	typedef struct
+	{
+		float *mins[ 3 ];
+		float *maxs[ 3 ];
+	} cullBoxes_t;
+
+	typedef struct
+	{
+		float *origin[ 3 ];
+		float *radius;
+	} cullSpheres_t;
+
+#define MAX_OCCLUDER_VERTS 32
+
+	// large opaque convex world face rasterized into the software occlusion buffer
+	typedef struct
+	{
+		vec3_t origin;
+		float  radius;
+
+		int    firstVert; // into world_t::occluderVerts
+		int    numVerts; // convex outline of the face
+
+		int    collectCount; // already found if it's the current collection of tr_occlusion.c
+	} occluder_t;
+
 	/*
 	typedef struct
 	{
@@ -2132,6 +2190,18 @@ extern "C" {
 		int                numMarkSurfaces;
 		bspSurface_t       **markSurfaces;
 
+		cullBoxes_t        nodeBounds; // of all nodes and leafs
+		byte               *nodeFrontBits; // frustum planes the node is in front of in the current view
+		byte               *nodeBackBits; // frustum planes the node is behind in the current view
+
+		cullSpheres_t      markSurfaceSpheres; // of the surface each markSurfaces entry points to
+		byte               *markSurfaceCulled; // outside the frustum of the current view
+
+		int                numOccluders;
+		occluder_t         *occluders;
+		vec3_t             *occluderVerts;
+		int                *surfaceOccluders; // occluder of each world surface, -1 if it isn't one
+
 		int                numFogs;
 		fog_t              *fogs;
 
@@ -2561,6 +2631,10 @@ extern "C" {
 		int c_CHCTime;
 
 		int c_decalProjectors, c_decalTestSurfaces, c_decalClipSurfaces, c_decalSurfaces, c_decalSurfacesCreated;
+
+		int c_occluders;
+		int c_occludedNodes, c_occludedEntities;
+		int c_occlusionBufferTime;
 	} frontEndCounters_t;
 
 #define FOG_TABLE_SIZE  256
@@ -3117,6 +3191,10 @@ extern "C" {
 	extern cvar_t *r_debugShadowMaps;
 	extern cvar_t *r_noShadowFrustums;
 	extern cvar_t *r_noLightFrustums;
+	extern cvar_t *r_parallelLightCulling;
+	extern cvar_t *r_batchCulling;
+	extern cvar_t *r_lightCache;
+	extern cvar_t *r_worldCache;
 	extern cvar_t *r_shadowMapLuminanceAlpha;
 	extern cvar_t *r_shadowMapLinearFilter;
 	extern cvar_t *r_lightBleedReduction;
@@ -3194,6 +3272,7 @@ extern "C" {
 	extern cvar_t *r_vboModels;
 	extern cvar_t *r_vboOptimizeVertices;
 	extern cvar_t *r_vboVertexSkinning;
+	extern cvar_t *r_skinningThreads;
 	extern cvar_t *r_vboDeformVertexes;
 	extern cvar_t *r_vboSmoothNormals;
 
@@ -3209,6 +3288,7 @@ extern "C" {
 	extern cvar_t *r_parallaxDepthScale;
 
 	extern cvar_t *r_dynamicBspOcclusionCulling;
+	extern cvar_t *r_softwareOcclusionCulling;
 	extern cvar_t *r_dynamicEntityOcclusionCulling;
 	extern cvar_t *r_dynamicLightOcclusionCulling;
 	extern cvar_t *r_chcMaxPrevInvisNodesBatchSize;
@@ -3279,12 +3359,20 @@ extern "C" {
 
 	void           R_AddDrawSurf( surfaceType_t *surface, shader_t *shader, int lightmapNum, int fogNum );
 
+	uint64_t       R_EntitySortKey( const trRefEntity_t *ent );
+	sortKey_t      *R_GetSortKeys( int numKeys );
+	void           R_SortByKeys( void *items, int itemSize, sortKey_t *keys, int numItems );
+	void           R_ShutdownSortBuffers( void );
+	void           R_SortBench_f( void );
+
 	void           R_LocalNormalToWorld( const vec3_t local, vec3_t world );
 	void           R_LocalPointToWorld( const vec3_t local, vec3_t world );
 
 	cullResult_t   R_CullLocalBox( vec3_t bounds[ 2 ] );
 	int            R_CullLocalPointAndRadius( vec3_t origin, float radius );
 	int            R_CullPointAndRadius( vec3_t origin, float radius );
+	void           R_CullBoxes( const cullBoxes_t *boxes, int first, int count, byte *frontBits, byte *backBits );
+	void           R_CullSpheres( const cullSpheres_t *spheres, int first, int count, byte *culled );
 
 	int            R_FogLocalPointAndRadius( const vec3_t pt, float radius );
 	int            R_FogPointAndRadius( const vec3_t pt, float radius );
@@ -3453,6 +3541,7 @@ extern "C" {
 	                            int width, int height, int bits, filterType_t filterType, wrapType_t wrapType );
 
 	image_t *R_CreateGlyph( const char *name, const byte *pic, int width, int height );
+	void    R_UpdateGlyph( image_t *image, const byte *pic, int y, int height );
 
 	image_t *R_AllocImage( const char *name, qboolean linkIntoHashTable );
 	void    R_UploadImage( const byte **dataArray, int numData, image_t *image );
@@ -3501,6 +3590,11 @@ extern "C" {
 	void     GLimp_FrontEndSleep( void );
 	void     GLimp_WakeRenderer( void *data );
 
+	void     GLimp_InitWorkers( int count );
+	void     GLimp_ShutdownWorkers( void );
+	int      GLimp_NumWorkers( void );
+	void     GLimp_RunJobs( void ( *function )( void *data, int job ), void *data, int numJobs );
+
 	void     GLimp_LogComment( const char *comment );
 
 // NOTE TTimo linux works with float gamma value, not the gamma table
@@ -3640,6 +3734,7 @@ extern "C" {
 
 	void     R_AddBSPModelSurfaces( trRefEntity_t *e );
 	void     R_AddWorldSurfaces( void );
+	void     R_CullBench_f( void );
 	qboolean R_inPVS( const vec3_t p1, const vec3_t p2 );
 	qboolean R_inPVVS( const vec3_t p1, const vec3_t p2 );
 
@@ -3650,6 +3745,19 @@ extern "C" {
 	/*
 	============================================================
 
+	SOFTWARE OCCLUSION CULLING, tr_occlusion.c
+
+	============================================================
+	*/
+
+	qboolean R_RenderOcclusionBuffer( void );
+	qboolean R_OccludedBox( const vec3_t mins, const vec3_t maxs );
+	void     R_CullOccludedEntity( trRefEntity_t *ent );
+	void     R_OcclusionBench_f( void );
+
+	/*
+	============================================================
+
 	FLARES, tr_flares.c
 
 	============================================================
@@ -3694,6 +3802,10 @@ extern "C" {
 
 	byte     R_CalcLightCubeSideBits( trRefLight_t *light, vec3_t worldBounds[ 2 ] );
 
+	qboolean R_LightIntersectsEntity( trRefLight_t *light, trRefEntity_t *ent, byte *cubeSideBits );
+	void     R_CullLightEntities( trRefLight_t **lights, int numLights );
+	void     R_ShutdownLightEntityCulls( void );
+
 	int      R_CullLightPoint( trRefLight_t *light, const vec3_t p );
 
 	int      R_CullLightTriangle( trRefLight_t *light, vec3_t verts[ 3 ] );
@@ -3888,6 +4000,24 @@ extern "C" {
 	skelAnimation_t *R_GetAnimationByHandle( qhandle_t hAnim );
 	void            R_AnimationList_f( void );
 
+	/*
+	 * CPU skinning of md5Vertex_t arrays, for when there is no GPU skinning
+	 */
+	typedef struct
+	{
+		const matrix_t    *bones; // indexed by md5Weight_t::boneIndex
+		const md5Vertex_t *verts;
+		int               numVerts;
+		qboolean          weightOffsets; // skin the md5Weight_t offsets instead of md5Vertex_t::position
+		qboolean          tangentSpace; // also skin tangents, binormals and normals
+		vec4_t            *xyz;
+		vec4_t            *tangents;
+		vec4_t            *binormals;
+		vec4_t            *normals;
+	} skinVertexes_t;
+
+	void            Tess_SkinVertexes( const skinVertexes_t *skin );
+
 	void            R_AddMD5Surfaces( trRefEntity_t *ent );
 	void            R_AddMD5Interactions( trRefEntity_t *ent, trRefLight_t *light, interactionType_t iaType );
 
@@ -4027,6 +4157,16 @@ extern "C" {
 		float    angle; // NERVE - SMF
 	} stretchPicCommand_t;
 
+	// followed by numPics stretchPic_t, padded to pointer alignment
+#define MAX_STRETCH_PICS 1024
+
+	typedef struct
+	{
+		int      commandId;
+		shader_t *shader;
+		int      numPics;
+	} stretchPicsCommand_t;
+
 	typedef struct
 	{
 		int        commandId;
@@ -4114,6 +4254,7 @@ extern "C" {
 	  RC_END_OF_LIST,
 	  RC_SET_COLOR,
 	  RC_STRETCH_PIC,
+	  RC_STRETCH_PICS,
 	  RC_2DPOLYS,
 	  RC_SCISSORENABLE,
 	  RC_SCISSORSET,
@@ -4177,6 +4318,8 @@ extern "C" {
 	void                                R_AddRunVisTestsCmd( visTest_t **visTests, int numVisTests );
 	void                                RE_SetClipRegion( const float *region );
 	void                                RE_StretchPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader );
+	void                                RE_StretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader );
+	void                                R_StretchPicBench_f( void );
 	void                                RE_RotatedPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader, float angle );  // NERVE - SMF
 	void                                RE_StretchPicGradient( float x, float y, float w, float h,
 	    float s1, float t1, float s2, float t2, qhandle_t hShader, const float *gradientColor,
@@ -4202,6 +4345,7 @@ extern "C" {
 // video stuff
 	const void *RB_TakeVideoFrameCmd( const void *data );
 	void       RE_TakeVideoFrame( int width, int height, byte *captureBuffer, byte *encodeBuffer, qboolean motionJpeg );
+	int        RE_EncodeVideoFrame( byte *buffer, int bufferSize, byte *pixels, int width, int height, qboolean motionJpeg );
 
 // cubemap reflections stuff
 	void       R_BuildCubeMaps( void );
@@ -730,6 +730,203 @@ int R_CullPointAndRadius( vec3_t pt, float radius )
 	return CULL_IN; // completely inside frustum
 }
 
+#if defined( __SSE__ ) || id386_sse
+#include <xmmintrin.h>
+#define CULL_SSE 1
+#else
+#define CULL_SSE 0
+#endif
+
+#if CULL_SSE
+
+// spreads a 4 bit lane mask to the lowest bit of 4 bytes
+static const unsigned int cullLaneBytes[ 16 ] =
+{
+	0x00000000, 0x00000001, 0x00000100, 0x00000101,
+	0x00010000, 0x00010001, 0x00010100, 0x00010101,
+	0x01000000, 0x01000001, 0x01000100, 0x01000101,
+	0x01010000, 0x01010001, 0x01010100, 0x01010101
+};
+#endif
+
+/*
+=================
+R_CullBoxes
+
+Tests the boxes first to first + count - 1 against the frustum planes,
+the bit of a plane is set in frontBits if BoxOnPlaneSide would return 1
+and in backBits if it would return 2. Up to CULL_BATCH - 1 boxes past
+the last one may be tested as well, so the outputs need as much padding.
+=================
+*/
+void R_CullBoxes( const cullBoxes_t *boxes, int first, int count, byte *frontBits, byte *backBits )
+{
+	int      i, j, p;
+	cplane_t *frust;
+
+#if CULL_SSE
+	__m128       mins[ 3 ], maxs[ 3 ], dist[ 2 ], d, front, back;
+	unsigned int frontLanes, backLanes;
+
+	for ( i = first; i < first + count; i += CULL_BATCH )
+	{
+		for ( j = 0; j < 3; j++ )
+		{
+			mins[ j ] = _mm_loadu_ps( boxes->mins[ j ] + i );
+			maxs[ j ] = _mm_loadu_ps( boxes->maxs[ j ] + i );
+		}
+
+		// one byte of plane bits per box
+		frontLanes = backLanes = 0;
+
+		for ( p = 0; p < FRUSTUM_PLANES; p++ )
+		{
+			frust = &tr.viewParms.frustums[ 0 ][ p ];
+
+			// the same corners and summation order as BoxOnPlaneSide
+			dist[ 0 ] = dist[ 1 ] = _mm_setzero_ps();
+
+			for ( j = 0; j < 3; j++ )
+			{
+				d = _mm_set1_ps( frust->normal[ j ] );
+
+				if ( ( frust->signbits >> j ) & 1 )
+				{
+					dist[ 0 ] = _mm_add_ps( dist[ 0 ], _mm_mul_ps( d, mins[ j ] ) );
+					dist[ 1 ] = _mm_add_ps( dist[ 1 ], _mm_mul_ps( d, maxs[ j ] ) );
+				}
+				else
+				{
+					dist[ 0 ] = _mm_add_ps( dist[ 0 ], _mm_mul_ps( d, maxs[ j ] ) );
+					dist[ 1 ] = _mm_add_ps( dist[ 1 ], _mm_mul_ps( d, mins[ j ] ) );
+				}
+			}
+
+			d = _mm_set1_ps( frust->dist );
+			front = _mm_cmpge_ps( dist[ 0 ], d );
+			back = _mm_cmplt_ps( dist[ 1 ], d );
+
+			frontLanes |= cullLaneBytes[ _mm_movemask_ps( _mm_andnot_ps( back, front ) ) ] << p;
+			backLanes |= cullLaneBytes[ _mm_movemask_ps( _mm_andnot_ps( front, back ) ) ] << p;
+		}
+
+		for ( j = 0; j < CULL_BATCH; j++ )
+		{
+			frontBits[ i + j ] = frontLanes >> ( j * 8 );
+			backBits[ i + j ] = backLanes >> ( j * 8 );
+		}
+	}
+
+#else
+	vec3_t mins, maxs;
+	int    r;
+
+	for ( i = first; i < first + count; i++ )
+	{
+		for ( j = 0; j < 3; j++ )
+		{
+			mins[ j ] = boxes->mins[ j ][ i ];
+			maxs[ j ] = boxes->maxs[ j ][ i ];
+		}
+
+		frontBits[ i ] = backBits[ i ] = 0;
+
+		for ( p = 0; p < FRUSTUM_PLANES; p++ )
+		{
+			frust = &tr.viewParms.frustums[ 0 ][ p ];
+			r = BoxOnPlaneSide( mins, maxs, frust );
+
+			if ( r == 1 )
+			{
+				frontBits[ i ] |= 1 << p;
+			}
+			else if ( r == 2 )
+			{
+				backBits[ i ] |= 1 << p;
+			}
+		}
+	}
+
+#endif
+}
+
+/*
+=================
+R_CullSpheres
+
+Sets culled for the spheres first to first + count - 1 that
+R_CullPointAndRadius would return CULL_OUT for, with the same
+padding requirements as R_CullBoxes
+=================
+*/
+void R_CullSpheres( const cullSpheres_t *spheres, int first, int count, byte *culled )
+{
+	int      i, j, p;
+	cplane_t *frust;
+
+#if CULL_SSE
+	__m128 origin[ 3 ], radius, dist, out;
+	int    outMask;
+
+	for ( i = first; i < first + count; i += CULL_BATCH )
+	{
+		for ( j = 0; j < 3; j++ )
+		{
+			origin[ j ] = _mm_loadu_ps( spheres->origin[ j ] + i );
+		}
+
+		radius = _mm_sub_ps( _mm_setzero_ps(), _mm_loadu_ps( spheres->radius + i ) );
+		out = _mm_setzero_ps();
+
+		for ( p = 0; p < FRUSTUM_PLANES; p++ )
+		{
+			frust = &tr.viewParms.frustums[ 0 ][ p ];
+
+			dist = _mm_add_ps( _mm_add_ps( _mm_mul_ps( origin[ 0 ], _mm_set1_ps( frust->normal[ 0 ] ) ),
+			                               _mm_mul_ps( origin[ 1 ], _mm_set1_ps( frust->normal[ 1 ] ) ) ),
+			                   _mm_mul_ps( origin[ 2 ], _mm_set1_ps( frust->normal[ 2 ] ) ) );
+			dist = _mm_sub_ps( dist, _mm_set1_ps( frust->dist ) );
+
+			out = _mm_or_ps( out, _mm_cmplt_ps( dist, radius ) );
+		}
+
+		outMask = _mm_movemask_ps( out );
+
+		for ( j = 0; j < CULL_BATCH; j++ )
+		{
+			culled[ i + j ] = ( outMask >> j ) & 1;
+		}
+	}
+
+#else
+	vec3_t origin;
+	float  dist;
+
+	for ( i = first; i < first + count; i++ )
+	{
+		for ( j = 0; j < 3; j++ )
+		{
+			origin[ j ] = spheres->origin[ j ][ i ];
+		}
+
+		culled[ i ] = qfalse;
+
+		for ( p = 0; p < FRUSTUM_PLANES; p++ )
+		{
+			frust = &tr.viewParms.frustums[ 0 ][ p ];
+			dist = DotProduct( origin, frust->normal ) - frust->dist;
+
+			if ( dist < -spheres->radius[ i ] )
+			{
+				culled[ i ] = qtrue;
+				break;
+			}
+		}
+	}
+
+#endif
+}
+
 /*
 =================
 R_FogLocalPointAndRadius
@@ -2402,7 +2599,8 @@ void R_AddDrawSurf( surfaceType_t *surface, shader_t *shader, int lightmapNum, i
 /*
 =================
 DrawSurfCompare
-compare function for qsort()
+compare function for qsort(), only used by sortbench now
+to check R_SortDrawSurfList against
 =================
 */
 static int DrawSurfCompare( const void *a, const void *b )
@@ -2480,6 +2678,301 @@ static int DrawSurfCompare( const void *a, const void *b )
 	return 0;
 }
 
+static sortKey_t *sortKeys;
+static int       sortKeysSize;
+static byte      *sortItems;
+static int       sortItemsSize;
+static int       sortBenchIterations;
+
+/*
+=================
+R_EntitySortKey
+
+The world entity sorts first, the others in the order they are
+stored in, which is the same as the order of their addresses
+=================
+*/
+uint64_t R_EntitySortKey( const trRefEntity_t *ent )
+{
+	const trRefEntity_t *entities = backEndData[ tr.smpFrame ]->entities;
+
+	if ( ent == &tr.worldEntity || !ent )
+	{
+		return 0;
+	}
+
+	if ( ent < entities || ent >= entities + MAX_REF_ENTITIES )
+	{
+		return 0xFFFF;
+	}
+
+	return ( ent - entities ) + 1;
+}
+
+/*
+=================
+R_GetSortKeys
+
+Returns room for numKeys keys, followed by as many again
+for R_SortByKeys to sort them in
+=================
+*/
+sortKey_t *R_GetSortKeys( int numKeys )
+{
+	if ( numKeys > sortKeysSize )
+	{
+		if ( sortKeys )
+		{
+			ri.Free( sortKeys );
+		}
+
+		sortKeysSize = numKeys;
+		sortKeys = ( sortKey_t * ) ri.Z_Malloc( 2 * numKeys * sizeof( sortKey_t ) );
+	}
+
+	return sortKeys;
+}
+
+/*
+=================
+R_RadixSort
+
+Stable LSD radix sort on the keys, a byte at a time, skipping bytes
+that are the same in all keys. Returns the buffer holding the result.
+=================
+*/
+static sortKey_t *R_RadixSort( sortKey_t *keys, sortKey_t *temp, int numKeys )
+{
+	static int counts[ 8 ][ 256 ];
+	sortKey_t  *src, *dst, *swap;
+	uint64_t   key;
+	int        i, j, shift, offset, count;
+
+	// small lists are quicker with an insertion sort
+	if ( numKeys < 32 )
+	{
+		sortKey_t sortKey;
+
+		for ( i = 1; i < numKeys; i++ )
+		{
+			sortKey = keys[ i ];
+
+			for ( j = i; j > 0 && keys[ j - 1 ].key > sortKey.key; j-- )
+			{
+				keys[ j ] = keys[ j - 1 ];
+			}
+
+			keys[ j ] = sortKey;
+		}
+
+		return keys;
+	}
+
+	// count all digits in one pass
+	Com_Memset( counts, 0, sizeof( counts ) );
+
+	for ( i = 0; i < numKeys; i++ )
+	{
+		key = keys[ i ].key;
+
+		for ( j = 0; j < 8; j++ )
+		{
+			counts[ j ][ ( key >> ( j * 8 ) ) & 0xFF ]++;
+		}
+	}
+
+	src = keys;
+	dst = temp;
+
+	for ( j = 0, shift = 0; j < 8; j++, shift += 8 )
+	{
+		// nothing to do if all keys have the same digit here
+		if ( counts[ j ][ ( src[ 0 ].key >> shift ) & 0xFF ] == numKeys )
+		{
+			continue;
+		}
+
+		// turn the counts into offsets
+		for ( i = 0, offset = 0; i < 256; i++ )
+		{
+			count = counts[ j ][ i ];
+			counts[ j ][ i ] = offset;
+			offset += count;
+		}
+
+		for ( i = 0; i < numKeys; i++ )
+		{
+			dst[ counts[ j ][ ( src[ i ].key >> shift ) & 0xFF ]++ ] = src[ i ];
+		}
+
+		swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	return src;
+}
+
+/*
+=================
+R_SortByKeys
+
+Sorts the items by the keys from R_GetSortKeys, keys[ i ] being the
+key of item i. Items with equal keys keep their order.
+=================
+*/
+void R_SortByKeys( void *items, int itemSize, sortKey_t *keys, int numItems )
+{
+	sortKey_t *sorted;
+	int       i;
+
+	if ( numItems < 2 )
+	{
+		return;
+	}
+
+	for ( i = 0; i < numItems; i++ )
+	{
+		keys[ i ].index = i;
+	}
+
+	sorted = R_RadixSort( keys, keys + numItems, numItems );
+
+	if ( numItems * itemSize > sortItemsSize )
+	{
+		if ( sortItems )
+		{
+			ri.Free( sortItems );
+		}
+
+		sortItemsSize = numItems * itemSize;
+		sortItems = ( byte * ) ri.Z_Malloc( sortItemsSize );
+	}
+
+	// gather the items in their new order and copy them back
+	for ( i = 0; i < numItems; i++ )
+	{
+		Com_Memcpy( sortItems + i * itemSize, ( byte * ) items + sorted[ i ].index * itemSize, itemSize );
+	}
+
+	Com_Memcpy( items, sortItems, numItems * itemSize );
+}
+
+/*
+=================
+R_ShutdownSortBuffers
+=================
+*/
+void R_ShutdownSortBuffers( void )
+{
+	if ( sortKeys )
+	{
+		ri.Free( sortKeys );
+		sortKeys = NULL;
+	}
+
+	if ( sortItems )
+	{
+		ri.Free( sortItems );
+		sortItems = NULL;
+	}
+
+	sortKeysSize = 0;
+	sortItemsSize = 0;
+}
+
+/*
+=================
+R_SortDrawSurfList
+
+Sorts by shader, then lightmap, then entity, then fog, like DrawSurfCompare
+=================
+*/
+static void R_SortDrawSurfList( drawSurf_t *drawSurfs, int numDrawSurfs )
+{
+	sortKey_t  *keys;
+	drawSurf_t *drawSurf;
+	int        i;
+
+	keys = R_GetSortKeys( numDrawSurfs );
+
+	for ( i = 0, drawSurf = drawSurfs; i < numDrawSurfs; i++, drawSurf++ )
+	{
+		// flipping the sign bit keeps the order of the signed numbers
+		keys[ i ].key = ( ( uint64_t ) ( drawSurf->shaderNum & 0xFFFF ) << 48 ) |
+		                ( ( uint64_t ) ( ( uint16_t ) drawSurf->lightmapNum ^ 0x8000 ) << 32 ) |
+		                ( R_EntitySortKey( drawSurf->entity ) << 16 ) |
+		                ( ( uint16_t ) drawSurf->fogNum ^ 0x8000 );
+	}
+
+	R_SortByKeys( drawSurfs, sizeof( drawSurf_t ), keys, numDrawSurfs );
+}
+
+/*
+=================
+R_BenchDrawSurfSort
+=================
+*/
+static void R_BenchDrawSurfSort( void )
+{
+	drawSurf_t *captured, *qsorted, *radixSorted;
+	int        numDrawSurfs = tr.viewParms.numDrawSurfs;
+	int        i, start, qsortMsec, radixMsec, mismatches;
+
+	captured = ( drawSurf_t * ) ri.Hunk_AllocateTempMemory( 3 * numDrawSurfs * sizeof( drawSurf_t ) );
+	qsorted = captured + numDrawSurfs;
+	radixSorted = qsorted + numDrawSurfs;
+
+	Com_Memcpy( captured, tr.viewParms.drawSurfs, numDrawSurfs * sizeof( drawSurf_t ) );
+
+	start = ri.Milliseconds();
+
+	for ( i = 0; i < sortBenchIterations; i++ )
+	{
+		Com_Memcpy( qsorted, captured, numDrawSurfs * sizeof( drawSurf_t ) );
+		qsort( qsorted, numDrawSurfs, sizeof( drawSurf_t ), DrawSurfCompare );
+	}
+
+	qsortMsec = ri.Milliseconds() - start;
+	start = ri.Milliseconds();
+
+	for ( i = 0; i < sortBenchIterations; i++ )
+	{
+		Com_Memcpy( radixSorted, captured, numDrawSurfs * sizeof( drawSurf_t ) );
+		R_SortDrawSurfList( radixSorted, numDrawSurfs );
+	}
+
+	radixMsec = ri.Milliseconds() - start;
+
+	// qsort is not stable, so only the order of unequal surfaces can be compared
+	for ( i = 0, mismatches = 0; i < numDrawSurfs; i++ )
+	{
+		if ( DrawSurfCompare( &qsorted[ i ], &radixSorted[ i ] ) )
+		{
+			mismatches++;
+		}
+	}
+
+	ri.Printf( PRINT_ALL, "%i drawSurfs sorted %i times: qsort %i msec, radix sort %i msec, %i out of order\n",
+	           numDrawSurfs, sortBenchIterations, qsortMsec, radixMsec, mismatches );
+
+	ri.Hunk_FreeTempMemory( captured );
+}
+
+/*
+=================
+R_SortBench_f
+
+Times sorting the draw surfaces of the next main view with
+qsort against the radix sort
+=================
+*/
+void R_SortBench_f( void )
+{
+	sortBenchIterations = ri.Cmd_Argc() > 1 ? atoi( ri.Cmd_Argv( 1 ) ) : 100;
+	sortBenchIterations = MAX( sortBenchIterations, 1 );
+}
+
 /*
 =================
 R_SortDrawSurfs
@@ -2521,9 +3014,14 @@ static void R_SortDrawSurfs( void )
 		ia->next = NULL;
 	}
 
-	// sort the drawsurfs by sort type, then orientation, then shader
-//  qsortFast(drawSurfs, numDrawSurfs, sizeof(drawSurf_t));
-	qsort( tr.viewParms.drawSurfs, tr.viewParms.numDrawSurfs, sizeof( drawSurf_t ), DrawSurfCompare );
+	if ( sortBenchIterations && !tr.viewParms.isPortal )
+	{
+		R_BenchDrawSurfSort();
+		sortBenchIterations = 0;
+	}
+
+	// sort the drawsurfs by shader, then lightmap, entity and fog
+	R_SortDrawSurfList( tr.viewParms.drawSurfs, tr.viewParms.numDrawSurfs );
 
 	// check for any pass through drawing, which
 	// may cause another view to be rendered first
@@ -2575,6 +3073,12 @@ static void R_SortDrawSurfs( void )
 /*
 =============
 R_AddEntitySurfaces
+
+Still runs on one thread, the model functions cull and add their
+surfaces through tr.currentEntity, tr.currentModel and tr.orientation,
+and the lighting and fog setup they call write into the entities.
+Collecting them on the workers needs those passed down instead, and
+draw surface buffers per worker merged in entity order.
 =============
 */
 void R_AddEntitySurfaces( void )
@@ -2892,15 +3396,21 @@ R_AddLightInteractions
 */
 void R_AddLightInteractions( void )
 {
-	int          i;
-	trRefLight_t *light;
+	int                 i;
+	trRefLight_t        *light;
 	//bspNode_t     **leafs; //unused
-	bspNode_t    *leaf;
-	link_t       *l; //, *sentinel; //unused
+	bspNode_t           *leaf;
+	link_t              *l; //, *sentinel; //unused
+	static trRefLight_t *visibleLights[ MAX_REF_LIGHTS ];
+	int                 numVisibleLights;
+	orientationr_t      orientation;
+
+	numVisibleLights = 0;
 
 	for ( i = 0; i < tr.refdef.numLights; i++ )
 	{
 		light = tr.currentLight = &tr.refdef.lights[ i ];
+		light->entityCulls = NULL;
 
 		if ( light->isStatic )
 		{
@@ -3073,6 +3583,27 @@ void R_AddLightInteractions( void )
 		// look for proper attenuation shader
 		R_SetupLightShader( light );
 
+		visibleLights[ numVisibleLights++ ] = light;
+	}
+
+	// the light setup above left tr.orientation set up for the last light
+	orientation = tr.orientation;
+
+	// test the entities against all lights at once on the worker threads,
+	// the interactions below only pick up the results
+	if ( r_parallelLightCulling->integer && GLimp_NumWorkers() && r_drawentities->integer &&
+	     !( r_deferredShading->integer && r_shadows->integer < SHADOWING_ESM16 ) )
+	{
+		R_CullLightEntities( visibleLights, numVisibleLights );
+	}
+
+	for ( i = 0; i < numVisibleLights; i++ )
+	{
+		light = tr.currentLight = visibleLights[ i ];
+
+		// world interactions need tr.orientation set up for this light
+		R_RotateLightForViewParms( light, &tr.viewParms, &tr.orientation );
+
 		// setup interactions
 		light->firstInteraction = NULL;
 		light->lastInteraction = NULL;
@@ -3125,7 +3656,11 @@ void R_AddLightInteractions( void )
 			tr.refdef.numInteractions -= light->numInteractions;
 			light->cull = CULL_OUT;
 		}
+
+		light->entityCulls = NULL;
 	}
+
+	tr.orientation = orientation;
 }
 
 void R_AddLightBoundsToVisBounds( void )
@@ -312,6 +312,7 @@ void R_AddMDVSurfaces( trRefEntity_t *ent )
 	// cull the entire model if merged bounding box of both frames
 	// is outside the view frustum.
 	R_CullMDV( model, ent );
+	R_CullOccludedEntity( ent );
 
 	if ( ent->cull == CULL_OUT )
 	{
@@ -422,25 +423,13 @@ void R_AddMDVInteractions( trRefEntity_t *ent, trRefLight_t *light, interactionT
 
 	model = tr.currentModel->mdv[ lod ];
 
-	// do a quick AABB cull
-	if ( !BoundsIntersect( light->worldBounds[ 0 ], light->worldBounds[ 1 ], ent->worldBounds[ 0 ], ent->worldBounds[ 1 ] ) )
+	// cull against the light volume and find the shadow cube sides it touches
+	if ( !R_LightIntersectsEntity( light, ent, &cubeSideBits ) )
 	{
 		tr.pc.c_dlightSurfacesCulled += model->numSurfaces;
 		return;
 	}
 
-	// do a more expensive and precise light frustum cull
-	if ( !r_noLightFrustums->integer )
-	{
-		if ( R_CullLightWorldBounds( light, ent->worldBounds ) == CULL_OUT )
-		{
-			tr.pc.c_dlightSurfacesCulled += model->numSurfaces;
-			return;
-		}
-	}
-
-	cubeSideBits = R_CalcLightCubeSideBits( light, ent->worldBounds );
-
 	// generate interactions with all surfaces
 	if ( r_vboModels->integer && model->numVBOSurfaces )
 	{
@@ -0,0 +1,890 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+Copyright (C) 2006-2008 Robert Beckebans <trebor_7@users.sourceforge.net>
+
+This file is part of Daemon source code.
+
+Daemon source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Daemon source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Daemon source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// tr_occlusion.c -- software occlusion culling
+
+// instead of asking the GPU with occlusion queries like the CHC++ code in
+// tr_world.cpp does, the large opaque faces of the potentially visible leafs
+// are rasterized into a small depth buffer on the CPU before the world is
+// traversed, and the bounds of the BSP nodes and entities are tested against it
+
+#include "tr_local.h"
+
+#if defined( __SSE__ ) || id386_sse
+#include <xmmintrin.h>
+#define OCCLUSION_SSE 1
+#else
+#define OCCLUSION_SSE 0
+#endif
+
+#define OCCLUSION_WIDTH         256 // must be a multiple of 4
+#define OCCLUSION_HEIGHT        128
+#define OCCLUSION_BAND_ROWS     16 // rasterized by one job
+#define OCCLUSION_BANDS         ( OCCLUSION_HEIGHT / OCCLUSION_BAND_ROWS )
+
+#define MAX_VIEW_OCCLUDERS      1024
+#define MAX_OCCLUSION_POLYGONS  2048
+#define MAX_OCCLUSION_EDGES     ( MAX_OCCLUSION_POLYGONS * 8 )
+#define MAX_OCCLUDER_CLIP_VERTS ( MAX_OCCLUDER_VERTS + 5 ) // clipped by the near and the 4 side planes
+
+typedef struct
+{
+	int   firstEdge, numEdges; // the whole pixel is inside if a * x + b * y + c >= 0 for all of them
+	float depth[ 3 ]; // 1 / w at the farthest point of the pixel
+	int   mins[ 2 ], maxs[ 2 ]; // covered pixels
+} occlusionPolygon_t;
+
+typedef struct
+{
+	occluder_t *occluder;
+	float      score;
+} viewOccluder_t;
+
+static float              s_occlusionDepth[ OCCLUSION_WIDTH * OCCLUSION_HEIGHT ]; // 1 / w of the nearest occluder, 0 if there is none
+static occlusionPolygon_t s_occlusionPolygons[ MAX_OCCLUSION_POLYGONS ];
+static int                s_numOcclusionPolygons;
+static float              s_occlusionEdges[ MAX_OCCLUSION_EDGES ][ 3 ];
+static int                s_numOcclusionEdges;
+static viewOccluder_t     s_viewOccluders[ MAX_VIEW_OCCLUDERS ];
+static int                s_numViewOccluders;
+static int                s_occluderCollectCount;
+static matrix_t           s_occlusionMatrix; // world to clip space of the view the buffer was rendered for
+static float              s_occlusionNear;
+static int                s_occlusionViewCount = -1; // tr.viewCountNoReset of that view
+static int                s_occlusionBenchIterations;
+
+/*
+=================
+R_CollectOccluders
+
+Finds the occluders of the leafs marked by R_MarkLeaves that are inside the
+view frustum, when there are too many the ones that look the biggest are kept
+=================
+*/
+static void R_CollectOccluders( void )
+{
+	int            i, j, k, worst;
+	bspNode_t      *leaf;
+	occluder_t     *occluder;
+	viewOccluder_t *viewOccluder;
+	vec3_t         delta;
+	float          score;
+
+	s_numViewOccluders = 0;
+	s_occluderCollectCount++;
+
+	for ( i = tr.world->numDecisionNodes, leaf = &tr.world->nodes[ i ]; i < tr.world->numnodes; i++, leaf++ )
+	{
+		if ( leaf->visCounts[ tr.visIndex ] != tr.visCounts[ tr.visIndex ] )
+		{
+			continue;
+		}
+
+		for ( j = 0; j < leaf->numMarkSurfaces; j++ )
+		{
+			k = tr.world->surfaceOccluders[ leaf->markSurfaces[ j ] - tr.world->surfaces ];
+
+			if ( k < 0 )
+			{
+				continue;
+			}
+
+			occluder = &tr.world->occluders[ k ];
+
+			// faces are shared by several leafs
+			if ( occluder->collectCount == s_occluderCollectCount )
+			{
+				continue;
+			}
+
+			occluder->collectCount = s_occluderCollectCount;
+
+			if ( R_CullPointAndRadius( occluder->origin, occluder->radius ) == CULL_OUT )
+			{
+				continue;
+			}
+
+			VectorSubtract( occluder->origin, tr.viewParms.orientation.origin, delta );
+			score = occluder->radius * occluder->radius / ( DotProduct( delta, delta ) + 1.0f );
+
+			if ( s_numViewOccluders < MAX_VIEW_OCCLUDERS )
+			{
+				viewOccluder = &s_viewOccluders[ s_numViewOccluders++ ];
+			}
+			else
+			{
+				for ( k = 1, worst = 0; k < MAX_VIEW_OCCLUDERS; k++ )
+				{
+					if ( s_viewOccluders[ k ].score < s_viewOccluders[ worst ].score )
+					{
+						worst = k;
+					}
+				}
+
+				if ( s_viewOccluders[ worst ].score >= score )
+				{
+					continue;
+				}
+
+				viewOccluder = &s_viewOccluders[ worst ];
+			}
+
+			viewOccluder->occluder = occluder;
+			viewOccluder->score = score;
+		}
+	}
+}
+
+/*
+=================
+ViewOccluderCompare
+
+compare function for qsort(), biggest first
+=================
+*/
+static int ViewOccluderCompare( const void *a, const void *b )
+{
+	const viewOccluder_t *aa = ( const viewOccluder_t * ) a;
+	const viewOccluder_t *bb = ( const viewOccluder_t * ) b;
+
+	if ( aa->score > bb->score )
+	{
+		return -1;
+	}
+
+	if ( aa->score < bb->score )
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+=================
+R_OcclusionPlaneDistance
+
+The near plane and the 4 side planes of the view frustum in clip space
+=================
+*/
+static float R_OcclusionPlaneDistance( const vec4_t v, int plane )
+{
+	switch ( plane )
+	{
+		case 0:
+			return v[ 3 ] - s_occlusionNear;
+
+		case 1:
+			return v[ 3 ] + v[ 0 ];
+
+		case 2:
+			return v[ 3 ] - v[ 0 ];
+
+		case 3:
+			return v[ 3 ] + v[ 1 ];
+
+		default:
+			return v[ 3 ] - v[ 1 ];
+	}
+}
+
+/*
+=================
+R_ClipOccluderPolygon
+
+Clips a clip space polygon to the view frustum, returns the number of vertices
+left. inner[ i ] is set if the edge from vertex i to the next one runs along
+a side plane, those don't need to be pulled in because nothing beyond them
+is tested
+=================
+*/
+static int R_ClipOccluderPolygon( vec4_t clip[ MAX_OCCLUDER_CLIP_VERTS ], byte inner[ MAX_OCCLUDER_CLIP_VERTS ], int numVerts )
+{
+	vec4_t scratch[ MAX_OCCLUDER_CLIP_VERTS ];
+	byte   scratchInner[ MAX_OCCLUDER_CLIP_VERTS ];
+	vec4_t *in, *out;
+	byte   *innerIn, *innerOut;
+	float  dists[ MAX_OCCLUDER_CLIP_VERTS ];
+	int    i, j, plane, numIn, numOut, numFront;
+
+	in = clip;
+	out = scratch;
+	innerIn = inner;
+	innerOut = scratchInner;
+	numIn = numVerts;
+
+	for ( i = 0; i < numIn; i++ )
+	{
+		inner[ i ] = 0;
+	}
+
+	for ( plane = 0; plane < 5; plane++ )
+	{
+		for ( i = 0, numFront = 0; i < numIn; i++ )
+		{
+			dists[ i ] = R_OcclusionPlaneDistance( in[ i ], plane );
+
+			if ( dists[ i ] >= 0 )
+			{
+				numFront++;
+			}
+		}
+
+		if ( !numFront )
+		{
+			return 0;
+		}
+
+		if ( numFront == numIn )
+		{
+			continue;
+		}
+
+		for ( i = 0, numOut = 0; i < numIn; i++ )
+		{
+			j = ( i + 1 ) % numIn;
+
+			if ( dists[ i ] >= 0 )
+			{
+				Vector4Copy( in[ i ], out[ numOut ] );
+				innerOut[ numOut ] = innerIn[ i ];
+				numOut++;
+			}
+
+			if ( ( dists[ i ] >= 0 ) != ( dists[ j ] >= 0 ) )
+			{
+				float frac = dists[ i ] / ( dists[ i ] - dists[ j ] );
+
+				out[ numOut ][ 0 ] = in[ i ][ 0 ] + frac * ( in[ j ][ 0 ] - in[ i ][ 0 ] );
+				out[ numOut ][ 1 ] = in[ i ][ 1 ] + frac * ( in[ j ][ 1 ] - in[ i ][ 1 ] );
+				out[ numOut ][ 2 ] = in[ i ][ 2 ] + frac * ( in[ j ][ 2 ] - in[ i ][ 2 ] );
+				out[ numOut ][ 3 ] = in[ i ][ 3 ] + frac * ( in[ j ][ 3 ] - in[ i ][ 3 ] );
+
+				// leaving runs along the plane, entering continues the old edge
+				innerOut[ numOut ] = ( dists[ i ] >= 0 ) ? ( plane != 0 ) : innerIn[ i ];
+				numOut++;
+			}
+		}
+
+		// swap the buffers
+		numIn = numOut;
+		in = out;
+		out = ( out == scratch ) ? clip : scratch;
+		innerIn = innerOut;
+		innerOut = ( innerOut == scratchInner ) ? inner : scratchInner;
+	}
+
+	if ( in != clip )
+	{
+		for ( i = 0; i < numIn; i++ )
+		{
+			Vector4Copy( in[ i ], clip[ i ] );
+			inner[ i ] = innerIn[ i ];
+		}
+	}
+
+	return numIn;
+}
+
+/*
+=================
+R_SetupOcclusionPolygon
+
+Sets up the edge functions and the depth plane of a convex polygon with its
+vertices in pixel coordinates and 1 / w as depth. The edges that aren't inner
+are pulled in so only the pixels the polygon covers completely are rasterized
+=================
+*/
+static void R_SetupOcclusionPolygon( vec3_t *v, const byte *inner, int numVerts )
+{
+	occlusionPolygon_t *poly;
+	float              *edge;
+	float              area, sign, best, triArea, a, b;
+	int                i, j, bestVert;
+
+	if ( s_numOcclusionPolygons >= MAX_OCCLUSION_POLYGONS || s_numOcclusionEdges + numVerts > MAX_OCCLUSION_EDGES )
+	{
+		return;
+	}
+
+	// the biggest triangle of the fan gives the most precise depth plane
+	area = 0;
+	best = 0;
+	bestVert = 1;
+
+	for ( i = 1; i < numVerts - 1; i++ )
+	{
+		triArea = ( v[ i ][ 0 ] - v[ 0 ][ 0 ] ) * ( v[ i + 1 ][ 1 ] - v[ 0 ][ 1 ] ) - ( v[ i + 1 ][ 0 ] - v[ 0 ][ 0 ] ) * ( v[ i ][ 1 ] - v[ 0 ][ 1 ] );
+		area += triArea;
+
+		if ( fabs( triArea ) > fabs( best ) )
+		{
+			best = triArea;
+			bestVert = i;
+		}
+	}
+
+	// too thin to cover anything
+	if ( fabs( area ) < 0.001f || fabs( best ) < 0.001f )
+	{
+		return;
+	}
+
+	poly = &s_occlusionPolygons[ s_numOcclusionPolygons ];
+
+	poly->mins[ 0 ] = poly->mins[ 1 ] = 99999;
+	poly->maxs[ 0 ] = poly->maxs[ 1 ] = -99999;
+
+	for ( i = 0; i < numVerts; i++ )
+	{
+		for ( j = 0; j < 2; j++ )
+		{
+			poly->mins[ j ] = MIN( poly->mins[ j ], ( int ) ceil( v[ i ][ j ] ) );
+			poly->maxs[ j ] = MAX( poly->maxs[ j ], ( int ) floor( v[ i ][ j ] ) );
+		}
+	}
+
+	poly->mins[ 0 ] = MAX( poly->mins[ 0 ], 0 );
+	poly->mins[ 1 ] = MAX( poly->mins[ 1 ], 0 );
+	poly->maxs[ 0 ] = MIN( poly->maxs[ 0 ], OCCLUSION_WIDTH - 1 );
+	poly->maxs[ 1 ] = MIN( poly->maxs[ 1 ], OCCLUSION_HEIGHT - 1 );
+
+	if ( poly->mins[ 0 ] > poly->maxs[ 0 ] || poly->mins[ 1 ] > poly->maxs[ 1 ] )
+	{
+		return;
+	}
+
+	// make the inside positive for both windings
+	sign = area > 0 ? 1.0f : -1.0f;
+
+	poly->firstEdge = s_numOcclusionEdges;
+	poly->numEdges = numVerts;
+
+	for ( i = 0; i < numVerts; i++ )
+	{
+		j = ( i + 1 ) % numVerts;
+		edge = s_occlusionEdges[ s_numOcclusionEdges++ ];
+
+		edge[ 0 ] = ( v[ i ][ 1 ] - v[ j ][ 1 ] ) * sign;
+		edge[ 1 ] = ( v[ j ][ 0 ] - v[ i ][ 0 ] ) * sign;
+		edge[ 2 ] = -( edge[ 0 ] * v[ i ][ 0 ] + edge[ 1 ] * v[ i ][ 1 ] );
+
+		if ( !inner[ i ] )
+		{
+			edge[ 2 ] -= 0.5f * ( fabs( edge[ 0 ] ) + fabs( edge[ 1 ] ) );
+		}
+	}
+
+	i = bestVert;
+	j = bestVert + 1;
+
+	a = ( ( v[ i ][ 2 ] - v[ 0 ][ 2 ] ) * ( v[ j ][ 1 ] - v[ 0 ][ 1 ] ) - ( v[ j ][ 2 ] - v[ 0 ][ 2 ] ) * ( v[ i ][ 1 ] - v[ 0 ][ 1 ] ) ) / best;
+	b = ( ( v[ j ][ 2 ] - v[ 0 ][ 2 ] ) * ( v[ i ][ 0 ] - v[ 0 ][ 0 ] ) - ( v[ i ][ 2 ] - v[ 0 ][ 2 ] ) * ( v[ j ][ 0 ] - v[ 0 ][ 0 ] ) ) / best;
+
+	// the pixel is only hidden as far as its farthest corner
+	poly->depth[ 0 ] = a;
+	poly->depth[ 1 ] = b;
+	poly->depth[ 2 ] = v[ 0 ][ 2 ] - a * v[ 0 ][ 0 ] - b * v[ 0 ][ 1 ] - 0.5f * ( fabs( a ) + fabs( b ) );
+
+	s_numOcclusionPolygons++;
+}
+
+/*
+=================
+R_SetupOcclusionPolygons
+
+Transforms, clips and sets up the outlines of the occluders of the
+current view, biggest occluders first until the buffers are full
+=================
+*/
+static void R_SetupOcclusionPolygons( void )
+{
+	int         i, j, numVerts;
+	occluder_t  *occluder;
+	vec3_t      *xyz;
+	vec4_t      clip[ MAX_OCCLUDER_CLIP_VERTS ];
+	byte        inner[ MAX_OCCLUDER_CLIP_VERTS ];
+	vec3_t      screen[ MAX_OCCLUDER_CLIP_VERTS ];
+	const float *m;
+
+	MatrixMultiply( tr.viewParms.projectionMatrix, tr.viewParms.world.modelViewMatrix, s_occlusionMatrix );
+	s_occlusionNear = tr.viewParms.zNear;
+	m = s_occlusionMatrix;
+
+	R_CollectOccluders();
+	qsort( s_viewOccluders, s_numViewOccluders, sizeof( s_viewOccluders[ 0 ] ), ViewOccluderCompare );
+
+	s_numOcclusionPolygons = 0;
+	s_numOcclusionEdges = 0;
+
+	for ( i = 0; i < s_numViewOccluders && s_numOcclusionPolygons < MAX_OCCLUSION_POLYGONS; i++ )
+	{
+		occluder = s_viewOccluders[ i ].occluder;
+		xyz = &tr.world->occluderVerts[ occluder->firstVert ];
+
+		for ( j = 0; j < occluder->numVerts; j++ )
+		{
+			clip[ j ][ 0 ] = m[ 0 ] * xyz[ j ][ 0 ] + m[ 4 ] * xyz[ j ][ 1 ] + m[ 8 ] * xyz[ j ][ 2 ] + m[ 12 ];
+			clip[ j ][ 1 ] = m[ 1 ] * xyz[ j ][ 0 ] + m[ 5 ] * xyz[ j ][ 1 ] + m[ 9 ] * xyz[ j ][ 2 ] + m[ 13 ];
+			clip[ j ][ 2 ] = 0; // only 1 / w is needed
+			clip[ j ][ 3 ] = m[ 3 ] * xyz[ j ][ 0 ] + m[ 7 ] * xyz[ j ][ 1 ] + m[ 11 ] * xyz[ j ][ 2 ] + m[ 15 ];
+		}
+
+		numVerts = R_ClipOccluderPolygon( clip, inner, occluder->numVerts );
+
+		if ( numVerts < 3 )
+		{
+			continue;
+		}
+
+		// to pixel coordinates with the pixel centers on integers
+		for ( j = 0; j < numVerts; j++ )
+		{
+			screen[ j ][ 2 ] = 1.0f / clip[ j ][ 3 ];
+			screen[ j ][ 0 ] = ( clip[ j ][ 0 ] * screen[ j ][ 2 ] * 0.5f + 0.5f ) * OCCLUSION_WIDTH - 0.5f;
+			screen[ j ][ 1 ] = ( clip[ j ][ 1 ] * screen[ j ][ 2 ] * 0.5f + 0.5f ) * OCCLUSION_HEIGHT - 0.5f;
+		}
+
+		R_SetupOcclusionPolygon( screen, inner, numVerts );
+	}
+}
+
+/*
+=================
+R_RasterizeOcclusionBand
+
+Clears a band of rows of the depth buffer and rasterizes
+the parts of the polygons that fall into it
+=================
+*/
+static void R_RasterizeOcclusionBand( void *data, int band )
+{
+	int                i, j, x, y, firstRow, lastRow, minY, maxY, minX, numEdges;
+	occlusionPolygon_t *poly;
+	float              ( *edges )[ 3 ];
+	float              *row;
+#if OCCLUSION_SSE
+	__m128             lanes, zero, depth, depthStep, inside;
+	__m128             edgeValues[ MAX_OCCLUDER_CLIP_VERTS ], edgeSteps[ MAX_OCCLUDER_CLIP_VERTS ];
+#else
+	float              depth, edgeValues[ MAX_OCCLUDER_CLIP_VERTS ];
+	qboolean           inside;
+#endif
+
+	firstRow = band * OCCLUSION_BAND_ROWS;
+	lastRow = firstRow + OCCLUSION_BAND_ROWS - 1;
+
+	Com_Memset( &s_occlusionDepth[ firstRow * OCCLUSION_WIDTH ], 0, OCCLUSION_BAND_ROWS * OCCLUSION_WIDTH * sizeof( float ) );
+
+#if OCCLUSION_SSE
+	lanes = _mm_set_ps( 3, 2, 1, 0 );
+	zero = _mm_setzero_ps();
+#endif
+
+	for ( i = 0, poly = s_occlusionPolygons; i < s_numOcclusionPolygons; i++, poly++ )
+	{
+		if ( poly->maxs[ 1 ] < firstRow || poly->mins[ 1 ] > lastRow )
+		{
+			continue;
+		}
+
+		minY = MAX( poly->mins[ 1 ], firstRow );
+		maxY = MIN( poly->maxs[ 1 ], lastRow );
+		edges = &s_occlusionEdges[ poly->firstEdge ];
+		numEdges = poly->numEdges;
+
+#if OCCLUSION_SSE
+		// 4 pixels at a time from an aligned column, the edges mask the extra ones
+		minX = poly->mins[ 0 ] & ~3;
+
+		for ( j = 0; j < numEdges; j++ )
+		{
+			edgeSteps[ j ] = _mm_set1_ps( edges[ j ][ 0 ] * 4 );
+		}
+
+		depthStep = _mm_set1_ps( poly->depth[ 0 ] * 4 );
+
+		for ( y = minY; y <= maxY; y++ )
+		{
+			row = &s_occlusionDepth[ y * OCCLUSION_WIDTH ];
+
+			for ( j = 0; j < numEdges; j++ )
+			{
+				edgeValues[ j ] = _mm_add_ps( _mm_set1_ps( edges[ j ][ 0 ] * minX + edges[ j ][ 1 ] * y + edges[ j ][ 2 ] ),
+				                              _mm_mul_ps( _mm_set1_ps( edges[ j ][ 0 ] ), lanes ) );
+			}
+
+			depth = _mm_add_ps( _mm_set1_ps( poly->depth[ 0 ] * minX + poly->depth[ 1 ] * y + poly->depth[ 2 ] ),
+			                    _mm_mul_ps( _mm_set1_ps( poly->depth[ 0 ] ), lanes ) );
+
+			for ( x = minX; x <= poly->maxs[ 0 ]; x += 4 )
+			{
+				inside = _mm_cmpge_ps( edgeValues[ 0 ], zero );
+				edgeValues[ 0 ] = _mm_add_ps( edgeValues[ 0 ], edgeSteps[ 0 ] );
+
+				for ( j = 1; j < numEdges; j++ )
+				{
+					inside = _mm_and_ps( inside, _mm_cmpge_ps( edgeValues[ j ], zero ) );
+					edgeValues[ j ] = _mm_add_ps( edgeValues[ j ], edgeSteps[ j ] );
+				}
+
+				// the buffer is never negative so the masked out lanes keep their value
+				_mm_storeu_ps( &row[ x ], _mm_max_ps( _mm_loadu_ps( &row[ x ] ), _mm_and_ps( inside, depth ) ) );
+
+				depth = _mm_add_ps( depth, depthStep );
+			}
+		}
+#else
+		minX = poly->mins[ 0 ];
+
+		for ( y = minY; y <= maxY; y++ )
+		{
+			row = &s_occlusionDepth[ y * OCCLUSION_WIDTH ];
+
+			for ( j = 0; j < numEdges; j++ )
+			{
+				edgeValues[ j ] = edges[ j ][ 0 ] * minX + edges[ j ][ 1 ] * y + edges[ j ][ 2 ];
+			}
+
+			depth = poly->depth[ 0 ] * minX + poly->depth[ 1 ] * y + poly->depth[ 2 ];
+
+			for ( x = minX; x <= poly->maxs[ 0 ]; x++ )
+			{
+				for ( j = 0, inside = qtrue; j < numEdges; j++ )
+				{
+					if ( edgeValues[ j ] < 0 )
+					{
+						inside = qfalse;
+					}
+
+					edgeValues[ j ] += edges[ j ][ 0 ];
+				}
+
+				if ( inside && depth > row[ x ] )
+				{
+					row[ x ] = depth;
+				}
+
+				depth += poly->depth[ 0 ];
+			}
+		}
+#endif
+	}
+}
+
+/*
+=================
+R_OccludedBox
+
+Returns qtrue if the world space box is hidden behind the occluders
+rasterized for the current view
+=================
+*/
+qboolean R_OccludedBox( const vec3_t mins, const vec3_t maxs )
+{
+	int         i, x, y, minX, minY, maxX, maxY;
+	float       w, sx, sy, minW, screenMins[ 2 ], screenMaxs[ 2 ], depth;
+	vec3_t      corner;
+	const float *m;
+	const float *row;
+
+	if ( s_occlusionViewCount != tr.viewCountNoReset )
+	{
+		return qfalse;
+	}
+
+	m = s_occlusionMatrix;
+	minW = 0;
+	screenMins[ 0 ] = screenMins[ 1 ] = 99999;
+	screenMaxs[ 0 ] = screenMaxs[ 1 ] = -99999;
+
+	for ( i = 0; i < 8; i++ )
+	{
+		corner[ 0 ] = ( i & 1 ) ? maxs[ 0 ] : mins[ 0 ];
+		corner[ 1 ] = ( i & 2 ) ? maxs[ 1 ] : mins[ 1 ];
+		corner[ 2 ] = ( i & 4 ) ? maxs[ 2 ] : mins[ 2 ];
+
+		w = m[ 3 ] * corner[ 0 ] + m[ 7 ] * corner[ 1 ] + m[ 11 ] * corner[ 2 ] + m[ 15 ];
+
+		// the box reaches the viewer
+		if ( w < s_occlusionNear )
+		{
+			return qfalse;
+		}
+
+		sx = ( m[ 0 ] * corner[ 0 ] + m[ 4 ] * corner[ 1 ] + m[ 8 ] * corner[ 2 ] + m[ 12 ] ) / w;
+		sy = ( m[ 1 ] * corner[ 0 ] + m[ 5 ] * corner[ 1 ] + m[ 9 ] * corner[ 2 ] + m[ 13 ] ) / w;
+
+		screenMins[ 0 ] = MIN( screenMins[ 0 ], sx );
+		screenMins[ 1 ] = MIN( screenMins[ 1 ], sy );
+		screenMaxs[ 0 ] = MAX( screenMaxs[ 0 ], sx );
+		screenMaxs[ 1 ] = MAX( screenMaxs[ 1 ], sy );
+
+		if ( !i || w < minW )
+		{
+			minW = w;
+		}
+	}
+
+	// every pixel the box touches
+	minX = ( int ) floor( ( screenMins[ 0 ] * 0.5f + 0.5f ) * OCCLUSION_WIDTH );
+	minY = ( int ) floor( ( screenMins[ 1 ] * 0.5f + 0.5f ) * OCCLUSION_HEIGHT );
+	maxX = ( int ) floor( ( screenMaxs[ 0 ] * 0.5f + 0.5f ) * OCCLUSION_WIDTH );
+	maxY = ( int ) floor( ( screenMaxs[ 1 ] * 0.5f + 0.5f ) * OCCLUSION_HEIGHT );
+
+	// leave boxes outside the view to the frustum culling
+	if ( maxX < 0 || maxY < 0 || minX >= OCCLUSION_WIDTH || minY >= OCCLUSION_HEIGHT )
+	{
+		return qfalse;
+	}
+
+	minX = MAX( minX, 0 );
+	minY = MAX( minY, 0 );
+	maxX = MIN( maxX, OCCLUSION_WIDTH - 1 );
+	maxY = MIN( maxY, OCCLUSION_HEIGHT - 1 );
+
+	// the nearest point of the box has to be behind the occluders everywhere
+	depth = 1.0f / minW;
+
+#if OCCLUSION_SSE
+	{
+		__m128 lanes, first, last, boxDepth, columns, visible;
+
+		lanes = _mm_set_ps( 3, 2, 1, 0 );
+		first = _mm_set1_ps( minX );
+		last = _mm_set1_ps( maxX );
+		boxDepth = _mm_set1_ps( depth );
+
+		for ( y = minY; y <= maxY; y++ )
+		{
+			row = &s_occlusionDepth[ y * OCCLUSION_WIDTH ];
+
+			for ( x = minX & ~3; x <= maxX; x += 4 )
+			{
+				columns = _mm_add_ps( _mm_set1_ps( x ), lanes );
+				visible = _mm_and_ps( _mm_cmple_ps( _mm_loadu_ps( &row[ x ] ), boxDepth ),
+				                      _mm_and_ps( _mm_cmpge_ps( columns, first ), _mm_cmple_ps( columns, last ) ) );
+
+				if ( _mm_movemask_ps( visible ) )
+				{
+					return qfalse;
+				}
+			}
+		}
+	}
+#else
+
+	for ( y = minY; y <= maxY; y++ )
+	{
+		row = &s_occlusionDepth[ y * OCCLUSION_WIDTH ];
+
+		for ( x = minX; x <= maxX; x++ )
+		{
+			if ( row[ x ] <= depth )
+			{
+				return qfalse;
+			}
+		}
+	}
+
+#endif
+
+	return qtrue;
+}
+
+/*
+=================
+R_CullOccludedEntity
+
+Marks a model that survived the frustum culling as culled when its world
+bounds are hidden, it still gets its shadow only interactions like the
+models outside the frustum
+=================
+*/
+void R_CullOccludedEntity( trRefEntity_t *ent )
+{
+	if ( ent->cull == CULL_OUT || ( ent->e.renderfx & ( RF_FIRST_PERSON | RF_DEPTHHACK ) ) )
+	{
+		return;
+	}
+
+	if ( R_OccludedBox( ent->worldBounds[ 0 ], ent->worldBounds[ 1 ] ) )
+	{
+		tr.pc.c_occludedEntities++;
+		ent->cull = CULL_OUT;
+	}
+}
+
+/*
+=================
+R_BenchOcclusionCulling
+
+Times rendering the occlusion buffer of the current view on the render workers and
+on one thread, and how many of the leafs in the frustum it hides
+=================
+*/
+static void R_BenchOcclusionCulling( void )
+{
+	int       i, j, k, r, start, setupMsec, threadedMsec, singleMsec, testMsec;
+	int       numLeafs, numSurfaces, hiddenLeafs, hiddenSurfaces;
+	bspNode_t *leaf, **leafs;
+
+	start = ri.Milliseconds();
+
+	for ( k = 0; k < s_occlusionBenchIterations; k++ )
+	{
+		R_SetupOcclusionPolygons();
+	}
+
+	setupMsec = ri.Milliseconds() - start;
+	start = ri.Milliseconds();
+
+	for ( k = 0; k < s_occlusionBenchIterations; k++ )
+	{
+		GLimp_RunJobs( R_RasterizeOcclusionBand, NULL, OCCLUSION_BANDS );
+	}
+
+	threadedMsec = ri.Milliseconds() - start;
+	start = ri.Milliseconds();
+
+	for ( k = 0; k < s_occlusionBenchIterations; k++ )
+	{
+		for ( j = 0; j < OCCLUSION_BANDS; j++ )
+		{
+			R_RasterizeOcclusionBand( NULL, j );
+		}
+	}
+
+	singleMsec = ri.Milliseconds() - start;
+
+	// the leafs the frustum culling would let through
+	leafs = ( bspNode_t ** ) ri.Hunk_AllocateTempMemory( tr.world->numnodes * sizeof( *leafs ) );
+	numLeafs = 0;
+	numSurfaces = 0;
+
+	for ( i = tr.world->numDecisionNodes, leaf = &tr.world->nodes[ i ]; i < tr.world->numnodes; i++, leaf++ )
+	{
+		if ( leaf->visCounts[ tr.visIndex ] != tr.visCounts[ tr.visIndex ] || !leaf->numMarkSurfaces )
+		{
+			continue;
+		}
+
+		for ( j = 0; j < FRUSTUM_PLANES; j++ )
+		{
+			r = BoxOnPlaneSide( leaf->mins, leaf->maxs, &tr.viewParms.frustums[ 0 ][ j ] );
+
+			if ( r == 2 )
+			{
+				break;
+			}
+		}
+
+		if ( j == FRUSTUM_PLANES )
+		{
+			leafs[ numLeafs++ ] = leaf;
+			numSurfaces += leaf->numMarkSurfaces;
+		}
+	}
+
+	s_occlusionViewCount = tr.viewCountNoReset;
+	hiddenLeafs = 0;
+	hiddenSurfaces = 0;
+	start = ri.Milliseconds();
+
+	for ( k = 0; k < s_occlusionBenchIterations; k++ )
+	{
+		for ( i = 0; i < numLeafs; i++ )
+		{
+			if ( R_OccludedBox( leafs[ i ]->mins, leafs[ i ]->maxs ) && !k )
+			{
+				hiddenLeafs++;
+				hiddenSurfaces += leafs[ i ]->numMarkSurfaces;
+			}
+		}
+	}
+
+	testMsec = ri.Milliseconds() - start;
+	s_occlusionViewCount = -1;
+
+	ri.Printf( PRINT_ALL, "%i occluders %i polygons rendered %i times: setup %i msec, rasterized %i msec on %i workers, %i msec on one thread\n",
+	           s_numViewOccluders, s_numOcclusionPolygons, s_occlusionBenchIterations, setupMsec, threadedMsec, GLimp_NumWorkers(),
+	           singleMsec );
+	ri.Printf( PRINT_ALL, "%i of %i leafs and %i of %i leaf surfaces in the frustum hidden, tested in %i msec\n",
+	           hiddenLeafs, numLeafs, hiddenSurfaces, numSurfaces, testMsec );
+
+	ri.Hunk_FreeTempMemory( leafs );
+}
+
+/*
+=================
+R_OcclusionBench_f
+
+Times the software occlusion culling of the next main view
+=================
+*/
+void R_OcclusionBench_f( void )
+{
+	s_occlusionBenchIterations = ri.Cmd_Argc() > 1 ? atoi( ri.Cmd_Argv( 1 ) ) : 100;
+	s_occlusionBenchIterations = MAX( s_occlusionBenchIterations, 1 );
+}
+
+/*
+=================
+R_RenderOcclusionBuffer
+
+Rasterizes the occluders of the leafs marked by R_MarkLeaves, the bands of
+the buffer are split over the render workers. Returns qtrue if the nodes and
+entities of the current view can be tested with R_OccludedBox
+=================
+*/
+qboolean R_RenderOcclusionBuffer( void )
+{
+	int startTime;
+
+	// occluders between a portal and its camera are clipped away by the GPU
+	if ( !tr.world->numOccluders || tr.viewParms.isPortal || r_nocull->integer )
+	{
+		return qfalse;
+	}
+
+	if ( s_occlusionBenchIterations )
+	{
+		R_BenchOcclusionCulling();
+		s_occlusionBenchIterations = 0;
+	}
+
+	if ( !r_softwareOcclusionCulling->integer )
+	{
+		return qfalse;
+	}
+
+	startTime = ri.Milliseconds();
+
+	R_SetupOcclusionPolygons();
+	GLimp_RunJobs( R_RasterizeOcclusionBand, NULL, OCCLUSION_BANDS );
+
+	s_occlusionViewCount = tr.viewCountNoReset;
+	tr.pc.c_occluders += s_numOcclusionPolygons;
+	tr.pc.c_occlusionBufferTime += ri.Milliseconds() - startTime;
+
+	return qtrue;
+}
@@ -1677,7 +1677,7 @@ Tess_SurfaceMD5
 */
 static void Tess_SurfaceMD5( md5Surface_t *srf )
 {
-	int             i, j, k;
+	int             i, j;
 	int             numIndexes = 0;
 	int             numVertexes;
 	md5Model_t      *model;
@@ -1687,6 +1687,7 @@ static void Tess_SurfaceMD5( md5Surface_t *srf )
 //	vec3_t          lightOrigin;
 //	float          *xyzw, *xyzw2;
 	static matrix_t boneMatrices[ MAX_BONES ];
+	skinVertexes_t  skin;
 
 	GLimp_LogComment( "--- Tess_SurfaceMD5 ---\n" );
 
@@ -1705,9 +1706,6 @@ static void Tess_SurfaceMD5( md5Surface_t *srf )
 
 	if ( tess.skipTangentSpaces )
 	{
-		vec3_t      tmpVert;
-		md5Weight_t *w;
-
 		// convert bones back to matrices
 		for ( i = 0; i < model->numBones; i++ )
 		{
@@ -1732,33 +1730,24 @@ static void Tess_SurfaceMD5( md5Surface_t *srf )
 		// deform the vertices by the lerped bones
 		numVertexes = srf->numVerts;
 
-		memset( tess.xyz + tess.numVertexes, 0, numVertexes * sizeof( tess.xyz[ 0 ] ) );
+		skin.bones = boneMatrices;
+		skin.verts = srf->verts;
+		skin.numVerts = numVertexes;
+		skin.weightOffsets = qtrue;
+		skin.tangentSpace = qfalse;
+		skin.xyz = tess.xyz + tess.numVertexes;
+		Tess_SkinVertexes( &skin );
 
 		for ( j = 0, v = srf->verts; j < numVertexes; j++, v++ )
 		{
-			vec3_t      *const tmpPosition = (vec3_t *) tess.xyz[ tess.numVertexes + j ];
-
-			tess.xyz[ tess.numVertexes + j ][ 3 ] = 1;
-
 			tess.texCoords[ tess.numVertexes + j ][ 0 ] = v->texCoords[ 0 ];
 			tess.texCoords[ tess.numVertexes + j ][ 1 ] = v->texCoords[ 1 ];
 			tess.texCoords[ tess.numVertexes + j ][ 2 ] = 0;
 			tess.texCoords[ tess.numVertexes + j ][ 3 ] = 1;
-
-			for ( k = 0, w = v->weights[ 0 ]; k < v->numWeights; k++, w++ )
-			{
-				//bone = &model->bones[w->boneIndex];
-
-				MatrixTransformPoint( boneMatrices[ w->boneIndex ], w->offset, tmpVert );
-				VectorMA( *tmpPosition, w->boneWeight, tmpVert, *tmpPosition );
-			}
 		}
 	}
 	else
 	{
-		vec3_t      tmpVert;
-		md5Weight_t *w;
-
 		// convert bones back to matrices
 		for ( i = 0; i < model->numBones; i++ )
 		{
@@ -1785,51 +1774,23 @@ static void Tess_SurfaceMD5( md5Surface_t *srf )
 		// deform the vertices by the lerped bones
 		numVertexes = srf->numVerts;
 
-		memset( tess.xyz       + tess.numVertexes, 0, numVertexes * sizeof( tess.xyz[ 0 ] ) );
-		memset( tess.tangents  + tess.numVertexes, 0, numVertexes * sizeof( tess.tangents[ 0 ] ) );
-		memset( tess.binormals + tess.numVertexes, 0, numVertexes * sizeof( tess.binormals[ 0 ] ) );
-		memset( tess.normals   + tess.numVertexes, 0, numVertexes * sizeof( tess.normals[ 0 ] ) );
+		skin.bones = boneMatrices;
+		skin.verts = srf->verts;
+		skin.numVerts = numVertexes;
+		skin.weightOffsets = qfalse;
+		skin.tangentSpace = qtrue;
+		skin.xyz = tess.xyz + tess.numVertexes;
+		skin.tangents = tess.tangents + tess.numVertexes;
+		skin.binormals = tess.binormals + tess.numVertexes;
+		skin.normals = tess.normals + tess.numVertexes;
+		Tess_SkinVertexes( &skin );
 
 		for ( j = 0, v = srf->verts; j < numVertexes; j++, v++ )
 		{
-			vec3_t *const tmpPosition = (vec3_t *) tess.xyz[ tess.numVertexes + j ];
-			vec3_t *const tmpTangent  = (vec3_t *) tess.tangents[ tess.numVertexes + j ];
-			vec3_t *const tmpBinormal = (vec3_t *) tess.binormals[ tess.numVertexes + j ];
-			vec3_t *const tmpNormal   = (vec3_t *) tess.normals[ tess.numVertexes + j ];
-
-			tess.xyz[ tess.numVertexes + j ][ 3 ] = 1;
-			tess.tangents[ tess.numVertexes + j ][ 3 ] = 1;
-			tess.binormals[ tess.numVertexes + j ][ 3 ] = 1;
-			tess.normals[ tess.numVertexes + j ][ 3 ] = 1;
-
 			tess.texCoords[ tess.numVertexes + j ][ 0 ] = v->texCoords[ 0 ];
 			tess.texCoords[ tess.numVertexes + j ][ 1 ] = v->texCoords[ 1 ];
 			tess.texCoords[ tess.numVertexes + j ][ 2 ] = 0;
 			tess.texCoords[ tess.numVertexes + j ][ 3 ] = 1;
-
-			for ( k = 0, w = v->weights[ 0 ]; k < v->numWeights; k++, w++ )
-			{
-				//MatrixTransformPoint(boneMatrices[w->boneIndex], w->offset, tmpVert);
-				MatrixTransformPoint( boneMatrices[ w->boneIndex ], v->position, tmpVert );
-				VectorMA( *tmpPosition, w->boneWeight, tmpVert, *tmpPosition );
-
-				MatrixTransformNormal( boneMatrices[ w->boneIndex ], v->tangent, tmpVert );
-				VectorMA( *tmpTangent, w->boneWeight, tmpVert, *tmpTangent );
-
-				MatrixTransformNormal( boneMatrices[ w->boneIndex ], v->binormal, tmpVert );
-				VectorMA( *tmpBinormal, w->boneWeight, tmpVert, *tmpBinormal );
-
-				MatrixTransformNormal( boneMatrices[ w->boneIndex ], v->normal, tmpVert );
-				VectorMA( *tmpNormal, w->boneWeight, tmpVert, *tmpNormal );
-			}
-
-			//VectorNormalize(tmpTangent);
-			//VectorNormalize(tmpBinormal);
-			//VectorNormalize(tmpNormal);
-
-			//VectorCopy(v->tangent, tmpTangent);
-			//VectorCopy(v->binormal, tmpBinormal);
-			//VectorCopy(v->normal, tmpNormal);
 		}
 	}
 
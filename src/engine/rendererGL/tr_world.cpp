@@ -25,6 +25,11 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "tr_local.h"
 #include "gl_shader.h"
 
+static qboolean s_batchCulling; // the world of the current view is culled with R_CullBoxes and R_CullSpheres
+static qboolean s_marksCulled; // R_CullWorldNodes already culled the spheres of all mark surfaces
+static qboolean s_occlusionCulling; // the nodes of the current view are tested with R_OccludedBox
+static int      s_cullBenchIterations;
+
 /*
 =================
 R_CullTriSurf
@@ -123,9 +128,12 @@ Tries to back face cull surfaces before they are lighted or
 added to the sorting list.
 
 This will also allow mirrors on both sides of a model without recursion.
+
+sphereCulled is the R_CullSpheres result for the surface, or NULL
+if the sphere has to be tested here.
 ================
 */
-static qboolean R_CullSurface( surfaceType_t *surface, shader_t *shader, int *frontFace )
+static qboolean R_CullSurface( surfaceType_t *surface, shader_t *shader, int *frontFace, const byte *sphereCulled )
 {
 	srfGeneric_t *gen;
 	int          cull;
@@ -206,7 +214,11 @@ static qboolean R_CullSurface( surfaceType_t *surface, shader_t *shader, int *fr
 
 	{
 		// try sphere cull
-		if ( tr.currentEntity != &tr.worldEntity )
+		if ( sphereCulled )
+		{
+			cull = *sphereCulled ? CULL_OUT : CULL_CLIP;
+		}
+		else if ( tr.currentEntity != &tr.worldEntity )
 		{
 			cull = R_CullLocalPointAndRadius( gen->origin, gen->radius );
 		}
@@ -338,7 +350,7 @@ static void R_AddInteractionSurface( bspSurface_t *surf, trRefLight_t *light )
 R_AddWorldSurface
 ======================
 */
-static void R_AddWorldSurface( bspSurface_t *surf, int decalBits )
+static void R_AddWorldSurface( bspSurface_t *surf, int decalBits, const byte *sphereCulled )
 {
 	int      i, frontFace;
 	shader_t *shader;
@@ -380,7 +392,7 @@ static void R_AddWorldSurface( bspSurface_t *surf, int decalBits )
 #endif
 
 	// try to cull before lighting or adding
-	if ( R_CullSurface( surf->data, surf->shader, &frontFace ) )
+	if ( R_CullSurface( surf->data, surf->shader, &frontFace, sphereCulled ) )
 	{
 		return;
 	}
@@ -388,6 +400,50 @@ static void R_AddWorldSurface( bspSurface_t *surf, int decalBits )
 	R_AddDrawSurf( surf->data, surf->shader, surf->lightmapNum, surf->fogIndex );
 }
 
+/*
+======================
+R_AddMarkSurfaces
+
+Adds the surfaces of a world leaf, their spheres are
+culled in batches first if r_batchCulling is set
+======================
+*/
+static void R_AddMarkSurfaces( bspNode_t *node, int decalBits )
+{
+	int          c, first;
+	bspSurface_t **mark;
+	const byte   *culled;
+
+	mark = node->markSurfaces;
+	c = node->numMarkSurfaces;
+	culled = NULL;
+
+	if ( s_batchCulling )
+	{
+		first = mark - tr.world->markSurfaces;
+
+		if ( !s_marksCulled )
+		{
+			R_CullSpheres( &tr.world->markSurfaceSpheres, first, c, tr.world->markSurfaceCulled );
+		}
+
+		culled = tr.world->markSurfaceCulled + first;
+	}
+
+	while ( c-- )
+	{
+		// the surface may have already been added if it
+		// spans multiple leafs
+		R_AddWorldSurface( *mark, decalBits, culled );
+		mark++;
+
+		if ( culled )
+		{
+			culled++;
+		}
+	}
+}
+
 /*
 =============================================================
 
@@ -413,7 +469,7 @@ static void R_AddBrushModelSurface( bspSurface_t *surf, int fogIndex )
 	surf->viewCount = tr.viewCountNoReset;
 
 	// try to cull before lighting or adding
-	if ( R_CullSurface( surf->data, surf->shader, &frontFace ) )
+	if ( R_CullSurface( surf->data, surf->shader, &frontFace, NULL ) )
 	{
 		return;
 	}
@@ -475,6 +531,13 @@ void R_AddBSPModelSurfaces( trRefEntity_t *ent )
 		AddPointToBounds( transformed, ent->worldBounds[ 0 ], ent->worldBounds[ 1 ] );
 	}
 
+	R_CullOccludedEntity( ent );
+
+	if ( ent->cull == CULL_OUT )
+	{
+		return;
+	}
+
 	VectorAdd( ent->worldBounds[ 0 ], ent->worldBounds[ 1 ], boundsCenter );
 	VectorScale( boundsCenter, 0.5f, boundsCenter );
 
@@ -526,9 +589,6 @@ void R_AddBSPModelSurfaces( trRefEntity_t *ent )
 
 static void R_AddLeafSurfaces( bspNode_t *node, int decalBits )
 {
-	int          c;
-	bspSurface_t *surf, **mark;
-
 	tr.pc.c_leafs++;
 
 	// add to z buffer bounds
@@ -563,17 +623,7 @@ static void R_AddLeafSurfaces( bspNode_t *node, int decalBits )
 	}
 
 	// add the individual surfaces
-	mark = node->markSurfaces;
-	c = node->numMarkSurfaces;
-
-	while ( c-- )
-	{
-		// the surface may have already been added if it
-		// spans multiple leafs
-		surf = *mark;
-		R_AddWorldSurface( surf, decalBits );
-		mark++;
-	}
+	R_AddMarkSurfaces( node, decalBits );
 }
 
 /*
@@ -599,7 +649,17 @@ static void R_RecursiveWorldNode( bspNode_t *node, int planeBits, int decalBits
 
 		// if the bounding volume is outside the frustum, nothing
 		// inside can be visible OPTIMIZE: don't do this all the way to leafs?
-		if ( !r_nocull->integer )
+		if ( s_batchCulling )
+		{
+			// planes were tested by R_CullWorldNodes
+			if ( tr.world->nodeBackBits[ node - tr.world->nodes ] & planeBits )
+			{
+				return; // culled
+			}
+
+			planeBits &= ~tr.world->nodeFrontBits[ node - tr.world->nodes ];  // all descendants will also be in front
+		}
+		else if ( !r_nocull->integer )
 		{
 			int i;
 			int r;
@@ -623,6 +683,12 @@ static void R_RecursiveWorldNode( bspNode_t *node, int planeBits, int decalBits
 			}
 		}
 
+		if ( s_occlusionCulling && R_OccludedBox( node->mins, node->maxs ) )
+		{
+			tr.pc.c_occludedNodes++;
+			return; // hidden behind the occluders
+		}
+
 		InsertLink( &node->visChain, &tr.traversalStack );
 
 		// ydnar: cull decals
@@ -1445,9 +1511,6 @@ static void R_MarkLeaves( void )
 static void DrawLeaf( bspNode_t *node, int decalBits )
 {
 	// leaf node, so add mark surfaces
-	int          c;
-	bspSurface_t *surf, **mark;
-
 	tr.pc.c_leafs++;
 
 	// add to z buffer bounds
@@ -1482,17 +1545,7 @@ static void DrawLeaf( bspNode_t *node, int decalBits )
 	}
 
 	// add the individual surfaces
-	mark = node->markSurfaces;
-	c = node->numMarkSurfaces;
-
-	while ( c-- )
-	{
-		// the surface may have already been added if it
-		// spans multiple leafs
-		surf = *mark;
-		R_AddWorldSurface( surf, decalBits );
-		mark++;
-	}
+	R_AddMarkSurfaces( node, decalBits );
 }
 
 // ================================================================================================
@@ -1503,6 +1556,12 @@ static void DrawLeaf( bspNode_t *node, int decalBits )
 
 static qboolean InsideViewFrustum( bspNode_t *node, int planeBits )
 {
+	if ( s_batchCulling )
+	{
+		// planes were tested by R_CullWorldNodes
+		return ( tr.world->nodeBackBits[ node - tr.world->nodes ] & planeBits ) ? qfalse : qtrue;
+	}
+
 	if ( !r_nocull->integer )
 	{
 		int i;
@@ -2470,6 +2529,257 @@ static void R_CoherentHierachicalCulling()
 	}
 }
 
+/*
+=============
+R_CullWorldNodeRange
+
+Tests the nodes from start to end - 1 marked by R_MarkLeaves against
+the frustum planes in batches, start has to be a multiple of CULL_BATCH
+=============
+*/
+static void R_CullWorldNodeRange( int start, int end )
+{
+	int       i, j, first;
+	bspNode_t *node;
+
+	first = -1;
+
+	// cull runs of batches that contain any marked nodes
+	for ( i = start; i < end; i += CULL_BATCH )
+	{
+		for ( j = i, node = &tr.world->nodes[ i ]; j < i + CULL_BATCH && j < end; j++, node++ )
+		{
+			if ( node->visCounts[ tr.visIndex ] == tr.visCounts[ tr.visIndex ] )
+			{
+				break;
+			}
+		}
+
+		if ( j < i + CULL_BATCH && j < end )
+		{
+			if ( first < 0 )
+			{
+				first = i;
+			}
+		}
+		else if ( first >= 0 )
+		{
+			R_CullBoxes( &tr.world->nodeBounds, first, i - first, tr.world->nodeFrontBits, tr.world->nodeBackBits );
+			first = -1;
+		}
+	}
+
+	if ( first >= 0 )
+	{
+		R_CullBoxes( &tr.world->nodeBounds, first, end - first, tr.world->nodeFrontBits, tr.world->nodeBackBits );
+	}
+}
+
+// nodes or mark surfaces per worker job, a multiple of CULL_BATCH
+// so the jobs never write into each other's results
+#define CULL_JOB_SIZE ( 256 * CULL_BATCH )
+
+static void R_CullWorldJob( void *data, int job )
+{
+	int first, numNodes;
+
+	numNodes = tr.world->numnodes;
+	first = job * CULL_JOB_SIZE;
+
+	// the node jobs come first, then the mark surface ones
+	if ( first < numNodes )
+	{
+		R_CullWorldNodeRange( first, MIN( first + CULL_JOB_SIZE, numNodes ) );
+		return;
+	}
+
+	first = ( job - ( numNodes + CULL_JOB_SIZE - 1 ) / CULL_JOB_SIZE ) * CULL_JOB_SIZE;
+
+	R_CullSpheres( &tr.world->markSurfaceSpheres, first, MIN( CULL_JOB_SIZE, tr.world->numMarkSurfaces - first ),
+	               tr.world->markSurfaceCulled );
+}
+
+/*
+=============
+R_CullWorldNodes
+
+Tests the nodes marked by R_MarkLeaves against the frustum planes
+in batches, the traversal only looks at the resulting plane bits.
+
+With render worker threads the nodes are split over them, and the
+spheres of all leaf surfaces are culled up front as well, so
+R_AddMarkSurfaces doesn't have to. That culls the surfaces of leafs
+outside the PVS too, but it saves going back to the workers once
+for every leaf. Returns qtrue if the surfaces were culled.
+=============
+*/
+static qboolean R_CullWorldNodes( void )
+{
+	int numNodeJobs, numMarkJobs;
+
+	if ( !GLimp_NumWorkers() )
+	{
+		R_CullWorldNodeRange( 0, tr.world->numnodes );
+		return qfalse;
+	}
+
+	numNodeJobs = ( tr.world->numnodes + CULL_JOB_SIZE - 1 ) / CULL_JOB_SIZE;
+	numMarkJobs = ( tr.world->numMarkSurfaces + CULL_JOB_SIZE - 1 ) / CULL_JOB_SIZE;
+
+	GLimp_RunJobs( R_CullWorldJob, NULL, numNodeJobs + numMarkJobs );
+
+	return qtrue;
+}
+
+/*
+=============
+R_BenchWorldCulling
+
+Culls the marked nodes and leaf surfaces of the current view one
+at a time and in batches, and compares the results
+=============
+*/
+static void R_BenchWorldCulling( void )
+{
+	int          i, j, k, start, scalarMsec, batchMsec, mismatches;
+	int          numNodes, numSurfaces, r;
+	byte         *frontBits, *backBits, *culled;
+	bspNode_t    *node;
+	srfGeneric_t *gen;
+
+	if ( r_nocull->integer )
+	{
+		ri.Printf( PRINT_ALL, "cullbench: r_nocull is set\n" );
+		return;
+	}
+
+	numNodes = tr.world->numnodes;
+
+	frontBits = ( byte * ) ri.Hunk_AllocateTempMemory( numNodes * 2 + tr.world->numMarkSurfaces );
+	backBits = frontBits + numNodes;
+	culled = backBits + numNodes;
+
+	start = ri.Milliseconds();
+
+	for ( k = 0; k < s_cullBenchIterations; k++ )
+	{
+		for ( i = 0, node = tr.world->nodes; i < numNodes; i++, node++ )
+		{
+			if ( node->visCounts[ tr.visIndex ] != tr.visCounts[ tr.visIndex ] )
+			{
+				continue;
+			}
+
+			frontBits[ i ] = backBits[ i ] = 0;
+
+			for ( j = 0; j < FRUSTUM_PLANES; j++ )
+			{
+				r = BoxOnPlaneSide( node->mins, node->maxs, &tr.viewParms.frustums[ 0 ][ j ] );
+
+				if ( r == 1 )
+				{
+					frontBits[ i ] |= 1 << j;
+				}
+				else if ( r == 2 )
+				{
+					backBits[ i ] |= 1 << j;
+				}
+			}
+
+			if ( node->contents == CONTENTS_NODE )
+			{
+				continue;
+			}
+
+			for ( j = 0; j < node->numMarkSurfaces; j++ )
+			{
+				gen = ( srfGeneric_t * ) node->markSurfaces[ j ]->data;
+				culled[ node->markSurfaces - tr.world->markSurfaces + j ] = R_CullPointAndRadius( gen->origin, gen->radius ) == CULL_OUT;
+			}
+		}
+	}
+
+	scalarMsec = ri.Milliseconds() - start;
+	start = ri.Milliseconds();
+
+	for ( k = 0; k < s_cullBenchIterations; k++ )
+	{
+		if ( R_CullWorldNodes() )
+		{
+			continue;
+		}
+
+		for ( i = tr.world->numDecisionNodes, node = &tr.world->nodes[ i ]; i < numNodes; i++, node++ )
+		{
+			if ( node->visCounts[ tr.visIndex ] == tr.visCounts[ tr.visIndex ] && node->numMarkSurfaces )
+			{
+				R_CullSpheres( &tr.world->markSurfaceSpheres, node->markSurfaces - tr.world->markSurfaces,
+				               node->numMarkSurfaces, tr.world->markSurfaceCulled );
+			}
+		}
+	}
+
+	batchMsec = ri.Milliseconds() - start;
+
+	for ( i = 0, node = tr.world->nodes, mismatches = 0, numNodes = 0, numSurfaces = 0; i < tr.world->numnodes; i++, node++ )
+	{
+		if ( node->visCounts[ tr.visIndex ] != tr.visCounts[ tr.visIndex ] )
+		{
+			continue;
+		}
+
+		numNodes++;
+
+		if ( frontBits[ i ] != tr.world->nodeFrontBits[ i ] || backBits[ i ] != tr.world->nodeBackBits[ i ] )
+		{
+			mismatches++;
+		}
+
+		if ( node->contents == CONTENTS_NODE )
+		{
+			continue;
+		}
+
+		for ( j = 0; j < node->numMarkSurfaces; j++ )
+		{
+			gen = ( srfGeneric_t * ) node->markSurfaces[ j ]->data;
+
+			// the other surfaces are not sphere culled
+			if ( gen->surfaceType != SF_FACE && gen->surfaceType != SF_GRID && gen->surfaceType != SF_TRIANGLES )
+			{
+				continue;
+			}
+
+			numSurfaces++;
+			k = node->markSurfaces - tr.world->markSurfaces + j;
+
+			if ( culled[ k ] != tr.world->markSurfaceCulled[ k ] )
+			{
+				mismatches++;
+			}
+		}
+	}
+
+	ri.Printf( PRINT_ALL, "%i nodes %i surfaces culled %i times: one by one %i msec, batched %i msec, %i mismatches\n",
+	           numNodes, numSurfaces, s_cullBenchIterations, scalarMsec, batchMsec, mismatches );
+
+	ri.Hunk_FreeTempMemory( frontBits );
+}
+
+/*
+=============
+R_CullBench_f
+
+Times culling the world nodes and surfaces of the next
+main view one at a time against the batched culling
+=============
+*/
+void R_CullBench_f( void )
+{
+	s_cullBenchIterations = ri.Cmd_Argc() > 1 ? atoi( ri.Cmd_Argv( 1 ) ) : 100;
+	s_cullBenchIterations = MAX( s_cullBenchIterations, 1 );
+}
+
 /*
 =============
 R_AddWorldSurfaces
@@ -2492,6 +2802,9 @@ void R_AddWorldSurfaces( void )
 	// clear out the visible min/max
 	ClearBounds( tr.viewParms.visBounds[ 0 ], tr.viewParms.visBounds[ 1 ] );
 
+	s_batchCulling = ( r_batchCulling->integer && !r_nocull->integer ) ? qtrue : qfalse;
+	s_marksCulled = qfalse;
+
 	// render sky or world?
 	if ( tr.refdef.rdflags & RDF_SKYBOXPORTAL && tr.world->numSkyNodes > 0 )
 	{
@@ -2508,8 +2821,22 @@ void R_AddWorldSurfaces( void )
 		// determine which leaves are in the PVS / areamask
 		R_MarkLeaves();
 
+		if ( s_cullBenchIterations && !tr.viewParms.isPortal )
+		{
+			R_BenchWorldCulling();
+			s_cullBenchIterations = 0;
+		}
+
+		if ( s_batchCulling )
+		{
+			s_marksCulled = R_CullWorldNodes();
+		}
+
+		// the software occlusion culling replaces the occlusion queries
+		s_occlusionCulling = R_RenderOcclusionBuffer();
+
 		// update the bsp nodes with the dynamic occlusion query results
-		if ( glConfig2.occlusionQueryBits && glConfig.driverType != GLDRV_MESA && r_dynamicBspOcclusionCulling->integer )
+		if ( !s_occlusionCulling && glConfig2.occlusionQueryBits && glConfig.driverType != GLDRV_MESA && r_dynamicBspOcclusionCulling->integer )
 		{
 			R_CoherentHierachicalCulling();
 		}
@@ -167,9 +167,38 @@ typedef enum gameImport_s
   G_QUOTESTRING,
   G_GENFINGERPRINT,
   G_GETPLAYERPUBKEY,
-  G_GETTIMESTRING
+  G_GETTIMESTRING,
+  G_BATCH,
+  G_FIND_CONFIGSTRING
 } gameImport_t;
 
+// queries which can be handed to the engine in bulk with G_BATCH
+typedef enum
+{
+  BATCH_TRACE,
+  BATCH_TRACECAPSULE,
+  BATCH_POINT_CONTENTS,
+  BATCH_LINKENTITY,
+  BATCH_UNLINKENTITY,
+
+  BATCH_NUM_TYPES
+} batchType_t;
+
+typedef struct
+{
+	int    type; // batchType_t
+	int    entityNum; // pass entity for traces and contents, the entity to (un)link otherwise
+	int    contentmask;
+	vec3_t start, mins, maxs, end; // only start is used by BATCH_POINT_CONTENTS
+} batchQuery_t;
+
+// results are written to the same index as their query
+typedef union
+{
+	trace_t trace;
+	int     contents;
+} batchResult_t;
+
 // engine-to-game-module calls
 typedef enum
 {
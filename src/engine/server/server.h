@@ -63,6 +63,8 @@ typedef struct voipServerPacket_s
 
 #define MAX_BPS_WINDOW 20 // NERVE - SMF - net debugging
 
+#define CONFIGSTRING_HASH_SIZE 1024
+
 typedef struct svEntity_s
 {
 	struct worldSector_s *worldSector;
@@ -75,6 +77,8 @@ typedef struct svEntity_s
 	int                  lastCluster; // if all the clusters don't fit in clusternums
 	int                  areanum, areanum2;
 	int                  snapshotCounter; // used to prevent double adding from portal views
+	int                  snapshotStateFrame; // sv.snapshotStateFrame when snapshotState was copied
+	int                  snapshotState; // into the circular svs.snapshotStates[]
 	int                  originCluster; // Gordon: calced upon linking, for origin only bmodel vis checks
 } svEntity_t;
 
@@ -96,14 +100,23 @@ typedef struct
 	// the serverId associated with the current checksumFeed (always <= serverId)
 	int             checksumFeedServerId;
 	int             snapshotCounter; // incremented for each snapshot built
+	int             snapshotStateFrame; // incremented whenever entity states may have changed between snapshots
 	int             timeResidual; // <= 1000 / sv_frame->value
 	int             nextFrameTime; // when time > nextFrameTime, process world
 	struct cmodel_s *models[ MAX_MODELS ];
 
 	char            *configstrings[ MAX_CONFIGSTRINGS ];
 	qboolean        configstringsmodified[ MAX_CONFIGSTRINGS ];
+	int             configstringHash[ CONFIGSTRING_HASH_SIZE ]; // index + 1 of the first non-empty configstring in the bucket
+	int             configstringHashNext[ MAX_CONFIGSTRINGS ]; // index + 1 of the next one
 	svEntity_t      svEntities[ MAX_GENTITIES ];
 
+	// the configstrings and baselines of the gamestate, deflated once for all
+	// the clients that support it until one of them changes
+	byte            *gamestateDeflated;
+	int             gamestateDeflatedSize; // -1 if deflating did not pay off
+	int             gamestateRawSize;
+
 	char            *entityParsePoint; // used during game VM init
 
 	// the game virtual machine will update these on init and changes
@@ -143,7 +156,8 @@ typedef struct
 	byte          areabits[ MAX_MAP_AREA_BYTES ]; // portalarea visibility bits
 	playerState_t ps;
 	int           num_entities;
-	int           first_entity; // into the circular sv_packet_entities[]
+	int           first_entity; // into the circular svs.snapshotEntities[]
+	int           first_state; // oldest of the svs.snapshotStates[] referenced
 	// the entities MUST be in increasing state number
 	// order, otherwise the delta compression will fail
 	int messageSent; // time the message was transmitted
@@ -201,11 +215,28 @@ typedef struct client_s
 	int           downloadClientBlock; // last block we sent to the client, awaiting ack
 	int           downloadCurrentBlock; // current block number
 	int           downloadXmitBlock; // last block we xmited
-	unsigned char *downloadBlocks[ MAX_DOWNLOAD_WINDOW ]; // the buffers for the download blocks
-	int           downloadBlockSize[ MAX_DOWNLOAD_WINDOW ];
+	unsigned char *downloadBlocks[ MAX_DOWNLOAD_SACK_WINDOW ]; // the buffers for the download blocks
+	int           downloadBlockSize[ MAX_DOWNLOAD_SACK_WINDOW ];
 	qboolean      downloadEOF; // We have sent the EOF block
 	int           downloadSendTime; // time we last got an ack from the client
 
+	// windowed downloads, sent outside of snapshots by SV_SendDownloadMessages
+	// all times are Sys_Milliseconds, since svs.time stands still between frames
+	int           downloadWindow; // blocks the client buffers out of order, 0 for an in order download
+	int           downloadId; // echoed back so the client can ignore blocks of an earlier download
+	int           downloadCwnd; // congestion window, in blocks
+	int           downloadCwndCount; // acknowledged blocks towards the next congestion window increase
+	int           downloadSsthresh; // slow start threshold, in blocks
+	int           downloadRecover; // no further backoff for blocks lost in messages up to this one
+	int           downloadSrtt; // smoothed round trip time, 0 before the first sample
+	int           downloadRttVar;
+	int           downloadRto; // retransmission timeout
+	int           downloadAckTime; // last acknowledge that made progress, or the last timeout
+	int           downloadSeq; // windowed download messages sent
+	int           downloadBlockSeq[ MAX_DOWNLOAD_SACK_WINDOW ]; // message that last carried the block, 0 if it needs sending
+	int           downloadBlockTime[ MAX_DOWNLOAD_SACK_WINDOW ]; // when the block was first sent, -1 once it was resent
+	qboolean      downloadBlockAcked[ MAX_DOWNLOAD_SACK_WINDOW ];
+
 	// www downloading
 	qboolean bDlOK; // passed from cl_wwwDownload CVAR_USERINFO, whether this client supports www dl
 	char     downloadURL[ MAX_OSPATH ]; // the URL we redirected the client to
@@ -236,8 +267,20 @@ typedef struct client_s
 	//% netchan_buffer_t **netchan_end_queue;
 	netchan_buffer_t *netchan_end_queue;
 
+	// SV_SendClientMessages spreads the clients over the frame interval,
+	// a message which is not due yet waits here for SV_SendPacedMessages
+	int              paceTime; // when the message being sent is due, 0 to send it now
+	int              pacedTime; // when the paced message is due, 0 if there is none
+	netchan_buffer_t paced;
+	int              paceLastSend;
+	int              paceInterval;
+	int              paceJitter; // in 1/16 msec, smoothed deviation of the send intervals
+
 	char             pubkey[ RSA_STRING_LENGTH ];
 
+	qboolean         huffTrained; // server to client messages use the trained huffman table
+	qboolean         gamestateDeflate; // the client can inflate svc_deflate in gamestates
+
 #ifdef USE_VOIP
 	qboolean           hasVoip;
 	qboolean           muteAllVoip;
@@ -266,6 +309,17 @@ typedef struct
 	int    latched_packets;
 } svstats_t;
 
+// game system calls followed by the query types inside G_BATCH
+#define LAST_GAME_SYSCALL      G_FIND_CONFIGSTRING
+#define MAX_GAME_SYSCALL_STATS ( LAST_GAME_SYSCALL - FIRST_VM_SYSCALL + 1 + BATCH_NUM_TYPES )
+
+typedef struct
+{
+	int frame; // calls since the last server frame
+	int total;
+	int peak; // most calls in one frame
+} gameSyscallStat_t;
+
 // MAX_CHALLENGES is made large to prevent a denial
 // of service attack that could cycle all of them
 // out before legitimate users connected
@@ -307,7 +361,10 @@ typedef struct
 	client_t      *clients; // [sv_maxclients->integer];
 	int           numSnapshotEntities; // sv_maxclients->integer*PACKET_BACKUP*MAX_PACKET_ENTITIES
 	int           nextSnapshotEntities; // next snapshotEntities to use
-	entityState_t *snapshotEntities; // [numSnapshotEntities]
+	int           *snapshotEntities; // [numSnapshotEntities], indexes into snapshotStates
+	int           numSnapshotStates; // shared by all clients, so at most MAX_GENTITIES per snapshot frame
+	int           nextSnapshotStates; // next snapshotStates to use
+	entityState_t *snapshotStates; // [numSnapshotStates]
 	int           nextHeartbeatTime;
 	challenge_t   challenges[ MAX_CHALLENGES ]; // to prevent invalid IP addresses from connecting
 	receipt_t     infoReceipts[ MAX_INFO_RECEIPTS ];
@@ -319,6 +376,13 @@ typedef struct
 	int       currentFrameIndex;
 	int       serverLoad;
 	svstats_t stats;
+
+	gameSyscallStat_t gameSyscallStats[ MAX_GAME_SYSCALL_STATS ];
+	int               gameSyscallFrames;
+
+	int               downloadBudget; // bytes windowed downloads may still send, see sv_dl_totalRate
+	int               downloadBudgetTime;
+	int               downloadNextClient; // first client to get the budget, so all get their turn
 } serverStatic_t;
 
 //=============================================================================
@@ -354,11 +418,15 @@ extern cvar_t *sv_newGameShlib;
 extern cvar_t *sv_pure;
 extern cvar_t *sv_floodProtect;
 extern cvar_t *sv_lanForceRate;
+extern cvar_t *sv_pace;
 
 extern cvar_t *sv_showAverageBPS; // NERVE - SMF - net debugging
 
 // TTimo - autodl
 extern cvar_t *sv_dl_maxRate;
+extern cvar_t *sv_dl_window;
+extern cvar_t *sv_dl_totalRate;
+extern cvar_t *sv_gamestateDeflate;
 
 // TTimo
 extern cvar_t *sv_wwwDownload; // general flag to enable/disable www download redirects
@@ -372,6 +440,7 @@ extern cvar_t *sv_wwwFallbackURL;
 //bani
 extern cvar_t *sv_cheats;
 extern cvar_t *sv_packetdelay;
+extern cvar_t *sv_gameSyscallStats;
 
 //fretn
 extern cvar_t *sv_fullmsg;
@@ -407,6 +476,7 @@ void SV_UpdateConfigStrings( void );
 void SV_SetConfigstring( int index, const char *val );
 void SV_UpdateConfigStrings( void );
 void SV_GetConfigstring( int index, char *buffer, int bufferSize );
+int  SV_FindConfigstring( const char *name, int start, int max, qboolean create );
 void SV_SetConfigstringRestrictions( int index, const clientList_t *clientList );
 
 void SV_SetUserinfo( int index, const char *val );
@@ -455,6 +525,7 @@ void SV_UpdateServerCommandsToClient( client_t *client, msg_t *msg );
 void SV_SendMessageToClient( msg_t *msg, client_t *client );
 void SV_SendClientMessages( void );
 void SV_SendClientSnapshot( client_t *client );
+entityState_t *SV_SnapshotEntityState( const clientSnapshot_t *frame, int index );
 
 //bani
 void SV_SendClientIdle( client_t *client );
@@ -479,6 +550,8 @@ qboolean       SV_inPVS( const vec3_t p1, const vec3_t p2 );
 qboolean       SV_GetTag( int clientNum, int tagFileNumber, const char *tagname, orientation_t *ort );
 int            SV_LoadTag( const char *mod_name );
 void           SV_GameBinaryMessageReceived( int cno, const char *buf, int buflen, int commandTime );
+void           SV_GameSyscallStats_f( void );
+void           SV_GameSyscallStatsFrame( void );
 
 //
 // sv_bot.c
@@ -550,6 +623,7 @@ void SV_ClipToEntity( trace_t *trace, const vec3_t start, const vec3_t mins, con
 // sv_net_chan.c
 //
 void     SV_Netchan_Transmit( client_t *client, msg_t *msg );
+int      SV_Netchan_TransmitPaced( client_t *client, qboolean flush );
 void     SV_Netchan_TransmitNextFragment( client_t *client );
 qboolean SV_Netchan_Process( client_t *client, msg_t *msg );
 void     SV_Netchan_FreeQueue( client_t *client );
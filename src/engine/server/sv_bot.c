@@ -331,7 +331,7 @@ int EntityInPVS( int client, int entityNum )
 
 	for ( i = 0; i < frame->num_entities; i++ )
 	{
-		if ( svs.snapshotEntities[( frame->first_entity + i ) % svs.numSnapshotEntities ].number == entityNum )
+		if ( SV_SnapshotEntityState( frame, i )->number == entityNum )
 		{
 			return qtrue;
 		}
@@ -360,5 +360,5 @@ int SV_BotGetSnapshotEntity( int client, int sequence )
 		return -1;
 	}
 
-	return svs.snapshotEntities[( frame->first_entity + sequence ) % svs.numSnapshotEntities ].number;
+	return SV_SnapshotEntityState( frame, sequence )->number;
 }
@@ -398,8 +398,8 @@ static void SV_Status_f( void )
 	Com_Printf( "cpu utilization  : %3i%%\n"
 	            "avg response time: %i ms\n"
 	            "map: %s\n"
-	            "num score ping name            lastmsg address               qport rate\n"
-	            "--- ----- ---- --------------- ------- --------------------- ----- -----\n",
+	            "num score ping name            lastmsg address               qport rate  jitter\n"
+	            "--- ----- ---- --------------- ------- --------------------- ----- ----- ------\n",
 	           ( int ) cpu, ( int ) avg, sv_mapname->string );
 
 	for ( i = 0, cl = svs.clients; i < sv_maxclients->integer; i++, cl++ )
@@ -450,6 +450,9 @@ static void SV_Status_f( void )
 
 		Com_Printf( " %5i", cl->rate );
 
+		// of the intervals between the messages sent to the client, in msec
+		Com_Printf( " %6.1f", cl->paceJitter / 16.0f );
+
 		Com_Printf( "\n" );
 	}
 
@@ -561,6 +564,7 @@ void SV_AddOperatorCommands( void )
 	{
 		// These commands should only be available while the server is running.
 		Cmd_AddCommand( "fieldinfo",   SV_FieldInfo_f );
+		Cmd_AddCommand( "gamesyscalls", SV_GameSyscallStats_f );
 		Cmd_AddCommand( "heartbeat",   SV_Heartbeat_f );
 		Cmd_AddCommand( "killserver",  SV_KillServer_f );
 		Cmd_AddCommand( "map_restart", SV_MapRestart_f );
@@ -580,6 +584,7 @@ void SV_RemoveOperatorCommands( void )
 {
 	Cmd_RemoveCommand( "dumpuser" );
 	Cmd_RemoveCommand( "fieldinfo" );
+	Cmd_RemoveCommand( "gamesyscalls" );
 	Cmd_RemoveCommand( "heartbeat" );
 	Cmd_RemoveCommand( "killserver" );
 	Cmd_RemoveCommand( "map_restart" );
@@ -37,8 +37,17 @@ Maryland 20850 USA.
 #include "server.h"
 #include "../qcommon/md4.h"
 
+#include <zlib.h>
+
 static void SV_CloseDownload( client_t *cl );
 
+// windowed downloads
+#define DOWNLOAD_INITIAL_CWND 4 // blocks
+#define DOWNLOAD_INITIAL_RTO  1000 // msec, until there is a round trip time
+#define DOWNLOAD_MIN_RTO      200
+#define DOWNLOAD_MAX_RTO      4000
+#define DOWNLOAD_HEADER_BYTES 48 // UDP/IP and netchan headers, as in SV_RateMsec
+
 /*
 =================
 SV_GetChallenge
@@ -373,6 +382,14 @@ gotnewcl:
 	// Save the pubkey
 	Q_strncpyz( newcl->pubkey, Info_ValueForKey( userinfo, "pubkey" ), sizeof( newcl->pubkey ) );
 	Info_RemoveKey( userinfo, "pubkey", qfalse );
+
+	// use the trained huffman table if the client loaded the same one
+	newcl->huffTrained = MSG_HuffmanChecksum() &&
+	                     atoi( Info_ValueForKey( userinfo, "huffman" ) ) == MSG_HuffmanChecksum();
+	Info_RemoveKey( userinfo, "huffman", qfalse );
+
+	newcl->gamestateDeflate = atoi( Info_ValueForKey( userinfo, "deflate" ) ) > 0;
+	Info_RemoveKey( userinfo, "deflate", qfalse );
 	// save the userinfo
 	Q_strncpyz( newcl->userinfo, userinfo, sizeof( newcl->userinfo ) );
 
@@ -395,7 +412,14 @@ gotnewcl:
 	svs.challenges[ i ].firstPing = 0;
 
 	// send the connect packet to the client
-	NET_OutOfBandPrint( NS_SERVER, from, "connectResponse" );
+	if ( newcl->huffTrained )
+	{
+		NET_OutOfBandPrint( NS_SERVER, from, "connectResponse %d", MSG_HuffmanChecksum() );
+	}
+	else
+	{
+		NET_OutOfBandPrint( NS_SERVER, from, "connectResponse" );
+	}
 
 	Com_DPrintf( "Going from CS_FREE to CS_CONNECTED for %s\n", newcl->name );
 
@@ -527,6 +551,9 @@ void SV_DropClient( client_t *drop, const char *reason )
 	// this will remove the body, among other things
 	VM_Call( gvm, GAME_CLIENT_DISCONNECT, drop - svs.clients );
 
+	// the game may have changed entities the other clients' snapshots share
+	sv.snapshotStateFrame++;
+
 	// add the disconnect command
 	SV_SendServerCommand( drop, "disconnect %s\n", Cmd_QuoteString( reason ) );
 
@@ -556,6 +583,96 @@ void SV_DropClient( client_t *drop, const char *reason )
 	}
 }
 
+/*
+================
+SV_WriteGamestateEntries
+================
+*/
+static void SV_WriteGamestateEntries( msg_t *msg )
+{
+	int           start;
+	entityState_t *base, nullstate;
+
+	// write the configstrings
+	for ( start = 0; start < MAX_CONFIGSTRINGS; start++ )
+	{
+		if ( sv.configstrings[ start ][ 0 ] )
+		{
+			MSG_WriteByte( msg, svc_configstring );
+			MSG_WriteShort( msg, start );
+			MSG_WriteBigString( msg, sv.configstrings[ start ] );
+		}
+	}
+
+	// write the baselines
+	memset( &nullstate, 0, sizeof( nullstate ) );
+
+	for ( start = 0; start < MAX_GENTITIES; start++ )
+	{
+		base = &sv.svEntities[ start ].baseline;
+
+		if ( !base->number )
+		{
+			continue;
+		}
+
+		MSG_WriteByte( msg, svc_baseline );
+		MSG_WriteDeltaEntity( msg, &nullstate, base, qtrue );
+	}
+}
+
+/*
+================
+SV_DeflateGamestate
+
+The configstrings and baselines are the bulk of a gamestate and the
+same for every client, so they are deflated once and kept until one
+of them changes. Returns qfalse if deflating does not pay off.
+================
+*/
+static qboolean SV_DeflateGamestate( void )
+{
+	static byte raw[ MAX_MSGLEN ];
+	static byte deflated[ MAX_MSGLEN ];
+	msg_t       msg;
+	uLongf      size;
+
+	if ( sv.gamestateDeflatedSize )
+	{
+		return sv.gamestateDeflatedSize > 0;
+	}
+
+	sv.gamestateDeflatedSize = -1;
+
+	// the inflated stream is parsed without huffman, up to its own svc_EOF
+	MSG_Init( &msg, raw, sizeof( raw ) );
+	msg.raw = qtrue;
+	msg.allowoverflow = qtrue;
+
+	SV_WriteGamestateEntries( &msg );
+	MSG_WriteByte( &msg, svc_EOF );
+
+	if ( msg.overflowed )
+	{
+		return qfalse;
+	}
+
+	size = sizeof( deflated );
+
+	if ( compress2( deflated, &size, raw, msg.cursize, Z_BEST_COMPRESSION ) != Z_OK || size >= msg.cursize )
+	{
+		return qfalse;
+	}
+
+	sv.gamestateDeflated = Z_Malloc( size );
+	Com_Memcpy( sv.gamestateDeflated, deflated, size );
+	sv.gamestateDeflatedSize = size;
+	sv.gamestateRawSize = msg.cursize;
+
+	Com_DPrintf( "Deflated gamestate from %i to %i bytes\n", sv.gamestateRawSize, sv.gamestateDeflatedSize );
+	return qtrue;
+}
+
 /*
 ================
 SV_SendClientGameState
@@ -569,8 +686,6 @@ the wrong gamestate.
 */
 void SV_SendClientGameState( client_t *client )
 {
-	int           start;
-	entityState_t *base, nullstate;
 	msg_t         msg;
 	byte          msgBuffer[ MAX_MSGLEN ];
 
@@ -586,6 +701,8 @@ void SV_SendClientGameState( client_t *client )
 	client->gamestateMessageNum = client->netchan.outgoingSequence;
 
 	MSG_Init( &msg, msgBuffer, sizeof( msgBuffer ) );
+	msg.huffTable = client->huffTrained ? HUFF_TRAINED : HUFF_STATIC;
+	msg.huffSample = qtrue;
 
 	// NOTE, MRE: all server->client messages now acknowledge
 	// let the client know which reliable clientCommands we have received
@@ -601,31 +718,20 @@ void SV_SendClientGameState( client_t *client )
 	MSG_WriteByte( &msg, svc_gamestate );
 	MSG_WriteLong( &msg, client->reliableSequence );
 
-	// write the configstrings
-	for ( start = 0; start < MAX_CONFIGSTRINGS; start++ )
+	if ( client->gamestateDeflate && sv_gamestateDeflate->integer && SV_DeflateGamestate() )
 	{
-		if ( sv.configstrings[ start ][ 0 ] )
-		{
-			MSG_WriteByte( &msg, svc_configstring );
-			MSG_WriteShort( &msg, start );
-			MSG_WriteBigString( &msg, sv.configstrings[ start ] );
-		}
-	}
+		MSG_WriteByte( &msg, svc_deflate );
+		MSG_WriteLong( &msg, sv.gamestateRawSize );
+		MSG_WriteLong( &msg, sv.gamestateDeflatedSize );
 
-	// write the baselines
-	memset( &nullstate, 0, sizeof( nullstate ) );
-
-	for ( start = 0; start < MAX_GENTITIES; start++ )
+		// huffman only makes deflated data bigger
+		msg.raw = qtrue;
+		MSG_WriteData( &msg, sv.gamestateDeflated, sv.gamestateDeflatedSize );
+		msg.raw = qfalse;
+	}
+	else
 	{
-		base = &sv.svEntities[ start ].baseline;
-
-		if ( !base->number )
-		{
-			continue;
-		}
-
-		MSG_WriteByte( &msg, svc_baseline );
-		MSG_WriteDeltaEntity( &msg, &nullstate, base, qtrue );
+		SV_WriteGamestateEntries( &msg );
 	}
 
 	MSG_WriteByte( &msg, svc_EOF );
@@ -698,7 +804,7 @@ static void SV_CloseDownload( client_t *cl )
 	*cl->downloadName = 0;
 
 	// Free the temporary buffer space
-	for ( i = 0; i < MAX_DOWNLOAD_WINDOW; i++ )
+	for ( i = 0; i < MAX_DOWNLOAD_SACK_WINDOW; i++ )
 	{
 		if ( cl->downloadBlocks[ i ] )
 		{
@@ -779,6 +885,153 @@ void SV_NextDownload_f( client_t *cl )
 	SV_DropClient( cl, "broken download" );
 }
 
+/*
+==================
+SV_DownloadAck_f
+
+Selective acknowledge of a windowed download: the first block the client is
+still missing, then a mask of the blocks after it that it already has
+==================
+*/
+void SV_DownloadAck_f( client_t *cl )
+{
+	int          next, block, slot, bit, acked, maxSeq, rtt, now;
+	unsigned int mask[ 2 ];
+	qboolean     lost;
+
+	if ( !cl->download || !cl->downloadWindow || Cmd_Argc() != 4 )
+	{
+		return; // late acknowledge of a download that is over
+	}
+
+	next = atoi( Cmd_Argv( 1 ) );
+	mask[ 0 ] = strtoul( Cmd_Argv( 2 ), NULL, 16 );
+	mask[ 1 ] = strtoul( Cmd_Argv( 3 ), NULL, 16 );
+
+	if ( next < cl->downloadClientBlock || next > cl->downloadCurrentBlock )
+	{
+		return;
+	}
+
+	now = Sys_Milliseconds();
+	acked = 0;
+	maxSeq = 0;
+	rtt = -1;
+
+	for ( block = cl->downloadClientBlock; block < cl->downloadCurrentBlock; block++ )
+	{
+		slot = block % MAX_DOWNLOAD_SACK_WINDOW;
+
+		if ( cl->downloadBlockAcked[ slot ] )
+		{
+			continue;
+		}
+
+		if ( block >= next )
+		{
+			bit = block - next - 1;
+
+			if ( bit < 0 || bit >= MAX_DOWNLOAD_SACK_WINDOW || !( mask[ bit >> 5 ] & ( 1u << ( bit & 31 ) ) ) )
+			{
+				continue;
+			}
+		}
+
+		cl->downloadBlockAcked[ slot ] = qtrue;
+		acked++;
+
+		// only blocks that were sent once give a round trip time
+		if ( cl->downloadBlockSeq[ slot ] > maxSeq )
+		{
+			maxSeq = cl->downloadBlockSeq[ slot ];
+			rtt = cl->downloadBlockTime[ slot ] > 0 ? now - cl->downloadBlockTime[ slot ] : -1;
+		}
+	}
+
+	if ( !acked )
+	{
+		return;
+	}
+
+	cl->downloadAckTime = now;
+
+	if ( rtt >= 0 )
+	{
+		if ( !cl->downloadSrtt )
+		{
+			cl->downloadSrtt = MAX( rtt, 1 );
+			cl->downloadRttVar = rtt / 2;
+		}
+		else
+		{
+			cl->downloadRttVar = ( 3 * cl->downloadRttVar + abs( cl->downloadSrtt - rtt ) ) / 4;
+			cl->downloadSrtt = MAX( ( 7 * cl->downloadSrtt + rtt ) / 8, 1 );
+		}
+
+		cl->downloadRto = cl->downloadSrtt + MAX( 4 * cl->downloadRttVar, 10 );
+		cl->downloadRto = MAX( MIN( cl->downloadRto, DOWNLOAD_MAX_RTO ), DOWNLOAD_MIN_RTO );
+	}
+
+	// the netchan drops messages that arrive out of order, so a block that
+	// went out before an acknowledged one and is still missing was lost
+	lost = qfalse;
+
+	for ( block = cl->downloadClientBlock; block < cl->downloadCurrentBlock; block++ )
+	{
+		slot = block % MAX_DOWNLOAD_SACK_WINDOW;
+
+		if ( !cl->downloadBlockAcked[ slot ] && cl->downloadBlockSeq[ slot ] && cl->downloadBlockSeq[ slot ] < maxSeq )
+		{
+			if ( cl->downloadBlockSeq[ slot ] > cl->downloadRecover )
+			{
+				lost = qtrue;
+			}
+
+			cl->downloadBlockSeq[ slot ] = 0;
+		}
+	}
+
+	// additive increase, multiplicative decrease, once per window of losses
+	if ( lost )
+	{
+		cl->downloadSsthresh = MAX( cl->downloadCwnd / 2, 2 );
+		cl->downloadCwnd = cl->downloadSsthresh;
+		cl->downloadCwndCount = 0;
+		cl->downloadRecover = cl->downloadSeq;
+	}
+	else if ( cl->downloadCwnd < cl->downloadSsthresh )
+	{
+		cl->downloadCwnd += acked;
+	}
+	else
+	{
+		cl->downloadCwndCount += acked;
+
+		if ( cl->downloadCwndCount >= cl->downloadCwnd )
+		{
+			cl->downloadCwndCount -= cl->downloadCwnd;
+			cl->downloadCwnd++;
+		}
+	}
+
+	cl->downloadCwnd = MIN( cl->downloadCwnd, cl->downloadWindow );
+
+	// slide the window over the blocks the client has written
+	while ( cl->downloadClientBlock < cl->downloadCurrentBlock &&
+	        cl->downloadBlockAcked[ cl->downloadClientBlock % MAX_DOWNLOAD_SACK_WINDOW ] )
+	{
+		// A zero-length block indicates EOF
+		if ( cl->downloadBlockSize[ cl->downloadClientBlock % MAX_DOWNLOAD_SACK_WINDOW ] == 0 )
+		{
+			Com_Printf(_( "clientDownload: %d : file \"%s\" completed\n"), ( int )( cl - svs.clients ), cl->downloadName );
+			SV_CloseDownload( cl );
+			return;
+		}
+
+		cl->downloadClientBlock++;
+	}
+}
+
 /*
 ==================
 SV_BeginDownload_f
@@ -798,6 +1051,16 @@ void SV_BeginDownload_f( client_t *cl )
 	// cl->downloadName is non-zero now, SV_WriteDownloadToClient will see this and open
 	// the file itself
 	Q_strncpyz( cl->downloadName, Cmd_Argv( 1 ), sizeof( cl->downloadName ) );
+
+	// clients able to buffer blocks out of order also pass their window and an id
+	cl->downloadWindow = 0;
+
+	if ( Cmd_Argc() > 3 && sv_dl_window->integer > 0 )
+	{
+		cl->downloadWindow = MIN( atoi( Cmd_Argv( 2 ) ), MIN( sv_dl_window->integer, MAX_DOWNLOAD_SACK_WINDOW ) );
+		cl->downloadWindow = MAX( cl->downloadWindow, 0 );
+		cl->downloadId = atoi( Cmd_Argv( 3 ) );
+	}
 }
 
 /*
@@ -912,6 +1175,76 @@ static qboolean SV_CheckFallbackURL( client_t *cl, msg_t *msg )
 	return qtrue;
 }
 
+/*
+==================
+SV_ReadDownloadBlocks
+
+Fill the window up with blocks of the file, then the zero length EOF block
+==================
+*/
+static void SV_ReadDownloadBlocks( client_t *cl )
+{
+	int curindex;
+	int window, ring, blockSize;
+
+	if ( cl->downloadWindow )
+	{
+		window = cl->downloadWindow;
+		ring = MAX_DOWNLOAD_SACK_WINDOW;
+		blockSize = DOWNLOAD_SACK_BLKSIZE;
+	}
+	else
+	{
+		window = ring = MAX_DOWNLOAD_WINDOW;
+		blockSize = MAX_DOWNLOAD_BLKSIZE;
+	}
+
+	// Perform any reads that we need to
+	while ( cl->downloadCurrentBlock - cl->downloadClientBlock < window && cl->downloadSize != cl->downloadCount )
+	{
+		curindex = ( cl->downloadCurrentBlock % ring );
+
+		// the buffers are freed whenever a download starts, so they always
+		// belong to the current mode and are sized for its blocks
+		if ( !cl->downloadBlocks[ curindex ] )
+		{
+			cl->downloadBlocks[ curindex ] = Z_Malloc( blockSize );
+		}
+
+		cl->downloadBlockSize[ curindex ] = FS_Read( cl->downloadBlocks[ curindex ], blockSize, cl->download );
+
+		if ( cl->downloadBlockSize[ curindex ] < 0 )
+		{
+			// EOF right now
+			cl->downloadCount = cl->downloadSize;
+			break;
+		}
+
+		cl->downloadCount += cl->downloadBlockSize[ curindex ];
+		cl->downloadBlockSeq[ curindex ] = 0;
+		cl->downloadBlockTime[ curindex ] = 0;
+		cl->downloadBlockAcked[ curindex ] = qfalse;
+
+		// Load in next block
+		cl->downloadCurrentBlock++;
+	}
+
+	// Check to see if we have eof condition and add the EOF block
+	if ( cl->downloadCount == cl->downloadSize &&
+	     !cl->downloadEOF && cl->downloadCurrentBlock - cl->downloadClientBlock < window )
+	{
+		curindex = ( cl->downloadCurrentBlock % ring );
+
+		cl->downloadBlockSize[ curindex ] = 0;
+		cl->downloadBlockSeq[ curindex ] = 0;
+		cl->downloadBlockTime[ curindex ] = 0;
+		cl->downloadBlockAcked[ curindex ] = qfalse;
+		cl->downloadCurrentBlock++;
+
+		cl->downloadEOF = qtrue; // We have added the EOF block
+	}
+}
+
 /*
 ==================
 SV_WriteDownloadToClient
@@ -1080,44 +1413,30 @@ void SV_WriteDownloadToClient( client_t *cl, msg_t *msg )
 		cl->downloadCount = 0;
 		cl->downloadEOF = qfalse;
 
-		bTellRate = qtrue;
-	}
-
-	// Perform any reads that we need to
-	while ( cl->downloadCurrentBlock - cl->downloadClientBlock < MAX_DOWNLOAD_WINDOW && cl->downloadSize != cl->downloadCount )
-	{
-		curindex = ( cl->downloadCurrentBlock % MAX_DOWNLOAD_WINDOW );
-
-		if ( !cl->downloadBlocks[ curindex ] )
+		if ( cl->downloadWindow )
 		{
-			cl->downloadBlocks[ curindex ] = Z_Malloc( MAX_DOWNLOAD_BLKSIZE );
-		}
-
-		cl->downloadBlockSize[ curindex ] = FS_Read( cl->downloadBlocks[ curindex ], MAX_DOWNLOAD_BLKSIZE, cl->download );
+			cl->downloadCwnd = DOWNLOAD_INITIAL_CWND;
+			cl->downloadCwndCount = 0;
+			cl->downloadSsthresh = cl->downloadWindow;
+			cl->downloadRecover = 0;
+			cl->downloadSrtt = cl->downloadRttVar = 0;
+			cl->downloadRto = DOWNLOAD_INITIAL_RTO;
+			cl->downloadAckTime = Sys_Milliseconds();
+			cl->downloadSeq = 0;
 
-		if ( cl->downloadBlockSize[ curindex ] < 0 )
-		{
-			// EOF right now
-			cl->downloadCount = cl->downloadSize;
-			break;
+			Com_Printf(_( "'%s' downloading with a window of %d blocks\n"), cl->name, cl->downloadWindow );
 		}
 
-		cl->downloadCount += cl->downloadBlockSize[ curindex ];
-
-		// Load in next block
-		cl->downloadCurrentBlock++;
+		bTellRate = qtrue;
 	}
 
-	// Check to see if we have eof condition and add the EOF block
-	if ( cl->downloadCount == cl->downloadSize &&
-	     !cl->downloadEOF && cl->downloadCurrentBlock - cl->downloadClientBlock < MAX_DOWNLOAD_WINDOW )
+	if ( cl->downloadWindow )
 	{
-		cl->downloadBlockSize[ cl->downloadCurrentBlock % MAX_DOWNLOAD_WINDOW ] = 0;
-		cl->downloadCurrentBlock++;
-
-		cl->downloadEOF = qtrue; // We have added the EOF block
+		return; // SV_SendDownloadMessages sends the blocks
 	}
 
+	SV_ReadDownloadBlocks( cl );
+
 	// Loop up to window size times based on how many blocks we can fit in the
 	// client snapMsec and rate
 
@@ -1211,6 +1530,206 @@ void SV_WriteDownloadToClient( client_t *cl, msg_t *msg )
 	}
 }
 
+/*
+==================
+SV_CheckDownloadTimeout
+
+Without any progress for a retransmission timeout, everything
+in flight is considered lost and the window starts over
+==================
+*/
+static void SV_CheckDownloadTimeout( client_t *cl, int now )
+{
+	int block, slot, inFlight;
+
+	if ( now - cl->downloadAckTime < cl->downloadRto )
+	{
+		return;
+	}
+
+	inFlight = 0;
+
+	for ( block = cl->downloadClientBlock; block < cl->downloadCurrentBlock; block++ )
+	{
+		slot = block % MAX_DOWNLOAD_SACK_WINDOW;
+
+		if ( cl->downloadBlockSeq[ slot ] && !cl->downloadBlockAcked[ slot ] )
+		{
+			cl->downloadBlockSeq[ slot ] = 0;
+			inFlight++;
+		}
+	}
+
+	if ( !inFlight )
+	{
+		return;
+	}
+
+	Com_DPrintf( "clientDownload: %d: timeout after %d msec, resending %d blocks\n", ( int )( cl - svs.clients ), cl->downloadRto, inFlight );
+
+	cl->downloadSsthresh = MAX( inFlight / 2, 2 );
+	cl->downloadCwnd = 1;
+	cl->downloadCwndCount = 0;
+	cl->downloadRecover = cl->downloadSeq;
+	cl->downloadRto = MIN( cl->downloadRto * 2, DOWNLOAD_MAX_RTO );
+	cl->downloadAckTime = now;
+}
+
+/*
+==================
+SV_SendDownloadBlocks
+
+Send as many blocks as the congestion window and the server budget allow,
+each in a message of its own so a lost packet costs a single block
+==================
+*/
+static void SV_SendDownloadBlocks( client_t *cl, int now )
+{
+	byte  msg_buf[ MAX_MSGLEN ];
+	msg_t msg;
+	int   block, slot, inFlight;
+
+	inFlight = 0;
+
+	for ( block = cl->downloadClientBlock; block < cl->downloadCurrentBlock; block++ )
+	{
+		slot = block % MAX_DOWNLOAD_SACK_WINDOW;
+
+		if ( cl->downloadBlockSeq[ slot ] && !cl->downloadBlockAcked[ slot ] )
+		{
+			inFlight++;
+		}
+	}
+
+	// the retransmission timer only runs while something is in flight
+	if ( !inFlight )
+	{
+		cl->downloadAckTime = now;
+	}
+
+	block = cl->downloadClientBlock;
+
+	while ( inFlight < cl->downloadCwnd && !cl->netchan.unsentFragments &&
+	        ( sv_dl_totalRate->integer <= 0 || svs.downloadBudget > 0 ) )
+	{
+		// lost blocks come first, as they are the oldest
+		for ( ; block < cl->downloadCurrentBlock; block++ )
+		{
+			slot = block % MAX_DOWNLOAD_SACK_WINDOW;
+
+			if ( !cl->downloadBlockSeq[ slot ] && !cl->downloadBlockAcked[ slot ] )
+			{
+				break;
+			}
+		}
+
+		if ( block == cl->downloadCurrentBlock )
+		{
+			return; // Nothing to transmit
+		}
+
+		MSG_Init( &msg, msg_buf, sizeof( msg_buf ) );
+		msg.huffTable = cl->huffTrained ? HUFF_TRAINED : HUFF_STATIC;
+		msg.huffSample = qfalse; // file data would only skew the huffman statistics
+
+		MSG_WriteLong( &msg, cl->lastClientCommand );
+
+		MSG_WriteByte( &msg, svc_download );
+		MSG_WriteShort( &msg, -2 );  // block -2 means a windowed download block
+		MSG_WriteShort( &msg, cl->downloadId );
+		MSG_WriteLong( &msg, block );
+
+		// block zero is special, contains file size
+		if ( block == 0 )
+		{
+			MSG_WriteLong( &msg, cl->downloadSize );
+		}
+
+		MSG_WriteShort( &msg, cl->downloadBlockSize[ slot ] );
+
+		if ( cl->downloadBlockSize[ slot ] )
+		{
+			MSG_WriteData( &msg, cl->downloadBlocks[ slot ], cl->downloadBlockSize[ slot ] );
+		}
+
+		// record information about the message, as in SV_SendMessageToClient
+		SV_Netchan_TransmitPaced( cl, qtrue );
+		cl->frames[ cl->netchan.outgoingSequence & PACKET_MASK ].messageSize = msg.cursize;
+		cl->frames[ cl->netchan.outgoingSequence & PACKET_MASK ].messageSent = svs.time;
+		cl->frames[ cl->netchan.outgoingSequence & PACKET_MASK ].messageAcked = -1;
+
+		SV_Netchan_Transmit( cl, &msg );
+
+		cl->downloadBlockSeq[ slot ] = ++cl->downloadSeq;
+		cl->downloadBlockTime[ slot ] = cl->downloadBlockTime[ slot ] ? -1 : MAX( now, 1 );
+		inFlight++;
+
+		svs.downloadBudget -= msg.cursize + DOWNLOAD_HEADER_BYTES;
+		sv.bpsTotalBytes += msg.cursize; // NERVE - SMF - net debugging
+
+		block++;
+	}
+}
+
+/*
+==================
+SV_SendDownloadMessages
+
+Windowed downloads are clocked by the acknowledges of the clients rather than
+by snapshots, so this runs every server frame and, on a dedicated server, while
+waiting for the next one.  Returns the number of windowed downloads going on
+==================
+*/
+int SV_SendDownloadMessages( void )
+{
+	int      i, now, rate, numDownloads;
+	client_t *cl;
+
+	if ( !com_sv_running || !com_sv_running->integer || !svs.clients || sv_maxclients->integer < 1 )
+	{
+		return 0;
+	}
+
+	now = Sys_Milliseconds();
+	rate = sv_dl_totalRate->integer;
+
+	// refill the budget, allowing for bursts of up to a tenth of a second
+	if ( rate > 0 )
+	{
+		svs.downloadBudget += ( float ) MIN( now - svs.downloadBudgetTime, 1000 ) * rate / 1000;
+		svs.downloadBudget = MIN( svs.downloadBudget, MAX( rate / 10, DOWNLOAD_SACK_BLKSIZE ) );
+	}
+
+	svs.downloadBudgetTime = now;
+	numDownloads = 0;
+
+	for ( i = 0; i < sv_maxclients->integer; i++ )
+	{
+		cl = &svs.clients[ ( svs.downloadNextClient + i ) % sv_maxclients->integer ];
+
+		if ( cl->state < CS_CONNECTED || !cl->download || !cl->downloadWindow )
+		{
+			continue;
+		}
+
+		numDownloads++;
+
+		if ( cl->netchan.unsentFragments )
+		{
+			SV_Netchan_TransmitNextFragment( cl );
+			continue;
+		}
+
+		SV_ReadDownloadBlocks( cl );
+		SV_CheckDownloadTimeout( cl, now );
+		SV_SendDownloadBlocks( cl, now );
+	}
+
+	svs.downloadNextClient = ( svs.downloadNextClient + 1 ) % sv_maxclients->integer;
+
+	return numDownloads;
+}
+
 /*
 =================
 SV_Disconnect_f
@@ -1632,6 +2151,7 @@ static ucmd_t ucmds[] =
 	{ "vdr",        SV_ResetPureClient_f, qfalse },
 	{ "download",   SV_BeginDownload_f,   qfalse },
 	{ "nextdl",     SV_NextDownload_f,    qfalse },
+	{ "dlack",      SV_DownloadAck_f,     qfalse },
 	{ "stopdl",     SV_StopDownload_f,    qfalse },
 	{ "donedl",     SV_DoneDownload_f,    qfalse },
 #ifdef USE_VOIP
@@ -2163,7 +2683,8 @@ void SV_ExecuteClientMessage( client_t *cl, msg_t *msg )
 	// don't drop as long as previous command was a nextdl, after a dl is done, downloadName is set back to ""
 	// but we still need to read the next message to move to next download or send gamestate
 	// I don't like this hack though, it must have been working fine at some point, suspecting the fix is somewhere else
-	if ( serverId != sv.serverId && !*cl->downloadName && !strstr( cl->lastClientCommandString, "nextdl" ) )
+	if ( serverId != sv.serverId && !*cl->downloadName && !strstr( cl->lastClientCommandString, "nextdl" ) &&
+	     !strstr( cl->lastClientCommandString, "dlack" ) )
 	{
 		if ( serverId >= sv.restartedServerId && serverId < sv.serverId )
 		{
@@ -447,6 +447,230 @@ static void SV_GetTimeString( char *buffer, int length, const char *format, cons
 	}
 }
 
+/*
+====================
+SV_GameBatch
+
+Runs an array of independent queries for the game in one system call.
+Results may be NULL if only entities are being (un)linked.
+====================
+*/
+static int SV_GameBatch( const batchQuery_t *queries, batchResult_t *results, int count )
+{
+	int i;
+
+	for ( i = 0; i < count; i++ )
+	{
+		const batchQuery_t *query = &queries[ i ];
+
+		if ( query->type < BATCH_LINKENTITY && !results )
+		{
+			Com_Error( ERR_DROP, "SV_GameBatch: query %d needs a result", i );
+		}
+
+		switch ( query->type )
+		{
+			case BATCH_TRACE:
+			case BATCH_TRACECAPSULE:
+				{
+					vec3_t mins, maxs;
+
+					// SV_Trace may adjust the box, leave the game's copy alone
+					VectorCopy( query->mins, mins );
+					VectorCopy( query->maxs, maxs );
+					SV_Trace( &results[ i ].trace, query->start, mins, maxs, query->end, query->entityNum, query->contentmask,
+					          query->type == BATCH_TRACE ? TT_AABB : TT_CAPSULE );
+				}
+				break;
+
+			case BATCH_POINT_CONTENTS:
+				results[ i ].contents = SV_PointContents( query->start, query->entityNum );
+				break;
+
+			case BATCH_LINKENTITY:
+			case BATCH_UNLINKENTITY:
+				if ( query->entityNum < 0 || query->entityNum >= sv.num_entities )
+				{
+					Com_Error( ERR_DROP, "SV_GameBatch: bad entity %d", query->entityNum );
+				}
+
+				if ( query->type == BATCH_LINKENTITY )
+				{
+					SV_LinkEntity( SV_GentityNum( query->entityNum ) );
+				}
+				else
+				{
+					SV_UnlinkEntity( SV_GentityNum( query->entityNum ) );
+				}
+
+				break;
+
+			default:
+				Com_Error( ERR_DROP, "SV_GameBatch: bad query type %d", query->type );
+		}
+
+		if ( sv_gameSyscallStats->integer )
+		{
+			svs.gameSyscallStats[ LAST_GAME_SYSCALL - FIRST_VM_SYSCALL + 1 + query->type ].frame++;
+		}
+	}
+
+	return count;
+}
+
+/*
+====================
+SV_GameSyscallStats_f
+SV_GameSyscallStatsFrame
+
+With sv_gameSyscallStats set, counts the game's system calls (and the
+queries inside batches) per server frame
+====================
+*/
+static const char *const gameSyscallNames[ MAX_GAME_SYSCALL_STATS ] =
+{
+	"G_PRINT",
+	"G_ERROR",
+	"G_LOG",
+	"G_MILLISECONDS",
+	"G_CVAR_REGISTER",
+	"G_CVAR_UPDATE",
+	"G_CVAR_SET",
+	"G_CVAR_VARIABLE_INTEGER_VALUE",
+	"G_CVAR_VARIABLE_STRING_BUFFER",
+	"G_CVAR_LATCHEDVARIABLESTRINGBUFFER",
+	"G_ARGC",
+	"G_ARGV",
+	"G_SEND_CONSOLE_COMMAND",
+	"G_FS_FOPEN_FILE",
+	"G_FS_READ",
+	"G_FS_WRITE",
+	"G_FS_RENAME",
+	"G_FS_FCLOSE_FILE",
+	"G_FS_GETFILELIST",
+	"G_LOCATE_GAME_DATA",
+	"G_DROP_CLIENT",
+	"G_SEND_SERVER_COMMAND",
+	"G_LINKENTITY",
+	"G_UNLINKENTITY",
+	"G_ENTITIES_IN_BOX",
+	"G_ENTITY_CONTACT",
+	"G_ENTITY_CONTACTCAPSULE",
+	"G_TRACE",
+	"G_TRACECAPSULE",
+	"G_POINT_CONTENTS",
+	"G_SET_BRUSH_MODEL",
+	"G_IN_PVS",
+	"G_IN_PVS_IGNORE_PORTALS",
+	"G_SET_CONFIGSTRING",
+	"G_GET_CONFIGSTRING",
+	"G_SET_CONFIGSTRING_RESTRICTIONS",
+	"G_SET_USERINFO",
+	"G_GET_USERINFO",
+	"G_GET_SERVERINFO",
+	"G_ADJUST_AREA_PORTAL_STATE",
+	"G_AREAS_CONNECTED",
+	"G_BOT_ALLOCATE_CLIENT",
+	"G_BOT_FREE_CLIENT",
+	"G_GET_USERCMD",
+	"G_GET_ENTITY_TOKEN",
+	"G_GM_TIME",
+	"G_SNAPVECTOR",
+	"G_SEND_GAMESTAT",
+	"G_ADDCOMMAND",
+	"G_REMOVECOMMAND",
+	"G_GETTAG",
+	"G_REGISTERTAG",
+	"G_REGISTERSOUND",
+	"G_GET_SOUND_LENGTH",
+	"G_PARSE_ADD_GLOBAL_DEFINE",
+	"G_PARSE_LOAD_SOURCE",
+	"G_PARSE_FREE_SOURCE",
+	"G_PARSE_READ_TOKEN",
+	"G_PARSE_SOURCE_FILE_AND_LINE",
+	"BOT_GET_CONSOLE_MESSAGE",
+	"G_ADD_PHYSICS_ENTITY",
+	"G_ADD_PHYSICS_STATIC",
+	"G_SENDMESSAGE",
+	"G_MESSAGESTATUS",
+	"G_RSA_GENMSG",
+	"G_QUOTESTRING",
+	"G_GENFINGERPRINT",
+	"G_GETPLAYERPUBKEY",
+	"G_GETTIMESTRING",
+	"G_BATCH",
+	"G_FIND_CONFIGSTRING",
+	"  BATCH_TRACE",
+	"  BATCH_TRACECAPSULE",
+	"  BATCH_POINT_CONTENTS",
+	"  BATCH_LINKENTITY",
+	"  BATCH_UNLINKENTITY",
+};
+
+void SV_GameSyscallStats_f( void )
+{
+	int total = 0;
+	int i;
+
+	if ( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) )
+	{
+		Com_Memset( svs.gameSyscallStats, 0, sizeof( svs.gameSyscallStats ) );
+		svs.gameSyscallFrames = 0;
+		return;
+	}
+
+	if ( !svs.gameSyscallFrames )
+	{
+		Com_Printf( "No frames counted yet; set sv_gameSyscallStats 1\n" );
+		return;
+	}
+
+	Com_Printf( "%-36s %10s %9s %9s\n", "syscall", "total", "per frame", "peak" );
+
+	for ( i = 0; i < MAX_GAME_SYSCALL_STATS; i++ )
+	{
+		gameSyscallStat_t *stat = &svs.gameSyscallStats[ i ];
+
+		if ( !stat->total )
+		{
+			continue;
+		}
+
+		Com_Printf( "%-36s %10d %9.1f %9d\n", gameSyscallNames[ i ] ? gameSyscallNames[ i ] : va( "%d", i + FIRST_VM_SYSCALL ),
+		            stat->total, ( float ) stat->total / svs.gameSyscallFrames, stat->peak );
+
+		// batched queries are already included in their G_BATCH call
+		if ( i <= LAST_GAME_SYSCALL - FIRST_VM_SYSCALL )
+		{
+			total += stat->total;
+		}
+	}
+
+	Com_Printf( "%d system calls in %d frames, %.1f per frame\n", total, svs.gameSyscallFrames,
+	            ( float ) total / svs.gameSyscallFrames );
+}
+
+void SV_GameSyscallStatsFrame( void )
+{
+	int i;
+
+	if ( !sv_gameSyscallStats->integer )
+	{
+		return;
+	}
+
+	for ( i = 0; i < MAX_GAME_SYSCALL_STATS; i++ )
+	{
+		gameSyscallStat_t *stat = &svs.gameSyscallStats[ i ];
+
+		stat->total += stat->frame;
+		stat->peak = MAX( stat->peak, stat->frame );
+		stat->frame = 0;
+	}
+
+	svs.gameSyscallFrames++;
+}
+
 /*
 ====================
 SV_GameSystemCalls
@@ -456,6 +680,11 @@ The module is making a system call
 */
 intptr_t SV_GameSystemCalls( intptr_t *args )
 {
+	if ( sv_gameSyscallStats->integer && args[ 0 ] >= FIRST_VM_SYSCALL && args[ 0 ] <= LAST_GAME_SYSCALL )
+	{
+		svs.gameSyscallStats[ args[ 0 ] - FIRST_VM_SYSCALL ].frame++;
+	}
+
 	switch ( args[ 0 ] )
 	{
 		case G_PRINT:
@@ -746,6 +975,19 @@ intptr_t SV_GameSystemCalls( intptr_t *args )
 		        VM_CheckBlock( args[1], args[2], "STRFTIME" );
 			SV_GetTimeString( VMA( 1 ), args[ 2 ], VMA( 3 ), VMA( 4 ) );
 			return 0;
+
+		case G_BATCH:
+			VM_CheckBlock( args[ 1 ], args[ 3 ] * sizeof( batchQuery_t ), "BATCHQ" );
+
+			if ( args[ 2 ] )
+			{
+				VM_CheckBlock( args[ 2 ], args[ 3 ] * sizeof( batchResult_t ), "BATCHR" );
+			}
+
+			return SV_GameBatch( VMA( 1 ), VMA( 2 ), args[ 3 ] );
+
+		case G_FIND_CONFIGSTRING:
+			return SV_FindConfigstring( VMA( 1 ), args[ 2 ], args[ 3 ], args[ 4 ] );
 			
 		default:
 			Com_Error( ERR_DROP, "Bad game system trap: %ld", ( long int ) args[ 0 ] );
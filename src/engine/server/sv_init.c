@@ -41,6 +41,83 @@ Maryland 20850 USA.
 
 #include "server.h"
 
+/*
+===============
+SV_HashConfigstring
+SV_UnhashConfigstring
+
+Non-empty configstrings are kept in a reverse index, so the game can look up
+model, sound and shader indexes without fetching configstrings one by one
+===============
+*/
+static int SV_ConfigstringHashKey( const char *val )
+{
+	return Com_HashKey( ( char * ) val, MAX_STRING_CHARS ) & ( CONFIGSTRING_HASH_SIZE - 1 );
+}
+
+static void SV_HashConfigstring( int index )
+{
+	int key;
+
+	if ( !sv.configstrings[ index ][ 0 ] )
+	{
+		return;
+	}
+
+	key = SV_ConfigstringHashKey( sv.configstrings[ index ] );
+	sv.configstringHashNext[ index ] = sv.configstringHash[ key ];
+	sv.configstringHash[ key ] = index + 1;
+}
+
+static void SV_UnhashConfigstring( int index )
+{
+	int *link;
+
+	if ( !sv.configstrings[ index ] || !sv.configstrings[ index ][ 0 ] )
+	{
+		return;
+	}
+
+	for ( link = &sv.configstringHash[ SV_ConfigstringHashKey( sv.configstrings[ index ] ) ]; *link; link = &sv.configstringHashNext[ *link - 1 ] )
+	{
+		if ( *link == index + 1 )
+		{
+			*link = sv.configstringHashNext[ index ];
+			sv.configstringHashNext[ index ] = 0;
+			return;
+		}
+	}
+}
+
+/*
+===============
+SV_FreeDeflatedGamestate
+
+The configstrings or baselines changed, the next gamestate
+has to be deflated again
+===============
+*/
+static void SV_FreeDeflatedGamestate( void )
+{
+	if ( sv.gamestateDeflated )
+	{
+		Z_Free( sv.gamestateDeflated );
+	}
+
+	sv.gamestateDeflated = NULL;
+	sv.gamestateDeflatedSize = 0;
+	sv.gamestateRawSize = 0;
+}
+
+static void SV_ReplaceConfigstring( int index, const char *val )
+{
+	SV_FreeDeflatedGamestate();
+	SV_UnhashConfigstring( index );
+	Z_Free( sv.configstrings[ index ] );
+	sv.configstrings[ index ] = CopyString( val );
+	SV_HashConfigstring( index );
+}
+
 /*
 ===============
 SV_SetConfigstring
@@ -65,8 +142,7 @@ void SV_SetConfigstringNoUpdate( int index, const char *val )
 	}
 
 	// change the string in sv
-	Z_Free( sv.configstrings[ index ] );
-	sv.configstrings[ index ] = CopyString( val );
+	SV_ReplaceConfigstring( index, val );
 }
 
 void SV_SetConfigstring( int index, const char *val )
@@ -88,8 +164,7 @@ void SV_SetConfigstring( int index, const char *val )
 	}
 
 	// change the string in sv
-	Z_Free( sv.configstrings[ index ] );
-	sv.configstrings[ index ] = CopyString( val );
+	SV_ReplaceConfigstring( index, val );
 	sv.configstringsmodified[ index ] = qtrue;
 }
 
@@ -195,6 +270,69 @@ void SV_GetConfigstring( int index, char *buffer, int bufferSize )
 	Q_strncpyz( buffer, sv.configstrings[ index ], bufferSize );
 }
 
+/*
+===============
+SV_FindConfigstring
+
+Returns the offset from start of the lowest configstring in ( start, start + max )
+that is equal to name, or 0 if there is none. With create set, name is stored
+in the first empty one instead, and -1 is returned if there is no room left.
+Only creating a configstring has to look for a free slot, the lookups are all
+answered by the hash.
+===============
+*/
+int SV_FindConfigstring( const char *name, int start, int max, qboolean create )
+{
+	int index, found;
+
+	if ( start < 0 || max < 1 || start + max > MAX_CONFIGSTRINGS )
+	{
+		Com_Error( ERR_DROP, "SV_FindConfigstring: bad range %i+%i", start, max );
+	}
+
+	if ( !name || !name[ 0 ] )
+	{
+		return 0;
+	}
+
+	found = 0;
+
+	for ( index = sv.configstringHash[ SV_ConfigstringHashKey( name ) ]; index; index = sv.configstringHashNext[ index - 1 ] )
+	{
+		// keep the lowest match, as a linear search would
+		if ( index - 1 > start && index - 1 < start + max && ( !found || index - 1 < found )
+		     && !strcmp( sv.configstrings[ index - 1 ], name ) )
+		{
+			found = index - 1;
+		}
+	}
+
+	if ( found )
+	{
+		return found - start;
+	}
+
+	if ( !create )
+	{
+		return 0;
+	}
+
+	index = 1;
+
+	while ( index < max && sv.configstrings[ start + index ][ 0 ] )
+	{
+		index++;
+	}
+
+	if ( index == max )
+	{
+		return -1;
+	}
+
+	SV_SetConfigstring( start + index, name );
+	return index;
+}
+
 /*
 ===============
 SV_SetUserinfo
@@ -275,6 +413,8 @@ void SV_CreateBaseline( void )
 	sharedEntity_t *svent;
 	int            entnum;
 
+	SV_FreeDeflatedGamestate();
+
 	for ( entnum = 1; entnum < sv.num_entities; entnum++ )
 	{
 		svent = SV_GentityNum( entnum );
@@ -527,6 +667,8 @@ void SV_ClearServer( void )
 		}
 	}
 
+	SV_FreeDeflatedGamestate();
+
 	Com_Memset( &sv, 0, sizeof( sv ) );
 }
 
@@ -624,8 +766,11 @@ void SV_SpawnServer( char *server )
 	FS_ClearPakReferences( 0 );
 
 	// allocate the snapshot entities on the hunk
-	svs.snapshotEntities = Hunk_Alloc( sizeof( entityState_t ) * svs.numSnapshotEntities, h_high );
+	svs.snapshotEntities = Hunk_Alloc( sizeof( int ) * svs.numSnapshotEntities, h_high );
 	svs.nextSnapshotEntities = 0;
+	svs.numSnapshotStates = MIN( svs.numSnapshotEntities, PACKET_BACKUP * MAX_GENTITIES );
+	svs.snapshotStates = Hunk_Alloc( sizeof( entityState_t ) * svs.numSnapshotStates, h_high );
+	svs.nextSnapshotStates = 0;
 
 	// toggle the server bit so clients can detect that a
 	// server has changed
@@ -887,12 +1032,19 @@ void SV_Init( void )
 	sv_mapChecksum = Cvar_Get( "sv_mapChecksum", "", CVAR_ROM );
 
 	sv_lanForceRate = Cvar_Get( "sv_lanForceRate", "1", CVAR_ARCHIVE );
+	sv_pace = Cvar_Get( "sv_pace", "1", CVAR_ARCHIVE );
 
 	sv_showAverageBPS = Cvar_Get( "sv_showAverageBPS", "0", 0 );  // NERVE - SMF - net debugging
 
 	// the download netcode tops at 18/20 kb/s, no need to make you think you can go above
 	sv_dl_maxRate = Cvar_Get( "sv_dl_maxRate", "42000", CVAR_ARCHIVE );
 
+	// windowed downloads are paced by congestion control, only their total is capped
+	sv_dl_window = Cvar_Get( "sv_dl_window", "64", CVAR_ARCHIVE );
+	sv_dl_totalRate = Cvar_Get( "sv_dl_totalRate", "1000000", CVAR_ARCHIVE );
+
+	sv_gamestateDeflate = Cvar_Get( "sv_gamestateDeflate", "1", CVAR_ARCHIVE );
+
 	sv_wwwDownload = Cvar_Get( "sv_wwwDownload", "0", CVAR_ARCHIVE );
 	sv_wwwBaseURL = Cvar_Get( "sv_wwwBaseURL", "", CVAR_ARCHIVE );
 	sv_wwwDlDisconnected = Cvar_Get( "sv_wwwDlDisconnected", "0", CVAR_ARCHIVE );
@@ -901,6 +1053,9 @@ void SV_Init( void )
 	//bani
 	sv_packetdelay = Cvar_Get( "sv_packetdelay", "0", CVAR_CHEAT );
 
+	// count game system calls per frame, see the gamesyscalls command
+	sv_gameSyscallStats = Cvar_Get( "sv_gameSyscallStats", "0", 0 );
+
 	// fretn - note: redirecting of clients to other servers relies on this,
 	// ET://someserver.com
 	sv_fullmsg = Cvar_Get( "sv_fullmsg", "Server is full.", CVAR_ARCHIVE );
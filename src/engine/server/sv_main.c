@@ -68,8 +68,13 @@ cvar_t         *sv_pure;
 cvar_t         *sv_newGameShlib;
 cvar_t         *sv_floodProtect;
 cvar_t         *sv_lanForceRate; // TTimo - dedicated 1 (LAN) server forces local client rates to 99999 (bug #491)
+cvar_t         *sv_pace; // spread the client messages over the frame interval instead of sending them in a burst
 
 cvar_t         *sv_dl_maxRate;
+cvar_t         *sv_dl_window; // largest selective acknowledge window offered to clients, 0 for in order downloads only
+cvar_t         *sv_dl_totalRate; // bytes per second shared by all windowed downloads, 0 for no limit
+
+cvar_t         *sv_gamestateDeflate; // deflate gamestates for the clients that support it
 
 cvar_t *sv_showAverageBPS; // NERVE - SMF - net debugging
 
@@ -84,6 +89,7 @@ cvar_t *sv_wwwFallbackURL; // URL to send to if an http/ftp fails or is refused
 //bani
 cvar_t *sv_cheats;
 cvar_t *sv_packetdelay;
+cvar_t *sv_gameSyscallStats;
 
 // fretn
 cvar_t *sv_fullmsg;
@@ -1262,6 +1268,7 @@ void SV_Frame( int msec )
 	int        startTime;
 	char       mapname[ MAX_QPATH ];
 	int        frameStartTime = 0, frameEndTime;
+	int        paceMsec;
 	static int start, end;
 
 	start = Sys_Milliseconds();
@@ -1306,11 +1313,23 @@ void SV_Frame( int msec )
 		SV_BotFrame( svs.time + sv.timeResidual );
 	}
 
+	// the messages of the last frame go out over the frame interval
+	paceMsec = SV_SendPacedMessages();
+
 	if ( com_dedicated->integer && sv.timeResidual < frameMsec )
 	{
 		// NET_Sleep will give the OS time slices until either get a packet
-		// or time enough for a server frame has gone by
-		NET_Sleep( frameMsec - sv.timeResidual );
+		// or time enough for a server frame has gone by, or the next
+		// paced message is due
+		if ( paceMsec >= 0 && paceMsec < frameMsec - sv.timeResidual )
+		{
+			NET_Sleep( paceMsec );
+		}
+		else
+		{
+			NET_Sleep( frameMsec - sv.timeResidual );
+		}
+
 		return;
 	}
 
@@ -1332,7 +1351,8 @@ void SV_Frame( int msec )
 	}
 
 	// this can happen considerably earlier when lots of clients play and the map doesn't change
-	if ( svs.nextSnapshotEntities >= 0x7FFFFFFE - svs.numSnapshotEntities )
+	if ( svs.nextSnapshotEntities >= 0x7FFFFFFE - svs.numSnapshotEntities
+	     || svs.nextSnapshotStates >= 0x7FFFFFFE - svs.numSnapshotStates )
 	{
 		Q_strncpyz( mapname, sv_mapname->string, MAX_QPATH );
 		SV_Shutdown( "Restarting server due to numSnapshotEntities wrapping" );
@@ -1393,6 +1413,8 @@ void SV_Frame( int msec )
 		// let everything in the world think and move
 		VM_Call( gvm, GAME_RUN_FRAME, svs.time );
 
+		SV_GameSyscallStatsFrame();
+
 #ifdef USE_PHYSICS
 		CMod_PhysicsUpdate();
 #endif
@@ -1408,6 +1430,7 @@ void SV_Frame( int msec )
 
 	// send messages back to the clients
 	SV_SendClientMessages();
+	SV_SendDownloadMessages();
 
 	// send a heartbeat to the master if needed
 	SV_MasterHeartbeat( HEARTBEAT_GAME );
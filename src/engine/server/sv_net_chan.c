@@ -50,7 +50,7 @@ static void SV_Netchan_Encode( client_t *client, msg_t *msg, char *commandString
 	long /*reliableAcknowledge,*/ i, index;
 	byte                                     key, *string;
 	int                                      srdc, sbit;
-	qboolean                                 soob;
+	qboolean                                 soob, ssample;
 
 	if ( msg->cursize < SV_ENCODE_START )
 	{
@@ -61,14 +61,17 @@ static void SV_Netchan_Encode( client_t *client, msg_t *msg, char *commandString
 	srdc = msg->readcount;
 	sbit = msg->bit;
 	soob = msg->oob;
+	ssample = msg->huffSample;
 
 	msg->bit = 0;
 	msg->readcount = 0;
 	msg->oob = qfalse;
+	msg->huffSample = qfalse; // already sampled when it was written
 
 	/*reliableAcknowledge = */
 	MSG_ReadLong( msg );
 
+	msg->huffSample = ssample;
 	msg->oob = soob;
 	msg->bit = sbit;
 	msg->readcount = srdc;
@@ -178,6 +181,74 @@ void SV_Netchan_FreeQueue( client_t *client )
 
 	client->netchan_start_queue = NULL;
 	client->netchan_end_queue = client->netchan_start_queue;
+
+	client->pacedTime = 0;
+	client->paceLastSend = 0;
+	client->paceInterval = 0;
+	client->paceJitter = 0;
+}
+
+/*
+=================
+SV_Netchan_PaceStats
+
+A message of SV_SendClientMessages went out, keep track of
+how regular the intervals between them are
+=================
+*/
+static void SV_Netchan_PaceStats( client_t *client, int now )
+{
+	int interval;
+
+	if ( client->paceLastSend )
+	{
+		interval = now - client->paceLastSend;
+
+		if ( client->paceInterval )
+		{
+			client->paceJitter += abs( interval - client->paceInterval ) - ( ( client->paceJitter + 8 ) >> 4 );
+		}
+
+		client->paceInterval = interval;
+	}
+
+	client->paceLastSend = now;
+}
+
+/*
+=================
+SV_Netchan_TransmitPaced
+
+Send the paced message if it is due, or right away if flush is set.
+Returns the msec until it is due, or -1 if there is nothing waiting
+=================
+*/
+int SV_Netchan_TransmitPaced( client_t *client, qboolean flush )
+{
+	int now;
+
+	if ( !client->pacedTime )
+	{
+		return -1;
+	}
+
+	now = Sys_Milliseconds();
+
+	if ( !flush && client->pacedTime - now > 0 )
+	{
+		return client->pacedTime - now;
+	}
+
+	client->pacedTime = 0;
+
+	// the frame was recorded when the message was built, the ping starts now
+	client->frames[ client->netchan.outgoingSequence & PACKET_MASK ].messageSent = svs.time;
+
+	SV_Netchan_Encode( client, &client->paced.msg, client->paced.lastClientCommandString );
+	Netchan_Transmit( &client->netchan, client->paced.msg.cursize, client->paced.msg.data );
+
+	SV_Netchan_PaceStats( client, now );
+	return -1;
 }
 
 /*
@@ -253,10 +324,26 @@ then buffer them and make sure they get sent in correct order
 void SV_Netchan_Transmit( client_t *client, msg_t *msg )
 {
 	//int length, const byte *data ) {
+	int sendTime;
+
+	sendTime = client->paceTime;
+	client->paceTime = 0;
+
+	// keep the messages in order
+	SV_Netchan_TransmitPaced( client, qtrue );
+
 	MSG_WriteByte( msg, svc_EOF );
 	SV_WriteBinaryMessage( msg, client );
 
-	if ( client->netchan.unsentFragments )
+	if ( sendTime && !client->netchan.unsentFragments && !client->netchan_start_queue &&
+	     sendTime - Sys_Milliseconds() > 0 )
+	{
+		// encoded when it is sent, like the queued messages
+		MSG_Copy( &client->paced.msg, client->paced.msgBuffer, sizeof( client->paced.msgBuffer ), msg );
+		strcpy( client->paced.lastClientCommandString, client->lastClientCommandString );
+		client->pacedTime = sendTime;
+	}
+	else if ( client->netchan.unsentFragments )
 	{
 		netchan_buffer_t *netbuf;
 
@@ -294,6 +381,11 @@ void SV_Netchan_Transmit( client_t *client, msg_t *msg )
 	{
 		SV_Netchan_Encode( client, msg, client->lastClientCommandString );
 		Netchan_Transmit( &client->netchan, msg->cursize, msg->data );
+
+		if ( sendTime )
+		{
+			SV_Netchan_PaceStats( client, Sys_Milliseconds() );
+		}
 	}
 }
 
@@ -56,6 +56,9 @@ A server packet will look something like:
 =============================================================================
 */
 
+// set while SV_SendClientMessages builds the snapshots of a server frame
+static qboolean sharedSnapshotStates;
+
 /*
 =============
 SV_EmitPacketEntities
@@ -93,7 +96,7 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 		}
 		else
 		{
-			newent = &svs.snapshotEntities[( to->first_entity + newindex ) % svs.numSnapshotEntities ];
+			newent = SV_SnapshotEntityState( to, newindex );
 			newnum = newent->number;
 		}
 
@@ -103,7 +106,7 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 		}
 		else
 		{
-			oldent = &svs.snapshotEntities[( from->first_entity + oldindex ) % svs.numSnapshotEntities ];
+			oldent = SV_SnapshotEntityState( from, oldindex );
 			oldnum = oldent->number;
 		}
 
@@ -174,7 +177,8 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg )
 		lastframe = client->netchan.outgoingSequence - client->deltaMessage;
 
 		// the snapshot's entities may still have rolled off the buffer, though
-		if ( oldframe->first_entity <= svs.nextSnapshotEntities - svs.numSnapshotEntities )
+		if ( oldframe->first_entity <= svs.nextSnapshotEntities - svs.numSnapshotEntities
+		     || oldframe->first_state <= svs.nextSnapshotStates - svs.numSnapshotStates )
 		{
 			Com_DPrintf( "%s^7: Delta request from out of date entities.\n", client->name );
 			oldframe = NULL;
@@ -660,7 +664,6 @@ static void SV_BuildClientSnapshot( client_t *client )
 	snapshotEntityNumbers_t entityNumbers;
 	int                     i;
 	sharedEntity_t          *ent;
-	entityState_t           *state;
 	svEntity_t              *svEnt;
 	sharedEntity_t          *clent;
 	int                     clientNum;
@@ -733,19 +736,36 @@ static void SV_BuildClientSnapshot( client_t *client )
 		( ( int * ) frame->areabits ) [ i ] = ( ( int * ) frame->areabits ) [ i ] ^ -1;
 	}
 
-	// copy the entity states out
+	// copy the entity states out, unless another client's snapshot
+	// already did so since they last could have changed
+	if ( !sharedSnapshotStates )
+	{
+		sv.snapshotStateFrame++;
+	}
+
 	frame->num_entities = 0;
 	frame->first_entity = svs.nextSnapshotEntities;
+	frame->first_state = svs.nextSnapshotStates;
 
 	for ( i = 0; i < entityNumbers.numSnapshotEntities; i++ )
 	{
-		ent = SV_GentityNum( entityNumbers.snapshotEntities[ i ] );
-		state = &svs.snapshotEntities[ svs.nextSnapshotEntities % svs.numSnapshotEntities ];
-		*state = ent->s;
+		svEnt = &sv.svEntities[ entityNumbers.snapshotEntities[ i ] ];
+
+		if ( svEnt->snapshotStateFrame != sv.snapshotStateFrame )
+		{
+			ent = SV_GentityNum( entityNumbers.snapshotEntities[ i ] );
+			svs.snapshotStates[ svs.nextSnapshotStates % svs.numSnapshotStates ] = ent->s;
+			svEnt->snapshotStateFrame = sv.snapshotStateFrame;
+			svEnt->snapshotState = svs.nextSnapshotStates++;
+		}
+
+		frame->first_state = MIN( frame->first_state, svEnt->snapshotState );
+
+		svs.snapshotEntities[ svs.nextSnapshotEntities % svs.numSnapshotEntities ] = svEnt->snapshotState;
 		svs.nextSnapshotEntities++;
 
 		// this should never hit, map should always be restarted first in SV_Frame
-		if ( svs.nextSnapshotEntities >= 0x7FFFFFFE )
+		if ( svs.nextSnapshotEntities >= 0x7FFFFFFE || svs.nextSnapshotStates >= 0x7FFFFFFE )
 		{
 			Com_Error( ERR_FATAL, "svs.nextSnapshotEntities wrapped" );
 		}
@@ -754,6 +774,18 @@ static void SV_BuildClientSnapshot( client_t *client )
 	}
 }
 
+/*
+=============
+SV_SnapshotEntityState
+
+Returns the state of a snapshot's index'th entity
+=============
+*/
+entityState_t *SV_SnapshotEntityState( const clientSnapshot_t *frame, int index )
+{
+	return &svs.snapshotStates[ svs.snapshotEntities[( frame->first_entity + index ) % svs.numSnapshotEntities ] % svs.numSnapshotStates ];
+}
+
 #ifdef USE_VOIP
 
 /*
@@ -816,6 +848,7 @@ TTimo - use sv_maxRate or sv_dl_maxRate depending on regular or downloading clie
 ====================
 */
 #define HEADER_RATE_BYTES 48 // include our header, IP header, and some overhead
+#define PACE_MAX_MSEC     15 // the slots are spread over at most this much of the frame interval
 static int SV_RateMsec( client_t *client, int messageSize )
 {
 	int rate;
@@ -870,11 +903,16 @@ void SV_SendMessageToClient( msg_t *msg, client_t *client )
 {
 	int rateMsec;
 
+	// the paced message must go out first, its frame is the one before this
+	SV_Netchan_TransmitPaced( client, qtrue );
+
 	// record information about the message
 	client->frames[ client->netchan.outgoingSequence & PACKET_MASK ].messageSize = msg->cursize;
 	client->frames[ client->netchan.outgoingSequence & PACKET_MASK ].messageSent = svs.time;
 	client->frames[ client->netchan.outgoingSequence & PACKET_MASK ].messageAcked = -1;
 
+	MSG_HuffmanCountMessage( msg );
+
 	// send the datagram
 	SV_Netchan_Transmit( client, msg );
 
@@ -939,6 +977,8 @@ void SV_SendClientIdle( client_t *client )
 
 	MSG_Init( &msg, msg_buf, sizeof( msg_buf ) );
 	msg.allowoverflow = qtrue;
+	msg.huffTable = client->huffTrained ? HUFF_TRAINED : HUFF_STATIC;
+	msg.huffSample = qtrue;
 
 	// NOTE, MRE: all server->client messages now acknowledge
 	// let the client know which reliable clientCommands we have received
@@ -1007,6 +1047,8 @@ void SV_SendClientSnapshot( client_t *client )
 
 	MSG_Init( &msg, msg_buf, sizeof( msg_buf ) );
 	msg.allowoverflow = qtrue;
+	msg.huffTable = client->huffTrained ? HUFF_TRAINED : HUFF_STATIC;
+	msg.huffSample = qtrue;
 
 	// NOTE, MRE: all server->client messages now acknowledge
 	// let the client know which reliable clientCommands we have received
@@ -1043,15 +1085,31 @@ void SV_SendClientSnapshot( client_t *client )
 
 /*
 =======================
-SV_SendClientMessages
+SV_IsPacedClient
 =======================
 */
+static qboolean SV_IsPacedClient( client_t *c )
+{
+	if ( c->state < CS_ZOMBIE || ( c->gentity && c->gentity->r.svFlags & SVF_BOT ) )
+	{
+		return qfalse;
+	}
+
+	// nothing to gain for local clients
+	return c->netchan.remoteAddress.type != NA_LOOPBACK;
+}
 
+/*
+=======================
+SV_SendClientMessages
+=======================
+*/
 void SV_SendClientMessages( void )
 {
 	int      i;
 	client_t *c;
 	int      numclients = 0; // NERVE - SMF - net debugging
+	int      frameStart, spreadMsec, numPaced, slot;
 
 	sv.bpsTotalBytes = 0; // NERVE - SMF - net debugging
 	sv.ubpsTotalBytes = 0; // NERVE - SMF - net debugging
@@ -1059,6 +1117,29 @@ void SV_SendClientMessages( void )
 	// Gordon: update any changed configstrings from this frame
 	SV_UpdateConfigStrings();
 
+	// the game doesn't run while sending, so all clients can share the entity states
+	sv.snapshotStateFrame++;
+	sharedSnapshotStates = qtrue;
+
+	// the snapshots are all built now, but each client is given its own
+	// slot early in the frame interval so they don't leave in a single burst,
+	// capped so pacing never holds a snapshot back more than PACE_MAX_MSEC
+	frameStart = Sys_Milliseconds();
+	spreadMsec = MIN( 1000 / sv_fps->integer, PACE_MAX_MSEC );
+	numPaced = 0;
+	slot = 0;
+
+	if ( sv_pace->integer )
+	{
+		for ( i = 0; i < sv_maxclients->integer; i++ )
+		{
+			if ( SV_IsPacedClient( &svs.clients[ i ] ) )
+			{
+				numPaced++;
+			}
+		}
+	}
+
 	// send a message to each connected client
 	for ( i = 0; i < sv_maxclients->integer; i++ )
 	{
@@ -1078,17 +1159,29 @@ void SV_SendClientMessages( void )
 			continue;
 		}
 
+		// the slots stay the same from frame to frame, whether the client is sent something or not,
+		// without sv_pace they are all due now, which still keeps the jitter stats going
+		if ( SV_IsPacedClient( c ) )
+		{
+			c->paceTime = MAX( frameStart + ( numPaced ? slot++ * spreadMsec / numPaced : 0 ), 1 );
+		}
+
 		if ( svs.time < c->nextSnapshotTime )
 		{
+			c->paceTime = 0;
 			continue; // not time yet
 		}
 
 		numclients++; // NERVE - SMF - net debugging
 
+		// the previous frame could have run late
+		SV_Netchan_TransmitPaced( c, qtrue );
+
 		// send additional message fragments if the last message
 		// was too large to send at once
 		if ( c->netchan.unsentFragments )
 		{
+			c->paceTime = 0;
 			c->nextSnapshotTime = svs.time + SV_RateMsec( c, c->netchan.unsentLength - c->netchan.unsentFragmentStart );
 			SV_Netchan_TransmitNextFragment( c );
 			continue;
@@ -1096,8 +1189,11 @@ void SV_SendClientMessages( void )
 
 		// generate and send a new message
 		SV_SendClientSnapshot( c );
+		c->paceTime = 0;
 	}
 
+	sharedSnapshotStates = qfalse;
+
 	// NERVE - SMF - net debugging
 	if ( sv_showAverageBPS->integer && numclients > 0 )
 	{
@@ -1151,3 +1247,37 @@ void SV_SendClientMessages( void )
 
 	// -NERVE - SMF
 }
+
+/*
+=======================
+SV_SendPacedMessages
+
+Send the messages of SV_SendClientMessages whose slot has come, called by
+SV_Frame and between the frames of a dedicated server by Com_Frame.
+Returns the msec until the next one is due, or -1 if none is waiting
+=======================
+*/
+int SV_SendPacedMessages( void )
+{
+	int      i, msec, next;
+	client_t *c;
+
+	if ( !com_sv_running || !com_sv_running->integer || !svs.clients )
+	{
+		return -1;
+	}
+
+	next = -1;
+
+	for ( i = 0, c = svs.clients; i < sv_maxclients->integer; i++, c++ )
+	{
+		msec = SV_Netchan_TransmitPaced( c, qfalse );
+
+		if ( msec >= 0 && ( next < 0 || msec < next ) )
+		{
+			next = msec;
+		}
+	}
+
+	return next;
+}
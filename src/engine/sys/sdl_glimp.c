@@ -434,6 +434,228 @@ void GLimp_WakeRenderer( void *data )
 
 #endif
 
+#if defined( USE_XREAL_RENDERER )
+
+/*
+===========================================================
+
+Worker threads
+
+The renderer hands CPU heavy work which splits into independent
+jobs (like skinning) to these, and takes part in it itself
+
+===========================================================
+*/
+
+#define MAX_RENDER_WORKERS 8
+
+static SDL_Thread *renderWorkers[ MAX_RENDER_WORKERS ];
+static int        numRenderWorkers;
+static SDL_mutex  *workMutex;
+static SDL_cond   *workStartEvent;
+static SDL_cond   *workDoneEvent;
+static qboolean   workShutdown;
+
+static void ( *workFunction )( void *data, int job );
+static void       *workData;
+static int        workNumJobs;
+static int        workNextJob;
+static int        workJobsDone;
+
+/*
+===============
+GLimp_DoJobs
+
+Runs jobs until none are left to start, workMutex must be locked
+===============
+*/
+static void GLimp_DoJobs( void )
+{
+	int job;
+
+	while ( workNextJob < workNumJobs )
+	{
+		job = workNextJob++;
+
+		SDL_UnlockMutex( workMutex );
+		workFunction( workData, job );
+		SDL_LockMutex( workMutex );
+
+		if ( ++workJobsDone == workNumJobs )
+		{
+			SDL_CondSignal( workDoneEvent );
+		}
+	}
+}
+
+static int GLimp_WorkerThread( void *arg )
+{
+	SDL_LockMutex( workMutex );
+
+	while ( !workShutdown )
+	{
+		GLimp_DoJobs();
+		SDL_CondWait( workStartEvent, workMutex );
+	}
+
+	SDL_UnlockMutex( workMutex );
+
+	return 0;
+}
+
+/*
+===============
+GLimp_InitWorkers
+===============
+*/
+void GLimp_InitWorkers( int count )
+{
+	GLimp_ShutdownWorkers();
+
+	count = MIN( count, MAX_RENDER_WORKERS );
+
+	if ( count <= 0 )
+	{
+		return;
+	}
+
+	workMutex = SDL_CreateMutex();
+	workStartEvent = SDL_CreateCond();
+	workDoneEvent = SDL_CreateCond();
+
+	if ( !workMutex || !workStartEvent || !workDoneEvent )
+	{
+		ri.Printf( PRINT_WARNING, "Render worker creation failed: %s\n", SDL_GetError() );
+		GLimp_ShutdownWorkers();
+		return;
+	}
+
+	workShutdown = qfalse;
+
+	for ( numRenderWorkers = 0; numRenderWorkers < count; numRenderWorkers++ )
+	{
+		renderWorkers[ numRenderWorkers ] = SDL_CreateThread( GLimp_WorkerThread, NULL );
+
+		if ( !renderWorkers[ numRenderWorkers ] )
+		{
+			ri.Printf( PRINT_WARNING, "SDL_CreateThread() returned %s\n", SDL_GetError() );
+			break;
+		}
+	}
+
+	ri.Printf( PRINT_DEVELOPER, "%d render worker threads\n", numRenderWorkers );
+}
+
+/*
+===============
+GLimp_ShutdownWorkers
+===============
+*/
+void GLimp_ShutdownWorkers( void )
+{
+	int i;
+
+	if ( workMutex )
+	{
+		SDL_LockMutex( workMutex );
+		workShutdown = qtrue;
+		SDL_CondBroadcast( workStartEvent );
+		SDL_UnlockMutex( workMutex );
+	}
+
+	for ( i = 0; i < numRenderWorkers; i++ )
+	{
+		SDL_WaitThread( renderWorkers[ i ], NULL );
+		renderWorkers[ i ] = NULL;
+	}
+
+	numRenderWorkers = 0;
+
+	if ( workDoneEvent )
+	{
+		SDL_DestroyCond( workDoneEvent );
+		workDoneEvent = NULL;
+	}
+
+	if ( workStartEvent )
+	{
+		SDL_DestroyCond( workStartEvent );
+		workStartEvent = NULL;
+	}
+
+	if ( workMutex )
+	{
+		SDL_DestroyMutex( workMutex );
+		workMutex = NULL;
+	}
+}
+
+/*
+===============
+GLimp_NumWorkers
+===============
+*/
+int GLimp_NumWorkers( void )
+{
+	return numRenderWorkers;
+}
+
+/*
+===============
+GLimp_RunJobs
+
+Calls function( data, job ) for every job from 0 to numJobs - 1,
+spread over the worker threads, and returns once all are done.
+The jobs run on the calling thread if the workers are already busy
+with jobs from the other render thread.
+===============
+*/
+void GLimp_RunJobs( void ( *function )( void *data, int job ), void *data, int numJobs )
+{
+	int      job;
+	qboolean busy = qfalse;
+
+	if ( numRenderWorkers && numJobs > 1 )
+	{
+		SDL_LockMutex( workMutex );
+		busy = workJobsDone < workNumJobs;
+
+		if ( busy )
+		{
+			SDL_UnlockMutex( workMutex );
+		}
+	}
+
+	if ( !numRenderWorkers || numJobs <= 1 || busy )
+	{
+		for ( job = 0; job < numJobs; job++ )
+		{
+			function( data, job );
+		}
+
+		return;
+	}
+
+	workFunction = function;
+	workData = data;
+	workNumJobs = numJobs;
+	workNextJob = 0;
+	workJobsDone = 0;
+
+	SDL_CondBroadcast( workStartEvent );
+
+	GLimp_DoJobs();
+
+	while ( workJobsDone < workNumJobs )
+	{
+		SDL_CondWait( workDoneEvent, workMutex );
+	}
+
+	SDL_UnlockMutex( workMutex );
+}
+
+#endif
+
 typedef enum
 {
   RSERR_OK,
@@ -51,6 +51,18 @@ Maryland 20850 USA.
 #include <libgen.h>
 #include <fcntl.h>
 #include <fenv.h>
+#include <dlfcn.h>
+
+#ifdef __linux__
+#include <ucontext.h>
+#include <sys/syscall.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
 
 
 #if !defined(DEDICATED) && !defined(BUILD_TTY_CLIENT)
@@ -323,6 +335,193 @@ qboolean Sys_LowPhysicalMemory( void )
 	return qfalse;
 }
 
+static sysProfileCallback_t profileCallback;
+static intptr_t             profileThread;
+
+/*
+==================
+Sys_ProfileThreadId
+
+Safe to call from a signal handler
+==================
+*/
+static intptr_t Sys_ProfileThreadId( void )
+{
+#ifdef __linux__
+	return syscall( SYS_gettid );
+#else
+	return ( intptr_t ) pthread_self();
+#endif
+}
+
+/*
+==================
+Sys_ProfileSigHandler
+
+Hands the interrupted program counter, stack pointer and the native backtrace
+(with this handler and the signal trampoline stripped) to the profiler
+==================
+*/
+static void Sys_ProfileSigHandler( int signum, siginfo_t *info, void *context )
+{
+	void *frames[ SYS_PROFILE_MAX_FRAMES ];
+	void *pc = NULL;
+	void *sp = NULL;
+	int  numFrames = 0;
+	int  first = 0;
+	int  savedErrno = errno;
+
+	// the timer counts the CPU time of all threads, but the signal
+	// can only tell where the VMs are on the thread that runs them
+	if ( Sys_ProfileThreadId() != profileThread )
+	{
+		return;
+	}
+
+#if defined(__linux__) && defined(__x86_64__)
+	pc = ( void * ) ( ( ucontext_t * ) context )->uc_mcontext.gregs[ REG_RIP ];
+	sp = ( void * ) ( ( ucontext_t * ) context )->uc_mcontext.gregs[ REG_RSP ];
+#elif defined(__linux__) && defined(__i386__)
+	pc = ( void * ) ( ( ucontext_t * ) context )->uc_mcontext.gregs[ REG_EIP ];
+	sp = ( void * ) ( ( ucontext_t * ) context )->uc_mcontext.gregs[ REG_ESP ];
+#elif defined(MACOS_X) && defined(__x86_64__)
+	pc = ( void * ) ( ( ucontext_t * ) context )->uc_mcontext->__ss.__rip;
+	sp = ( void * ) ( ( ucontext_t * ) context )->uc_mcontext->__ss.__rsp;
+#elif defined(MACOS_X) && defined(__i386__)
+	pc = ( void * ) ( ( ucontext_t * ) context )->uc_mcontext->__ss.__eip;
+	sp = ( void * ) ( ( ucontext_t * ) context )->uc_mcontext->__ss.__esp;
+#endif
+
+#ifdef __GLIBC__
+	numFrames = backtrace( frames, ARRAY_LEN( frames ) );
+
+	for ( first = 0; first < numFrames && frames[ first ] != pc; first++ )
+	{
+	}
+
+	if ( first == numFrames )
+	{
+		// couldn't find the interrupted frame; assume handler + trampoline
+		first = numFrames < 2 ? numFrames : 2;
+	}
+#endif
+
+	if ( profileCallback )
+	{
+		profileCallback( pc, sp, frames + first, numFrames - first );
+	}
+
+	errno = savedErrno;
+}
+
+/*
+==================
+Sys_StartProfileTimer
+
+Calls the callback about hz times per second of consumed CPU time,
+when the calling thread is the one running
+==================
+*/
+qboolean Sys_StartProfileTimer( int hz, sysProfileCallback_t callback )
+{
+	struct sigaction action;
+	struct itimerval timer;
+
+	if ( hz <= 0 || !callback )
+	{
+		return qfalse;
+	}
+
+#ifdef __GLIBC__
+	{
+		// the first backtrace() may load libgcc, which isn't safe in a signal handler
+		void *dummy[ 1 ];
+		backtrace( dummy, 1 );
+	}
+#endif
+
+	profileCallback = callback;
+	profileThread = Sys_ProfileThreadId();
+
+	memset( &action, 0, sizeof( action ) );
+	action.sa_sigaction = Sys_ProfileSigHandler;
+	action.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset( &action.sa_mask );
+
+	if ( sigaction( SIGPROF, &action, NULL ) )
+	{
+		profileCallback = NULL;
+		return qfalse;
+	}
+
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = hz >= 1000000 ? 1 : 1000000 / hz;
+	timer.it_value = timer.it_interval;
+
+	if ( setitimer( ITIMER_PROF, &timer, NULL ) )
+	{
+		signal( SIGPROF, SIG_IGN );
+		profileCallback = NULL;
+		return qfalse;
+	}
+
+	return qtrue;
+}
+
+/*
+==================
+Sys_StopProfileTimer
+==================
+*/
+void Sys_StopProfileTimer( void )
+{
+	struct itimerval timer;
+
+	memset( &timer, 0, sizeof( timer ) );
+	setitimer( ITIMER_PROF, &timer, NULL );
+	signal( SIGPROF, SIG_IGN );
+	profileCallback = NULL;
+}
+
+/*
+==================
+Sys_AddressInfo
+
+Finds the loaded module containing an address and the closest exported symbol
+==================
+*/
+qboolean Sys_AddressInfo( void *address, void **moduleBase, char *symbol, int symbolSize )
+{
+	Dl_info info;
+
+	if ( !dladdr( address, &info ) || !info.dli_fbase )
+	{
+		return qfalse;
+	}
+
+	if ( moduleBase )
+	{
+		*moduleBase = info.dli_fbase;
+	}
+
+	if ( symbol )
+	{
+		if ( info.dli_sname )
+		{
+			Q_strncpyz( symbol, info.dli_sname, symbolSize );
+		}
+		else
+		{
+			const char *module = info.dli_fname ? strrchr( info.dli_fname, '/' ) : NULL;
+
+			Com_sprintf( symbol, symbolSize, "%s+0x%lx", module ? module + 1 : "?",
+			             ( unsigned long ) ( ( byte * ) address - ( byte * ) info.dli_fbase ) );
+		}
+	}
+
+	return qtrue;
+}
+
 /*
 ==================
 Sys_Basename
@@ -256,6 +256,214 @@ qboolean Sys_LowPhysicalMemory( void )
 	return ( stat.dwTotalPhys <= MEM_THRESHOLD ) ? qtrue : qfalse;
 }
 
+static sysProfileCallback_t profileCallback;
+static HANDLE               profileThread; // the thread being sampled
+static HANDLE               profileTimer; // the thread sampling it
+static volatile LONG        profileStop;
+static int                  profileMsec;
+static ULONG_PTR            profileStackBase; // of profileThread
+
+/*
+==================
+Sys_ProfileBacktrace
+
+Unwinds the suspended thread, without reading outside of its stack
+==================
+*/
+static int Sys_ProfileBacktrace( const CONTEXT *context, void **frames, int maxFrames )
+{
+	int numFrames = 0;
+#ifdef _WIN64
+	CONTEXT           unwind = *context;
+	PRUNTIME_FUNCTION function;
+	DWORD64           imageBase, establisherFrame;
+	PVOID             handlerData;
+
+	while ( numFrames < maxFrames && unwind.Rip )
+	{
+		frames[ numFrames++ ] = ( void * ) unwind.Rip;
+
+		function = RtlLookupFunctionEntry( unwind.Rip, &imageBase, NULL );
+
+		if ( function )
+		{
+			RtlVirtualUnwind( UNW_FLAG_NHANDLER, imageBase, unwind.Rip, function, &unwind, &handlerData, &establisherFrame, NULL );
+		}
+		else
+		{
+			// leaf functions and generated code, the return address is on top of the stack
+			if ( unwind.Rsp < context->Rsp || unwind.Rsp + sizeof( DWORD64 ) > profileStackBase )
+			{
+				break;
+			}
+
+			unwind.Rip = * ( DWORD64 * ) unwind.Rsp;
+			unwind.Rsp += sizeof( DWORD64 );
+		}
+
+		if ( unwind.Rsp < context->Rsp || unwind.Rsp >= profileStackBase )
+		{
+			break;
+		}
+	}
+#else
+	DWORD frame = context->Ebp;
+
+	frames[ numFrames++ ] = ( void * ) context->Eip;
+
+	// follow the frame pointers, they only get older towards the stack base
+	while ( numFrames < maxFrames && !( frame & 3 ) && frame >= context->Esp && frame + 8 <= profileStackBase )
+	{
+		frames[ numFrames++ ] = * ( void ** )( frame + 4 );
+
+		if ( * ( DWORD * ) frame <= frame )
+		{
+			break;
+		}
+
+		frame = * ( DWORD * ) frame;
+	}
+#endif
+
+	return numFrames;
+}
+
+/*
+==================
+Sys_ProfileThread
+
+Suspends the sampled thread about every profileMsec and hands its
+context to the profiler. Unlike ITIMER_PROF this counts wall clock
+time, the time spent waiting only shows up outside of the VMs.
+==================
+*/
+static DWORD WINAPI Sys_ProfileThread( LPVOID param )
+{
+	CONTEXT context;
+	void    *frames[ SYS_PROFILE_MAX_FRAMES ];
+	int     numFrames;
+
+	while ( !profileStop )
+	{
+		Sleep( profileMsec );
+
+		if ( SuspendThread( profileThread ) == ( DWORD ) -1 )
+		{
+			break;
+		}
+
+		// GetThreadContext also waits for the suspension to take effect
+		memset( &context, 0, sizeof( context ) );
+		context.ContextFlags = CONTEXT_FULL;
+
+		if ( GetThreadContext( profileThread, &context ) )
+		{
+			numFrames = Sys_ProfileBacktrace( &context, frames, ARRAY_LEN( frames ) );
+#ifdef _WIN64
+			profileCallback( ( void * ) context.Rip, ( void * ) context.Rsp, frames, numFrames );
+#else
+			profileCallback( ( void * ) context.Eip, ( void * ) context.Esp, frames, numFrames );
+#endif
+		}
+
+		ResumeThread( profileThread );
+	}
+
+	return 0;
+}
+
+/*
+==================
+Sys_StartProfileTimer
+
+There is no SIGPROF, so a timer thread samples the calling thread
+==================
+*/
+qboolean Sys_StartProfileTimer( int hz, sysProfileCallback_t callback )
+{
+	if ( hz <= 0 || !callback || profileTimer )
+	{
+		return qfalse;
+	}
+
+	if ( !DuplicateHandle( GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &profileThread,
+	                       THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT, FALSE, 0 ) )
+	{
+		profileThread = NULL;
+		return qfalse;
+	}
+
+	profileCallback = callback;
+	profileStackBase = ( ULONG_PTR ) ( ( NT_TIB * ) NtCurrentTeb() )->StackBase;
+	profileMsec = hz >= 1000 ? 1 : 1000 / hz;
+	profileStop = 0;
+
+	profileTimer = CreateThread( NULL, 0, Sys_ProfileThread, NULL, 0, NULL );
+
+	if ( !profileTimer )
+	{
+		CloseHandle( profileThread );
+		profileThread = NULL;
+		profileCallback = NULL;
+		return qfalse;
+	}
+
+	// wake up on time even while the engine keeps the CPU busy
+	SetThreadPriority( profileTimer, THREAD_PRIORITY_TIME_CRITICAL );
+
+	return qtrue;
+}
+
+/*
+==================
+Sys_StopProfileTimer
+==================
+*/
+void Sys_StopProfileTimer( void )
+{
+	if ( !profileTimer )
+	{
+		return;
+	}
+
+	InterlockedExchange( &profileStop, 1 );
+	WaitForSingleObject( profileTimer, INFINITE );
+
+	CloseHandle( profileTimer );
+	CloseHandle( profileThread );
+	profileTimer = NULL;
+	profileThread = NULL;
+	profileCallback = NULL;
+}
+
+/*
+==================
+Sys_AddressInfo
+==================
+*/
+qboolean Sys_AddressInfo( void *address, void **moduleBase, char *symbol, int symbolSize )
+{
+	HMODULE module;
+
+	if ( !GetModuleHandleEx( GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+	                         ( LPCTSTR ) address, &module ) )
+	{
+		return qfalse;
+	}
+
+	if ( moduleBase )
+	{
+		*moduleBase = module;
+	}
+
+	if ( symbol )
+	{
+		Com_sprintf( symbol, symbolSize, "0x%lx", ( unsigned long ) ( ( byte * ) address - ( byte * ) module ) );
+	}
+
+	return qtrue;
+}
+
 /*
 ==============
 Sys_Basename
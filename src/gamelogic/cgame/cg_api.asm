@@ -188,3 +188,5 @@ equ trap_SetColorGrading                  -425
 equ trap_CM_DistanceToModel               -426
 equ trap_R_ScissorEnable                  -427
 equ trap_R_ScissorSet                     -428
+equ trap_Parse_ReadTokens                 -429
+equ trap_R_DrawStretchPics                -430
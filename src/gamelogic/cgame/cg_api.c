@@ -677,6 +677,12 @@ void trap_R_DrawStretchPic( float x, float y, float w, float h, float s1, float
 	syscall( CG_R_DRAWSTRETCHPIC, PASSFLOAT( x ), PASSFLOAT( y ), PASSFLOAT( w ), PASSFLOAT( h ), PASSFLOAT( s1 ), PASSFLOAT( t1 ), PASSFLOAT( s2 ), PASSFLOAT( t2 ), hShader );
 }
 
+//SCR_DrawStretchPics(VMA(1), args[2], args[3]);
+void trap_R_DrawStretchPics( const stretchPic_t *pics, int numPics, qhandle_t hShader )
+{
+	syscall( CG_R_DRAWSTRETCHPICS, pics, numPics, hShader );
+}
+
 //86.
 //re.DrawRotatedPic(VMF(1), VMF(2), VMF(3), VMF(4), VMF(5), VMF(6), VMF(7), VMF(8), args[9], VMF(10));
 void trap_R_DrawRotatedPic( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader, float angle )
@@ -1025,6 +1031,12 @@ int trap_Parse_ReadToken( int handle, pc_token_t *pc_token )
 	return syscall( CG_PARSE_READ_TOKEN, handle, pc_token );
 }
 
+//return Parse_ReadTokensHandle(args[1], VMA(2), args[3]);
+int trap_Parse_ReadTokens( int handle, pc_token_t *pc_tokens, int maxTokens )
+{
+	return syscall( CG_PARSE_READ_TOKENS, handle, pc_tokens, maxTokens );
+}
+
 //147.
 //return Parse_SourceFileAndLine(args[1], VMA(2), VMA(3));
 int trap_Parse_SourceFileAndLine( int handle, char *filename, int *line )
@@ -1136,7 +1136,7 @@ void CG_BuildableStatusParse( const char *filename, buildStat_t *bs )
 	float      f;
 	vec4_t     c;
 
-	handle = trap_Parse_LoadSource( filename );
+	handle = PC_LoadSource( filename );
 
 	if ( !handle )
 	{
@@ -1145,7 +1145,7 @@ void CG_BuildableStatusParse( const char *filename, buildStat_t *bs )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			break;
 		}
@@ -1321,13 +1321,13 @@ void CG_BuildableStatusParse( const char *filename, buildStat_t *bs )
 			Com_Printf( "CG_BuildableStatusParse: unknown token %s in %s\n",
 			            token.string, filename );
 			bs->loaded = qfalse;
-			trap_Parse_FreeSource( handle );
+			PC_FreeSource( handle );
 			return;
 		}
 	}
 
 	bs->loaded = qtrue;
-	trap_Parse_FreeSource( handle );
+	PC_FreeSource( handle );
 }
 
 #define STATUS_FADE_TIME     200
@@ -1826,7 +1826,7 @@ qboolean CG_Asset_Parse( int handle )
 	const char *tempStr;
 	const char *fallbackFont = "fonts/unifont.ttf";
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -1838,7 +1838,7 @@ qboolean CG_Asset_Parse( int handle )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			return qfalse;
 		}
@@ -2043,11 +2043,11 @@ void CG_ParseMenu( const char *menuFile )
 	pc_token_t token;
 	int        handle;
 
-	handle = trap_Parse_LoadSource( menuFile );
+	handle = PC_LoadSource( menuFile );
 
 	if ( !handle )
 	{
-		handle = trap_Parse_LoadSource( "ui/testhud.menu" );
+		handle = PC_LoadSource( "ui/testhud.menu" );
 	}
 
 	if ( !handle )
@@ -2057,7 +2057,7 @@ void CG_ParseMenu( const char *menuFile )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			break;
 		}
@@ -2096,7 +2096,7 @@ void CG_ParseMenu( const char *menuFile )
 		}
 	}
 
-	trap_Parse_FreeSource( handle );
+	PC_FreeSource( handle );
 }
 
 qboolean CG_Load_Menu( char **p )
@@ -2519,6 +2519,7 @@ void CG_LoadHudMenu( void )
 	cgDC.drawHandlePic = &CG_DrawPic;
 	cgDC.drawNoStretchPic = &CG_DrawNoStretchPic;
 	cgDC.drawStretchPic = &trap_R_DrawStretchPic;
+	cgDC.drawStretchPics = &trap_R_DrawStretchPics;
 	cgDC.registerModel = &trap_R_RegisterModel;
 	cgDC.modelBounds = &trap_R_ModelBounds;
 	cgDC.fillRect = &CG_FillRect;
@@ -2618,6 +2619,8 @@ void CG_AssetCache( void )
 		cgDC.Assets.emoticons[ i ].shader = trap_R_RegisterShader(va("emoticons/%s_%dx1.tga", cgDC.Assets.emoticons[i].name, cgDC.Assets.emoticons[i].width),
 									  RSF_NOMIP);
 	}
+
+	UI_Text_ClearCache();
 }
 
 /*
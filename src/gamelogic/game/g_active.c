@@ -1331,12 +1331,17 @@ void G_UnlaggedCalc( int time, gentity_t *rewindEnt )
  G_UnlaggedOff
 
  Reverses the changes made to all active clients by G_UnlaggedOn()
+
+ Clients are only relinked if something linked them while they were
+ rewound, otherwise the engine still has them at their real position.
 ==============
 */
 void G_UnlaggedOff( void )
 {
-	int       i = 0;
-	gentity_t *ent;
+	int          i = 0;
+	gentity_t    *ent;
+	batchQuery_t links[ MAX_CLIENTS ];
+	int          numLinks = 0;
 
 	if ( !g_unlagged.integer )
 	{
@@ -1356,7 +1361,20 @@ void G_UnlaggedOff( void )
 		VectorCopy( ent->client->unlaggedBackup.maxs, ent->r.maxs );
 		VectorCopy( ent->client->unlaggedBackup.origin, ent->r.currentOrigin );
 		ent->client->unlaggedBackup.used = qfalse;
-		trap_LinkEntity( ent );
+
+		if ( ent->r.linkcount == ent->client->unlaggedLinkcount )
+		{
+			continue;
+		}
+
+		links[ numLinks ].type = BATCH_LINKENTITY;
+		links[ numLinks ].entityNum = i;
+		numLinks++;
+	}
+
+	if ( numLinks )
+	{
+		trap_Batch( links, NULL, numLinks );
 	}
 }
 
@@ -1369,8 +1387,11 @@ void G_UnlaggedOff( void )
  the clients' position data
 
  As an optimization, all clients that have an unlagged position that is
- not touchable at "range" from "muzzle" will be ignored.  This is required
- to prevent a huge amount of trap_LinkEntity() calls per user cmd.
+ not touchable at "range" from "muzzle" will be ignored.
+
+ The rewound clients are not relinked: the engine keeps colliding with their
+ real position, so traces made while unlagged is on must go through
+ G_UnlaggedTrace(), which tests the rewound boxes itself.
 ==============
 */
 
@@ -1432,13 +1453,459 @@ void G_UnlaggedOn( gentity_t *attacker, vec3_t muzzle, float range )
 		VectorCopy( ent->r.maxs, ent->client->unlaggedBackup.maxs );
 		VectorCopy( ent->r.currentOrigin, ent->client->unlaggedBackup.origin );
 		ent->client->unlaggedBackup.used = qtrue;
+		ent->client->unlaggedLinkcount = ent->r.linkcount;
 
 		// move the client to the calculated unlagged position
 		VectorCopy( calc->mins, ent->r.mins );
 		VectorCopy( calc->maxs, ent->r.maxs );
 		VectorCopy( calc->origin, ent->r.currentOrigin );
+	}
+}
+
+// must match SURFACE_CLIP_EPSILON in cm_local.h
+#define UNLAGGED_CLIP_EPSILON ( 0.125 )
+
+/*
+==============
+ G_UnlaggedClipBox
+
+ Sweeps a box against the rewound hitbox of a single client.  This is the
+ axial box case of CM_TransformedBoxTrace()/CM_TraceThroughBrush() done in
+ the game, so the result is the same as tracing against the client after
+ relinking it at the rewound position.
+==============
+*/
+static void G_UnlaggedClipBox( trace_t *tr, const vec3_t start, const vec3_t mins,
+                               const vec3_t maxs, const vec3_t end, gentity_t *ent )
+{
+	vec3_t   size[ 2 ];
+	vec3_t   s, e;
+	vec3_t   bounds[ 2 ];
+	float    offset, dist, d1, d2, f;
+	float    enterFrac, leaveFrac;
+	int      clipSide;
+	qboolean startout, getout;
+	int      i, axis;
+
+	memset( tr, 0, sizeof( *tr ) );
+	tr->fraction = 1.0f;
+
+	// make the box symmetric and move the trace into the space of the hitbox
+	for ( i = 0; i < 3; i++ )
+	{
+		offset = ( mins[ i ] + maxs[ i ] ) * 0.5f;
+		size[ 0 ][ i ] = mins[ i ] - offset;
+		size[ 1 ][ i ] = maxs[ i ] - offset;
+		s[ i ] = start[ i ] + offset;
+		e[ i ] = end[ i ] + offset;
+	}
+
+	VectorSubtract( s, ent->r.currentOrigin, s );
+	VectorSubtract( e, ent->r.currentOrigin, e );
+
+	for ( i = 0; i < 3; i++ )
+	{
+		if ( s[ i ] < e[ i ] )
+		{
+			bounds[ 0 ][ i ] = s[ i ] + size[ 0 ][ i ];
+			bounds[ 1 ][ i ] = e[ i ] + size[ 1 ][ i ];
+		}
+		else
+		{
+			bounds[ 0 ][ i ] = e[ i ] + size[ 0 ][ i ];
+			bounds[ 1 ][ i ] = s[ i ] + size[ 1 ][ i ];
+		}
+	}
+
+	// position test
+	if ( VectorCompare( s, e ) )
+	{
+		for ( i = 0; i < 3; i++ )
+		{
+			if ( bounds[ 0 ][ i ] > ent->r.maxs[ i ] || bounds[ 1 ][ i ] < ent->r.mins[ i ] )
+			{
+				return;
+			}
+		}
+
+		tr->startsolid = tr->allsolid = qtrue;
+		tr->fraction = 0.0f;
+		tr->contents = CONTENTS_BODY;
+		VectorCopy( start, tr->endpos );
+		return;
+	}
+
+	for ( i = 0; i < 3; i++ )
+	{
+		if ( bounds[ 1 ][ i ] < ent->r.mins[ i ] - UNLAGGED_CLIP_EPSILON ||
+		     bounds[ 0 ][ i ] > ent->r.maxs[ i ] + UNLAGGED_CLIP_EPSILON )
+		{
+			VectorCopy( end, tr->endpos );
+			return;
+		}
+	}
+
+	enterFrac = -1.0f;
+	leaveFrac = 1.0f;
+	clipSide = -1;
+	startout = getout = qfalse;
+
+	// the sides are in the same order as the engine's box brush:
+	// +x, -x, +y, -y, +z, -z, expanded by the symmetric trace box
+	for ( i = 0; i < 6; i++ )
+	{
+		axis = i >> 1;
+
+		if ( i & 1 )
+		{
+			dist = -ent->r.mins[ axis ] + size[ 1 ][ axis ];
+			d1 = -s[ axis ] - dist;
+			d2 = -e[ axis ] - dist;
+		}
+		else
+		{
+			dist = ent->r.maxs[ axis ] - size[ 0 ][ axis ];
+			d1 = s[ axis ] - dist;
+			d2 = e[ axis ] - dist;
+		}
+
+		if ( d2 > 0 )
+		{
+			getout = qtrue; // endpoint is not in solid
+		}
+
+		if ( d1 > 0 )
+		{
+			startout = qtrue;
+		}
+
+		// if completely in front of face, no intersection with the entire box
+		if ( d1 > 0 && ( d2 >= UNLAGGED_CLIP_EPSILON || d2 >= d1 ) )
+		{
+			VectorCopy( end, tr->endpos );
+			return;
+		}
+
+		// if it doesn't cross the plane, the plane isn't relevant
+		if ( d1 <= 0 && d2 <= 0 )
+		{
+			continue;
+		}
+
+		if ( d1 > d2 )
+		{
+			// enter
+			f = ( d1 - UNLAGGED_CLIP_EPSILON ) / ( d1 - d2 );
+
+			if ( f < 0 )
+			{
+				f = 0;
+			}
+
+			if ( f > enterFrac )
+			{
+				enterFrac = f;
+				clipSide = i;
+			}
+		}
+		else
+		{
+			// leave
+			f = ( d1 + UNLAGGED_CLIP_EPSILON ) / ( d1 - d2 );
+
+			if ( f > 1 )
+			{
+				f = 1;
+			}
+
+			if ( f < leaveFrac )
+			{
+				leaveFrac = f;
+			}
+		}
+	}
+
+	if ( !startout )
+	{
+		// original point was inside the box
+		tr->startsolid = qtrue;
+
+		if ( !getout )
+		{
+			tr->allsolid = qtrue;
+			tr->fraction = 0.0f;
+			tr->contents = CONTENTS_BODY;
+		}
+	}
+	else if ( enterFrac < leaveFrac && enterFrac > -1 && clipSide >= 0 )
+	{
+		if ( enterFrac < 0 )
+		{
+			enterFrac = 0;
+		}
+
+		axis = clipSide >> 1;
+		tr->fraction = enterFrac;
+		tr->plane.normal[ axis ] = ( clipSide & 1 ) ? -1.0f : 1.0f;
+		tr->plane.dist = ( clipSide & 1 ) ? -ent->r.mins[ axis ] : ent->r.maxs[ axis ];
+		tr->plane.type = ( clipSide & 1 ) ? 3 + axis : axis;
+		tr->plane.signbits = ( clipSide & 1 ) ? 1 << axis : 0;
+		tr->contents = CONTENTS_BODY;
+	}
+
+	tr->endpos[ 0 ] = start[ 0 ] + tr->fraction * ( end[ 0 ] - start[ 0 ] );
+	tr->endpos[ 1 ] = start[ 1 ] + tr->fraction * ( end[ 1 ] - start[ 1 ] );
+	tr->endpos[ 2 ] = start[ 2 ] + tr->fraction * ( end[ 2 ] - start[ 2 ] );
+}
+
+/*
+==============
+ G_UnlaggedReferenceTrace
+
+ The old way of tracing against rewound clients: relink them, trace, and
+ relink them back.  Only used by g_unlaggedVerify.
+==============
+*/
+static void G_UnlaggedReferenceTrace( trace_t *tr, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+                                      const vec3_t end, int passEntityNum, int contentmask )
+{
+	int          i;
+	gentity_t    *ent;
+	gclient_t    *client;
+	batchQuery_t links[ MAX_CLIENTS ];
+	int          numLinks = 0;
+
+	for ( i = 0; i < level.maxclients; i++ )
+	{
+		if ( g_entities[ i ].client->unlaggedBackup.used )
+		{
+			links[ numLinks ].type = BATCH_LINKENTITY;
+			links[ numLinks ].entityNum = i;
+			numLinks++;
+		}
+	}
+
+	trap_Batch( links, NULL, numLinks );
+	trap_Trace( tr, start, mins, maxs, end, passEntityNum, contentmask );
+
+	for ( i = 0; i < numLinks; i++ )
+	{
+		ent = &g_entities[ links[ i ].entityNum ];
+		client = ent->client;
+
+		VectorCopy( client->unlaggedBackup.mins, ent->r.mins );
+		VectorCopy( client->unlaggedBackup.maxs, ent->r.maxs );
+		VectorCopy( client->unlaggedBackup.origin, ent->r.currentOrigin );
 		trap_LinkEntity( ent );
+
+		VectorCopy( client->unlaggedCalc.mins, ent->r.mins );
+		VectorCopy( client->unlaggedCalc.maxs, ent->r.maxs );
+		VectorCopy( client->unlaggedCalc.origin, ent->r.currentOrigin );
+		client->unlaggedLinkcount = ent->r.linkcount;
+	}
+}
+
+/*
+==============
+ G_UnlaggedTrace
+
+ trap_Trace() for use between G_UnlaggedOn() and G_UnlaggedOff().  The
+ rewound clients are hidden from the engine trace by clearing their
+ contents, and their historical hitboxes are then clipped here, applying
+ the same entity skipping rules as SV_ClipMoveToEntities().
+==============
+*/
+void G_UnlaggedTrace( trace_t *tr, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+                      const vec3_t end, int passEntityNum, int contentmask )
+{
+	int       i;
+	int       contents[ MAX_CLIENTS ];
+	int       passOwnerNum = -1;
+	gentity_t *ent;
+	trace_t   trace;
+	trace_t   reference;
+	qboolean  oldStart;
+
+	if ( !g_unlagged.integer )
+	{
+		trap_Trace( tr, start, mins, maxs, end, passEntityNum, contentmask );
+		return;
+	}
+
+	if ( !mins )
+	{
+		mins = vec3_origin;
+	}
+
+	if ( !maxs )
+	{
+		maxs = vec3_origin;
+	}
+
+	if ( g_unlaggedVerify.integer )
+	{
+		G_UnlaggedReferenceTrace( &reference, start, mins, maxs, end, passEntityNum, contentmask );
 	}
+
+	for ( i = 0; i < level.maxclients; i++ )
+	{
+		ent = &g_entities[ i ];
+		contents[ i ] = ent->r.contents;
+
+		if ( ent->client->unlaggedBackup.used )
+		{
+			ent->r.contents = 0;
+		}
+	}
+
+	trap_Trace( tr, start, mins, maxs, end, passEntityNum, contentmask );
+
+	for ( i = 0; i < level.maxclients; i++ )
+	{
+		g_entities[ i ].r.contents = contents[ i ];
+	}
+
+	// blocked immediately by the world, or stuck in something
+	if ( ( tr->fraction == 0.0f && tr->entityNum == ENTITYNUM_WORLD ) || tr->allsolid )
+	{
+		return;
+	}
+
+	if ( passEntityNum != ENTITYNUM_NONE )
+	{
+		passOwnerNum = g_entities[ passEntityNum ].r.ownerNum;
+
+		if ( passOwnerNum == ENTITYNUM_NONE )
+		{
+			passOwnerNum = -1;
+		}
+	}
+
+	for ( i = 0; i < level.maxclients; i++ )
+	{
+		ent = &g_entities[ i ];
+
+		if ( !ent->client->unlaggedBackup.used )
+		{
+			continue;
+		}
+
+		if ( passEntityNum != ENTITYNUM_NONE )
+		{
+			if ( i == passEntityNum || ent->r.ownerNum == passEntityNum ||
+			     ent->r.ownerNum == passOwnerNum )
+			{
+				continue;
+			}
+		}
+
+		if ( !( contentmask & ent->r.contents ) || !( contentmask & CONTENTS_BODY ) )
+		{
+			continue;
+		}
+
+		G_UnlaggedClipBox( &trace, start, mins, maxs, end, ent );
+
+		if ( trace.allsolid )
+		{
+			tr->allsolid = qtrue;
+			trace.entityNum = i;
+		}
+		else if ( trace.startsolid )
+		{
+			tr->startsolid = qtrue;
+			trace.entityNum = i;
+		}
+
+		if ( trace.fraction < tr->fraction )
+		{
+			// make sure we keep a startsolid from a previous trace
+			oldStart = tr->startsolid;
+
+			trace.entityNum = i;
+			*tr = trace;
+			tr->startsolid |= oldStart;
+		}
+
+		if ( tr->allsolid )
+		{
+			break;
+		}
+	}
+
+	if ( g_unlaggedVerify.integer &&
+	     ( reference.entityNum != tr->entityNum ||
+	       fabs( reference.fraction - tr->fraction ) > 0.001f ||
+	       reference.startsolid != tr->startsolid ||
+	       reference.allsolid != tr->allsolid ) )
+	{
+		G_Printf( "G_UnlaggedTrace: mismatch: entity %d/%d fraction %f/%f "
+		          "startsolid %d/%d allsolid %d/%d\n",
+		          reference.entityNum, tr->entityNum,
+		          reference.fraction, tr->fraction,
+		          reference.startsolid, tr->startsolid,
+		          reference.allsolid, tr->allsolid );
+	}
+}
+
+/*
+==============
+ G_UnlaggedEntitiesInBox
+
+ trap_EntitiesInBox() for use between G_UnlaggedOn() and G_UnlaggedOff(),
+ reporting rewound clients at their historical position.
+==============
+*/
+int G_UnlaggedEntitiesInBox( const vec3_t mins, const vec3_t maxs, int *entityList, int maxcount )
+{
+	int       i, j, num, count;
+	gentity_t *ent;
+
+	num = trap_EntitiesInBox( mins, maxs, entityList, maxcount );
+
+	if ( !g_unlagged.integer )
+	{
+		return num;
+	}
+
+	// drop the rewound clients, they were found at their real position
+	for ( i = count = 0; i < num; i++ )
+	{
+		if ( entityList[ i ] < MAX_CLIENTS &&
+		     g_entities[ entityList[ i ] ].client->unlaggedBackup.used )
+		{
+			continue;
+		}
+
+		entityList[ count++ ] = entityList[ i ];
+	}
+
+	for ( i = 0; i < level.maxclients && count < maxcount; i++ )
+	{
+		ent = &g_entities[ i ];
+
+		if ( !ent->client->unlaggedBackup.used )
+		{
+			continue;
+		}
+
+		// same slop as the absolute bounds set by SV_LinkEntity()
+		for ( j = 0; j < 3; j++ )
+		{
+			if ( ent->r.currentOrigin[ j ] + ent->r.mins[ j ] - 1 > maxs[ j ] ||
+			     ent->r.currentOrigin[ j ] + ent->r.maxs[ j ] + 1 < mins[ j ] )
+			{
+				break;
+			}
+		}
+
+		if ( j == 3 )
+		{
+			entityList[ count++ ] = i;
+		}
+	}
+
+	return count;
 }
 
 /*
@@ -1498,8 +1965,8 @@ static void G_UnlaggedDetectCollisions( gentity_t *ent )
 
 	G_UnlaggedOn( ent, ent->client->oldOrigin, range );
 
-	trap_Trace( &tr, ent->client->oldOrigin, ent->r.mins, ent->r.maxs,
-	            ent->client->ps.origin, ent->s.number,  MASK_PLAYERSOLID );
+	G_UnlaggedTrace( &tr, ent->client->oldOrigin, ent->r.mins, ent->r.maxs,
+	                 ent->client->ps.origin, ent->s.number,  MASK_PLAYERSOLID );
 
 	if ( tr.entityNum >= 0 && tr.entityNum < MAX_CLIENTS )
 	{
@@ -88,3 +88,5 @@ equ trap_QuoteString                      -322
 equ trap_GenFingerprint                   -323
 equ trap_GetPlayerPubkey                  -324
 equ trap_GetTimeString                    -325
+equ trap_Batch                            -326
+equ trap_FindConfigstring                 -327
@@ -577,3 +577,15 @@ void trap_GetTimeString( char *buffer, int size, const char *format, const qtime
 {
 	syscall( G_GETTIMESTRING, buffer, size, format, tm );
 }
+
+// runs an array of traces, point contents and entity (un)links in one call
+int trap_Batch( const batchQuery_t *queries, batchResult_t *results, int count )
+{
+	return syscall( G_BATCH, queries, results, count );
+}
+
+// looks up a configstring by value, optionally storing it in the first free slot
+int trap_FindConfigstring( const char *name, int start, int max, qboolean create )
+{
+	return syscall( G_FIND_CONFIGSTRING, name, start, max, create );
+}
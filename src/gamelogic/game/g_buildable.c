@@ -4119,7 +4119,7 @@ static gentity_t *G_Build( gentity_t *builder, buildable_t buildable,
 	built->r.svFlags = SVF_CLIENTS_IN_RANGE;
 	built->r.clientRadius = MAX( HELMET_RANGE, ALIENSENSE_RANGE );
 	built->killedBy = ENTITYNUM_NONE;
-	built->classname = BG_Buildable( buildable )->entityName;
+	G_SetClassname( built, BG_Buildable( buildable )->entityName );
 	built->s.modelindex = buildable;
 	built->buildableTeam = built->s.modelindex2 = BG_Buildable( buildable )->team;
 	BG_BuildableBoundingBox( buildable, built->r.mins, built->r.maxs );
@@ -439,11 +439,11 @@ static void SpawnCorpse( gentity_t *ent )
 
 	if ( ent->client->ps.stats[ STAT_TEAM ] == TEAM_HUMANS )
 	{
-		body->classname = "humanCorpse";
+		G_SetClassname( body, "humanCorpse" );
 	}
 	else
 	{
-		body->classname = "alienCorpse";
+		G_SetClassname( body, "alienCorpse" );
 	}
 
 	body->s.misc = MAX_CLIENTS;
@@ -1600,7 +1600,7 @@ void ClientSpawn( gentity_t *ent, gentity_t *spawn, const vec3_t origin, const v
 	ent->s.groundEntityNum = ENTITYNUM_NONE;
 	ent->client = &level.clients[ index ];
 	ent->takedamage = teamLocal != TEAM_NONE && client->sess.spectatorState == SPECTATOR_NOT; //qtrue;
-	ent->classname = S_PLAYER_CLASSNAME;
+	G_SetClassname( ent, S_PLAYER_CLASSNAME );
 	if ( client->noclip )
 	{
 		client->cliprcontents = CONTENTS_BODY;
@@ -1863,7 +1863,7 @@ void ClientDisconnect( int clientNum )
 
 	trap_UnlinkEntity( ent );
 	ent->inuse = qfalse;
-	ent->classname = "disconnected";
+	G_SetClassname( ent, "disconnected" );
 	ent->client->pers.connected = CON_DISCONNECTED;
 	ent->client->sess.spectatorState =
 	  ent->client->ps.persistant[ PERS_SPECSTATE ] = SPECTATOR_NOT;
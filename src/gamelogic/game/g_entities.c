@@ -38,42 +38,405 @@ Maryland 20850 USA.
 /*
 =================================================================================
 
+gentity classname and name index
+
+Every classname and name in use is interned to a key, and each key holds a
+bitset of the entities carrying it, so searching by class or name only has to
+visit the matching entities, still in ascending entity order.
+If the key table runs full, searches fall back to scanning all entities.
+
+=================================================================================
+*/
+
+#define MAX_ENTITY_KEYS      1024
+#define ENTITY_KEY_HASH_SIZE ( MAX_ENTITY_KEYS * 2 )
+#define ENTITY_KEY_POOL_SIZE 32768
+#define ENTITY_KEY_OVERFLOW  -1
+#define ENTITY_BITSET_WORDS  ( MAX_GENTITIES / 32 )
+
+typedef struct
+{
+	const char   *string;
+	unsigned int classBits[ ENTITY_BITSET_WORDS ];
+	unsigned int nameBits[ ENTITY_BITSET_WORDS ];
+} entityKey_t;
+
+static entityKey_t  entityKeys[ MAX_ENTITY_KEYS ]; // key 0 is "none"
+static int          numEntityKeys;
+static int          entityKeyHash[ ENTITY_KEY_HASH_SIZE ];
+static char         entityKeyPool[ ENTITY_KEY_POOL_SIZE ];
+static int          entityKeyPoolUsed;
+static qboolean     entityKeysOverflowed;
+static unsigned int noEntityBits[ ENTITY_BITSET_WORDS ];
+
+/*
+=================
+G_ResetEntityIndex
+
+Forgets all keys, has to be called whenever g_entities gets cleared
+=================
+*/
+void G_ResetEntityIndex( void )
+{
+	memset( entityKeys, 0, sizeof( entityKeys ) );
+	memset( entityKeyHash, 0, sizeof( entityKeyHash ) );
+	numEntityKeys = 0;
+	entityKeyPoolUsed = 0;
+	entityKeysOverflowed = qfalse;
+}
+
+/*
+=================
+G_FindEntityKey
+
+Returns the key of a classname or name (case insensitive), 0 if it isn't known
+and can't or shouldn't be created, or ENTITY_KEY_OVERFLOW if the table is full
+=================
+*/
+static int G_FindEntityKey( const char *string, qboolean create )
+{
+	unsigned int hash;
+	const char   *s;
+	int          key, length;
+
+	if ( !string )
+	{
+		return 0;
+	}
+
+	hash = 0;
+
+	for ( s = string; *s; s++ )
+	{
+		hash = hash * 31 + tolower( *s );
+	}
+
+	hash &= ENTITY_KEY_HASH_SIZE - 1;
+
+	while ( ( key = entityKeyHash[ hash ] ) != 0 )
+	{
+		if ( !Q_stricmp( entityKeys[ key ].string, string ) )
+		{
+			return key;
+		}
+
+		hash = ( hash + 1 ) & ( ENTITY_KEY_HASH_SIZE - 1 );
+	}
+
+	if ( !create )
+	{
+		return 0;
+	}
+
+	length = strlen( string ) + 1;
+
+	if ( numEntityKeys + 1 >= MAX_ENTITY_KEYS || entityKeyPoolUsed + length > ENTITY_KEY_POOL_SIZE )
+	{
+		if ( !entityKeysOverflowed )
+		{
+			G_Printf( S_WARNING "too many distinct entity classnames and names, entity searches will be slower\n" );
+			entityKeysOverflowed = qtrue;
+		}
+
+		return ENTITY_KEY_OVERFLOW;
+	}
+
+	key = ++numEntityKeys;
+	entityKeys[ key ].string = entityKeyPool + entityKeyPoolUsed;
+	memcpy( entityKeyPool + entityKeyPoolUsed, string, length );
+	entityKeyPoolUsed += length;
+	entityKeyHash[ hash ] = key;
+
+	return key;
+}
+
+/*
+=================
+G_UnindexEntity
+=================
+*/
+static void G_UnindexEntity( gentity_t *entity )
+{
+	int number = entity - g_entities;
+	int i;
+
+	if ( entity->classnameKey > 0 )
+	{
+		entityKeys[ entity->classnameKey ].classBits[ number >> 5 ] &= ~( 1u << ( number & 31 ) );
+	}
+
+	entity->classnameKey = 0;
+
+	for ( i = 0; i < MAX_ENTITY_ALIASES; i++ )
+	{
+		if ( entity->nameKeys[ i ] > 0 )
+		{
+			entityKeys[ entity->nameKeys[ i ] ].nameBits[ number >> 5 ] &= ~( 1u << ( number & 31 ) );
+		}
+
+		entity->nameKeys[ i ] = 0;
+	}
+}
+
+/*
+=================
+G_IndexEntity
+
+(Re)files the entity under its current classname and names.
+Needs to be called after changing any of entity->names
+=================
+*/
+void G_IndexEntity( gentity_t *entity )
+{
+	int number = entity - g_entities;
+	int i, key;
+
+	G_UnindexEntity( entity );
+
+	key = G_FindEntityKey( entity->classname, qtrue );
+	entity->classnameKey = key;
+
+	if ( key > 0 )
+	{
+		entityKeys[ key ].classBits[ number >> 5 ] |= 1u << ( number & 31 );
+	}
+
+	for ( i = 0; i < MAX_ENTITY_ALIASES && entity->names[ i ]; i++ )
+	{
+		key = G_FindEntityKey( entity->names[ i ], qtrue );
+		entity->nameKeys[ i ] = key;
+
+		if ( key > 0 )
+		{
+			entityKeys[ key ].nameBits[ number >> 5 ] |= 1u << ( number & 31 );
+		}
+	}
+}
+
+/*
+=================
+G_SetClassname
+
+Entity classnames must only be changed through this
+=================
+*/
+void G_SetClassname( gentity_t *entity, const char *classname )
+{
+	entity->classname = classname;
+	G_IndexEntity( entity );
+}
+
+/*
+=================
+G_EntityClassIndex
+G_EntityNameIndex
+
+Return the bitset of entities carrying a classname or name,
+or NULL if the index can't tell and all entities have to be searched
+=================
+*/
+static const unsigned int *G_EntityClassIndex( const char *classname )
+{
+	int key;
+
+	if ( entityKeysOverflowed )
+	{
+		return NULL;
+	}
+
+	key = G_FindEntityKey( classname, qfalse );
+	return key > 0 ? entityKeys[ key ].classBits : noEntityBits;
+}
+
+static const unsigned int *G_EntityNameIndex( const char *name )
+{
+	int key;
+
+	if ( entityKeysOverflowed )
+	{
+		return NULL;
+	}
+
+	key = G_FindEntityKey( name, qfalse );
+	return key > 0 ? entityKeys[ key ].nameBits : noEntityBits;
+}
+
+/*
+=================
+G_NextIndexedEntity
+
+Returns the first entity from the given one on that is set in bits,
+or NULL if there is none left
+=================
+*/
+static gentity_t *G_NextIndexedEntity( const unsigned int *bits, gentity_t *entity )
+{
+	int          number = entity - g_entities;
+	unsigned int word;
+
+	while ( number < level.num_entities )
+	{
+		word = bits[ number >> 5 ] >> ( number & 31 );
+
+		if ( !word )
+		{
+			number = ( number | 31 ) + 1;
+			continue;
+		}
+
+		while ( !( word & 1 ) )
+		{
+			word >>= 1;
+			number++;
+		}
+
+		return number < level.num_entities ? &g_entities[ number ] : NULL;
+	}
+
+	return NULL;
+}
+
+/*
+=================================================================================
+
 basic gentity lifecycle handling
 
 =================================================================================
 */
 
-void G_InitGentity( gentity_t *entity )
+/*
+=================
+free entity slots
+
+Freed slots are queued in the order they were freed, which is also the order
+in which they become reusable, and move over to the ready set once the reuse
+delay is over. G_NewEntity then takes the lowest ready slot, which is the same
+one a scan over all entities would pick, without having to do the scan.
+=================
+*/
+
+#define FREE_SLOT_QUEUE_SIZE ( MAX_GENTITIES * 2 )
+
+typedef struct
 {
-	entity->inuse = qtrue;
-	entity->enabled = qtrue;
-	entity->classname = "noclass";
-	entity->s.number = entity - g_entities;
-	entity->r.ownerNum = ENTITYNUM_NONE;
-	entity->creationTime = level.time;
+	int number;
+	int freetime;
+} freeEntitySlot_t;
+
+static freeEntitySlot_t freeSlotQueue[ FREE_SLOT_QUEUE_SIZE ];
+static int              freeSlotHead, freeSlotTail;
+static unsigned int     readySlotBits[ ENTITY_BITSET_WORDS ]; // free slots past the reuse delay
+
+/*
+=================
+G_ResetEntitySlots
+
+Has to be called whenever g_entities gets cleared
+=================
+*/
+void G_ResetEntitySlots( void )
+{
+	freeSlotHead = freeSlotTail = 0;
+	memset( readySlotBits, 0, sizeof( readySlotBits ) );
 }
 
 /*
 =================
-G_NewEntity
+G_SlotReusable
 
-Either finds a free entity, or allocates a new one.
+the first couple seconds of server time can involve a lot of
+freeing and allocating, so relax the replacement policy
+=================
+*/
+static qboolean G_SlotReusable( int freetime )
+{
+	return !( freetime > level.startTime + 2000 && level.time - freetime < 1000 );
+}
 
-  The slots from 0 to MAX_CLIENTS-1 are always reserved for clients, and will
-never be used by anything else.
+/*
+=================
+G_ReadyFreeSlot
 
-Try to avoid reusing an entity that was recently freed, because it
-can cause the client to think the entity morphed into something else
-instead of being removed and recreated, which can cause interpolated
-angles and bad trails.
+Moves the oldest queued slot into the ready set, if it is still free
 =================
 */
-gentity_t *G_NewEntity( void )
+static void G_ReadyFreeSlot( void )
+{
+	freeEntitySlot_t *slot = &freeSlotQueue[ freeSlotHead ];
+	int              number = slot->number;
+
+	freeSlotHead = ( freeSlotHead + 1 ) % FREE_SLOT_QUEUE_SIZE;
+
+	// slots that got reused and freed again are queued a second time
+	if ( !g_entities[ number ].inuse && g_entities[ number ].freetime == slot->freetime )
+	{
+		readySlotBits[ number >> 5 ] |= 1u << ( number & 31 );
+	}
+}
+
+static void G_QueueFreeSlot( gentity_t *entity )
+{
+	int number = entity - g_entities;
+
+	if ( number < MAX_CLIENTS || number >= ENTITYNUM_MAX_NORMAL )
+	{
+		return;
+	}
+
+	if ( ( freeSlotTail + 1 ) % FREE_SLOT_QUEUE_SIZE == freeSlotHead )
+	{
+		G_ReadyFreeSlot();
+	}
+
+	freeSlotQueue[ freeSlotTail ].number = number;
+	freeSlotQueue[ freeSlotTail ].freetime = entity->freetime;
+	freeSlotTail = ( freeSlotTail + 1 ) % FREE_SLOT_QUEUE_SIZE;
+}
+
+/*
+=================
+G_LowestSlot
+
+Returns the lowest entity number set in bits, or -1
+=================
+*/
+static int G_LowestSlot( const unsigned int *bits )
+{
+	int          i, number;
+	unsigned int word;
+
+	for ( i = MAX_CLIENTS >> 5; i < ENTITY_BITSET_WORDS; i++ )
+	{
+		if ( !( word = bits[ i ] ) )
+		{
+			continue;
+		}
+
+		for ( number = i << 5; !( word & 1 ); number++ )
+		{
+			word >>= 1;
+		}
+
+		return number;
+	}
+
+	return -1;
+}
+
+/*
+=================
+G_ReferenceEntitySlot
+
+The slot the original scan over all entities picks, to check the above against
+with g_entityAllocVerify. Returns level.num_entities for a new slot, which is
+ENTITYNUM_MAX_NORMAL when there are no free entities left
+=================
+*/
+static int G_ReferenceEntitySlot( void )
 {
 	int       i, force;
 	gentity_t *newEntity;
 
-	newEntity = NULL; // shut up warning
 	i = 0; // shut up warning
 
 	for ( force = 0; force < 2; force++ )
@@ -96,9 +459,7 @@ gentity_t *G_NewEntity( void )
 				continue;
 			}
 
-			// reuse this slot
-			G_InitGentity( newEntity );
-			return newEntity;
+			return i;
 		}
 
 		if ( i != MAX_GENTITIES )
@@ -107,6 +468,62 @@ gentity_t *G_NewEntity( void )
 		}
 	}
 
+	return i;
+}
+
+void G_InitGentity( gentity_t *entity )
+{
+	int number = entity - g_entities;
+
+	readySlotBits[ number >> 5 ] &= ~( 1u << ( number & 31 ) );
+
+	entity->inuse = qtrue;
+	entity->enabled = qtrue;
+	G_SetClassname( entity, "noclass" );
+	entity->s.number = number;
+	entity->r.ownerNum = ENTITYNUM_NONE;
+	entity->creationTime = level.time;
+}
+
+/*
+=================
+G_NewEntity
+
+Either finds a free entity, or allocates a new one.
+
+  The slots from 0 to MAX_CLIENTS-1 are always reserved for clients, and will
+never be used by anything else.
+
+Try to avoid reusing an entity that was recently freed, because it
+can cause the client to think the entity morphed into something else
+instead of being removed and recreated, which can cause interpolated
+angles and bad trails.
+=================
+*/
+gentity_t *G_NewEntity( void )
+{
+	int       i, reference;
+	gentity_t *newEntity;
+
+	reference = g_entityAllocVerify.integer ? G_ReferenceEntitySlot() : -1;
+
+	while ( freeSlotHead != freeSlotTail && G_SlotReusable( freeSlotQueue[ freeSlotHead ].freetime ) )
+	{
+		G_ReadyFreeSlot();
+	}
+
+	i = G_LowestSlot( readySlotBits );
+
+	if ( i < 0 )
+	{
+		i = level.num_entities;
+	}
+
+	if ( reference >= 0 && reference != i )
+	{
+		G_Printf( S_WARNING "G_NewEntity: picked slot %i instead of %i\n", i, reference );
+	}
+
 	if ( i == ENTITYNUM_MAX_NORMAL )
 	{
 		for ( i = 0; i < MAX_GENTITIES; i++ )
@@ -117,6 +534,15 @@ gentity_t *G_NewEntity( void )
 		G_Error( "G_Spawn: no free entities" );
 	}
 
+	newEntity = &g_entities[ i ];
+
+	if ( i < level.num_entities )
+	{
+		// reuse this slot
+		G_InitGentity( newEntity );
+		return newEntity;
+	}
+
 	// open up a new slot
 	level.num_entities++;
 
@@ -150,10 +576,15 @@ void G_FreeEntity( gentity_t *entity )
 	if( entity->eclass && entity->eclass->instanceCounter > 0)
 		entity->eclass->instanceCounter--;
 
+	G_UnindexEntity( entity );
+
+	// free entities are never searched for, so they stay out of the index
 	memset( entity, 0, sizeof( *entity ) );
 	entity->classname = "freent";
 	entity->freetime = level.time;
 	entity->inuse = qfalse;
+
+	G_QueueFreeSlot( entity );
 }
 
 
@@ -174,7 +605,7 @@ gentity_t *G_NewTempEntity( const vec3_t origin, int event )
 	newEntity = G_NewEntity();
 	newEntity->s.eType = ET_EVENTS + event;
 
-	newEntity->classname = "tempEntity";
+	G_SetClassname( newEntity, "tempEntity" );
 	newEntity->eventTime = level.time;
 	newEntity->freeAfterEvent = qtrue;
 
@@ -275,6 +706,7 @@ Set NULL as previous gentity to start the iteration from the beginning
 gentity_t *G_IterateEntities( gentity_t *entity, const char *classname, qboolean skipdisabled, size_t fieldofs, const char *match )
 {
 	char *fieldString;
+	const unsigned int *candidates = NULL;
 
 	if ( !entity )
 	{
@@ -288,16 +720,21 @@ gentity_t *G_IterateEntities( gentity_t *entity, const char *classname, qboolean
 		entity++;
 	}
 
+	if ( classname )
+		candidates = G_EntityClassIndex( classname );
+
 	for ( ; entity < &g_entities[ level.num_entities ]; entity++ )
 	{
+		if ( candidates && !( entity = G_NextIndexedEntity( candidates, entity ) ) )
+			break;
+
 		if ( !entity->inuse )
 			continue;
 
 		if( skipdisabled && !entity->enabled)
 			continue;
 
-
-		if ( classname && Q_stricmp( entity->classname, classname ) )
+		if ( !candidates && classname && Q_stricmp( entity->classname, classname ) )
 			continue;
 
 		if ( fieldofs && match )
@@ -564,9 +1001,13 @@ gentity_t *G_ResolveEntityKeyword( gentity_t *self, char *keyword )
 gentity_t *G_IterateTargets(gentity_t *entity, int *targetIndex, gentity_t *self)
 {
 	gentity_t *possibleTarget = NULL;
+	const unsigned int *candidates;
 
 	if (entity)
+	{
+		candidates = G_EntityNameIndex( self->targets[*targetIndex] );
 		goto cont;
+	}
 
 	for (*targetIndex = 0; self->targets[*targetIndex]; ++(*targetIndex))
 	{
@@ -578,8 +1019,13 @@ gentity_t *G_IterateTargets(gentity_t *entity, int *targetIndex, gentity_t *self
 			return NULL;
 		}
 
+		candidates = G_EntityNameIndex( self->targets[*targetIndex] );
+
 		for( entity = &g_entities[ MAX_CLIENTS ]; entity < &g_entities[ level.num_entities ]; entity++ )
 		{
+			if ( candidates && !( entity = G_NextIndexedEntity( candidates, entity ) ) )
+				break;
+
 			if ( !entity->inuse || !entity->enabled)
 				continue;
 
@@ -594,16 +1040,26 @@ gentity_t *G_IterateTargets(gentity_t *entity, int *targetIndex, gentity_t *self
 
 gentity_t *G_IterateCallEndpoints(gentity_t *entity, int *calltargetIndex, gentity_t *self)
 {
+	const unsigned int *candidates;
+
 	if (entity)
+	{
+		candidates = G_EntityNameIndex( self->calltargets[*calltargetIndex].name );
 		goto cont;
+	}
 
 	for (*calltargetIndex = 0; self->calltargets[*calltargetIndex].name; ++(*calltargetIndex))
 	{
 		if(self->calltargets[*calltargetIndex].name[0] == '$')
 			return G_ResolveEntityKeyword( self, self->calltargets[*calltargetIndex].name );
 
+		candidates = G_EntityNameIndex( self->calltargets[*calltargetIndex].name );
+
 		for( entity = &g_entities[ MAX_CLIENTS ]; entity < &g_entities[ level.num_entities ]; entity++ )
 		{
+			if ( candidates && !( entity = G_NextIndexedEntity( candidates, entity ) ) )
+				break;
+
 			if ( !entity->inuse )
 				continue;
 
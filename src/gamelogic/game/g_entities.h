@@ -222,7 +222,13 @@ extern const gentityCall_t NULL_CALL;
 //
 // g_entities.c
 //
+//index
+void       G_ResetEntityIndex( void );
+void       G_IndexEntity( gentity_t *entity );
+void       G_SetClassname( gentity_t *entity, const char *classname );
+
 //lifecycle
+void       G_ResetEntitySlots( void );
 void       G_InitGentity( gentity_t *e );
 gentity_t  *G_NewEntity( void );
 gentity_t  *G_NewTempEntity( const vec3_t origin, int event );
@@ -173,6 +173,13 @@ struct gentity_s
 
 	char         *names[ MAX_ENTITY_ALIASES + 1 ];
 
+	/*
+	 * keys of classname and names in the entity index
+	 * only to be kept up to date through G_SetClassname and G_IndexEntity
+	 */
+	int          classnameKey;
+	int          nameKeys[ MAX_ENTITY_ALIASES ];
+
 	/**
 	 * is the entity considered active?
 	 * as in 'currently doing something'
@@ -580,6 +587,7 @@ struct gclient_s
 	unlagged_t unlaggedBackup;
 	unlagged_t unlaggedCalc;
 	int        unlaggedTime;
+	int        unlaggedLinkcount; // r.linkcount when rewound by G_UnlaggedOn()
 
 	float      voiceEnthusiasm;
 	char       lastVoiceCmd[ MAX_VOICE_CMD_LEN ];
@@ -1147,6 +1155,9 @@ void G_UnlaggedClear( gentity_t *ent );
 void G_UnlaggedCalc( int time, gentity_t *skipEnt );
 void G_UnlaggedOn( gentity_t *attacker, vec3_t muzzle, float range );
 void G_UnlaggedOff( void );
+void G_UnlaggedTrace( trace_t *tr, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+                      const vec3_t end, int passEntityNum, int contentmask );
+int  G_UnlaggedEntitiesInBox( const vec3_t mins, const vec3_t maxs, int *entityList, int maxcount );
 void ClientThink( int clientNum );
 void ClientEndFrame( gentity_t *ent );
 void G_RunClient( gentity_t *ent );
@@ -1287,6 +1298,7 @@ extern  vmCvar_t g_pulseFullPowerTime;
 extern  vmCvar_t g_flameFadeout;
 
 extern  vmCvar_t g_unlagged;
+extern  vmCvar_t g_unlaggedVerify;
 
 extern  vmCvar_t g_disabledEquipment;
 extern  vmCvar_t g_disabledClasses;
@@ -1341,6 +1353,7 @@ extern  vmCvar_t g_showKillerHP;
 extern  vmCvar_t g_combatCooldown;
 
 extern  vmCvar_t g_debugEntities;
+extern  vmCvar_t g_entityAllocVerify;
 
 void             trap_Print( const char *string );
 void             trap_Error( const char *string ) NORETURN;
@@ -1421,6 +1434,8 @@ void             trap_GenFingerprint( const char *pubkey, int size, char *buffer
 void             trap_GetPlayerPubkey( int clientNum, char *pubkey, int size );
 
 void             trap_GetTimeString( char *buffer, int size, const char *format, const qtime_t *tm );
+int              trap_Batch( const batchQuery_t *queries, batchResult_t *results, int count );
+int              trap_FindConfigstring( const char *name, int start, int max, qboolean create );
 
 //==================================================================
 #endif /* G_LOCAL_H_ */
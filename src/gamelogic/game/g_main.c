@@ -122,6 +122,7 @@ vmCvar_t           g_pulseFullPowerTime;
 vmCvar_t           g_flameFadeout;
 
 vmCvar_t           g_unlagged;
+vmCvar_t           g_unlaggedVerify;
 
 vmCvar_t           g_disabledEquipment;
 vmCvar_t           g_disabledClasses;
@@ -178,6 +179,7 @@ vmCvar_t           g_showKillerHP;
 vmCvar_t           g_combatCooldown;
 
 vmCvar_t           g_debugEntities;
+vmCvar_t           g_entityAllocVerify;
 
 // copy cvars that can be set in worldspawn so they can be restored later
 static char        cv_gravity[ MAX_CVAR_VALUE_STRING ];
@@ -290,6 +292,7 @@ static cvarTable_t gameCvarTable[] =
 	{ &g_flameFadeout,                "g_flameFadeout",                "1",                                CVAR_ARCHIVE,                                    0, qtrue            },
 
 	{ &g_unlagged,                    "g_unlagged",                    "1",                                CVAR_SERVERINFO | CVAR_ARCHIVE,                  0, qtrue            },
+	{ &g_unlaggedVerify,              "g_unlaggedVerify",              "0",                                0,                                               0, qfalse           },
 
 	{ &g_disabledEquipment,           "g_disabledEquipment",           "",                                 CVAR_ROM | CVAR_SYSTEMINFO,                      0, qfalse           },
 	{ &g_disabledClasses,             "g_disabledClasses",             "",                                 CVAR_ROM | CVAR_SYSTEMINFO,                      0, qfalse           },
@@ -324,6 +327,7 @@ static cvarTable_t gameCvarTable[] =
 	{ &g_layoutAuto,                  "g_layoutAuto",                  "0",                                CVAR_ARCHIVE,                                    0, qfalse           },
 
 	{ &g_debugEntities,               "g_debugEntities",               "0",                                0,                                               0, qfalse           },
+	{ &g_entityAllocVerify,           "g_entityAllocVerify",           "0",                                0,                                               0, qfalse           },
 
 	{ &g_emoticonsAllowedInNames,     "g_emoticonsAllowedInNames",     "1",                                CVAR_LATCH | CVAR_ARCHIVE,                       0, qfalse           },
 	{ &g_unnamedNumbering,            "g_unnamedNumbering",            "-1",                               CVAR_ARCHIVE,                                    0, qfalse           },
@@ -507,6 +511,9 @@ void G_FindEntityGroups( void )
 					masterEntity->names[k] = comparedEntity->names[k];
 					comparedEntity->names[k] = NULL;
 				}
+
+				G_IndexEntity( masterEntity );
+				G_IndexEntity( comparedEntity );
 			}
 		}
 	}
@@ -732,6 +739,8 @@ void G_InitGame( int levelTime, int randomSeed, int restart )
 
 	// initialize all entities for this game
 	memset( g_entities, 0, MAX_GENTITIES * sizeof( g_entities[ 0 ] ) );
+	G_ResetEntityIndex();
+	G_ResetEntitySlots();
 	level.gentities = g_entities;
 
 	// initialize all clients for this game
@@ -751,7 +760,7 @@ void G_InitGame( int levelTime, int randomSeed, int restart )
 	level.num_entities = MAX_CLIENTS;
 
 	for( i = 0; i < MAX_CLIENTS; i++ )
-		g_entities[ i ].classname = "clientslot";
+		G_SetClassname( &g_entities[ i ], "clientslot" );
 
 	// let the server system know where the entites are
 	trap_LocateGameData( level.gentities, level.num_entities, sizeof( gentity_t ),
@@ -466,7 +466,7 @@ gentity_t *fire_flamer( gentity_t *self, vec3_t start, vec3_t dir )
 	vec3_t    pvel;
 
 	bolt = G_NewEntity();
-	bolt->classname = "flame";
+	G_SetClassname( bolt, "flame" );
 	bolt->pointAgainstWorld = qfalse;
 	bolt->nextthink = level.time + FLAMER_LIFETIME;
 	bolt->think = G_ExplodeMissile;
@@ -511,7 +511,7 @@ gentity_t *fire_blaster( gentity_t *self, vec3_t start, vec3_t dir )
 	gentity_t *bolt;
 
 	bolt = G_NewEntity();
-	bolt->classname = "blaster";
+	G_SetClassname( bolt, "blaster" );
 	bolt->pointAgainstWorld = qtrue;
 	bolt->nextthink = level.time + 10000;
 	bolt->think = G_ExplodeMissile;
@@ -555,7 +555,7 @@ gentity_t *fire_pulseRifle( gentity_t *self, vec3_t start, vec3_t dir )
 	gentity_t *bolt;
 
 	bolt = G_NewEntity();
-	bolt->classname = "pulse";
+	G_SetClassname( bolt, "pulse" );
 	bolt->pointAgainstWorld = qtrue;
 	bolt->nextthink = level.time + 10000;
 	bolt->think = G_ExplodeMissile;
@@ -601,7 +601,7 @@ gentity_t *fire_luciferCannon( gentity_t *self, vec3_t start, vec3_t dir,
 	float     charge;
 
 	bolt = G_NewEntity();
-	bolt->classname = "lcannon";
+	G_SetClassname( bolt, "lcannon" );
 	bolt->pointAgainstWorld = qtrue;
 
 	if ( damage == LCANNON_DAMAGE )
@@ -666,7 +666,7 @@ gentity_t *launch_grenade( gentity_t *self, vec3_t start, vec3_t dir )
 	gentity_t *bolt;
 
 	bolt = G_NewEntity();
-	bolt->classname = "grenade";
+	G_SetClassname( bolt, "grenade" );
 	bolt->pointAgainstWorld = qfalse;
 	bolt->nextthink = level.time + 5000;
 	bolt->think = G_ExplodeMissile;
@@ -780,7 +780,7 @@ gentity_t *fire_hive( gentity_t *self, vec3_t start, vec3_t dir )
 	gentity_t *bolt;
 
 	bolt = G_NewEntity();
-	bolt->classname = "hive";
+	G_SetClassname( bolt, "hive" );
 	bolt->pointAgainstWorld = qfalse;
 	bolt->nextthink = level.time + HIVE_DIR_CHANGE_PERIOD;
 	bolt->think = AHive_SearchAndDestroy;
@@ -821,7 +821,7 @@ gentity_t *fire_lockblob( gentity_t *self, vec3_t start, vec3_t dir )
 	gentity_t *bolt;
 
 	bolt = G_NewEntity();
-	bolt->classname = "lockblob";
+	G_SetClassname( bolt, "lockblob" );
 	bolt->pointAgainstWorld = qtrue;
 	bolt->nextthink = level.time + 15000;
 	bolt->think = G_ExplodeMissile;
@@ -858,7 +858,7 @@ gentity_t *fire_slowBlob( gentity_t *self, vec3_t start, vec3_t dir )
 	gentity_t *bolt;
 
 	bolt = G_NewEntity();
-	bolt->classname = "slowblob";
+	G_SetClassname( bolt, "slowblob" );
 	bolt->pointAgainstWorld = qtrue;
 	bolt->nextthink = level.time + 15000;
 	bolt->think = G_ExplodeMissile;
@@ -896,7 +896,7 @@ gentity_t *fire_bounceBall( gentity_t *self, vec3_t start, vec3_t dir )
 	gentity_t *bolt;
 
 	bolt = G_NewEntity();
-	bolt->classname = "bounceball";
+	G_SetClassname( bolt, "bounceball" );
 	bolt->pointAgainstWorld = qtrue;
 	bolt->nextthink = level.time + 3000;
 	bolt->think = G_ExplodeMissile;
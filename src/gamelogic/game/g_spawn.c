@@ -481,7 +481,7 @@ qboolean G_HandleEntityVersions( entityClassDescriptor_t *spawnDescription, gent
 			G_Printf( S_WARNING "Entity %s uses a deprecated classtype — use the class " S_COLOR_CYAN "%s" S_COLOR_WHITE " instead\n", etos( entity ), spawnDescription->replacement );
 		}
 	}
-	entity->classname = spawnDescription->replacement;
+	G_SetClassname( entity, spawnDescription->replacement );
 	return qtrue;
 }
 
@@ -841,6 +841,7 @@ void G_SpawnGEntityFromSpawnVars( void )
 			spawningEntity->names[j++] = spawningEntity->names[i];
 	}
 	spawningEntity->names[ j ] = NULL;
+	G_IndexEntity( spawningEntity );
 
 	/*
 	 * for backward compatbility, since before targets were used for calling,
@@ -1077,11 +1078,11 @@ void SP_worldspawn( void )
 
 	g_entities[ ENTITYNUM_WORLD ].s.number = ENTITYNUM_WORLD;
 	g_entities[ ENTITYNUM_WORLD ].r.ownerNum = ENTITYNUM_NONE;
-	g_entities[ ENTITYNUM_WORLD ].classname = S_WORLDSPAWN;
+	G_SetClassname( &g_entities[ ENTITYNUM_WORLD ], S_WORLDSPAWN );
 
 	g_entities[ ENTITYNUM_NONE ].s.number = ENTITYNUM_NONE;
 	g_entities[ ENTITYNUM_NONE ].r.ownerNum = ENTITYNUM_NONE;
-	g_entities[ ENTITYNUM_NONE ].classname = "nothing";
+	G_SetClassname( &g_entities[ ENTITYNUM_NONE ], "nothing" );
 
 	// see if we want a warmup time
 	trap_SetConfigstring( CS_WARMUP, "-1" );
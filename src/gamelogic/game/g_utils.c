@@ -95,41 +95,20 @@ G_FindConfigstringIndex
 */
 static int G_FindConfigstringIndex( const char *name, int start, int max, qboolean create )
 {
-	int  i;
-	char s[ MAX_STRING_CHARS ];
+	int i;
 
 	if ( !name || !name[ 0 ] )
 	{
 		return 0;
 	}
 
-	for ( i = 1; i < max; i++ )
-	{
-		trap_GetConfigstring( start + i, s, sizeof( s ) );
-
-		if ( !s[ 0 ] )
-		{
-			break;
-		}
-
-		if ( !strcmp( s, name ) )
-		{
-			return i;
-		}
-	}
-
-	if ( !create )
-	{
-		return 0;
-	}
+	i = trap_FindConfigstring( name, start, max, create );
 
-	if ( i == max )
+	if ( i < 0 )
 	{
 		G_Error( "G_FindConfigstringIndex: overflow" );
 	}
 
-	trap_SetConfigstring( start + i, name );
-
 	return i;
 }
 
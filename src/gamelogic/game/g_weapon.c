@@ -165,7 +165,7 @@ static void G_WideTrace( trace_t *tr, gentity_t *ent, float range,
 	VectorMA( muzzle, range, forward, end );
 
 	// Trace against entities
-	trap_Trace( tr, muzzle, mins, maxs, end, ent->s.number, CONTENTS_BODY );
+	G_UnlaggedTrace( tr, muzzle, mins, maxs, end, ent->s.number, CONTENTS_BODY );
 
 	if ( tr->entityNum != ENTITYNUM_NONE )
 	{
@@ -378,7 +378,7 @@ void bulletFire( gentity_t *ent, float spread, int damage, int mod )
 	if ( ent->client )
 	{
 		G_UnlaggedOn( ent, muzzle, 8192 * 16 );
-		trap_Trace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
+		G_UnlaggedTrace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
 		G_UnlaggedOff();
 	}
 	else
@@ -456,7 +456,7 @@ void ShotgunPattern( vec3_t origin, vec3_t origin2, int seed, gentity_t *ent )
 		VectorMA( end, r, right, end );
 		VectorMA( end, u, up, end );
 
-		trap_Trace( &tr, origin, NULL, NULL, end, ent->s.number, MASK_SHOT );
+		G_UnlaggedTrace( &tr, origin, NULL, NULL, end, ent->s.number, MASK_SHOT );
 		traceEnt = &g_entities[ tr.entityNum ];
 
 		// send bullet impact
@@ -503,7 +503,7 @@ void massDriverFire( gentity_t *ent )
 	VectorMA( muzzle, 8192.0f * 16.0f, forward, end );
 
 	G_UnlaggedOn( ent, muzzle, 8192.0f * 16.0f );
-	trap_Trace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
+	G_UnlaggedTrace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
 	G_UnlaggedOff();
 
 	if ( tr.surfaceFlags & SURF_NOIMPACT )
@@ -652,7 +652,7 @@ void lasGunFire( gentity_t *ent )
 	VectorMA( muzzle, 8192 * 16, forward, end );
 
 	G_UnlaggedOn( ent, muzzle, 8192 * 16 );
-	trap_Trace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
+	G_UnlaggedTrace( &tr, muzzle, NULL, NULL, end, ent->s.number, MASK_SHOT );
 	G_UnlaggedOff();
 
 	if ( tr.surfaceFlags & SURF_NOIMPACT )
@@ -1114,7 +1114,7 @@ void poisonCloud( gentity_t *ent )
 	VectorSubtract( ent->client->ps.origin, range, mins );
 
 	G_UnlaggedOn( ent, ent->client->ps.origin, LEVEL1_PCLOUD_RANGE );
-	num = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+	num = G_UnlaggedEntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
 
 	for ( i = 0; i < num; i++ )
 	{
@@ -1288,7 +1288,7 @@ static void G_CreateNewZap( gentity_t *creator, gentity_t *target )
 
 		zap->effectChannel = G_NewEntity();
 		zap->effectChannel->s.eType = ET_LEV2_ZAP_CHAIN;
-		zap->effectChannel->classname = "lev2zapchain";
+		G_SetClassname( zap->effectChannel, "lev2zapchain" );
 		G_UpdateZapEffect( zap );
 
 		return;
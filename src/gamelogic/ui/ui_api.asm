@@ -133,3 +133,5 @@ equ trap_R_GlyphChar                      -369
 equ trap_R_UnregisterFont                 -370
 equ trap_Pgettext                         -371
 equ trap_GettextPlural                    -372
+equ trap_Parse_ReadTokens                 -373
+equ trap_R_DrawStretchPics                -374
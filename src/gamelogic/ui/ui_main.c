@@ -267,6 +267,8 @@ void AssetCache( void )
 		uiInfo.uiDC.Assets.emoticons[ i ].shader = trap_R_RegisterShader(va("emoticons/%s_%dx1.tga", uiInfo.uiDC.Assets.emoticons[i].name, uiInfo.uiDC.Assets.emoticons[i].width),
 										 RSF_NOMIP);
 	}
+
+	UI_Text_ClearCache();
 }
 
 void UI_DrawSides( float x, float y, float w, float h, float size )
@@ -1321,7 +1323,7 @@ qboolean Asset_Parse( int handle )
 	const char *tempStr;
 	const char *fallbackFont = "fonts/unifont.ttf";
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -1335,7 +1337,7 @@ qboolean Asset_Parse( int handle )
 	{
 		memset( &token, 0, sizeof( pc_token_t ) );
 
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			return qfalse;
 		}
@@ -1544,7 +1546,7 @@ qboolean UI_ParseMenu( const char *menuFile )
 	int        handle;
 	pc_token_t token;
 
-	handle = trap_Parse_LoadSource( menuFile );
+	handle = PC_LoadSource( menuFile );
 
 	if ( !handle )
 	{
@@ -1557,7 +1559,7 @@ qboolean UI_ParseMenu( const char *menuFile )
 	{
 		memset( &token, 0, sizeof( pc_token_t ) );
 
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			break;
 		}
@@ -1596,7 +1598,7 @@ qboolean UI_ParseMenu( const char *menuFile )
 		}
 	}
 
-	trap_Parse_FreeSource( handle );
+	PC_FreeSource( handle );
 	return qtrue;
 }
 
@@ -1604,7 +1606,7 @@ qboolean Load_Menu( int handle )
 {
 	pc_token_t token;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -1616,7 +1618,7 @@ qboolean Load_Menu( int handle )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			return qfalse;
 		}
@@ -1646,7 +1648,7 @@ qboolean UI_LoadMenus( const char *menuFile, qboolean reset )
 
 	start = trap_Milliseconds();
 
-	handle = trap_Parse_LoadSource( menuFile );
+	handle = PC_LoadSource( menuFile );
 
 	if ( !handle )
 	{
@@ -1680,7 +1682,7 @@ qboolean UI_LoadMenus( const char *menuFile, qboolean reset )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			break;
 		}
@@ -1710,7 +1712,7 @@ qboolean UI_LoadMenus( const char *menuFile, qboolean reset )
 
 	// Com_Printf(_( "UI menu file '%s' loaded in %d msec\n"), menuFile, trap_Milliseconds() - start );
 
-	trap_Parse_FreeSource( handle );
+	PC_FreeSource( handle );
 	return qtrue;
 }
 
@@ -1722,7 +1724,7 @@ qboolean UI_LoadHelp( const char *helpFile )
 
 	start = trap_Milliseconds();
 
-	handle = trap_Parse_LoadSource( helpFile );
+	handle = PC_LoadSource( helpFile );
 
 	if ( !handle )
 	{
@@ -1731,7 +1733,7 @@ qboolean UI_LoadHelp( const char *helpFile )
 		return qfalse;
 	}
 
-	if ( !trap_Parse_ReadToken( handle, &token ) ||
+	if ( !PC_ReadToken( handle, &token ) ||
 	     token.string[ 0 ] == 0 || token.string[ 0 ] != '{' )
 	{
 		Com_Printf( S_WARNING "help file '%s' does not start with "
@@ -1744,7 +1746,7 @@ qboolean UI_LoadHelp( const char *helpFile )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) ||
+		if ( !PC_ReadToken( handle, &token ) ||
 		     token.string[ 0 ] == 0 || token.string[ 0 ] == '}' )
 		{
 			break;
@@ -1756,7 +1758,7 @@ qboolean UI_LoadHelp( const char *helpFile )
 			Q_strcat( buffer, sizeof( buffer ), title );
 			Q_strcat( buffer, sizeof( buffer ), "\n\n" );
 
-			while ( trap_Parse_ReadToken( handle, &token ) &&
+			while ( PC_ReadToken( handle, &token ) &&
 			        token.string[ 0 ] != 0 && token.string[ 0 ] != '}' )
 			{
 				Q_strcat( buffer, sizeof( buffer ), token.string );
@@ -1774,7 +1776,7 @@ qboolean UI_LoadHelp( const char *helpFile )
 		}
 	}
 
-	trap_Parse_FreeSource( handle );
+	PC_FreeSource( handle );
 
 	// Com_Printf(_( "UI help file '%s' loaded in %d msec (%d infopanes)\n"),
 	//             helpFile, trap_Milliseconds() - start, uiInfo.helpCount );
@@ -5155,6 +5157,7 @@ void UI_Init( void )
 	uiInfo.uiDC.drawHandlePic = &UI_DrawHandlePic;
 	uiInfo.uiDC.drawNoStretchPic = &UI_DrawNoStretchPic;
 	uiInfo.uiDC.drawStretchPic = &trap_R_DrawStretchPic;
+	uiInfo.uiDC.drawStretchPics = &trap_R_DrawStretchPics;
 	uiInfo.uiDC.registerModel = &trap_R_RegisterModel;
 	uiInfo.uiDC.modelBounds = &trap_R_ModelBounds;
 	uiInfo.uiDC.fillRect = &UI_FillRect;
@@ -374,6 +374,121 @@ void String_Init( void )
 	}
 }
 
+/*
+=================
+PC_LoadSource, PC_FreeSource, PC_ReadToken
+
+The tokens of a source are read from the engine PC_TOKEN_BATCH at a time
+and handed out from a buffer, so a menu costs a trap call per batch
+rather than one per token. Sources beyond PC_TOKEN_BUFFERS are read a
+token at a time.
+=================
+*/
+#define PC_TOKEN_BATCH   32
+#define PC_TOKEN_BUFFERS 4
+
+typedef struct
+{
+	int        handle; // 0 if unused
+	pc_token_t tokens[ PC_TOKEN_BATCH ];
+	int        numTokens;
+	int        token; // next token to hand out
+	int        line; // line of the last token handed out
+} pcTokenBuffer_t;
+
+static pcTokenBuffer_t pcTokenBuffers[ PC_TOKEN_BUFFERS ];
+
+static pcTokenBuffer_t *PC_TokenBuffer( int handle )
+{
+	int i;
+
+	for ( i = 0; i < PC_TOKEN_BUFFERS; i++ )
+	{
+		if ( pcTokenBuffers[ i ].handle == handle )
+		{
+			return &pcTokenBuffers[ i ];
+		}
+	}
+
+	return NULL;
+}
+
+int PC_LoadSource( const char *filename )
+{
+	pcTokenBuffer_t *buffer;
+	int             handle;
+
+	handle = trap_Parse_LoadSource( filename );
+
+	if ( handle && ( buffer = PC_TokenBuffer( 0 ) ) )
+	{
+		buffer->handle = handle;
+		buffer->numTokens = 0;
+		buffer->token = 0;
+		buffer->line = 0;
+	}
+
+	return handle;
+}
+
+int PC_FreeSource( int handle )
+{
+	pcTokenBuffer_t *buffer;
+
+	if ( handle && ( buffer = PC_TokenBuffer( handle ) ) )
+	{
+		buffer->handle = 0;
+	}
+
+	return trap_Parse_FreeSource( handle );
+}
+
+int PC_ReadToken( int handle, pc_token_t *token )
+{
+	pcTokenBuffer_t *buffer;
+
+	if ( !handle || !( buffer = PC_TokenBuffer( handle ) ) )
+	{
+		return trap_Parse_ReadToken( handle, token );
+	}
+
+	if ( buffer->token >= buffer->numTokens )
+	{
+		buffer->numTokens = trap_Parse_ReadTokens( handle, buffer->tokens, PC_TOKEN_BATCH );
+		buffer->token = 0;
+
+		if ( !buffer->numTokens )
+		{
+			memset( token, 0, sizeof( *token ) );
+			return 0;
+		}
+	}
+
+	*token = buffer->tokens[ buffer->token++ ];
+	buffer->line = token->line;
+	return 1;
+}
+
+/*
+=================
+PC_SourceFileAndLine
+
+The engine has read ahead of a buffered source,
+so the line is the one of the last token handed out
+=================
+*/
+static void PC_SourceFileAndLine( int handle, char *filename, int *line )
+{
+	pcTokenBuffer_t *buffer;
+
+	trap_Parse_SourceFileAndLine( handle, filename, line );
+
+	if ( handle && ( buffer = PC_TokenBuffer( handle ) ) )
+	{
+		*line = buffer->line;
+	}
+}
+
 /*
 =================
 PC_SourceWarning
@@ -392,7 +507,7 @@ void PRINTF_LIKE(2) PC_SourceWarning( int handle, char *format, ... )
 
 	filename[ 0 ] = '\0';
 	line = 0;
-	trap_Parse_SourceFileAndLine( handle, filename, &line );
+	PC_SourceFileAndLine( handle, filename, &line );
 
 	Com_Printf( S_WARNING "%s, line %d: %s\n", filename, line, string );
 }
@@ -415,7 +530,7 @@ void PRINTF_LIKE(2) PC_SourceError( int handle, char *format, ... )
 
 	filename[ 0 ] = '\0';
 	line = 0;
-	trap_Parse_SourceFileAndLine( handle, filename, &line );
+	PC_SourceFileAndLine( handle, filename, &line );
 
 	Com_Printf( S_ERROR "%s, line %d: %s\n", filename, line, string );
 }
@@ -584,7 +699,7 @@ static qboolean PC_Expression_Parse( int handle, float *f )
 	stack.f = fifo.f = 0;
 	stack.b = fifo.b = -1;
 
-	while ( trap_Parse_ReadToken( handle, &token ) )
+	while ( PC_ReadToken( handle, &token ) )
 	{
 		if ( !unmatchedParentheses && token.string[ 0 ] == ')' )
 		{
@@ -594,7 +709,7 @@ static qboolean PC_Expression_Parse( int handle, float *f )
 		// Special case to catch negative numbers
 		if ( expectingNumber && token.string[ 0 ] == '-' )
 		{
-			if ( !trap_Parse_ReadToken( handle, &token ) )
+			if ( !PC_ReadToken( handle, &token ) )
 			{
 				return qfalse;
 			}
@@ -752,7 +867,7 @@ qboolean PC_Float_Parse( int handle, float *f )
 	pc_token_t token;
 	int        negative = qfalse;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -764,7 +879,7 @@ qboolean PC_Float_Parse( int handle, float *f )
 
 	if ( token.string[ 0 ] == '-' )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			return qfalse;
 		}
@@ -867,7 +982,7 @@ qboolean PC_Int_Parse( int handle, int *i )
 	pc_token_t token;
 	int        negative = qfalse;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -889,7 +1004,7 @@ qboolean PC_Int_Parse( int handle, int *i )
 
 	if ( token.string[ 0 ] == '-' )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			return qfalse;
 		}
@@ -990,7 +1105,7 @@ qboolean PC_String_Parse( int handle, const char **out )
 {
 	pc_token_t token;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -1004,7 +1119,7 @@ qboolean PC_String_ParseTranslate( int handle, const char **out )
 {
 	pc_token_t token;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -1024,7 +1139,7 @@ qboolean PC_Char_Parse( int handle, char *out )
 {
 	pc_token_t token;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -1048,7 +1163,7 @@ qboolean PC_Script_Parse( int handle, const char **out )
 	// scripts start with { and have ; separated command lists.. commands are command, arg..
 	// basically we want everything between the { } as it will be interpreted at run time
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -1060,7 +1175,7 @@ qboolean PC_Script_Parse( int handle, const char **out )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			return qfalse;
 		}
@@ -2367,7 +2482,7 @@ float UI_Char_Width( const char **text, float scale )
 	return 0.0f;
 }
 
-float UI_Text_Width( const char *text, float scale )
+static float UI_Text_Width_Generic( const char *text, float scale )
 {
 	float      out;
 	const char *s = text;
@@ -2388,6 +2503,275 @@ float UI_Text_Width( const char *text, float scale )
 	return out + indentWidth;
 }
 
+/*
+================
+Text layout cache
+
+Laying a string out decodes its UTF-8, looks for colour codes and
+emoticons and asks the engine for the metrics of every glyph in it.
+The result is kept, keyed on the string, the scale and the gap, as the
+width of the string and the quads of its glyphs relative to the pen
+position at its start in 640x480 virtual coordinates, so that text
+which is drawn every frame is only laid out once.
+================
+*/
+#define TEXT_CACHE_SIZE      256
+#define TEXT_CACHE_HASH_SIZE 512
+#define TEXT_CACHE_MAX_CHARS 96
+
+#define TEXT_COLOR_BASE      -1 // the colour the text is painted with
+#define TEXT_COLOR_EMOTICON  -2 // drawn in white, without a style
+
+typedef struct
+{
+	float     x, y, w, h;
+	float     s1, t1, s2, t2;
+	float     width; // how far the pen moves past it, less the gap
+	qhandle_t shader;
+	int       color; // TEXT_COLOR_* or an index into g_color_table
+} textQuad_t;
+
+typedef struct textLayout_s
+{
+	struct textLayout_s *hashNext;
+	struct textLayout_s *prev, *next; // most recently used first
+
+	qboolean            inuse;
+	unsigned            hash;
+	fontHandle_t        font;
+	float               scale;
+	float               gapAdjust;
+	char                text[ TEXT_CACHE_MAX_CHARS ];
+
+	float               width; // as returned by UI_Text_Width
+	float               advance; // pen position after the whole string
+	int                 numQuads;
+	textQuad_t          quads[ TEXT_CACHE_MAX_CHARS ];
+} textLayout_t;
+
+static textLayout_t textCache[ TEXT_CACHE_SIZE ];
+static textLayout_t *textCacheHash[ TEXT_CACHE_HASH_SIZE ];
+static textLayout_t textCacheList;
+
+/*
+================
+UI_Text_ClearCache
+
+Must be called when fonts or emoticons are (re)registered
+================
+*/
+void UI_Text_ClearCache( void )
+{
+	int i;
+
+	memset( textCacheHash, 0, sizeof( textCacheHash ) );
+
+	textCacheList.next = textCacheList.prev = &textCacheList;
+
+	for ( i = 0; i < TEXT_CACHE_SIZE; i++ )
+	{
+		textCache[ i ].inuse = qfalse;
+		textCache[ i ].next = &textCacheList;
+		textCache[ i ].prev = textCacheList.prev;
+		textCacheList.prev->next = &textCache[ i ];
+		textCacheList.prev = &textCache[ i ];
+	}
+}
+
+static void UI_Text_BuildLayout( textLayout_t *layout, const fontMetrics_t *font, const char *text )
+{
+	const char  *s = text;
+	textQuad_t  *quad;
+	glyphInfo_t *glyph;
+	float       x, useScale;
+	float       emoticonH, emoticonW;
+	qhandle_t   emoticonHandle;
+	qboolean    emoticonEscaped;
+	int         emoticonLen, emoticonWidth;
+	int         len, count = 0;
+	int         color = TEXT_COLOR_BASE;
+	int         ch;
+
+	useScale = layout->scale * font->glyphScale;
+
+	emoticonH = UI_EmoticonHeight( font, layout->scale );
+	emoticonW = UI_EmoticonWidth( font, layout->scale );
+
+	len = Q_UTF8_Strlen( text );
+
+	layout->width = UI_Text_Width_Generic( text, layout->scale );
+	layout->numQuads = 0;
+
+	x = UI_Parse_Indent( &s );
+
+	// this follows UI_Text_Paint_Generic without a cursor
+	while ( *s && count < len )
+	{
+		if ( Q_IsColorString( s ) )
+		{
+			color = ColorIndex( s[ 1 ] );
+			s += 2;
+			continue;
+		}
+
+		if ( *s == Q_COLOR_ESCAPE && s[ 1 ] == Q_COLOR_ESCAPE )
+		{
+			s++;
+		}
+
+		if ( *s == INDENT_MARKER )
+		{
+			s++;
+			continue;
+		}
+
+		quad = &layout->quads[ layout->numQuads++ ];
+
+		if ( UI_Text_IsEmoticon( s, &emoticonEscaped, &emoticonLen,
+		                         &emoticonHandle, &emoticonWidth ) )
+		{
+			if ( emoticonEscaped )
+			{
+				s++;
+			}
+			else
+			{
+				glyph = UI_GlyphCP( font, '[' );
+
+				quad->x = x;
+				quad->y = -useScale * glyph->top;
+				quad->w = emoticonW * emoticonWidth;
+				quad->h = emoticonH;
+				quad->s1 = quad->t1 = 0.0f;
+				quad->s2 = quad->t2 = 1.0f;
+				quad->width = quad->w;
+				quad->shader = emoticonHandle;
+				quad->color = TEXT_COLOR_EMOTICON;
+
+				x += quad->width + layout->gapAdjust;
+				s += emoticonLen;
+				count += emoticonWidth;
+				continue;
+			}
+		}
+
+		ch = Q_UTF8_CodePoint( s );
+		glyph = UI_GlyphCP( font, ch );
+
+		quad->x = x;
+		quad->y = -useScale * glyph->top;
+		quad->w = glyph->imageWidth * DC->aspectScale * useScale;
+		quad->h = glyph->imageHeight * useScale;
+		quad->s1 = glyph->s;
+		quad->t1 = glyph->t;
+		quad->s2 = glyph->s2;
+		quad->t2 = glyph->t2;
+		quad->width = glyph->xSkip * DC->aspectScale * useScale;
+		quad->shader = glyph->glyph;
+		quad->color = color;
+
+		x += quad->width + layout->gapAdjust;
+		s += Q_UTF8_WidthCP( ch );
+		count++;
+	}
+
+	layout->advance = x;
+}
+
+/*
+================
+UI_Text_Layout
+
+Returns the cached layout of a string, laying it out if it isn't
+cached, or NULL if the string is too long to be cached
+================
+*/
+static textLayout_t *UI_Text_Layout( const char *text, float scale, float gapAdjust )
+{
+	const fontMetrics_t *font;
+	textLayout_t        *layout, **prev;
+	unsigned            hash;
+	int                 length;
+
+	for ( hash = 2166136261u, length = 0; text[ length ]; length++ )
+	{
+		if ( length == TEXT_CACHE_MAX_CHARS - 1 )
+		{
+			return NULL;
+		}
+
+		hash = ( hash ^ ( byte ) text[ length ] ) * 16777619u;
+	}
+
+	hash ^= ( int )( scale * 1000.0f ) * 31 + ( int )( gapAdjust * 1000.0f );
+
+	if ( !textCacheList.next )
+	{
+		UI_Text_ClearCache();
+	}
+
+	font = UI_FontForScale( scale );
+
+	for ( layout = textCacheHash[ hash & ( TEXT_CACHE_HASH_SIZE - 1 ) ]; layout; layout = layout->hashNext )
+	{
+		if ( layout->hash == hash && layout->scale == scale &&
+		     layout->gapAdjust == gapAdjust && layout->font == font->handle &&
+		     !strcmp( layout->text, text ) )
+		{
+			break;
+		}
+	}
+
+	if ( !layout )
+	{
+		// reuse the least recently used layout
+		layout = textCacheList.prev;
+
+		if ( layout->inuse )
+		{
+			for ( prev = &textCacheHash[ layout->hash & ( TEXT_CACHE_HASH_SIZE - 1 ) ]; *prev != layout; prev = &( *prev )->hashNext )
+			{
+			}
+
+			*prev = layout->hashNext;
+		}
+
+		layout->inuse = qtrue;
+		layout->hash = hash;
+		layout->font = font->handle;
+		layout->scale = scale;
+		layout->gapAdjust = gapAdjust;
+		memcpy( layout->text, text, length + 1 );
+
+		UI_Text_BuildLayout( layout, font, text );
+
+		layout->hashNext = textCacheHash[ hash & ( TEXT_CACHE_HASH_SIZE - 1 ) ];
+		textCacheHash[ hash & ( TEXT_CACHE_HASH_SIZE - 1 ) ] = layout;
+	}
+
+	// move it to the front of the list
+	layout->prev->next = layout->next;
+	layout->next->prev = layout->prev;
+	layout->next = textCacheList.next;
+	layout->prev = &textCacheList;
+	textCacheList.next->prev = layout;
+	textCacheList.next = layout;
+
+	return layout;
+}
+
+float UI_Text_Width( const char *text, float scale )
+{
+	textLayout_t *layout;
+
+	if ( text && scale > 0.0f && ( layout = UI_Text_Layout( text, scale, 0.0f ) ) )
+	{
+		return layout->width;
+	}
+
+	return UI_Text_Width_Generic( text, scale );
+}
+
 float UI_Plain_Text_Width( const char *text, float scale )
 {
 	float      out;
@@ -2564,6 +2948,175 @@ static void UI_Text_PaintChar( float x, float y, float scale,
 	                    glyph->glyph );
 }
 
+#define TEXT_BATCH_SIZE 256
+
+static stretchPic_t textBatch[ TEXT_BATCH_SIZE ];
+static int          textBatchCount;
+static qhandle_t    textBatchShader;
+
+static void UI_Text_FlushBatch( void )
+{
+	if ( textBatchCount )
+	{
+		DC->drawStretchPics( textBatch, textBatchCount, textBatchShader );
+		textBatchCount = 0;
+	}
+}
+
+static void UI_Text_BatchQuad( const textQuad_t *quad, float x, float y, float scale,
+                               float size, const vec4_t color )
+{
+	stretchPic_t *pic;
+	float        w = quad->w, h = quad->h;
+
+	if ( quad->shader != textBatchShader || textBatchCount == TEXT_BATCH_SIZE )
+	{
+		UI_Text_FlushBatch();
+		textBatchShader = quad->shader;
+	}
+
+	x += quad->x;
+	y += quad->y;
+
+	if ( size > 0.0f )
+	{
+		float half = size * 0.5f * scale;
+		x -= half;
+		y -= half;
+		w += size * DC->aspectScale * scale;
+		h += size * scale;
+	}
+
+	UI_AdjustFrom640( &x, &y, &w, &h );
+
+	pic = &textBatch[ textBatchCount++ ];
+	pic->x = x;
+	pic->y = y;
+	pic->w = w;
+	pic->h = h;
+	pic->s1 = quad->s1;
+	pic->t1 = quad->t1;
+	pic->s2 = quad->s2;
+	pic->t2 = quad->t2;
+	pic->modulate[ 0 ] = ClampByte( color[ 0 ] * 255 );
+	pic->modulate[ 1 ] = ClampByte( color[ 1 ] * 255 );
+	pic->modulate[ 2 ] = ClampByte( color[ 2 ] * 255 );
+	pic->modulate[ 3 ] = ClampByte( color[ 3 ] * 255 );
+}
+
+static const float *UI_Text_QuadColor( const textQuad_t *quad, const vec4_t color, vec4_t codeColor )
+{
+	switch ( quad->color )
+	{
+		case TEXT_COLOR_BASE:
+			return color;
+
+		case TEXT_COLOR_EMOTICON:
+			return colorWhite;
+
+		default:
+			VectorCopy( g_color_table[ quad->color ], codeColor );
+			codeColor[ 3 ] = color[ 3 ];
+			return codeColor;
+	}
+}
+
+/*
+================
+UI_Text_Paint_Cached
+
+Paints a cached layout as runs of quads which share a shader, one
+pass of the style at a time, rather than a trap per glyph
+================
+*/
+static qboolean UI_Text_Paint_Cached( float x, float y, float scale, float gapAdjust,
+                                      const char *text, const vec4_t color, int style,
+                                      float *maxX )
+{
+	const textLayout_t *layout;
+	const textQuad_t   *quad;
+	const float        *quadColor;
+	vec4_t             codeColor, shadow, glow;
+	float              useScale;
+	int                numQuads;
+	int                i;
+
+	if ( scale <= 0.0f || !( layout = UI_Text_Layout( text, scale, gapAdjust ) ) )
+	{
+		return qfalse;
+	}
+
+	numQuads = layout->numQuads;
+
+	if ( maxX )
+	{
+		for ( i = 0; i < numQuads; i++ )
+		{
+			if ( x + layout->quads[ i ].x + layout->quads[ i ].width > *maxX )
+			{
+				break;
+			}
+		}
+
+		*maxX = x + ( i < numQuads ? layout->quads[ i ].x : layout->advance );
+		numQuads = i;
+	}
+
+	useScale = scale * UI_FontForScale( scale )->glyphScale;
+
+	if ( style == ITEM_TEXTSTYLE_SHADOWED ||
+	     style == ITEM_TEXTSTYLE_SHADOWEDMORE )
+	{
+		float ofs = ( style == ITEM_TEXTSTYLE_SHADOWED ) ? 1.0f : 2.0f;
+
+		VectorCopy( colorBlack, shadow );
+		shadow[ 3 ] = color[ 3 ];
+
+		for ( i = 0, quad = layout->quads; i < numQuads; i++, quad++ )
+		{
+			if ( quad->color != TEXT_COLOR_EMOTICON )
+			{
+				UI_Text_BatchQuad( quad, x + ofs, y + ofs, useScale, 0.0f, shadow );
+			}
+		}
+	}
+	else if ( style == ITEM_TEXTSTYLE_NEON )
+	{
+		for ( i = 0, quad = layout->quads; i < numQuads; i++, quad++ )
+		{
+			if ( quad->color != TEXT_COLOR_EMOTICON )
+			{
+				quadColor = UI_Text_QuadColor( quad, color, codeColor );
+				Vector4Copy( quadColor, glow );
+				glow[ 3 ] *= 0.2f;
+
+				UI_Text_BatchQuad( quad, x, y, useScale, 6.0f, glow );
+				UI_Text_BatchQuad( quad, x, y, useScale, 4.0f, glow );
+				UI_Text_BatchQuad( quad, x, y, useScale, 2.0f, quadColor );
+			}
+		}
+	}
+
+	for ( i = 0, quad = layout->quads; i < numQuads; i++, quad++ )
+	{
+		if ( style == ITEM_TEXTSTYLE_NEON )
+		{
+			quadColor = colorWhite;
+		}
+		else
+		{
+			quadColor = UI_Text_QuadColor( quad, color, codeColor );
+		}
+
+		UI_Text_BatchQuad( quad, x, y, useScale, 0.0f, quadColor );
+	}
+
+	UI_Text_FlushBatch();
+	DC->setColor( NULL );
+
+	return qtrue;
+}
+
 static void UI_Text_Paint_Generic( float x, float y, float scale, float gapAdjust,
                                    const char *text, vec4_t color, int style,
                                    int scrollIndex, int scrollLength, int fieldWidth,
@@ -2591,6 +3144,12 @@ static void UI_Text_Paint_Generic( float x, float y, float scale, float gapAdjus
 		return;
 	}
 
+	if ( cursorPos < 0 && !scrollLength && !fieldWidth && !( maxX && gapAdjust ) &&
+	     UI_Text_Paint_Cached( x, y, scale, gapAdjust, text, color, style, maxX ) )
+	{
+		return;
+	}
+
 	font = UI_FontForScale( scale );
 	useScale = scale * font->glyphScale;
 
@@ -8421,7 +8980,7 @@ qboolean ItemParse_cvarStrList( itemDef_t *item, int handle )
 	multiPtr->count = 0;
 	multiPtr->strDef = qtrue;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -8435,7 +8994,7 @@ qboolean ItemParse_cvarStrList( itemDef_t *item, int handle )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			PC_SourceError( handle, "end of file inside menu item" );
 			return qfalse;
@@ -8483,7 +9042,7 @@ qboolean ItemParse_cvarFloatList( itemDef_t *item, int handle )
 	multiPtr->count = 0;
 	multiPtr->strDef = qfalse;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -8495,7 +9054,7 @@ qboolean ItemParse_cvarFloatList( itemDef_t *item, int handle )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			PC_SourceError( handle, "end of file inside menu item" );
 			return qfalse;
@@ -8724,7 +9283,7 @@ qboolean Item_Parse( int handle, itemDef_t *item )
 	pc_token_t    token;
 	keywordHash_t *key;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -8736,7 +9295,7 @@ qboolean Item_Parse( int handle, itemDef_t *item )
 
 	while ( 1 )
 	{
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			PC_SourceError( handle, "end of file inside menu item" );
 			return qfalse;
@@ -8828,6 +9387,7 @@ qboolean MenuParse_font( itemDef_t *item, int handle )
 	{
 		DC->registerFont( menu->font, NULL, 48, &DC->Assets.textFont );
 		DC->Assets.fontRegistered = qtrue;
+		UI_Text_ClearCache();
 	}
 
 	return qtrue;
@@ -9304,7 +9864,7 @@ qboolean Menu_Parse( int handle, menuDef_t *menu )
 	pc_token_t    token;
 	keywordHash_t *key;
 
-	if ( !trap_Parse_ReadToken( handle, &token ) )
+	if ( !PC_ReadToken( handle, &token ) )
 	{
 		return qfalse;
 	}
@@ -9318,7 +9878,7 @@ qboolean Menu_Parse( int handle, menuDef_t *menu )
 	{
 		memset( &token, 0, sizeof( pc_token_t ) );
 
-		if ( !trap_Parse_ReadToken( handle, &token ) )
+		if ( !PC_ReadToken( handle, &token ) )
 		{
 			PC_SourceError( handle, "end of file inside menu" );
 			return qfalse;
@@ -9709,6 +10269,8 @@ void UI_R_UnregisterFont( fontHandle_t font )
 
   if( engineState & 0x02 )
     trap_R_UnregisterFont( font );
+
+  UI_Text_ClearCache();
 }
 
 const char *Gettext( const char *msgid )
@@ -392,6 +392,7 @@ typedef struct
 	void ( *drawHandlePic )( float x, float y, float w, float h, qhandle_t asset );
 	void ( *drawNoStretchPic ) ( float x, float y, float w, float h, qhandle_t asset );
 	void ( *drawStretchPic )( float x, float y, float w, float h, float s1, float t1, float s2, float t2, qhandle_t hShader );
+	void ( *drawStretchPics )( const stretchPic_t *pics, int numPics, qhandle_t hShader );
 	qhandle_t ( *registerModel )( const char *p );
 	void ( *modelBounds )( qhandle_t model, vec3_t min, vec3_t max );
 	void ( *fillRect )( float x, float y, float w, float h, const vec4_t color );
@@ -487,6 +488,9 @@ qboolean            Int_Parse( char **p, int *i );
 qboolean            Rect_Parse( char **p, rectDef_t *r );
 qboolean            String_Parse( char **p, const char **out );
 qboolean            Script_Parse( char **p, const char **out );
+int                 PC_LoadSource( const char *filename );
+int                 PC_FreeSource( int handle );
+int                 PC_ReadToken( int handle, pc_token_t *token );
 qboolean            PC_Float_Parse( int handle, float *f );
 qboolean            PC_Color_Parse( int handle, vec4_t *c );
 qboolean            PC_Int_Parse( int handle, int *i );
@@ -546,6 +550,7 @@ void        UI_Text_Paint( float x, float y, float scale, vec4_t color, const ch
 void        UI_Text_Paint_Limit( float *maxX, float x, float y, float scale,
                                  vec4_t color, const char *text, float adjust );
 float       UI_Text_Width( const char *text, float scale );
+void        UI_Text_ClearCache( void );
 float       UI_Text_Height( const char *text, float scale );
 float       UI_Text_EmWidth( float scale );
 float       UI_Text_EmHeight( float scale );
@@ -557,6 +562,7 @@ int         trap_Parse_AddGlobalDefine( const char *define );
 int         trap_Parse_LoadSource( const char *filename );
 int         trap_Parse_FreeSource( int handle );
 int         trap_Parse_ReadToken( int handle, pc_token_t *pc_token );
+int         trap_Parse_ReadTokens( int handle, pc_token_t *pc_tokens, int maxTokens );
 int         trap_Parse_SourceFileAndLine( int handle, char *filename, int *line );
 
 void        BindingFromName( const char *cvar );